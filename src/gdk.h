@@ -479,7 +479,12 @@
 #define TYPE_flt	9
 #define TYPE_dbl	10
 #define TYPE_lng	11
+#ifdef HAVE_HGE
+#define TYPE_hge	12
+#define TYPE_str	13
+#else
 #define TYPE_str	12
+#endif
 #define TYPE_any	255	/* limit types to <255! */
 
 typedef signed char bit;
@@ -641,6 +646,74 @@ typedef struct {
 	Heap *heap;		/* heap where the hash is stored */
 } Hash;
 
+typedef struct {
+	int type;		/* storage type of the column */
+	BUN count;		/* number of values covered */
+	BUN zonesize;		/* number of values per zone */
+	BUN nzones;		/* number of zones */
+	void *min;		/* minimum of each zone */
+	void *max;		/* maximum of each zone */
+	Heap *heap;		/* heap where the zone map is stored */
+} Zonemap;
+
+#define STATS_BUCKETS	32	/* buckets in the equi-depth histogram */
+#define STATS_KMV	256	/* hash values kept for the distinct count */
+
+typedef struct {
+	int type;		/* storage type of the column */
+	int version;		/* layout version of the saved statistics */
+	BUN count;		/* number of values covered */
+	BUN nils;		/* number of nil values */
+	BUN distinct;		/* estimated number of distinct values */
+	BUN hcount;		/* number of values when histogram was made */
+	dbl min, max;		/* smallest and largest value (min > max: none) */
+	int nbounds;		/* number of histogram bounds (0 or BUCKETS+1) */
+	int nkmv;		/* number of hash values in kmv */
+	dbl bounds[STATS_BUCKETS + 1];	/* bucket bounds, equal counts per bucket */
+	lng kmv[STATS_KMV];	/* smallest hash values seen, ascending */
+} Colstats;
+
+typedef struct {
+	union {
+		lng l;		/* bte, sht, int and lng columns */
+		dbl d;		/* flt and dbl columns */
+	} v;			/* the bound */
+	int incl;		/* values <= v (else < v) lie before pos */
+	BUN pos;		/* first position beyond the bound */
+} Crackpivot;
+
+typedef struct {
+	int type;		/* storage type of the column */
+	BUN count;		/* number of values of the column covered */
+	BUN n;			/* number of values copied (no nils or NaNs) */
+	BUN cap;		/* allocated size of vals and oids */
+	void *vals;		/* copy of the values, partitioned into pieces */
+	oid *oids;		/* position in the column of each copied value */
+	int npivots;		/* number of piece boundaries */
+	int maxpivots;		/* allocated size of pivots */
+	Crackpivot *pivots;	/* piece boundaries in ascending order */
+	MT_Lock lock;		/* serializes the selects that crack */
+} Cracker;
+
+/* compressed candidate lists, see gdk_cand.c */
+#define CAND_DENSE	0	/* all oids in [first, last) */
+#define CAND_LIST	1	/* the tail of the candidate BAT list */
+#define CAND_RUNS	2	/* the ranges [runs[2i], runs[2i+1]) */
+#define CAND_BITMAP	3	/* first + i for each bit i set in bits */
+
+typedef unsigned long long candword;
+#define CANDWORDBITS	64
+
+typedef struct {
+	int kind;
+	oid first, last;	/* all candidates are in [first, last) */
+	BUN count;		/* number of candidates */
+	struct BAT *list;	/* CAND_LIST */
+	oid *runs;		/* CAND_RUNS, nruns pairs */
+	BUN nruns;
+	candword *bits;		/* CAND_BITMAP */
+} Cand;
+
 /*
  * @+ Binary Association Tables
  * Having gone to the previous preliminary definitions, we will now
@@ -709,6 +782,9 @@ typedef struct {
 		str sval;
 		dbl dval;
 		lng lval;
+#ifdef HAVE_HGE
+		hge hval;
+#endif
 	} val;
 	int len, vtype;
 } *ValPtr, ValRecord;
@@ -857,6 +933,10 @@ typedef struct {
 	Heap heap;		/* space for the column. */
 	Heap *vheap;		/* space for the varsized data. */
 	Hash *hash;		/* hash table */
+	Zonemap *zonemap;	/* min/max per zone */
+	Colstats *stats;	/* column statistics */
+	Cracker *cracker;	/* cracker index */
+	Cand *cand;		/* compressed candidates (see CANDtoBAT) */
 
 	PROPrec *props;		/* list of dynamic properties stored in the bat descriptor */
 } COLrec;
@@ -1527,6 +1607,7 @@ gdk_export BAT *BATmark(BAT *b, oid base);
 gdk_export BAT *BATmark_grp(BAT *b, BAT *g, oid *base);
 
 gdk_export gdk_return BATgroup(BAT **groups, BAT **extents, BAT **histo, BAT *b, BAT *g, BAT *e, BAT *h);
+gdk_export gdk_return BATgroup_multi(BAT **groups, BAT **extents, BAT **histo, BAT **cols, int ncols);
 
 /*
  * @- BAT Input/Output
@@ -2134,15 +2215,38 @@ gdk_export oid OIDnew(oid inc);
  *  BAThash (BAT *b, BUN masksize)
  * @end multitable
  *
- * The current BAT implementation supports one search accelerator:
- * hashing. The routine BAThash makes sure that a hash accelerator on
- * the head of the BAT exists. A zero is returned upon failure to
- * create the supportive structures.
+ * The current BAT implementation supports two search accelerators:
+ * hashing and zone maps. The routine BAThash makes sure that a hash
+ * accelerator on the head of the BAT exists. A zero is returned upon
+ * failure to create the supportive structures.
  *
  * The hash data structures are currently maintained during update
  * operations.
+ *
+ * BATzonemap makes sure that a zone map (the minimum and maximum
+ * value of each block of a few cache lines) on the head of the BAT
+ * exists.  Zone maps only exist for fixed-width numeric columns, are
+ * extended by appends, dropped by other updates, and saved with the
+ * BAT.
+ *
+ * BATstats makes sure that statistics (minimum, maximum, number of
+ * nils, an estimate of the number of distinct values and an
+ * equi-depth histogram) of the head of the BAT exist.  They are only
+ * kept for fixed-width numeric columns, are extended by appends,
+ * dropped by other updates, and saved with the BAT.  Select, join and
+ * group use them for their size estimates when they exist.
+ *
+ * BATcrack gives the head of a BAT with a dense tail a cracker index:
+ * a copy of the column that every range select on it partitions a
+ * little further, so that later selects only look at the pieces that
+ * overlap their range.  It is only made on request, for fixed-width
+ * numeric columns, lives in memory only, absorbs appends and is
+ * dropped by other updates.
  */
 gdk_export BAT *BAThash(BAT *b, BUN masksize);
+gdk_export BAT *BATzonemap(BAT *b);
+gdk_export BAT *BATstats(BAT *b);
+gdk_export BAT *BATcrack(BAT *b);
 gdk_export BAT *BAThashjoin(BAT *l, BAT *r, BUN estimate);
 
 /* low level functions */
@@ -2298,6 +2402,9 @@ VALptr(const ValRecord *v)
 	case TYPE_flt: return (const void *) &v->val.fval;
 	case TYPE_dbl: return (const void *) &v->val.dval;
 	case TYPE_lng: return (const void *) &v->val.lval;
+#ifdef HAVE_HGE
+	case TYPE_hge: return (const void *) &v->val.hval;
+#endif
 	case TYPE_str: return (const void *) v->val.sval;
 	default:       return (const void *) v->val.pval;
 	}
@@ -2390,6 +2497,12 @@ VALptr(const ValRecord *v)
 		((((lng)normal_int_SWAP(l))<<32) |\
 		 (0xffffffff&normal_int_SWAP(l>>32)))
 
+#ifdef HAVE_HGE
+#define huge_int_SWAP(h) \
+		((((hge)long_long_SWAP(h))<<64) |\
+		 (0xffffffffffffffff&long_long_SWAP(h>>64)))
+#endif
+
 /*
  * The kernel maintains a central table of all active threads.  They
  * are indexed by their tid. The structure contains information on the
@@ -2703,9 +2816,14 @@ gdk_export int ALIGNsetH(BAT *b1, BAT *b2);
 
 #define ALIGNset(x,y)	do {ALIGNsetH(x,y);ALIGNsetT(x,y);} while (0)
 #define ALIGNsetT(x,y)	ALIGNsetH(BATmirror(x),BATmirror(y))
-#define ALIGNins(x,y,f)	do {if (!(f)) VIEWchk(x,y,BAT_READ);(x)->halign=(x)->talign=0; } while (0)
-#define ALIGNdel(x,y,f)	do {if (!(f)) VIEWchk(x,y,BAT_READ|BAT_APPEND);(x)->halign=(x)->talign=0; } while (0)
-#define ALIGNinp(x,y,f) do {if (!(f)) VIEWchk(x,y,BAT_READ|BAT_APPEND);(x)->talign=0; } while (0)
+/* any update but an append invalidates the zone maps, column
+ * statistics and cracker indices */
+#define ZONEzap(x)	do {if ((x)->H->zonemap || (x)->T->zonemap) ZONEdestroy(x); } while (0)
+#define STATSzap(x)	do {if ((x)->H->stats || (x)->T->stats) STATSdestroy(x); } while (0)
+#define CRACKzap(x)	do {if ((x)->H->cracker || (x)->T->cracker) CRACKdestroy(x); } while (0)
+#define ALIGNins(x,y,f)	do {if (!(f)) VIEWchk(x,y,BAT_READ);(x)->halign=(x)->talign=0; ZONEzap(x); STATSzap(x); CRACKzap(x); } while (0)
+#define ALIGNdel(x,y,f)	do {if (!(f)) VIEWchk(x,y,BAT_READ|BAT_APPEND);(x)->halign=(x)->talign=0; ZONEzap(x); STATSzap(x); CRACKzap(x); } while (0)
+#define ALIGNinp(x,y,f) do {if (!(f)) VIEWchk(x,y,BAT_READ|BAT_APPEND);(x)->talign=0; ZONEzap(x); STATSzap(x); CRACKzap(x); } while (0)
 #define ALIGNapp(x,y,f) do {if (!(f)) VIEWchk(x,y,BAT_READ);(x)->talign=0; } while (0)
 
 #define BAThrestricted(b) (VIEWhparent(b) ? BBP_cache(VIEWhparent(b))->batRestricted : (b)->batRestricted)
@@ -3110,6 +3228,14 @@ gdk_export int BATtopN(BAT *b, BUN topN);	/* used in monet5/src/modules/kernel/a
 #define JOIN_BAND	3
 
 gdk_export BAT *BATsubselect(BAT *b, BAT *s, const void *tl, const void *th, int li, int hi, int anti);
+/* one predicate of BATsubselect_conj: the fields are the arguments
+ * of BATsubselect */
+typedef struct {
+	BAT *b;
+	const void *tl, *th;
+	int li, hi, anti;
+} selpred_t;
+gdk_export BAT *BATsubselect_conj(BAT *s, const selpred_t *preds, int npreds);
 gdk_export BAT *BATthetasubselect(BAT *b, BAT *s, const void *val, const char *op);
 gdk_export BAT *BATselect_(BAT *b, const void *tl, const void *th, bit li, bit hi);
 gdk_export BAT *BATuselect_(BAT *b, const void *tl, const void *th, bit li, bit hi);
@@ -3146,6 +3272,140 @@ gdk_export BAT *BATkdiff(BAT *b, BAT *c);
 gdk_export BAT *BATmergecand(BAT *a, BAT *b);
 gdk_export BAT *BATintersectcand(BAT *a, BAT *b);
 
+/*
+ * @- Compressed candidate lists
+ * A Cand (see gdk_cand.c) is a set of oids, stored as a range, an oid
+ * list, a list of ranges or a bitmap.  CANDtoBAT turns it into a
+ * candidate BAT; if it is a list of ranges or a bitmap, that is a
+ * compact candidate BAT: the count is the number of candidates, the
+ * tail is void without seqbase (so BATtdense is false), and the Cand
+ * is kept in T->cand.  Compact candidate BATs are transient and
+ * read-only, and are only understood as the candidate list s of the
+ * selections, of the BATcalc and aggregate functions (everything that
+ * uses CANDINIT), as left input of BATfetchjoin and BATleftfetchjoin,
+ * and as input of BATmergecand and BATintersectcand.  The selections return compact
+ * candidate BATs when given one.  BATcandlist turns a compact
+ * candidate BAT into an ordinary one for all other uses.
+ *
+ * CANDiter and CANDiternext iterate over the candidates of any
+ * (not dense) candidate BAT.
+ */
+#define BATtcand(b)	((b)->T->cand != NULL)
+
+typedef struct {
+	const BAT *s;		/* the candidate BAT */
+	int kind;		/* CAND_LIST, CAND_RUNS or CAND_BITMAP */
+	oid next;		/* current candidate, oid_nil at the end */
+	oid last;		/* one beyond the last candidate */
+	BUN count;		/* number of candidates, including next */
+	const oid *list, *listend; /* CAND_LIST: candidates after next */
+	const oid *runs, *runsend; /* CAND_RUNS: runs after that of next */
+	oid runend;		/* CAND_RUNS: end of the run of next */
+	const candword *bits;	/* CAND_BITMAP: word of next */
+	oid base;		/* CAND_BITMAP: oid of the first bit of *bits */
+	candword w;		/* CAND_BITMAP: bits of *bits after next */
+} CandIter;
+
+gdk_export Cand *CANDnew(int kind, oid first, oid last);
+gdk_export void CANDdestroy(Cand *c);
+gdk_export Cand *CANDcompact(Cand *c);
+gdk_export Cand *CANDfromBAT(BAT *s);
+gdk_export BAT *CANDtoBAT(Cand *c);
+gdk_export BAT *BATcandlist(BAT *s);
+gdk_export void CANDiter(CandIter *ci, const BAT *s, oid lo, oid hi);
+gdk_export Cand *CANDintersect(const Cand *a, const Cand *b);
+gdk_export Cand *CANDunion(const Cand *a, const Cand *b);
+gdk_export Cand *BATsubselect_cand(BAT *b, BAT *s, const void *tl, const void *th, int li, int hi, int anti);
+
+/* bit counting on the words of candidate bitmaps */
+static inline int
+candword_popcount(candword w)
+{
+#ifdef __GNUC__
+	return __builtin_popcountll(w);
+#else
+	int n;
+
+	for (n = 0; w; n++)
+		w &= w - 1;
+	return n;
+#endif
+}
+
+/* number of trailing zero bits, w != 0 */
+static inline int
+candword_ctz(candword w)
+{
+#ifdef __GNUC__
+	return __builtin_ctzll(w);
+#else
+	int n = 0;
+
+	while ((w & 1) == 0) {
+		w >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+/* number of leading zero bits, w != 0 */
+static inline int
+candword_clz(candword w)
+{
+#ifdef __GNUC__
+	return __builtin_clzll(w);
+#else
+	int n = 0;
+
+	while ((w & ((candword) 1 << (CANDWORDBITS - 1))) == 0) {
+		w <<= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+/* return the current candidate (ci->next) and advance to the next
+ * one, which is oid_nil after the last */
+static inline oid
+CANDiternext(CandIter *ci)
+{
+	oid o = ci->next;
+
+	switch (ci->kind) {
+	case CAND_LIST:
+		ci->next = ci->list < ci->listend ? *ci->list++ : oid_nil;
+		break;
+	case CAND_RUNS:
+		if (++ci->next < ci->runend)
+			break;
+		if (ci->runs == ci->runsend) {
+			ci->next = oid_nil;
+			break;
+		}
+		ci->next = ci->runs[0];
+		ci->runend = ci->runs[1] < ci->last ? ci->runs[1] : ci->last;
+		ci->runs += 2;
+		break;
+	default:		/* CAND_BITMAP */
+		while (ci->w == 0) {
+			if (ci->base + CANDWORDBITS >= ci->last) {
+				ci->next = oid_nil;
+				return o;
+			}
+			ci->w = *++ci->bits;
+			ci->base += CANDWORDBITS;
+		}
+		ci->next = ci->base + (oid) candword_ctz(ci->w);
+		ci->w &= ci->w - 1;
+		if (ci->next >= ci->last)
+			ci->next = oid_nil;
+		break;
+	}
+	return o;
+}
+
 #include "gdk_calc.h"
 
 /*
@@ -21,6 +21,7 @@
 #include "gdk.h"
 #include "gdk_private.h"
 #include "gdk_calc_private.h"
+#include "gdk_mapreduce.h"
 #include <math.h>
 
 /*
@@ -72,19 +73,20 @@
  *
  * This function finds the minimum and maximum group id (and the
  * number of groups) and initializes the variables for candidates
- * selection.
+ * selection: *cip is NULL if all positions in [*startp, *endp) are
+ * candidates, otherwise it is cisp, set up to iterate over them.
  */
 const char *
 BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 		 /* outputs: */
 		 oid *minp, oid *maxp, BUN *ngrpp, BUN *startp, BUN *endp,
-		 BUN *cntp, const oid **candp, const oid **candendp)
+		 BUN *cntp, CandIter *cisp, CandIter **cip)
 {
 	oid min, max;
 	BUN i, ngrp;
 	const oid *gids;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	if (b == NULL || !BAThdense(b))
 		return "b must be dense-headed";
@@ -149,20 +151,917 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 	*startp = start;
 	*endp = end;
 	*cntp = cnt;
-	*candp = cand;
-	*candendp = candend;
+	if (ci) {
+		*cisp = cis;
+		ci = cisp;
+	}
+	*cip = ci;
+
+	return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+/* parallel grouped aggregation */
+
+/* Big grouped aggregates (sum, count, min, max, avg) are computed by
+ * several threads.  There are two ways of splitting up the work:
+ * - the input is cut into one range of rows per thread, and each
+ *   thread aggregates its rows into private partial result arrays,
+ *   which are merged afterwards, range after range, so that for each
+ *   group the merge sees the partials in input order;
+ * - the groups are cut into one range per thread, and each thread
+ *   aggregates the rows that belong to its own groups directly into
+ *   the result.  The rows are first radix-partitioned on the range of
+ *   their group (in parallel, keeping them in input order), so that
+ *   each thread only reads its own rows; if there is no memory for
+ *   that, each thread scans all of the input instead.
+ * The first is used when the partial results are small compared to
+ * the input and the aggregate can be merged exactly: counts, minimums
+ * and maximums, averages of small integer types, and sums that
+ * cannot overflow.  Otherwise the second is used: there every group
+ * is still aggregated in input order by a single thread, so results
+ * are those of the sequential code, also for floating point types
+ * and in the presence of overflow.
+ *
+ * Worker threads do not call GDKerror; failures are recorded per
+ * piece and reported by the caller. */
+
+#define AGGR_PARALLEL_MINSIZE	((BUN) 1 << 20)
+#define AGGR_MAXPIECES		64
+
+#define AGGR_ERR_OVERFLOW	1
+#define AGGR_ERR_MALLOC		2
+
+typedef struct {
+	BAT *b;
+	const oid *gids;
+	oid min, max;
+	BUN ngrp;
+	BUN start, end;
+	const CandIter *ci;	/* the candidates, before iterating */
+	int skip_nils, abort_on_error;
+	int tp1, tp2;		/* input type and result type */
+	const void *values;	/* sum: the values (instead of b) */
+	oid seqb;
+	int nonil;
+	int prec;		/* sketches: log2 of the registers per group */
+	int mergeall;		/* merge also after failure, to free partials */
+	int failed;		/* error code of the pieces, for merge */
+	int local;		/* private partials per range of rows? */
+	BUN n;			/* number of rows (local: to split up) */
+	BUN grain;		/* rows (local) or groups per piece */
+	BUN npieces;
+	BUN mgrain;		/* groups per piece of the merge */
+	oid *rows;		/* groups: the rows (as oids) of the pieces */
+	BUN *hist;		/* groups: rows per chunk and piece */
+	BUN pgrain;		/* groups: rows per chunk of partitioning */
+	BUN bounds[AGGR_MAXPIECES + 1]; /* groups: rows of piece p */
+	void *res[3];		/* result arrays */
+	void *part[AGGR_MAXPIECES][3]; /* local: partial result arrays */
+	BUN nils[AGGR_MAXPIECES];
+	BUN mnils[AGGR_MAXPIECES];
+	int err[AGGR_MAXPIECES];
+} aggrpar_t;
+
+/* Decide whether (and how) to do a grouped aggregate in parallel;
+ * canmerge tells whether partial results can be merged exactly.
+ * Returns 0 if the sequential code is to be used. */
+static int
+aggr_parallel_init(aggrpar_t *a, BAT *b, const oid *gids, oid min, oid max,
+		   BUN ngrp, BUN start, BUN end, const CandIter *ci,
+		   int skip_nils, int abort_on_error, int tp1, int tp2,
+		   int canmerge, const char *func)
+{
+	int nthreads = GDKnr_threads;
+	BUN n = ci ? ci->count : end - start;
+
+	/* with a dense g every row is a group of its own, a case
+	 * not worth the effort */
+	if (nthreads <= 1 || gids == NULL || ngrp <= 1 ||
+	    n < AGGR_PARALLEL_MINSIZE)
+		return 0;
+	if (nthreads > AGGR_MAXPIECES)
+		nthreads = AGGR_MAXPIECES;
+
+	memset(a, 0, sizeof(*a));
+	a->b = b;
+	a->gids = gids;
+	a->min = min;
+	a->max = max;
+	a->ngrp = ngrp;
+	a->start = start;
+	a->end = end;
+	a->ci = ci;
+	a->skip_nils = skip_nils;
+	a->abort_on_error = abort_on_error;
+	a->tp1 = tp1;
+	a->tp2 = tp2;
+	a->seqb = b ? b->hseqbase : 0;
+	a->n = n;
+	a->local = canmerge && (BUN) nthreads * ngrp <= n / 4;
+	if (a->local) {
+		/* with candidates, the pieces are ranges of rows
+		 * nonetheless, each with the candidates in it */
+		if (ci)
+			a->n = end - start;
+		a->grain = (a->n + nthreads - 1) / nthreads;
+		a->npieces = (a->n + a->grain - 1) / a->grain;
+	} else {
+		/* multiples of 32 groups, so that pieces don't share
+		 * words of a bitmap of groups */
+		a->grain = ((ngrp + nthreads - 1) / nthreads + 31) & ~(BUN) 31;
+		a->npieces = (ngrp + a->grain - 1) / a->grain;
+	}
+	a->mgrain = ((ngrp + nthreads - 1) / nthreads + 31) & ~(BUN) 31;
+	if (a->npieces <= 1)
+		return 0;
+	ALGODEBUG fprintf(stderr, "#%s: parallel, %s, " BUNFMT " pieces\n",
+			  func, a->local ? "partials per row range" :
+			  "per group range", a->npieces);
+	return 1;
+}
+
+/* Set up the rows, candidates (in cis, if any) and groups for a
+ * piece; returns the piece number.  For private partials the piece is
+ * a range of rows, otherwise a range of groups, and then the caller
+ * must offset its result arrays by lo. */
+static BUN
+aggr_piece(const aggrpar_t *a, BUN lo, BUN hi, BUN *startp, BUN *endp,
+	   CandIter *cis, CandIter **cip, oid *minp, oid *maxp)
+{
+	*cip = NULL;
+	if (a->local) {
+		*startp = a->start + lo;
+		*endp = a->start + hi;
+		if (a->ci) {
+			CANDiter(cis, a->ci->s, a->seqb + *startp,
+				 a->seqb + *endp);
+			*cip = cis;
+		}
+		*minp = a->min;
+		*maxp = a->max;
+	} else {
+		if (a->rows) {
+			/* the rows of the groups of this piece */
+			CANDiterlist(cis, a->rows + a->bounds[lo / a->grain],
+				     a->bounds[lo / a->grain + 1] -
+				     a->bounds[lo / a->grain]);
+			*cip = cis;
+		} else if (a->ci) {
+			/* a copy, to iterate over all candidates */
+			*cis = *a->ci;
+			*cip = cis;
+		}
+		*startp = a->start;
+		*endp = a->end;
+		*minp = a->min + lo;
+		*maxp = a->min + hi - 1;
+	}
+	return lo / a->grain;
+}
+
+/* One pass of the partitioning of the rows by piece, over the chunk
+ * of rows [lo, hi): count the rows per piece, or scatter them. */
+static void
+aggr_part_pass(aggrpar_t *a, BUN lo, BUN hi, int scatter)
+{
+	CandIter cis, *ci = NULL;
+	BUN start = a->start + lo, end = a->start + hi, i;
+	BUN *h = a->hist + (lo / a->pgrain) * a->npieces;
+	oid gid;
+
+	if (a->ci) {
+		CANDiter(&cis, a->ci->s, a->seqb + start, a->seqb + end);
+		ci = &cis;
+	}
+	for (;;) {
+		if (ci) {
+			if (ci->next == oid_nil)
+				break;
+			i = CANDiternext(ci) - a->seqb;
+		} else {
+			i = start++;
+			if (i == end)
+				break;
+		}
+		gid = a->gids[i];
+		if (gid < a->min || gid > a->max)
+			continue;
+		if (scatter)
+			a->rows[h[(gid - a->min) / a->grain]++] = a->seqb + i;
+		else
+			h[(gid - a->min) / a->grain]++;
+	}
+}
+
+static void
+aggr_part_count(BUN lo, BUN hi, void *arg)
+{
+	aggr_part_pass(arg, lo, hi, 0);
+}
+
+static void
+aggr_part_scatter(BUN lo, BUN hi, void *arg)
+{
+	aggr_part_pass(arg, lo, hi, 1);
+}
+
+/* Radix-partition the rows on the range of groups of the pieces, in
+ * a->rows, piece after piece and each in input order.  On failure
+ * a->rows stays NULL and the pieces scan all rows. */
+static void
+aggr_partition(aggrpar_t *a)
+{
+	BUN n = a->end - a->start, nchunks, c, p, tot, cnt;
+	int nthreads = GDKnr_threads;
+
+	if (nthreads > AGGR_MAXPIECES)
+		nthreads = AGGR_MAXPIECES;
+	a->pgrain = (n + nthreads - 1) / nthreads;
+	nchunks = (n + a->pgrain - 1) / a->pgrain;
+	a->hist = GDKzalloc(nchunks * a->npieces * sizeof(BUN));
+	if (a->hist == NULL)
+		return;
+	MRparallel_for(0, n, a->pgrain, aggr_part_count, a);
+	/* turn the counts into the offsets of the chunks in rows */
+	for (p = 0, tot = 0; p < a->npieces; p++) {
+		a->bounds[p] = tot;
+		for (c = 0; c < nchunks; c++) {
+			cnt = a->hist[c * a->npieces + p];
+			a->hist[c * a->npieces + p] = tot;
+			tot += cnt;
+		}
+	}
+	a->bounds[a->npieces] = tot;
+	if ((a->rows = GDKmalloc(MAX(tot, 1) * sizeof(oid))) != NULL)
+		MRparallel_for(0, n, a->pgrain, aggr_part_scatter, a);
+	GDKfree(a->hist);
+	a->hist = NULL;
+	ALGODEBUG fprintf(stderr, "#aggr_partition: " BUNFMT " rows in "
+			  BUNFMT " pieces%s\n", tot, a->npieces,
+			  a->rows ? "" : ": out of memory");
+}
+
+/* Do the work: allocate the partials (widths are the per-group sizes
+ * of up to three partial arrays, 0 terminated, -1 for a bitmap), run
+ * piece over all pieces and then, for partials, merge over all
+ * ranges of groups.  If a->mergeall is set, the merge is also run
+ * after a piece failed (with a->failed set), so that it can release
+ * what the partials refer to.  Returns the number of nils counted by
+ * the pieces and merges, or BUN_NONE after reporting an error. */
+static BUN
+aggr_parallel_run(aggrpar_t *a, const int *widths,
+		  void (*piece)(BUN, BUN, void *),
+		  void (*merge)(BUN, BUN, void *), const char *func)
+{
+	BUN p, nils = 0;
+	int k, err = 0;
+
+	if (a->local) {
+		for (p = 0; p < a->npieces && err == 0; p++) {
+			for (k = 0; k < 3 && widths[k] != 0; k++) {
+				size_t sz = widths[k] < 0 ?
+					((a->ngrp + 31) / 32) * sizeof(int) :
+					a->ngrp * (size_t) widths[k];
+				if ((a->part[p][k] = GDKmalloc(sz)) == NULL) {
+					err = AGGR_ERR_MALLOC;
+					break;
+				}
+			}
+		}
+	}
+	if (err != 0)
+		goto bailout;
+	if (!a->local)
+		aggr_partition(a);
+	MRparallel_for(0, a->local ? a->n : a->ngrp, a->grain, piece, a);
+	for (p = 0; p < a->npieces && err == 0; p++) {
+		err = a->err[p];
+		nils += a->nils[p];
+	}
+	if ((err == 0 || a->mergeall) && a->local) {
+		a->failed = err;
+		MRparallel_for(0, a->ngrp, a->mgrain, merge, a);
+		for (p = 0; p * a->mgrain < a->ngrp; p++) {
+			nils += a->mnils[p];
+			if (err == 0)
+				err = a->err[p];
+		}
+	}
+  bailout:
+	for (p = 0; p < a->npieces; p++)
+		for (k = 0; k < 3; k++)
+			if (a->part[p][k])
+				GDKfree(a->part[p][k]);
+	if (a->rows) {
+		GDKfree(a->rows);
+		a->rows = NULL;
+	}
+	switch (err) {
+	case 0:
+		return nils;
+	case AGGR_ERR_OVERFLOW:
+		GDKerror("22003!overflow in calculation.\n");
+		return BUN_NONE;
+	default:
+		GDKerror("%s: cannot allocate enough memory.\n", func);
+		return BUN_NONE;
+	}
+}
+
+/* largest value of an integer type, 0 for other types */
+static lng
+aggr_intmax(int tp)
+{
+	switch (ATOMstorage(tp)) {
+	case TYPE_bte:
+		return GDK_bte_max;
+	case TYPE_sht:
+		return GDK_sht_max;
+	case TYPE_int:
+		return GDK_int_max;
+	case TYPE_lng:
+		return GDK_lng_max;
+	default:
+		return 0;
+	}
+}
+
+/* can n values of integer type tp1 be added up in type tp2 (in any
+ * order) without overflow? */
+static int
+aggr_nooverflow(int tp1, int tp2, BUN n)
+{
+	lng max1 = aggr_intmax(tp1), max2 = aggr_intmax(tp2);
+
+#ifdef HAVE_HGE
+	if (ATOMstorage(tp2) == TYPE_hge)
+		return max1 > 0;
+#endif
+	return max1 > 0 && max1 < GDK_lng_max && max2 > 0 &&
+		n <= (BUN) (max2 / (max1 + 1));
+}
+
+/* is t one of the fixed-width types the parallel code handles? */
+static int
+aggr_fixedtype(int t)
+{
+	switch (t) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* ---------------------------------------------------------------------- */
+/* blocked ungrouped sums, products, minimums and maximums */
+
+/* Without groups and candidates, integer sums and products, and the
+ * minimum and maximum of fixed-width types are computed a block of
+ * AGGR_BLOCK values at a time.  A branch-free kernel, simple enough
+ * for the compiler to vectorize, reduces the block to a partial
+ * result using wide (or, for lng, wrap-around) arithmetic, together
+ * with the range that the running result could pass through while
+ * adding the values one by one: for a sum the block minimum and
+ * maximum times the block size, for a product the largest absolute
+ * value to the power of the number of values that are not -1, 0 or
+ * 1.  If that range fits in the result type, no value of the block
+ * can cause an overflow and the partial result is used as is;
+ * otherwise, and if the block contains a nil that is not to be
+ * skipped, the block is redone by a checked loop that does exactly
+ * what the element-at-a-time loops of AGGR_SUM and AGGR_PROD do.  So
+ * the results, errors included, are those of those loops.
+ *
+ * Big inputs are cut into pieces that are reduced by several threads
+ * with the kernels only.  The caller then combines the pieces in
+ * order, and redoes a piece with the checked loops when its range
+ * does not fit around the running result.
+ *
+ * Floating point sums and products are not done this way, since
+ * adding the values in a different order gives different results. */
+
+#define AGGR_BLOCK		((BUN) 4096)
+#define AGGR_BLOCKED_MINSIZE	(4 * AGGR_BLOCK)
+/* the ranges are computed in dbl, so leave some room for rounding */
+#define AGGR_RANGE(max)		((dbl) (max) * (1 - 1.0 / 1024))
+
+typedef BUN (*aggr_sumblk)(const void *vals, BUN n, int nonil,
+			   lng *sump, lng *minp, lng *maxp);
+typedef BUN (*aggr_prodblk)(const void *vals, BUN n, int nonil,
+			    lng *prodp, dbl *boundp);
+typedef BUN (*aggr_minmaxblk)(const void *vals, BUN n, int nonil,
+			      void *minp, void *maxp);
+
+/* sum (modulo 2^64) and the minimum and maximum of the non-nil values
+ * of a block and zero; returns the number of nils */
+#define SUMBLK(TYPE)							\
+static BUN								\
+sumblk_##TYPE(const void *vals_, BUN n, int nonil,			\
+	      lng *sump, lng *minp, lng *maxp)				\
+{									\
+	const TYPE *vals = (const TYPE *) vals_;			\
+	ulng sum = 0;							\
+	TYPE mn = 0, mx = 0;						\
+	BUN k, nils = 0;						\
+									\
+	if (nonil) {							\
+		for (k = 0; k < n; k++) {				\
+			const TYPE x = vals[k];				\
+			sum += (ulng) (lng) x;				\
+			mn = x < mn ? x : mn;				\
+			mx = x > mx ? x : mx;				\
+		}							\
+	} else {							\
+		for (k = 0; k < n; k++) {				\
+			const int isnil = vals[k] == TYPE##_nil;	\
+			const TYPE x = isnil ? 0 : vals[k];		\
+			sum += (ulng) (lng) x;				\
+			mn = x < mn ? x : mn;				\
+			mx = x > mx ? x : mx;				\
+			nils += isnil;					\
+		}							\
+	}								\
+	*sump = (lng) sum;						\
+	*minp = mn;							\
+	*maxp = mx;							\
+	return nils;							\
+}
+
+/* product (modulo 2^64) of the non-nil values of a block, and a bound
+ * on the absolute value of the product of any of its prefixes;
+ * returns the number of nils */
+#define PRODBLK(TYPE)							\
+static BUN								\
+prodblk_##TYPE(const void *vals_, BUN n, int nonil,			\
+	       lng *prodp, dbl *boundp)					\
+{									\
+	const TYPE *vals = (const TYPE *) vals_;			\
+	ulng prod = 1;							\
+	ulng mx = 1;							\
+	BUN k, big = 0, nils = 0;					\
+									\
+	for (k = 0; k < n; k++) {					\
+		const int isnil = !nonil && vals[k] == TYPE##_nil;	\
+		const TYPE x = isnil ? 1 : vals[k];			\
+		const ulng ax = x < 0 ? -(ulng) (lng) x : (ulng) (lng) x; \
+		prod *= (ulng) (lng) x;					\
+		mx = ax > mx ? ax : mx;					\
+		big += ax > 1;						\
+		nils += isnil;						\
+	}								\
+	*prodp = (lng) prod;						\
+	*boundp = big == 0 ? 1 : big >= 64 ? GDK_dbl_max :		\
+		pow((dbl) mx, (dbl) big);				\
+	return nils;							\
+}
+
+/* minimum and maximum of the non-nil values of a block (nil is the
+ * smallest value of these types, so a block without values has
+ * maximum nil); returns the number of nils */
+#define MINMAXBLK(TYPE)							\
+static BUN								\
+minmaxblk_##TYPE(const void *vals_, BUN n, int nonil,			\
+		 void *minp, void *maxp)				\
+{									\
+	const TYPE *vals = (const TYPE *) vals_;			\
+	TYPE mn = GDK_##TYPE##_max, mx = TYPE##_nil;			\
+	BUN k, nils = 0;						\
+									\
+	if (nonil) {							\
+		for (k = 0; k < n; k++) {				\
+			const TYPE x = vals[k];				\
+			mn = x < mn ? x : mn;				\
+			mx = x > mx ? x : mx;				\
+		}							\
+	} else {							\
+		for (k = 0; k < n; k++) {				\
+			const int isnil = vals[k] == TYPE##_nil;	\
+			const TYPE x = isnil ? GDK_##TYPE##_max : vals[k]; \
+			mn = x < mn ? x : mn;				\
+			mx = vals[k] > mx ? vals[k] : mx;		\
+			nils += isnil;					\
+		}							\
+	}								\
+	* (TYPE *) minp = mn;						\
+	* (TYPE *) maxp = mx;						\
+	return nils;							\
+}
+
+SUMBLK(bte)
+SUMBLK(sht)
+SUMBLK(int)
+SUMBLK(lng)
+PRODBLK(bte)
+PRODBLK(sht)
+PRODBLK(int)
+PRODBLK(lng)
+MINMAXBLK(bte)
+MINMAXBLK(sht)
+MINMAXBLK(int)
+MINMAXBLK(lng)
+MINMAXBLK(flt)
+MINMAXBLK(dbl)
+
+/* the kernels for integer type tp1 summed or multiplied into integer
+ * type tp2, or NULL */
+static aggr_sumblk
+sumblk_find(int tp1, int tp2)
+{
+	if (aggr_intmax(tp2) == 0 || aggr_intmax(tp1) > aggr_intmax(tp2))
+		return NULL;
+	switch (ATOMstorage(tp1)) {
+	case TYPE_bte: return sumblk_bte;
+	case TYPE_sht: return sumblk_sht;
+	case TYPE_int: return sumblk_int;
+	case TYPE_lng: return sumblk_lng;
+	}
+	return NULL;
+}
 
+static aggr_prodblk
+prodblk_find(int tp1, int tp2)
+{
+	if (aggr_intmax(tp2) == 0 || aggr_intmax(tp1) > aggr_intmax(tp2))
+		return NULL;
+	switch (ATOMstorage(tp1)) {
+	case TYPE_bte: return prodblk_bte;
+	case TYPE_sht: return prodblk_sht;
+	case TYPE_int: return prodblk_int;
+	case TYPE_lng: return prodblk_lng;
+	}
+	return NULL;
+}
+
+static aggr_minmaxblk
+minmaxblk_find(int tp)
+{
+	switch (tp) {
+	case TYPE_bte: return minmaxblk_bte;
+	case TYPE_sht: return minmaxblk_sht;
+	case TYPE_int: return minmaxblk_int;
+	case TYPE_lng: return minmaxblk_lng;
+	case TYPE_flt: return minmaxblk_flt;
+	case TYPE_dbl: return minmaxblk_dbl;
+	}
 	return NULL;
 }
 
+/* the checked loops: continue the running sum or product with the
+ * values vals[i..j) one by one; return 1 from the enclosing function
+ * if the result became nil, BUN_NONE on overflow with abort_on_error
+ * set */
+#define AGGR_SUM_CHECKED(TYPE)						\
+	do {								\
+		const TYPE *v = (const TYPE *) vals;			\
+		for (; i < j; i++) {					\
+			if (!nonil && v[i] == TYPE##_nil) {		\
+				if (!skip_nils)				\
+					return 1;			\
+				continue;				\
+			}						\
+			*seen = 1;					\
+			if (v[i] < 0 ? sum < -max2 - v[i] :		\
+			    sum > max2 - v[i])				\
+				return abort_on_error ? BUN_NONE : 1;	\
+			sum += v[i];					\
+			*sump = sum;					\
+		}							\
+	} while (0)
+
+#define AGGR_PROD_CHECKED(TYPE)						\
+	do {								\
+		const TYPE *v = (const TYPE *) vals;			\
+		for (; i < j; i++) {					\
+			lng x, ax, ap;					\
+			if (v[i] == TYPE##_nil) {			\
+				if (!skip_nils)				\
+					return 1;			\
+				continue;				\
+			}						\
+			x = v[i];					\
+			ax = x < 0 ? -x : x;				\
+			ap = prod < 0 ? -prod : prod;			\
+			if (ax > 1 && ap > max2 / ax)			\
+				return abort_on_error ? BUN_NONE : 1;	\
+			prod *= x;					\
+			*prodp = prod;					\
+		}							\
+	} while (0)
+
+/* Continue the sum in *sump (kept within [-max2,max2]) with
+ * vals[start..end) of integer type tp1, the same as the ungrouped
+ * loop of AGGR_SUM without candidates; *seen is set when a value has
+ * been added.  Returns 0, 1 if the sum became nil, or BUN_NONE on
+ * overflow (without reporting an error). */
+static BUN
+sum_blocked_range(const char *vals, int tp1, int nonil, BUN start, BUN end,
+		  lng max2, int skip_nils, int abort_on_error,
+		  lng *sump, int *seen)
+{
+	aggr_sumblk kernel = sumblk_find(tp1, TYPE_lng);
+	int width = ATOMsize(tp1);
+	lng sum = *sump, bsum, bmin, bmax;
+	dbl lim = AGGR_RANGE(max2);
+	BUN i, j, n, bnils;
+
+	for (i = start; i < end; i = j) {
+		n = end - i < AGGR_BLOCK ? end - i : AGGR_BLOCK;
+		j = i + n;
+		bnils = (*kernel)(vals + i * width, n, nonil,
+				  &bsum, &bmin, &bmax);
+		if ((bnils == 0 || skip_nils) &&
+		    (dbl) sum + (dbl) bmin * n >= -lim &&
+		    (dbl) sum + (dbl) bmax * n <= lim) {
+			/* exact, since the true sum is in range */
+			sum = (lng) ((ulng) sum + (ulng) bsum);
+			*sump = sum;
+			*seen |= bnils < n;
+			continue;
+		}
+		switch (ATOMstorage(tp1)) {
+		case TYPE_bte:
+			AGGR_SUM_CHECKED(bte);
+			break;
+		case TYPE_sht:
+			AGGR_SUM_CHECKED(sht);
+			break;
+		case TYPE_int:
+			AGGR_SUM_CHECKED(int);
+			break;
+		default:
+			AGGR_SUM_CHECKED(lng);
+			break;
+		}
+	}
+	return 0;
+}
+
+/* Continue the product in *prodp (kept within [-max2,max2]) with
+ * vals[start..end) of integer type tp1, the same as the ungrouped
+ * loop of AGGR_PROD without candidates once the result is no longer
+ * nil.  Returns 0, 1 if the product became nil, or BUN_NONE on
+ * overflow (without reporting an error). */
+static BUN
+prod_blocked_range(const char *vals, int tp1, BUN start, BUN end,
+		   lng max2, int skip_nils, int abort_on_error, lng *prodp)
+{
+	aggr_prodblk kernel = prodblk_find(tp1, TYPE_lng);
+	int width = ATOMsize(tp1);
+	lng prod = *prodp, bprod;
+	dbl lim = AGGR_RANGE(max2), bound;
+	BUN i, j, n, bnils;
+
+	for (i = start; i < end; i = j) {
+		n = end - i < AGGR_BLOCK ? end - i : AGGR_BLOCK;
+		j = i + n;
+		bnils = (*kernel)(vals + i * width, n, 0, &bprod, &bound);
+		if ((bnils == 0 || skip_nils) &&
+		    (prod == 0 || (dbl) (prod < 0 ? -prod : prod) * bound <= lim)) {
+			prod = (lng) ((ulng) prod * (ulng) bprod);
+			*prodp = prod;
+			continue;
+		}
+		switch (ATOMstorage(tp1)) {
+		case TYPE_bte:
+			AGGR_PROD_CHECKED(bte);
+			break;
+		case TYPE_sht:
+			AGGR_PROD_CHECKED(sht);
+			break;
+		case TYPE_int:
+			AGGR_PROD_CHECKED(int);
+			break;
+		default:
+			AGGR_PROD_CHECKED(lng);
+			break;
+		}
+	}
+	return 0;
+}
+
+typedef struct {
+	const char *vals;
+	int width, nonil;
+	aggr_sumblk sumblk;	/* one of these three is set */
+	aggr_prodblk prodblk;
+	aggr_minmaxblk minmaxblk;
+	BUN base, grain;
+	/* per piece: */
+	lng r[AGGR_MAXPIECES];	/* sum or product (modulo 2^64) */
+	dbl lo[AGGR_MAXPIECES];	/* range of the partial sums, or */
+	dbl hi[AGGR_MAXPIECES];	/* bound on the partial products */
+	lng mn[AGGR_MAXPIECES];	/* minimum (room for a dbl) */
+	lng mx[AGGR_MAXPIECES];	/* maximum */
+	BUN nils[AGGR_MAXPIECES];
+} aggrblk_t;
+
+static void
+aggr_blk_piece(BUN lo, BUN hi, void *arg)
+{
+	aggrblk_t *a = arg;
+	BUN p = (lo - a->base) / a->grain;
+	BUN i, n, nils = 0;
+	ulng r = a->prodblk ? 1 : 0;
+	dbl rd = 0, rlo = 0, rhi = a->prodblk ? 1 : 0;
+	lng bmn, bmx;
+	dbl bound;
+
+	if (a->minmaxblk) {
+		/* no overflow: reduce the piece in one go */
+		a->nils[p] = (*a->minmaxblk)(a->vals + lo * a->width, hi - lo,
+					     a->nonil, &a->mn[p], &a->mx[p]);
+		return;
+	}
+	for (i = lo; i < hi; i += n) {
+		const char *v;
+
+		n = hi - i < AGGR_BLOCK ? hi - i : AGGR_BLOCK;
+		v = a->vals + i * a->width;
+		if (a->sumblk) {
+			lng bsum;
+
+			nils += (*a->sumblk)(v, n, a->nonil, &bsum, &bmn, &bmx);
+			if ((dbl) bmn * n < -AGGR_RANGE(GDK_lng_max) ||
+			    (dbl) bmx * n > AGGR_RANGE(GDK_lng_max)) {
+				/* bsum may have wrapped around */
+				rlo = -GDK_dbl_max;
+				rhi = GDK_dbl_max;
+			}
+			if (rd + (dbl) bmn * n < rlo)
+				rlo = rd + (dbl) bmn * n;
+			if (rd + (dbl) bmx * n > rhi)
+				rhi = rd + (dbl) bmx * n;
+			r += (ulng) bsum;
+			rd += (dbl) bsum;
+		} else {
+			lng bprod;
+
+			nils += (*a->prodblk)(v, n, a->nonil, &bprod, &bound);
+			r *= (ulng) bprod;
+			rhi *= bound;
+		}
+	}
+	a->r[p] = (lng) r;
+	a->lo[p] = rlo;
+	a->hi[p] = rhi;
+	a->nils[p] = nils;
+}
+
+/* Cut [start,end) into pieces for aggr_blk_piece and run them;
+ * returns the number of pieces, or 0 if it is not worth it. */
+static BUN
+aggr_blk_run(aggrblk_t *a, const void *vals, int width, int nonil,
+	     BUN start, BUN end)
+{
+	int nthreads = GDKnr_threads;
+
+	if (nthreads <= 1 || end - start < AGGR_PARALLEL_MINSIZE)
+		return 0;
+	a->vals = vals;
+	a->width = width;
+	a->nonil = nonil;
+	a->base = start;
+	a->grain = (end - start) / ((BUN) nthreads * 4);
+	if (a->grain < 16 * AGGR_BLOCK)
+		a->grain = 16 * AGGR_BLOCK;
+	a->grain = (a->grain + AGGR_BLOCK - 1) & ~(AGGR_BLOCK - 1);
+	if ((end - start + a->grain - 1) / a->grain > AGGR_MAXPIECES)
+		a->grain = (end - start + AGGR_MAXPIECES - 1) / AGGR_MAXPIECES;
+	MRparallel_for(start, end, a->grain, aggr_blk_piece, a);
+	return (end - start + a->grain - 1) / a->grain;
+}
+
+/* The ungrouped sum of vals[start..end) of integer type tp1 into
+ * integer type tp2 without candidates: the same as the ungrouped loop
+ * of AGGR_SUM, and with the same return value; the result is stored
+ * in results if a value was seen (*seen). */
+static BUN
+sum_blocked(const void *vals, int nonil, BUN start, BUN end, void *results,
+	    int tp1, int tp2, int skip_nils, int abort_on_error,
+	    unsigned int *seen, const char *func)
+{
+	aggrblk_t a;
+	lng sum = 0, max2 = aggr_intmax(tp2);
+	dbl lim = AGGR_RANGE(max2);
+	int seenval = 0;
+	BUN p, lo, hi, np, nils = 0;
+
+	memset(&a, 0, sizeof(a));
+	a.sumblk = sumblk_find(tp1, tp2);
+	assert(a.sumblk != NULL);
+	np = aggr_blk_run(&a, vals, ATOMsize(tp1), nonil, start, end);
+	ALGODEBUG fprintf(stderr, "#%s: blocked sum, " BUNFMT " pieces\n",
+			  func, np);
+	if (np == 0)
+		nils = sum_blocked_range(vals, tp1, nonil, start, end, max2,
+					 skip_nils, abort_on_error,
+					 &sum, &seenval);
+	for (p = 0; p < np && nils == 0; p++) {
+		lo = start + p * a.grain;
+		hi = lo + a.grain < end ? lo + a.grain : end;
+		if ((a.nils[p] == 0 || skip_nils) &&
+		    (dbl) sum + a.lo[p] >= -lim &&
+		    (dbl) sum + a.hi[p] <= lim) {
+			sum = (lng) ((ulng) sum + (ulng) a.r[p]);
+			seenval |= a.nils[p] < hi - lo;
+		} else {
+			nils = sum_blocked_range(vals, tp1, nonil, lo, hi,
+						 max2, skip_nils,
+						 abort_on_error,
+						 &sum, &seenval);
+		}
+	}
+	if (nils == BUN_NONE)
+		return BUN_NONE;
+	*seen = seenval;
+	if (seenval) {
+		switch (ATOMstorage(tp2)) {
+		case TYPE_bte:
+			* (bte *) results = nils ? bte_nil : (bte) sum;
+			break;
+		case TYPE_sht:
+			* (sht *) results = nils ? sht_nil : (sht) sum;
+			break;
+		case TYPE_int:
+			* (int *) results = nils ? int_nil : (int) sum;
+			break;
+		default:
+			* (lng *) results = nils ? lng_nil : sum;
+			break;
+		}
+	}
+	return nils;
+}
+
+/* The ungrouped product of vals[start..end) of integer type tp1 into
+ * integer type tp2 without candidates, for start < end: the same as
+ * the ungrouped loop of AGGR_PROD (when the result starts at 1).
+ * Returns the number of nils (0 or 1), or BUN_NONE on overflow. */
+static BUN
+prod_blocked(const void *vals, BUN start, BUN end, void *results,
+	     int tp1, int tp2, int skip_nils, int abort_on_error,
+	     const char *func)
+{
+	aggrblk_t a;
+	lng prod = 1, max2 = aggr_intmax(tp2);
+	dbl lim = AGGR_RANGE(max2);
+	BUN p, lo, hi, np, nils = 0;
+
+	memset(&a, 0, sizeof(a));
+	a.prodblk = prodblk_find(tp1, tp2);
+	assert(a.prodblk != NULL);
+	np = aggr_blk_run(&a, vals, ATOMsize(tp1), 0, start, end);
+	ALGODEBUG fprintf(stderr, "#%s: blocked product, " BUNFMT " pieces\n",
+			  func, np);
+	if (np == 0)
+		nils = prod_blocked_range(vals, tp1, start, end, max2,
+					  skip_nils, abort_on_error, &prod);
+	for (p = 0; p < np && nils == 0; p++) {
+		lo = start + p * a.grain;
+		hi = lo + a.grain < end ? lo + a.grain : end;
+		if ((a.nils[p] == 0 || skip_nils) &&
+		    (prod == 0 ||
+		     (dbl) (prod < 0 ? -prod : prod) * a.hi[p] <= lim)) {
+			prod = (lng) ((ulng) prod * (ulng) a.r[p]);
+		} else {
+			nils = prod_blocked_range(vals, tp1, lo, hi,
+						  max2, skip_nils,
+						  abort_on_error, &prod);
+		}
+	}
+	if (nils == BUN_NONE)
+		return BUN_NONE;
+	switch (ATOMstorage(tp2)) {
+	case TYPE_bte:
+		* (bte *) results = nils ? bte_nil : (bte) prod;
+		break;
+	case TYPE_sht:
+		* (sht *) results = nils ? sht_nil : (sht) prod;
+		break;
+	case TYPE_int:
+		* (int *) results = nils ? int_nil : (int) prod;
+		break;
+	default:
+		* (lng *) results = nils ? lng_nil : prod;
+		break;
+	}
+	return nils;
+}
+
 /* ---------------------------------------------------------------------- */
 /* sum */
 
-#define AGGR_SUM(TYPE1, TYPE2)						\
+#define AGGR_SUM_OP(TYPE1, TYPE2, ADD)					\
 	do {								\
 		TYPE1 x;						\
 		const TYPE1 *vals = (const TYPE1 *) values;		\
-		if (ngrp == 1 && cand == NULL) {			\
+		if (!grouped && ci == NULL) {				\
 			TYPE2 sum;					\
 			ALGODEBUG fprintf(stderr,			\
 					  "#%s: no candidates, no groups; " \
@@ -174,7 +1073,7 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 				*seen = start < end;			\
 				for (i = start; i < end && nils == 0; i++) { \
 					x = vals[i];			\
-					ADD_WITH_CHECK(TYPE1, x,	\
+					ADD(TYPE1, x,		\
 						       TYPE2, sum,	\
 						       TYPE2, sum,	\
 						       goto overflow);	\
@@ -189,7 +1088,7 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 							nils = 1;	\
 						}			\
 					} else {			\
-						ADD_WITH_CHECK(TYPE1, x, \
+						ADD(TYPE1, x,	\
 							       TYPE2, sum, \
 							       TYPE2, sum, \
 							       goto overflow); \
@@ -200,7 +1099,7 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 			}						\
 			if (*seen)					\
 				*sums = sum;				\
-		} else if (ngrp == 1) {					\
+		} else if (!grouped) {					\
 			TYPE2 sum;					\
 			int seenval = 0;				\
 			ALGODEBUG fprintf(stderr,			\
@@ -209,8 +1108,8 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 					  "\n",				\
 					  func, start, end);		\
 			sum = 0;					\
-			while (cand < candend) {			\
-				i = *cand++ - seqb;			\
+			while (ci->next != oid_nil) {			\
+				i = CANDiternext(ci) - seqb;		\
 				if (i >= end)				\
 					break;				\
 				x = vals[i];				\
@@ -220,7 +1119,7 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 						nils = 1;		\
 					}				\
 				} else {				\
-					ADD_WITH_CHECK(TYPE1, x,	\
+					ADD(TYPE1, x,		\
 						       TYPE2, sum,	\
 						       TYPE2, sum,	\
 						       goto overflow);	\
@@ -229,7 +1128,7 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 			}						\
 			if (seenval)					\
 				*sums = sum;				\
-		} else if (cand == NULL) {				\
+		} else if (ci == NULL) {				\
 			ALGODEBUG fprintf(stderr,			\
 					  "#%s: no candidates, with groups; " \
 					  "start " BUNFMT ", end " BUNFMT \
@@ -251,7 +1150,7 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 							nils++;		\
 						}			\
 					} else if (sums[gid] != TYPE2##_nil) { \
-						ADD_WITH_CHECK(TYPE1, x, \
+						ADD(TYPE1, x,	\
 							       TYPE2,	\
 							       sums[gid], \
 							       TYPE2,	\
@@ -266,8 +1165,8 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 					  "groups; start " BUNFMT ", "	\
 					  "end " BUNFMT "\n",		\
 					  func, start, end);		\
-			while (cand < candend) {			\
-				i = *cand++ - seqb;			\
+			while (ci->next != oid_nil) {			\
+				i = CANDiternext(ci) - seqb;		\
 				if (i >= end)				\
 					break;				\
 				if (gids == NULL ||			\
@@ -285,7 +1184,7 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 							nils++;		\
 						}			\
 					} else if (sums[gid] != TYPE2##_nil) { \
-						ADD_WITH_CHECK(TYPE1, x, \
+						ADD(TYPE1, x,	\
 							       TYPE2,	\
 							       sums[gid], \
 							       TYPE2,	\
@@ -297,24 +1196,31 @@ BATgroupaggrinit(const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 		}							\
 	} while (0)
 
+#define AGGR_SUM(TYPE1, TYPE2)	AGGR_SUM_OP(TYPE1, TYPE2, ADD_WITH_CHECK)
+
+#ifdef HAVE_HGE
+/* even BUN_MAX lng values cannot overflow a hge, so summing any
+ * narrower integer type into a hge needs no overflow check */
+#define ADD_NO_CHECK(TYPE1, lft, TYPE2, rgt, TYPE3, dst, on_overflow)	\
+	((dst) = (TYPE3) (lft) + (rgt))
+#define AGGR_SUM_HGE(TYPE1)	AGGR_SUM_OP(TYPE1, hge, ADD_NO_CHECK)
+#endif
+
+/* sum the values into results, marking the groups in seen; if not
+ * grouped, gids is ignored and there is a single group; returns the
+ * number of nils, BUN_NONE on overflow (with abort_on_error set) or
+ * BUN_NONE + 1 for an unsupported type combination, without reporting
+ * an error */
 static BUN
-dosum(const void *values, int nonil, oid seqb, BUN start, BUN end,
-      void *results, BUN ngrp, int tp1, int tp2,
-      const oid *cand, const oid *candend, const oid *gids,
-      oid min, oid max, int skip_nils, int abort_on_error,
-      int nil_if_empty, const char *func)
+dosum_range(const void *values, int nonil, oid seqb, BUN start, BUN end,
+	    void *results, BUN ngrp, int grouped, int tp1, int tp2,
+	    CandIter *ci, const oid *gids,
+	    oid min, oid max, int skip_nils, int abort_on_error,
+	    int nil_if_empty, unsigned int *seen, const char *func)
 {
 	BUN nils = 0;
 	BUN i;
 	oid gid;
-	unsigned int *seen;	/* bitmask for groups that we've seen */
-
-	/* allocate bitmap for seen group ids */
-	seen = GDKzalloc(((ngrp + 31) / 32) * sizeof(int));
-	if (seen == NULL) {
-		GDKerror("%s: cannot allocate enough memory\n", func);
-		return BUN_NONE;
-	}
 
 	switch (ATOMstorage(tp2)) {
 	case TYPE_bte: {
@@ -379,6 +1285,31 @@ dosum(const void *values, int nonil, oid seqb, BUN start, BUN end,
 		}
 		break;
 	}
+#ifdef HAVE_HGE
+	case TYPE_hge: {
+		hge *sums = (hge *) results;
+		switch (ATOMstorage(tp1)) {
+		case TYPE_bte:
+			AGGR_SUM_HGE(bte);
+			break;
+		case TYPE_sht:
+			AGGR_SUM_HGE(sht);
+			break;
+		case TYPE_int:
+			AGGR_SUM_HGE(int);
+			break;
+		case TYPE_lng:
+			AGGR_SUM_HGE(lng);
+			break;
+		case TYPE_hge:
+			AGGR_SUM(hge, hge);
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+	}
+#endif
 	case TYPE_flt: {
 		flt *sums = (flt *) results;
 		switch (ATOMstorage(tp1)) {
@@ -407,35 +1338,212 @@ dosum(const void *values, int nonil, oid seqb, BUN start, BUN end,
 	default:
 		goto unsupported;
 	}
+	return nils;
 
-	if (nils == 0 && nil_if_empty) {
-		/* figure out whether there were any empty groups
-		 * (that result in a nil value) */
-		if (ngrp & 0x1F) {
-			/* fill last slot */
-			seen[ngrp >> 5] |= ~0U << (ngrp & 0x1F);
-		}
-		for (i = 0, ngrp = (ngrp + 31) / 32; i < ngrp; i++) {
-			if (seen[i] != ~0U) {
-				nils = 1;
-				break;
-			}
-		}
+  unsupported:
+	return BUN_NONE + 1;
+
+  overflow:
+	return BUN_NONE;
+}
+
+/* the type combinations supported by dosum_range */
+static int
+sum_supported(int tp1, int tp2)
+{
+	tp1 = ATOMstorage(tp1);
+	switch (ATOMstorage(tp2)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+		return (tp1 == TYPE_bte || tp1 == TYPE_sht ||
+			tp1 == TYPE_int || tp1 == TYPE_lng) &&
+			ATOMsize(tp1) <= ATOMsize(tp2);
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		return tp1 == TYPE_bte || tp1 == TYPE_sht ||
+			tp1 == TYPE_int || tp1 == TYPE_lng ||
+			tp1 == TYPE_hge;
+#endif
+	case TYPE_flt:
+		return tp1 == TYPE_flt;
+	case TYPE_dbl:
+		return tp1 == TYPE_flt || tp1 == TYPE_dbl;
+	default:
+		return 0;
 	}
-	GDKfree(seen);
+}
 
-	return nils;
+static void
+aggr_sum_piece(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	BUN start, end, ngrp, nils;
+	CandIter cis, *ci;
+	oid min, max;
+	BUN p = aggr_piece(a, lo, hi, &start, &end, &cis, &ci,
+			   &min, &max);
+	void *sums;
+	unsigned int *seen;
+
+	if (a->local) {
+		/* a partial sum only counts if its group was seen, and
+		 * it is set to zero when the group is first seen */
+		ngrp = a->ngrp;
+		sums = a->part[p][0];
+		seen = a->part[p][1];
+		memset(seen, 0, ((ngrp + 31) / 32) * sizeof(int));
+	} else {
+		ngrp = hi - lo;
+		sums = (char *) a->res[0] + lo * ATOMsize(a->tp2);
+		seen = (unsigned int *) a->res[1] + lo / 32;
+	}
+	nils = dosum_range(a->values, a->nonil, a->seqb, start, end,
+			   sums, ngrp, 1, a->tp1, a->tp2, ci,
+			   a->gids, min, max, a->skip_nils, a->abort_on_error,
+			   1, seen, "BATgroupsum");
+	if (nils >= BUN_NONE)
+		a->err[p] = AGGR_ERR_OVERFLOW;
+	else
+		a->nils[p] = nils;
+}
 
-  unsupported:
-	GDKfree(seen);
-	GDKerror("%s: type combination (sum(%s)->%s) not supported.\n",
-		 func, ATOMname(tp1), ATOMname(tp2));
-	return BUN_NONE;
+#define AGGR_SUM_MERGE(TYPE)						\
+	do {								\
+		TYPE *sums = (TYPE *) a->res[0];			\
+		for (p = 0; p < a->npieces; p++) {			\
+			const TYPE *psums = (const TYPE *) a->part[p][0]; \
+			const unsigned int *pseen = a->part[p][1];	\
+			for (g = lo; g < hi; g++) {			\
+				if (!(pseen[g >> 5] & (1U << (g & 0x1F)))) \
+					continue;			\
+				if (!(seen[g >> 5] & (1U << (g & 0x1F)))) { \
+					seen[g >> 5] |= 1U << (g & 0x1F); \
+					sums[g] = 0;			\
+				}					\
+				if (psums[g] == TYPE##_nil)		\
+					sums[g] = TYPE##_nil;		\
+				else if (sums[g] != TYPE##_nil)		\
+					sums[g] += psums[g];		\
+			}						\
+		}							\
+	} while (0)
 
-  overflow:
+/* only used if the sums cannot overflow (aggr_nooverflow) */
+static void
+aggr_sum_merge(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	unsigned int *seen = a->res[1];
+	BUN p, g;
+
+	switch (ATOMstorage(a->tp2)) {
+	case TYPE_sht:
+		AGGR_SUM_MERGE(sht);
+		break;
+	case TYPE_int:
+		AGGR_SUM_MERGE(int);
+		break;
+	case TYPE_lng:
+		AGGR_SUM_MERGE(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		AGGR_SUM_MERGE(hge);
+		break;
+#endif
+	default:
+		assert(0);
+	}
+}
+
+static BUN
+dosum(const void *values, int nonil, oid seqb, BUN start, BUN end,
+      void *results, BUN ngrp, int tp1, int tp2,
+      CandIter *ci, const oid *gids,
+      oid min, oid max, int skip_nils, int abort_on_error,
+      int nil_if_empty, const char *func)
+{
+	BUN nils = 0;
+	BUN i;
+	unsigned int *seen;	/* bitmask for groups that we've seen */
+	aggrpar_t a;
+	/* partial sums and a bitmap of the groups seen */
+	int widths[3] = {ATOMsize(tp2), -1, 0};
+
+	/* allocate bitmap for seen group ids */
+	seen = GDKzalloc(((ngrp + 31) / 32) * sizeof(int));
+	if (seen == NULL) {
+		GDKerror("%s: cannot allocate enough memory\n", func);
+		return BUN_NONE;
+	}
+
+	if (ngrp > 1 && nil_if_empty && sum_supported(tp1, tp2) &&
+	    aggr_parallel_init(&a, NULL, gids, min, max, ngrp, start, end,
+			       ci, skip_nils, abort_on_error,
+			       tp1, tp2,
+			       aggr_nooverflow(tp1, tp2,
+					       ci ? ci->count : end - start),
+			       func)) {
+		a.values = values;
+		a.seqb = seqb;
+		a.nonil = nonil;
+		a.res[0] = results;
+		a.res[1] = seen;
+		nils = aggr_parallel_run(&a, widths, aggr_sum_piece,
+					 aggr_sum_merge, func);
+		if (nils == BUN_NONE) {
+			GDKfree(seen);
+			return BUN_NONE;
+		}
+	} else if (ngrp == 1 && ci == NULL &&
+		   end - start >= AGGR_BLOCKED_MINSIZE &&
+		   sum_supported(tp1, tp2) && sumblk_find(tp1, tp2)) {
+		nils = sum_blocked(values, nonil, start, end, results,
+				   tp1, tp2, skip_nils, abort_on_error,
+				   seen, func);
+		if (nils == BUN_NONE) {
+			GDKfree(seen);
+			GDKerror("22003!overflow in calculation.\n");
+			return BUN_NONE;
+		}
+	} else {
+		nils = dosum_range(values, nonil, seqb, start, end,
+				   results, ngrp, ngrp != 1, tp1, tp2,
+				   ci, gids, min, max,
+				   skip_nils, abort_on_error, nil_if_empty,
+				   seen, func);
+		if (nils == BUN_NONE + 1) {
+			GDKfree(seen);
+			GDKerror("%s: type combination (sum(%s)->%s) not supported.\n",
+				 func, ATOMname(tp1), ATOMname(tp2));
+			return BUN_NONE;
+		}
+		if (nils == BUN_NONE) {
+			GDKfree(seen);
+			GDKerror("22003!overflow in calculation.\n");
+			return BUN_NONE;
+		}
+	}
+
+	if (nils == 0 && nil_if_empty) {
+		/* figure out whether there were any empty groups
+		 * (that result in a nil value) */
+		if (ngrp & 0x1F) {
+			/* fill last slot */
+			seen[ngrp >> 5] |= ~0U << (ngrp & 0x1F);
+		}
+		for (i = 0, ngrp = (ngrp + 31) / 32; i < ngrp; i++) {
+			if (seen[i] != ~0U) {
+				nils = 1;
+				break;
+			}
+		}
+	}
 	GDKfree(seen);
-	GDKerror("22003!overflow in calculation.\n");
-	return BUN_NONE;
+
+	return nils;
 }
 
 /* calculate group sums with optional candidates list */
@@ -448,11 +1556,11 @@ BATgroupsum(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	BUN nils;
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
+				    &cnt, &cis, &ci)) != NULL) {
 		GDKerror("BATgroupsum: %s\n", err);
 		return NULL;
 	}
@@ -489,7 +1597,7 @@ BATgroupsum(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 
 	nils = dosum(Tloc(b, BUNfirst(b)), b->T->nonil, b->hseqbase, start, end,
 		     Tloc(bn, BUNfirst(bn)), ngrp, b->ttype, tp,
-		     cand, candend, gids, min, max,
+		     ci, gids, min, max,
 		     skip_nils, abort_on_error, 1, "BATgroupsum");
 
 	if (nils < BUN_NONE) {
@@ -515,12 +1623,12 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 	BUN ngrp;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
 
 	if ((err = BATgroupaggrinit(b, NULL, NULL, s, &min, &max, &ngrp,
 				    &start, &end, &cnt,
-				    &cand, &candend)) != NULL) {
+				    &cis, &ci)) != NULL) {
 		GDKerror("BATsum: %s\n", err);
 		return GDK_FAIL;
 	}
@@ -537,6 +1645,11 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 	case TYPE_lng:
 		* (lng *) res = nil_if_empty ? lng_nil : 0;
 		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		* (hge *) res = nil_if_empty ? hge_nil : 0;
+		break;
+#endif
 	case TYPE_flt:
 	case TYPE_dbl:
 		switch (ATOMstorage(b->ttype)) {
@@ -610,7 +1723,7 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 	if (BATcount(b) == 0)
 		return GDK_SUCCEED;
 	nils = dosum(Tloc(b, BUNfirst(b)), b->T->nonil, b->hseqbase, start, end,
-		     res, 1, b->ttype, tp, cand, candend, &min, min, max,
+		     res, 1, b->ttype, tp, ci, &min, min, max,
 		     skip_nils, abort_on_error, nil_if_empty, "BATsum");
 	return nils < BUN_NONE ? GDK_SUCCEED : GDK_FAIL;
 }
@@ -624,10 +1737,10 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 		assert(gidincr == 0 || gidincr == 1);			\
 		gid = 0;	/* doesn't change if gidincr == 0 */	\
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - seqb;			\
+				i = CANDiternext(ci) - seqb;		\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -670,10 +1783,10 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 		assert(gidincr == 0 || gidincr == 1);			\
 		gid = 0;	/* doesn't change if gidincr == 0 */	\
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - seqb;			\
+				i = CANDiternext(ci) - seqb;		\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -709,16 +1822,63 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 		}							\
 	} while (0)
 
+#ifdef HAVE_HGE
+#define AGGR_PROD_HGE(TYPE)						\
+	do {								\
+		const TYPE *vals = (const TYPE *) values;		\
+		assert(gidincr == 0 || gidincr == 1);			\
+		gid = 0;	/* doesn't change if gidincr == 0 */	\
+		for (;;) {						\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
+					break;				\
+				i = CANDiternext(ci) - seqb;		\
+				if (i >= end)				\
+					break;				\
+			} else {					\
+				i = start++;				\
+				if (i == end)				\
+					break;				\
+			}						\
+			if (gids == NULL || gidincr == 0 ||		\
+			    (gids[i] >= min && gids[i] <= max)) {	\
+				if (gidincr) {				\
+					if (gids)			\
+						gid = gids[i] - min;	\
+					else				\
+						gid = (oid) i;		\
+				}					\
+				if (nil_if_empty &&			\
+				    !(seen[gid >> 5] & (1 << (gid & 0x1F)))) { \
+					seen[gid >> 5] |= 1 << (gid & 0x1F); \
+					prods[gid] = 1;			\
+				}					\
+				if (vals[i] == TYPE##_nil) {		\
+					if (!skip_nils) {		\
+						prods[gid] = hge_nil;	\
+						nils++;			\
+					}				\
+				} else if (prods[gid] != hge_nil) {	\
+					HGEMUL_CHECK(TYPE, vals[i],	\
+						     hge, prods[gid],	\
+						     prods[gid],	\
+						     goto overflow);	\
+				}					\
+			}						\
+		}							\
+	} while (0)
+#endif
+
 #define AGGR_PROD_FLOAT(TYPE1, TYPE2)					\
 	do {								\
 		const TYPE1 *vals = (const TYPE1 *) values;		\
 		assert(gidincr == 0 || gidincr == 1);			\
 		gid = 0;	/* doesn't change if gidincr == 0 */	\
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - seqb;			\
+				i = CANDiternext(ci) - seqb;		\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -761,7 +1921,7 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 
 static BUN
 doprod(const void *values, oid seqb, BUN start, BUN end, void *results,
-       BUN ngrp, int tp1, int tp2, const oid *cand, const oid *candend,
+       BUN ngrp, int tp1, int tp2, CandIter *ci,
        const oid *gids, int gidincr, oid min, oid max,
        int skip_nils, int abort_on_error, int nil_if_empty, const char *func)
 {
@@ -777,6 +1937,16 @@ doprod(const void *values, oid seqb, BUN start, BUN end, void *results,
 		return GDK_FAIL;
 	}
 
+	if (ngrp == 1 && gidincr == 0 && ci == NULL &&
+	    end - start >= AGGR_BLOCKED_MINSIZE && prodblk_find(tp1, tp2)) {
+		nils = prod_blocked(values, start, end, results, tp1, tp2,
+				    skip_nils, abort_on_error, func);
+		if (nils == BUN_NONE)
+			goto overflow;
+		seen[0] = 1;
+		goto done;
+	}
+
 	switch (ATOMstorage(tp2)) {
 	case TYPE_bte: {
 		bte *prods = (bte *) results;
@@ -840,6 +2010,31 @@ doprod(const void *values, oid seqb, BUN start, BUN end, void *results,
 		}
 		break;
 	}
+#ifdef HAVE_HGE
+	case TYPE_hge: {
+		hge *prods = (hge *) results;
+		switch (ATOMstorage(tp1)) {
+		case TYPE_bte:
+			AGGR_PROD_HGE(bte);
+			break;
+		case TYPE_sht:
+			AGGR_PROD_HGE(sht);
+			break;
+		case TYPE_int:
+			AGGR_PROD_HGE(int);
+			break;
+		case TYPE_lng:
+			AGGR_PROD_HGE(lng);
+			break;
+		case TYPE_hge:
+			AGGR_PROD_HGE(hge);
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+	}
+#endif
 	case TYPE_flt: {
 		flt *prods = (flt *) results;
 		switch (ATOMstorage(tp1)) {
@@ -893,6 +2088,7 @@ doprod(const void *values, oid seqb, BUN start, BUN end, void *results,
 		goto unsupported;
 	}
 
+  done:
 	if (nils == 0 && nil_if_empty) {
 		/* figure out whether there were any empty groups
 		 * (that result in a nil value) */
@@ -933,11 +2129,11 @@ BATgroupprod(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on
 	BUN nils;
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
+				    &cnt, &cis, &ci)) != NULL) {
 		GDKerror("BATgroupprod: %s\n", err);
 		return NULL;
 	}
@@ -974,7 +2170,7 @@ BATgroupprod(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on
 
 	nils = doprod(Tloc(b, BUNfirst(b)), b->hseqbase, start, end,
 		      Tloc(bn, BUNfirst(bn)), ngrp, b->ttype, tp,
-		      cand, candend, gids, 1, min, max,
+		      ci, gids, 1, min, max,
 		      skip_nils, abort_on_error, 1, "BATgroupprod");
 
 	if (nils < BUN_NONE) {
@@ -1000,12 +2196,12 @@ BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, in
 	BUN ngrp;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
 
 	if ((err = BATgroupaggrinit(b, NULL, NULL, s, &min, &max, &ngrp,
 				    &start, &end, &cnt,
-				    &cand, &candend)) != NULL) {
+				    &cis, &ci)) != NULL) {
 		GDKerror("BATprod: %s\n", err);
 		return GDK_FAIL;
 	}
@@ -1022,6 +2218,11 @@ BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, in
 	case TYPE_lng:
 		* (lng *) res = nil_if_empty ? lng_nil : (lng) 1;
 		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		* (hge *) res = nil_if_empty ? hge_nil : (hge) 1;
+		break;
+#endif
 	case TYPE_flt:
 		* (flt *) res = nil_if_empty ? flt_nil : (flt) 1;
 		break;
@@ -1036,11 +2237,122 @@ BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, in
 	if (BATcount(b) == 0)
 		return GDK_SUCCEED;
 	nils = doprod(Tloc(b, BUNfirst(b)), b->hseqbase, start, end, res, 1,
-		      b->ttype, tp, cand, candend, &min, 0, min, max,
+		      b->ttype, tp, ci, &min, 0, min, max,
 		      skip_nils, abort_on_error, nil_if_empty, "BATprod");
 	return nils < BUN_NONE ? GDK_SUCCEED : GDK_FAIL;
 }
 
+/* ---------------------------------------------------------------------- */
+/* minimum and maximum */
+
+/* The smallest (ismin) or largest non-nil value of b, nil if there
+ * is none, copied into aggr or, if aggr is NULL, into newly allocated
+ * memory which the caller must free.  A given aggr must have room
+ * for the value (ATOMlen). */
+static void *
+BATminmax(BAT *b, void *aggr, int ismin, const char *func)
+{
+	int t = ATOMtype(b->ttype);
+	const void *nil = ATOMnilptr(t);
+	const void *res = NULL;
+	BUN cnt = BATcount(b), i;
+	aggr_minmaxblk kernel;
+	aggrblk_t a;		/* the result may point into this */
+	oid v;
+	int len;
+
+	if (cnt == 0 || (BATtvoid(b) && b->tseqbase == oid_nil)) {
+		res = nil;
+	} else if (BATtdense(b)) {
+		v = b->tseqbase + (ismin ? 0 : cnt - 1);
+		res = &v;
+	} else if (b->tsorted || b->trevsorted) {
+		/* the minimum and maximum are at the ends, the nils
+		 * at one of them */
+		BATiter bi = bat_iterator(b);
+		int (*cmp)(const void *, const void *) = BATatoms[t].atomCmp;
+		int fromstart = ismin == (b->tsorted != 0);
+		const void *p;
+
+		ALGODEBUG fprintf(stderr, "#%s: sorted\n", func);
+		for (i = 0; i < cnt; i++) {
+			p = BUNtail(bi, fromstart ? BUNfirst(b) + i : BUNlast(b) - 1 - i);
+			if ((*cmp)(p, nil) != 0) {
+				res = p;
+				break;
+			}
+		}
+	} else if ((kernel = minmaxblk_find(t)) != NULL) {
+		char vals[AGGR_MAXPIECES * sizeof(lng)];
+		BUN p, np, nils = 0;
+		int width = ATOMsize(t);
+
+		memset(&a, 0, sizeof(a));
+		a.minmaxblk = kernel;
+		np = aggr_blk_run(&a, Tloc(b, BUNfirst(b)), width,
+				  b->T->nonil, 0, cnt);
+		ALGODEBUG fprintf(stderr, "#%s: blocked, " BUNFMT " pieces\n",
+				  func, np);
+		if (np == 0) {
+			nils = (*kernel)(Tloc(b, BUNfirst(b)), cnt,
+					 b->T->nonil, &a.mn[0], &a.mx[0]);
+		} else {
+			/* reduce the minimums or maximums of the pieces */
+			for (p = 0; p < np; p++) {
+				memcpy(vals + p * width,
+				       ismin ? (void *) &a.mn[p] : (void *) &a.mx[p],
+				       width);
+				nils += a.nils[p];
+			}
+			if (ismin)
+				(*kernel)(vals, np, 0, &a.mn[0], &a.mx[1]);
+			else
+				(*kernel)(vals, np, 0, &a.mn[1], &a.mx[0]);
+		}
+		if (ismin)
+			res = nils < cnt ? (const void *) &a.mn[0] : nil;
+		else
+			res = &a.mx[0];	/* nil if there are no values */
+	} else {
+		BATiter bi = bat_iterator(b);
+		int (*cmp)(const void *, const void *) = BATatoms[t].atomCmp;
+		const void *p;
+		BUN q, r;
+
+		BATloop(b, q, r) {
+			p = BUNtail(bi, q);
+			if ((*cmp)(p, nil) != 0 &&
+			    (res == NULL ||
+			     (ismin ? (*cmp)(p, res) < 0 : (*cmp)(p, res) > 0)))
+				res = p;
+		}
+	}
+	if (res == NULL)
+		res = nil;
+	len = ATOMlen(t, res);
+	if (aggr == NULL) {
+		aggr = GDKmalloc(len);
+		if (aggr == NULL) {
+			GDKerror("%s: cannot allocate enough memory\n", func);
+			return NULL;
+		}
+	}
+	memcpy(aggr, res, len);
+	return aggr;
+}
+
+void *
+BATmin(BAT *b, void *aggr)
+{
+	return BATminmax(b, aggr, 1, "BATmin");
+}
+
+void *
+BATmax(BAT *b, void *aggr)
+{
+	return BATminmax(b, aggr, 0, "BATmax");
+}
+
 /* ---------------------------------------------------------------------- */
 /* average */
 
@@ -1104,17 +2416,14 @@ BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, in
 		}							\
 	} while (0)
 
-#define AGGR_AVG(TYPE)							\
+#define AGGR_AVG_LOOP(TYPE)						\
 	do {								\
 		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
-		TYPE *avgs = GDKzalloc(ngrp * sizeof(TYPE));		\
-		if (avgs == NULL)					\
-			goto alloc_fail;				\
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - b->hseqbase;		\
+				i = CANDiternext(ci) - b->hseqbase;	\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -1139,6 +2448,14 @@ BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, in
 				}					\
 			}						\
 		}							\
+	} while (0)
+
+#define AGGR_AVG(TYPE)							\
+	do {								\
+		TYPE *avgs = GDKzalloc(ngrp * sizeof(TYPE));		\
+		if (avgs == NULL)					\
+			goto alloc_fail;				\
+		AGGR_AVG_LOOP(TYPE);					\
 		for (i = 0; i < ngrp; i++) {				\
 			if (cnts[i] == 0 || cnts[i] == BUN_NONE) {	\
 				dbls[i] = dbl_nil;			\
@@ -1156,10 +2473,10 @@ BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, in
 		for (i = 0; i < ngrp; i++)				\
 			dbls[i] = 0;					\
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - b->hseqbase;		\
+				i = CANDiternext(ci) - b->hseqbase;	\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -1191,6 +2508,141 @@ BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, in
 		}							\
 	} while (0)
 
+static void
+aggr_avg_piece(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	BAT *b = a->b;
+	const oid *gids = a->gids;
+	CandIter cis, *ci;
+	BUN start, end, i, ngrp, nils = 0;
+	oid min, max, gid;
+	int skip_nils = a->skip_nils;
+	BUN p = aggr_piece(a, lo, hi, &start, &end, &cis, &ci,
+			   &min, &max);
+	BUN *rems, *cnts;
+	dbl *dbls;
+
+	if (a->local) {
+		/* integer types only: partial floor averages with
+		 * remainders and counts */
+		ngrp = a->ngrp;
+		rems = a->part[p][1];
+		cnts = a->part[p][2];
+		memset(a->part[p][0], 0, ngrp * ATOMsize(a->tp1));
+		memset(rems, 0, ngrp * sizeof(BUN));
+		memset(cnts, 0, ngrp * sizeof(BUN));
+		switch (ATOMstorage(a->tp1)) {
+		case TYPE_bte: {
+			bte *avgs = a->part[p][0];
+			AGGR_AVG_LOOP(bte);
+			break;
+		}
+		case TYPE_sht: {
+			sht *avgs = a->part[p][0];
+			AGGR_AVG_LOOP(sht);
+			break;
+		}
+		case TYPE_int: {
+			int *avgs = a->part[p][0];
+			AGGR_AVG_LOOP(int);
+			break;
+		}
+		default:
+			assert(0);
+		}
+		return;
+	}
+	ngrp = hi - lo;
+	dbls = (dbl *) a->res[0] + lo;
+	cnts = (BUN *) a->res[1] + lo;
+	rems = a->res[2] ? (BUN *) a->res[2] + lo : NULL;
+	switch (ATOMstorage(a->tp1)) {
+	case TYPE_bte:
+		AGGR_AVG(bte);
+		break;
+	case TYPE_sht:
+		AGGR_AVG(sht);
+		break;
+	case TYPE_int:
+		AGGR_AVG(int);
+		break;
+	case TYPE_lng:
+		AGGR_AVG(lng);
+		break;
+	case TYPE_flt:
+		AGGR_AVG_FLOAT(flt);
+		break;
+	case TYPE_dbl:
+		AGGR_AVG_FLOAT(dbl);
+		break;
+	default:
+		assert(0);
+	}
+	a->nils[p] = nils;
+	return;
+
+  alloc_fail:
+	a->err[p] = AGGR_ERR_MALLOC;
+}
+
+/* The partials satisfy avg * cnt + rem == sum with 0 <= rem < cnt,
+ * and the sum of all values fits in a lng (aggr_nooverflow), so the
+ * merged average and remainder are exactly those of the sequential
+ * code. */
+#define AGGR_AVG_MERGE(TYPE)						\
+	do {								\
+		for (g = lo; g < hi; g++) {				\
+			lng sum = 0, q;					\
+			BUN n = 0, r;					\
+			for (p = 0; p < a->npieces; p++) {		\
+				const TYPE *pavgs = a->part[p][0];	\
+				const BUN *prems = a->part[p][1];	\
+				const BUN *pcnts = a->part[p][2];	\
+				if (pcnts[g] == BUN_NONE) {		\
+					n = BUN_NONE;			\
+					break;				\
+				}					\
+				sum += (lng) pavgs[g] * (lng) pcnts[g] + \
+					(lng) prems[g];			\
+				n += pcnts[g];				\
+			}						\
+			if (n == 0 || n == BUN_NONE) {			\
+				dbls[g] = dbl_nil;			\
+				nils++;					\
+				continue;				\
+			}						\
+			q = sum / (lng) n;				\
+			if (sum % (lng) n < 0)				\
+				q--;					\
+			r = (BUN) (sum - q * (lng) n);			\
+			dbls[g] = (TYPE) q + (dbl) r / n;		\
+		}							\
+	} while (0)
+
+static void
+aggr_avg_merge(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	dbl *dbls = a->res[0];
+	BUN p, g, nils = 0;
+
+	switch (ATOMstorage(a->tp1)) {
+	case TYPE_bte:
+		AGGR_AVG_MERGE(bte);
+		break;
+	case TYPE_sht:
+		AGGR_AVG_MERGE(sht);
+		break;
+	case TYPE_int:
+		AGGR_AVG_MERGE(int);
+		break;
+	default:
+		assert(0);
+	}
+	a->mnils[lo / a->mgrain] = nils;
+}
+
 /* calculate group averages with optional candidates list */
 BAT *
 BATgroupavg(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error)
@@ -1204,15 +2656,17 @@ BATgroupavg(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	dbl *dbls;
 	BAT *bn = NULL;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
+	aggrpar_t a;
+	int canmerge = 0;
 
 	assert(tp == TYPE_dbl);
 	(void) tp;		/* compatibility (with other BATgroup*
 				 * functions) argument */
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
+				    &cnt, &cis, &ci)) != NULL) {
 		GDKerror("BATgroupavg: %s\n", err);
 		return NULL;
 	}
@@ -1264,6 +2718,42 @@ BATgroupavg(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	else
 		gids = (const oid *) Tloc(g, BUNfirst(g) + start);
 
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+		canmerge = aggr_nooverflow(b->ttype, TYPE_lng, cnt);
+		/* fall through */
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		if (aggr_parallel_init(&a, b, gids, min, max, ngrp, start, end,
+				       ci, skip_nils, abort_on_error,
+				       b->ttype, TYPE_dbl, canmerge,
+				       "BATgroupavg")) {
+			/* partial averages, remainders and counts */
+			int widths[3] = {
+				ATOMsize(b->ttype), sizeof(BUN), sizeof(BUN)
+			};
+
+			a.res[0] = dbls;
+			a.res[1] = cnts;
+			a.res[2] = rems;
+			nils = aggr_parallel_run(&a, widths, aggr_avg_piece,
+						 aggr_avg_merge, "BATgroupavg");
+			if (nils == BUN_NONE) {
+				GDKfree(rems);
+				GDKfree(cnts);
+				BBPunfix(bn->batCacheid);
+				return NULL;
+			}
+			goto done;
+		}
+		break;
+	default:
+		break;
+	}
+
 	switch (ATOMstorage(b->ttype)) {
 	case TYPE_bte:
 		AGGR_AVG(bte);
@@ -1291,6 +2781,7 @@ BATgroupavg(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 			 ATOMname(b->ttype));
 		return NULL;
 	}
+  done:
 	GDKfree(rems);
 	GDKfree(cnts);
 	BATsetcount(bn, ngrp);
@@ -1318,10 +2809,10 @@ BATgroupavg(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 		/* first try to calculate the sum of all values into a */ \
 		/* lng */						\
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - b->hseqbase;		\
+				i = CANDiternext(ci) - b->hseqbase;	\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -1361,25 +2852,27 @@ BATgroupavg(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 					r = n - r;			\
 				}					\
 			}						\
-			if (cand)					\
-				--cand;					\
 									\
-			for (; i < end; i++) {				\
+			/* continue with x[i], which did not fit */	\
+			for (;;) {					\
 				/* loop invariant: */			\
 				/* a + r/n == average(x[0],...,x[n]); */ \
 				/* 0 <= r < n (if n > 0) */		\
 				/* or if n == 0: a == 0; r == 0 */	\
-				if (cand) {				\
-					if (i < *cand - b->H->seq)	\
-						continue;		\
-					assert(i == *cand - b->H->seq);	\
-					if (++cand == candend)		\
-						end = i + 1;		\
-				}					\
 				x = ((const TYPE *) src)[i];		\
-				if (x == TYPE##_nil)			\
-					continue;			\
-				AVERAGE_ITER(TYPE, x, a, r, n);		\
+				if (x != TYPE##_nil)			\
+					AVERAGE_ITER(TYPE, x, a, r, n);	\
+				if (ci) {				\
+					if (ci->next == oid_nil)	\
+						break;			\
+					i = CANDiternext(ci) - b->hseqbase; \
+					if (i >= end)			\
+						break;			\
+				} else {				\
+					i = start++;			\
+					if (i == end)			\
+						break;			\
+				}					\
 			}						\
 			*avg = n > 0 ? a + (dbl) r / n : dbl_nil;	\
 		}							\
@@ -1390,10 +2883,10 @@ BATgroupavg(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 		double a = 0;					\
 		TYPE x;						\
 		for (;;) {					\
-			if (cand) {				\
-				if (cand == candend)		\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;			\
-				i = *cand++ - b->hseqbase;	\
+				i = CANDiternext(ci) - b->hseqbase;	\
 				if (i >= end)			\
 					break;			\
 			} else {				\
@@ -1415,7 +2908,7 @@ BATcalcavg(BAT *b, BAT *s, dbl *avg, BUN *vals)
 	BUN n = 0, r = 0, i = 0;
 	lng sum = 0;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const void *src;
 	/* these two needed for ADD_WITH_CHECK macro */
 	int abort_on_error = 1;
@@ -1461,10 +2954,10 @@ BATcalcavg(BAT *b, BAT *s, dbl *avg, BUN *vals)
 	do {								\
 		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - b->hseqbase;		\
+				i = CANDiternext(ci) - b->hseqbase;	\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -1485,6 +2978,64 @@ BATcalcavg(BAT *b, BAT *s, dbl *avg, BUN *vals)
 		}							\
 	} while (0)
 
+static void
+aggr_count_piece(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	BAT *b = a->b;
+	const oid *gids = a->gids;
+	CandIter cis, *ci;
+	BUN start, end, i;
+	oid min, max, gid;
+	int skip_nils = a->skip_nils;
+	BUN p = aggr_piece(a, lo, hi, &start, &end, &cis, &ci,
+			   &min, &max);
+	wrd *cnts;
+
+	if (a->local) {
+		cnts = a->part[p][0];
+		memset(cnts, 0, a->ngrp * sizeof(wrd));
+	} else {
+		cnts = (wrd *) a->res[0] + lo;
+	}
+	switch (a->tp1) {
+	case TYPE_bte:
+		AGGR_COUNT(bte);
+		break;
+	case TYPE_sht:
+		AGGR_COUNT(sht);
+		break;
+	case TYPE_int:
+		AGGR_COUNT(int);
+		break;
+	case TYPE_lng:
+		AGGR_COUNT(lng);
+		break;
+	case TYPE_flt:
+		AGGR_COUNT(flt);
+		break;
+	case TYPE_dbl:
+		AGGR_COUNT(dbl);
+		break;
+	default:
+		assert(0);
+	}
+}
+
+static void
+aggr_count_merge(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	wrd *cnts = a->res[0];
+	BUN p, g;
+
+	for (p = 0; p < a->npieces; p++) {
+		const wrd *pcnts = a->part[p][0];
+		for (g = lo; g < hi; g++)
+			cnts[g] += pcnts[g];
+	}
+}
+
 /* calculate group counts with optional candidates list */
 BAT *
 BATgroupcount(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error)
@@ -1500,15 +3051,16 @@ BATgroupcount(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_o
 	int (*atomcmp)(const void *, const void *);
 	BATiter bi;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
+	aggrpar_t a;
 
 	assert(tp == TYPE_wrd);
 	(void) tp;		/* compatibility (with other BATgroup* */
 	(void) abort_on_error;	/* functions) argument */
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
+				    &cnt, &cis, &ci)) != NULL) {
 		GDKerror("BATgroupcount: %s\n", err);
 		return NULL;
 	}
@@ -1544,6 +3096,21 @@ BATgroupcount(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_o
 	    ATOMnilptr(ATOMstorage(t)) == nil &&
 	    BATatoms[ATOMstorage(t)].atomCmp == atomcmp)
 		t = ATOMstorage(t);
+	if (aggr_fixedtype(t) &&
+	    aggr_parallel_init(&a, b, gids, min, max, ngrp, start, end,
+			       ci, skip_nils, abort_on_error,
+			       t, TYPE_wrd, 1, "BATgroupcount")) {
+		int widths[3] = {sizeof(wrd), 0, 0};
+
+		a.res[0] = cnts;
+		if (aggr_parallel_run(&a, widths, aggr_count_piece,
+				      aggr_count_merge,
+				      "BATgroupcount") == BUN_NONE) {
+			BBPunfix(bn->batCacheid);
+			return NULL;
+		}
+		goto done;
+	}
 	switch (t) {
 	case TYPE_bte:
 		AGGR_COUNT(bte);
@@ -1567,10 +3134,10 @@ BATgroupcount(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_o
 		bi = bat_iterator(b);
 
 		for (;;) {
-			if (cand) {
-				if (cand == candend)
+			if (ci) {
+				if (ci->next == oid_nil)
 					break;
-				i = *cand++ - b->hseqbase;
+				i = CANDiternext(ci) - b->hseqbase;
 				if (i >= end)
 					break;
 			} else {
@@ -1593,6 +3160,7 @@ BATgroupcount(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_o
 		}
 		break;
 	}
+  done:
 	BATsetcount(bn, ngrp);
 	BATseqbase(bn, min);
 	bn->tkey = BATcount(bn) <= 1;
@@ -1615,7 +3183,7 @@ BATgroupsize(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on
 	wrd *cnts;
 	BAT *bn = NULL;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
 
 	assert(tp == TYPE_wrd);
@@ -1626,7 +3194,7 @@ BATgroupsize(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on
 	(void) skip_nils;
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
+				    &cnt, &cis, &ci)) != NULL) {
 		GDKerror("BATgroupsize: %s\n", err);
 		return NULL;
 	}
@@ -1658,10 +3226,10 @@ BATgroupsize(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on
 	bits = (const bit *) Tloc(b, BUNfirst(b));
 
 		for (;;) {
-			if (cand) {
-				if (cand == candend)
+			if (ci) {
+				if (ci->next == oid_nil)
 					break;
-				i = *cand++ - b->hseqbase;
+				i = CANDiternext(ci) - b->hseqbase;
 				if (i >= end)
 					break;
 			} else {
@@ -1691,10 +3259,10 @@ BATgroupsize(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on
 	do {								\
 		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - b->hseqbase;		\
+				i = CANDiternext(ci) - b->hseqbase;	\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -1721,6 +3289,124 @@ BATgroupsize(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on
 		}							\
 	} while (0)
 
+/* A row of a later piece only replaces the partial result of an
+ * earlier one under the same condition as in AGGR_CMP, so that the
+ * positions are those found by the sequential code. */
+#define AGGR_CMP_MERGE(TYPE, OP)					\
+	do {								\
+		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
+		for (p = 0; p < a->npieces; p++) {			\
+			const oid *poids = a->part[p][0];		\
+			for (g = lo; g < hi; g++) {			\
+				if (poids[g] == oid_nil)		\
+					continue;			\
+				if (oids[g] == oid_nil ||		\
+				    (vals[oids[g] - b->hseqbase] != TYPE##_nil && \
+				     (vals[poids[g] - b->hseqbase] == TYPE##_nil || \
+				      OP(vals[poids[g] - b->hseqbase],	\
+					 vals[oids[g] - b->hseqbase])))) \
+					oids[g] = poids[g];		\
+			}						\
+		}							\
+	} while (0)
+
+#define AGGR_CMP_PARALLEL(NAME, OP)					\
+static void								\
+aggr_##NAME##_piece(BUN lo, BUN hi, void *arg)				\
+{									\
+	aggrpar_t *a = arg;						\
+	BAT *b = a->b;							\
+	const oid *gids = a->gids;					\
+	CandIter cis, *ci;						\
+	BUN start, end, i, ngrp, nils;					\
+	oid min, max, gid;						\
+	int skip_nils = a->skip_nils;					\
+	BUN p = aggr_piece(a, lo, hi, &start, &end, &cis, &ci,		\
+			   &min, &max);					\
+	oid *oids;							\
+									\
+	if (a->local) {							\
+		ngrp = a->ngrp;						\
+		oids = a->part[p][0];					\
+	} else {							\
+		ngrp = hi - lo;						\
+		oids = (oid *) a->res[0] + lo;				\
+	}								\
+	for (i = 0; i < ngrp; i++)					\
+		oids[i] = oid_nil;					\
+	nils = ngrp;							\
+	switch (a->tp1) {						\
+	case TYPE_bte:							\
+		AGGR_CMP(bte, OP);					\
+		break;							\
+	case TYPE_sht:							\
+		AGGR_CMP(sht, OP);					\
+		break;							\
+	case TYPE_int:							\
+		AGGR_CMP(int, OP);					\
+		break;							\
+	case TYPE_oid:							\
+		AGGR_CMP(oid, OP);					\
+		break;							\
+	case TYPE_lng:							\
+		AGGR_CMP(lng, OP);					\
+		break;							\
+	case TYPE_flt:							\
+		AGGR_CMP(flt, OP);					\
+		break;							\
+	case TYPE_dbl:							\
+		AGGR_CMP(dbl, OP);					\
+		break;							\
+	default:							\
+		assert(0);						\
+	}								\
+	if (!a->local)							\
+		a->nils[p] = nils;					\
+}									\
+									\
+static void								\
+aggr_##NAME##_merge(BUN lo, BUN hi, void *arg)				\
+{									\
+	aggrpar_t *a = arg;						\
+	BAT *b = a->b;							\
+	oid *oids = a->res[0];						\
+	BUN p, g, nils = 0;						\
+									\
+	for (g = lo; g < hi; g++)					\
+		oids[g] = oid_nil;					\
+	switch (a->tp1) {						\
+	case TYPE_bte:							\
+		AGGR_CMP_MERGE(bte, OP);				\
+		break;							\
+	case TYPE_sht:							\
+		AGGR_CMP_MERGE(sht, OP);				\
+		break;							\
+	case TYPE_int:							\
+		AGGR_CMP_MERGE(int, OP);				\
+		break;							\
+	case TYPE_oid:							\
+		AGGR_CMP_MERGE(oid, OP);				\
+		break;							\
+	case TYPE_lng:							\
+		AGGR_CMP_MERGE(lng, OP);				\
+		break;							\
+	case TYPE_flt:							\
+		AGGR_CMP_MERGE(flt, OP);				\
+		break;							\
+	case TYPE_dbl:							\
+		AGGR_CMP_MERGE(dbl, OP);				\
+		break;							\
+	default:							\
+		assert(0);						\
+	}								\
+	for (g = lo; g < hi; g++)					\
+		nils += oids[g] == oid_nil;				\
+	a->mnils[lo / a->mgrain] = nils;				\
+}
+
+AGGR_CMP_PARALLEL(min, LT)
+AGGR_CMP_PARALLEL(max, GT)
+
 /* calculate group minimums with optional candidates list
  *
  * note that this functions returns *positions* of where the minimum
@@ -1740,8 +3426,9 @@ BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	int (*atomcmp)(const void *, const void *);
 	BATiter bi;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
+	aggrpar_t a;
 
 	assert(tp == TYPE_oid);
 	(void) tp;		/* compatibility (with other BATgroup* */
@@ -1754,7 +3441,7 @@ BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	}
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
+				    &cnt, &cis, &ci)) != NULL) {
 		GDKerror("BATgroupmin: %s\n", err);
 		return NULL;
 	}
@@ -1791,6 +3478,21 @@ BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	    ATOMnilptr(ATOMstorage(t)) == nil &&
 	    BATatoms[ATOMstorage(t)].atomCmp == atomcmp)
 		t = ATOMstorage(t);
+	if ((t == TYPE_oid || aggr_fixedtype(t)) &&
+	    aggr_parallel_init(&a, b, gids, min, max, ngrp, start, end,
+			       ci, skip_nils, abort_on_error,
+			       t, TYPE_oid, 1, "BATgroupmin")) {
+		int widths[3] = {sizeof(oid), 0, 0};
+
+		a.res[0] = oids;
+		nils = aggr_parallel_run(&a, widths, aggr_min_piece,
+					 aggr_min_merge, "BATgroupmin");
+		if (nils == BUN_NONE) {
+			BBPunfix(bn->batCacheid);
+			return NULL;
+		}
+		goto done;
+	}
 	switch (t) {
 	case TYPE_bte:
 		AGGR_CMP(bte, LT);
@@ -1817,10 +3519,10 @@ BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 		bi = bat_iterator(b);
 
 		for (;;) {
-			if (cand) {
-				if (cand == candend)
+			if (ci) {
+				if (ci->next == oid_nil)
 					break;
-				i = *cand++ - b->hseqbase;
+				i = CANDiternext(ci) - b->hseqbase;
 				if (i >= end)
 					break;
 			} else {
@@ -1851,6 +3553,7 @@ BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 		}
 		break;
 	}
+  done:
 	BATsetcount(bn, ngrp);
 
 	BATseqbase(bn, min);
@@ -1881,8 +3584,9 @@ BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	int (*atomcmp)(const void *, const void *);
 	BATiter bi;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
+	aggrpar_t a;
 
 	assert(tp == TYPE_oid);
 	(void) tp;		/* compatibility (with other BATgroup* */
@@ -1895,7 +3599,7 @@ BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	}
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
+				    &cnt, &cis, &ci)) != NULL) {
 		GDKerror("BATgroupmax: %s\n", err);
 		return NULL;
 	}
@@ -1932,6 +3636,21 @@ BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 	    ATOMnilptr(ATOMstorage(t)) == nil &&
 	    BATatoms[ATOMstorage(t)].atomCmp == atomcmp)
 		t = ATOMstorage(t);
+	if ((t == TYPE_oid || aggr_fixedtype(t)) &&
+	    aggr_parallel_init(&a, b, gids, min, max, ngrp, start, end,
+			       ci, skip_nils, abort_on_error,
+			       t, TYPE_oid, 1, "BATgroupmax")) {
+		int widths[3] = {sizeof(oid), 0, 0};
+
+		a.res[0] = oids;
+		nils = aggr_parallel_run(&a, widths, aggr_max_piece,
+					 aggr_max_merge, "BATgroupmax");
+		if (nils == BUN_NONE) {
+			BBPunfix(bn->batCacheid);
+			return NULL;
+		}
+		goto done;
+	}
 	switch (t) {
 	case TYPE_bte:
 		AGGR_CMP(bte, GT);
@@ -1958,10 +3677,10 @@ BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 		bi = bat_iterator(b);
 
 		for (;;) {
-			if (cand) {
-				if (cand == candend)
+			if (ci) {
+				if (ci->next == oid_nil)
 					break;
-				i = *cand++ - b->hseqbase;
+				i = CANDiternext(ci) - b->hseqbase;
 				if (i >= end)
 					break;
 			} else {
@@ -1992,6 +3711,7 @@ BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 		}
 		break;
 	}
+  done:
 	BATsetcount(bn, ngrp);
 
 	BATseqbase(bn, min);
@@ -2004,46 +3724,628 @@ BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 }
 
 /* ---------------------------------------------------------------------- */
-/* median */
+/* several aggregates in one scan */
+
+/* Sums, counts, minimums, maximums and averages of the same values and
+ * groups, computed in a single scan over b and g.  Each result is
+ * that of the corresponding BATgroup* function.  Sums are only done
+ * here into lng (integers) or dbl (floating point), the usual result
+ * types; other sums are left to BATgroupsum. */
+
+typedef struct {
+	aggrpar_t a;		/* first: the pieces get a pointer to it */
+	void *sums;		/* GROUP_SUM: lng or dbl */
+	unsigned int *seen;	/* GROUP_SUM: bitmap of groups seen */
+	wrd *cnts;		/* GROUP_COUNT */
+	oid *mins, *maxs;	/* GROUP_MIN, GROUP_MAX: positions */
+	dbl *dbls;		/* GROUP_AVG */
+	void *avgs;		/* GROUP_AVG of integers: floor averages, */
+	BUN *rems;		/* remainders */
+	BUN *acnts;		/* and counts (BUN_NONE after a nil) */
+} aggrmulti_t;
+
+#define AGGR_MULTI(TYPE, STYPE, AVERAGE)				\
+	do {								\
+		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
+		STYPE *sums = m->sums ? (STYPE *) m->sums + lo : NULL;	\
+		TYPE x;							\
+		for (;;) {						\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
+					break;				\
+				i = CANDiternext(ci) - seqb;		\
+				if (i >= end)				\
+					break;				\
+			} else {					\
+				i = start++;				\
+				if (i == end)				\
+					break;				\
+			}						\
+			if (gids != NULL &&				\
+			    (gids[i] < min || gids[i] > max))		\
+				continue;				\
+			gid = gids ? gids[i] - min : (oid) i;		\
+			x = vals[i];					\
+			if (sums &&					\
+			    !(seen[gid >> 5] & (1U << (gid & 0x1F)))) { \
+				seen[gid >> 5] |= 1U << (gid & 0x1F);	\
+				sums[gid] = 0;				\
+			}						\
+			if (x == TYPE##_nil) {				\
+				if (skip_nils)				\
+					continue;			\
+				if (sums)				\
+					sums[gid] = STYPE##_nil;	\
+				if (cnts)				\
+					cnts[gid]++;			\
+				if (mins &&				\
+				    (mins[gid] == oid_nil ||		\
+				     vals[mins[gid] - seqb] != TYPE##_nil)) \
+					mins[gid] = i + seqb;		\
+				if (maxs &&				\
+				    (maxs[gid] == oid_nil ||		\
+				     vals[maxs[gid] - seqb] != TYPE##_nil)) \
+					maxs[gid] = i + seqb;		\
+				if (acnts)				\
+					acnts[gid] = BUN_NONE;		\
+				continue;				\
+			}						\
+			if (sums && sums[gid] != STYPE##_nil)		\
+				ADD_WITH_CHECK(TYPE, x, STYPE, sums[gid], \
+					       STYPE, sums[gid],	\
+					       goto overflow);		\
+			if (cnts)					\
+				cnts[gid]++;				\
+			if (mins &&					\
+			    (mins[gid] == oid_nil ||			\
+			     (vals[mins[gid] - seqb] != TYPE##_nil &&	\
+			      x < vals[mins[gid] - seqb])))		\
+				mins[gid] = i + seqb;			\
+			if (maxs &&					\
+			    (maxs[gid] == oid_nil ||			\
+			     (vals[maxs[gid] - seqb] != TYPE##_nil &&	\
+			      x > vals[maxs[gid] - seqb])))		\
+				maxs[gid] = i + seqb;			\
+			if (acnts && acnts[gid] != BUN_NONE)		\
+				AVERAGE;				\
+		}							\
+	} while (0)
 
-BAT *
-BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error)
+/* aggregate the given rows into the arrays of m, which are offset by
+ * lo groups (a multiple of 32); returns BUN_NONE on overflow (with
+ * abort_on_error set) */
+static BUN
+domulti_range(const aggrmulti_t *m, BAT *b, int t, const oid *gids, BUN lo,
+	      BUN start, BUN end, CandIter *ci,
+	      oid min, oid max, int skip_nils, int abort_on_error)
 {
-	int freeb = 0, freeg = 0;
+	oid seqb = b->hseqbase;
+	unsigned int *seen = m->seen ? m->seen + lo / 32 : NULL;
+	wrd *cnts = m->cnts ? m->cnts + lo : NULL;
+	oid *mins = m->mins ? m->mins + lo : NULL;
+	oid *maxs = m->maxs ? m->maxs + lo : NULL;
+	dbl *dbls = m->dbls ? m->dbls + lo : NULL;
+	BUN *rems = m->rems ? m->rems + lo : NULL;
+	BUN *acnts = m->acnts ? m->acnts + lo : NULL;
+	BUN i, nils = 0;	/* nils is needed by ADD_WITH_CHECK */
+	oid gid;
+
+	assert(lo % 32 == 0);
+	switch (t) {
+	case TYPE_bte: {
+		bte *avgs = m->avgs ? (bte *) m->avgs + lo : NULL;
+		AGGR_MULTI(bte, lng,
+			   AVERAGE_ITER(bte, x, avgs[gid], rems[gid],
+					acnts[gid]));
+		break;
+	}
+	case TYPE_sht: {
+		sht *avgs = m->avgs ? (sht *) m->avgs + lo : NULL;
+		AGGR_MULTI(sht, lng,
+			   AVERAGE_ITER(sht, x, avgs[gid], rems[gid],
+					acnts[gid]));
+		break;
+	}
+	case TYPE_int: {
+		int *avgs = m->avgs ? (int *) m->avgs + lo : NULL;
+		AGGR_MULTI(int, lng,
+			   AVERAGE_ITER(int, x, avgs[gid], rems[gid],
+					acnts[gid]));
+		break;
+	}
+	case TYPE_lng: {
+		lng *avgs = m->avgs ? (lng *) m->avgs + lo : NULL;
+		AGGR_MULTI(lng, lng,
+			   AVERAGE_ITER(lng, x, avgs[gid], rems[gid],
+					acnts[gid]));
+		break;
+	}
+	case TYPE_flt:
+		AGGR_MULTI(flt, dbl,
+			   AVERAGE_ITER_FLOAT(flt, x, dbls[gid], acnts[gid]));
+		break;
+	case TYPE_dbl:
+		AGGR_MULTI(dbl, dbl,
+			   AVERAGE_ITER_FLOAT(dbl, x, dbls[gid], acnts[gid]));
+		break;
+	default:
+		assert(0);
+	}
+	(void) nils;
+	return 0;
+
+  overflow:
+	return BUN_NONE;
+}
+
+static void
+aggr_multi_piece(BUN lo, BUN hi, void *arg)
+{
+	aggrmulti_t *m = arg;
+	CandIter cis, *ci;
+	BUN start, end;
 	oid min, max;
-	BUN ngrp;
-	BUN nils = 0;
-	BAT *bn = NULL;
-	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
-	BAT *t1, *t2;
-	BATiter bi;
-	const void *v;
-	const void *nil;
-	int (*atomcmp)(const void *, const void *);
-	const char *err;
+	BUN p = aggr_piece(&m->a, lo, hi, &start, &end, &cis, &ci,
+			   &min, &max);
 
-	(void) abort_on_error;
+	if (domulti_range(m, m->a.b, m->a.tp1, m->a.gids, lo, start, end,
+			  ci, min, max, m->a.skip_nils,
+			  m->a.abort_on_error) == BUN_NONE)
+		m->a.err[p] = AGGR_ERR_OVERFLOW;
+}
+
+#define AGGR_MULTI_AVG(TYPE)						\
+	do {								\
+		const TYPE *avgs = (const TYPE *) m.avgs;		\
+		for (i = 0; i < ngrp; i++) {				\
+			if (m.acnts[i] == 0 || m.acnts[i] == BUN_NONE) { \
+				m.dbls[i] = dbl_nil;			\
+				nils[GROUP_AVG]++;			\
+			} else {					\
+				m.dbls[i] = avgs[i] +			\
+					(dbl) m.rems[i] / m.acnts[i];	\
+			}						\
+		}							\
+	} while (0)
 
+/* Calculate the aggregates aggrs[0..naggrs-1] of b grouped by g (with
+ * optional extents e and candidates list s) into res[0..naggrs-1].
+ * res[k] is the BAT that BATgroupsum, BATgroupcount, BATgroupmin,
+ * BATgroupmax or BATgroupavg (as per aggrs[k]) would return given
+ * result type tps[k].  The aggregates that can, are computed together
+ * in one scan over b and g (by several threads for big inputs), the
+ * others (and repeats) separately.  On failure all of res is NULL. */
+gdk_return
+BATgroupaggr_multi(BAT **res, const groupaggr_t *aggrs, const int *tps,
+		   int naggrs, BAT *b, BAT *g, BAT *e, BAT *s,
+		   int skip_nils, int abort_on_error)
+{
+	const oid *gids;
+	oid min, max;
+	BUN i, ngrp, start, end, cnt;
+	BUN nils[GROUP_AVG + 1];
+	CandIter cis, *ci = NULL;
+	const char *err;
+	int k, j, t, fused = 0;
+	aggrmulti_t m;
+	BAT *bn[GROUP_AVG + 1];
+
+	memset(&m, 0, sizeof(m));
+	memset(bn, 0, sizeof(bn));
+	memset(nils, 0, sizeof(nils));
+	for (k = 0; k < naggrs; k++)
+		res[k] = NULL;
+	for (k = 0; k < naggrs; k++) {
+		if (aggrs[k] < GROUP_SUM || aggrs[k] > GROUP_AVG) {
+			GDKerror("BATgroupaggr_multi: unknown aggregate %d\n",
+				 (int) aggrs[k]);
+			return GDK_FAIL;
+		}
+	}
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
-		GDKerror("BATgroupmedian: %s\n", err);
-		return NULL;
+				    &cnt, &cis, &ci)) != NULL) {
+		GDKerror("BATgroupaggr_multi: %s\n", err);
+		return GDK_FAIL;
 	}
-	assert(tp == b->ttype);
-	if (!ATOMlinear(b->ttype)) {
-		GDKerror("BATgroupmedian: cannot determine median on "
-			 "non-linear type %s\n", ATOMname(b->ttype));
-		return NULL;
+	if (g == NULL) {
+		GDKerror("BATgroupaggr_multi: b and g must be aligned\n");
+		return GDK_FAIL;
 	}
 
-	if (BATcount(b) == 0 || ngrp == 0) {
-		/* trivial: no medians, so return bat aligned with e with
-		 * nil in the tail */
-		bn = BATconstant(tp, ATOMnilptr(tp), ngrp);
-		BATseqbase(bn, ngrp == 0 ? 0 : min);
-		return bn;
+	t = b->T->type;
+	if (t != ATOMstorage(t) &&
+	    ATOMnilptr(ATOMstorage(t)) == ATOMnilptr(t) &&
+	    BATatoms[ATOMstorage(t)].atomCmp == BATatoms[t].atomCmp)
+		t = ATOMstorage(t);
+	/* the trivial cases (no groups, singleton groups) are left to
+	 * the separate functions */
+	if (aggr_fixedtype(t) && BATcount(b) > 0 && ngrp > 0 &&
+	    !((e == NULL ||
+	       (BATcount(e) == BATcount(b) && e->hseqbase == b->hseqbase)) &&
+	      (BATtdense(g) || (g->tkey && g->T->nonil)))) {
+		for (k = 0; k < naggrs; k++) {
+			int tp;
+
+			switch (aggrs[k]) {
+			case GROUP_SUM:
+				if (ATOMstorage(tps[k]) !=
+				    (t == TYPE_flt || t == TYPE_dbl ?
+				     TYPE_dbl : TYPE_lng))
+					continue;
+				tp = tps[k];
+				break;
+			case GROUP_COUNT:
+				tp = TYPE_wrd;
+				break;
+			case GROUP_AVG:
+				tp = TYPE_dbl;
+				break;
+			default:
+				tp = TYPE_oid;
+				break;
+			}
+			if (bn[aggrs[k]] != NULL)
+				continue;
+			if ((bn[aggrs[k]] = BATnew(TYPE_void, tp, ngrp)) == NULL)
+				goto bailout;
+			fused++;
+		}
+	}
+
+	if (fused > 0) {
+		if (bn[GROUP_SUM]) {
+			m.sums = Tloc(bn[GROUP_SUM], BUNfirst(bn[GROUP_SUM]));
+			m.seen = GDKzalloc(((ngrp + 31) / 32) * sizeof(int));
+			if (m.seen == NULL)
+				goto alloc_fail;
+		}
+		if (bn[GROUP_COUNT]) {
+			m.cnts = (wrd *) Tloc(bn[GROUP_COUNT],
+					      BUNfirst(bn[GROUP_COUNT]));
+			memset(m.cnts, 0, ngrp * sizeof(wrd));
+		}
+		if (bn[GROUP_MIN]) {
+			m.mins = (oid *) Tloc(bn[GROUP_MIN],
+					      BUNfirst(bn[GROUP_MIN]));
+			for (i = 0; i < ngrp; i++)
+				m.mins[i] = oid_nil;
+		}
+		if (bn[GROUP_MAX]) {
+			m.maxs = (oid *) Tloc(bn[GROUP_MAX],
+					      BUNfirst(bn[GROUP_MAX]));
+			for (i = 0; i < ngrp; i++)
+				m.maxs[i] = oid_nil;
+		}
+		if (bn[GROUP_AVG]) {
+			m.dbls = (dbl *) Tloc(bn[GROUP_AVG],
+					      BUNfirst(bn[GROUP_AVG]));
+			memset(m.dbls, 0, ngrp * sizeof(dbl));
+			if ((m.acnts = GDKzalloc(ngrp * sizeof(BUN))) == NULL)
+				goto alloc_fail;
+			if (t != TYPE_flt && t != TYPE_dbl &&
+			    ((m.avgs = GDKzalloc(ngrp * ATOMsize(t))) == NULL ||
+			     (m.rems = GDKzalloc(ngrp * sizeof(BUN))) == NULL))
+				goto alloc_fail;
+		}
+
+		if (BATtdense(g))
+			gids = NULL;
+		else
+			gids = (const oid *) Tloc(g, BUNfirst(g) + start);
+
+		ALGODEBUG fprintf(stderr, "#BATgroupaggr_multi: %d aggregates "
+				  "in one scan, " BUNFMT " groups\n",
+				  fused, ngrp);
+		/* no private partials (canmerge is 0): every group is
+		 * done by a single thread, so the results are those
+		 * of the sequential code */
+		if (aggr_parallel_init(&m.a, b, gids, min, max, ngrp,
+				       start, end, ci,
+				       skip_nils, abort_on_error, t, TYPE_void,
+				       0, "BATgroupaggr_multi")) {
+			int widths[3] = {0, 0, 0};
+
+			if (aggr_parallel_run(&m.a, widths, aggr_multi_piece,
+					      NULL, "BATgroupaggr_multi") ==
+			    BUN_NONE)
+				goto bailout;
+		} else if (domulti_range(&m, b, t, gids, 0, start, end,
+					 ci, min, max,
+					 skip_nils, abort_on_error) == BUN_NONE) {
+			GDKerror("22003!overflow in calculation.\n");
+			goto bailout;
+		}
+
+		/* groups without rows have a nil sum */
+		if (m.sums && t != TYPE_flt && t != TYPE_dbl) {
+			lng *sums = m.sums;
+			for (i = 0; i < ngrp; i++) {
+				if (!(m.seen[i >> 5] & (1U << (i & 0x1F))))
+					sums[i] = lng_nil;
+				nils[GROUP_SUM] += sums[i] == lng_nil;
+			}
+		} else if (m.sums) {
+			dbl *sums = m.sums;
+			for (i = 0; i < ngrp; i++) {
+				if (!(m.seen[i >> 5] & (1U << (i & 0x1F))))
+					sums[i] = dbl_nil;
+				nils[GROUP_SUM] += sums[i] == dbl_nil;
+			}
+		}
+		for (i = 0; m.mins && i < ngrp; i++)
+			nils[GROUP_MIN] += m.mins[i] == oid_nil;
+		for (i = 0; m.maxs && i < ngrp; i++)
+			nils[GROUP_MAX] += m.maxs[i] == oid_nil;
+		if (m.acnts) {
+			switch (t) {
+			case TYPE_bte:
+				AGGR_MULTI_AVG(bte);
+				break;
+			case TYPE_sht:
+				AGGR_MULTI_AVG(sht);
+				break;
+			case TYPE_int:
+				AGGR_MULTI_AVG(int);
+				break;
+			case TYPE_lng:
+				AGGR_MULTI_AVG(lng);
+				break;
+			default:
+				for (i = 0; i < ngrp; i++) {
+					if (m.acnts[i] == 0 ||
+					    m.acnts[i] == BUN_NONE) {
+						m.dbls[i] = dbl_nil;
+						nils[GROUP_AVG]++;
+					}
+				}
+				break;
+			}
+		}
+		GDKfree(m.seen);
+		GDKfree(m.acnts);
+		GDKfree(m.avgs);
+		GDKfree(m.rems);
+		m.seen = NULL;
+		m.acnts = NULL;
+		m.avgs = NULL;
+		m.rems = NULL;
+
+		for (j = GROUP_SUM; j <= GROUP_AVG; j++) {
+			if (bn[j] == NULL)
+				continue;
+			BATsetcount(bn[j], ngrp);
+			BATseqbase(bn[j], min);
+			bn[j]->tkey = BATcount(bn[j]) <= 1;
+			bn[j]->tsorted = BATcount(bn[j]) <= 1;
+			bn[j]->trevsorted = BATcount(bn[j]) <= 1;
+			bn[j]->T->nil = nils[j] != 0;
+			bn[j]->T->nonil = nils[j] == 0;
+		}
+	}
+
+	/* hand out the results of the scan, and compute the rest */
+	for (k = 0; k < naggrs; k++) {
+		j = aggrs[k];
+		if (bn[j] != NULL &&
+		    (j != GROUP_SUM || bn[j]->ttype == tps[k])) {
+			res[k] = bn[j];
+			bn[j] = NULL;
+			continue;
+		}
+		switch (j) {
+		case GROUP_SUM:
+			res[k] = BATgroupsum(b, g, e, s, tps[k],
+					     skip_nils, abort_on_error);
+			break;
+		case GROUP_COUNT:
+			res[k] = BATgroupcount(b, g, e, s, tps[k],
+					       skip_nils, abort_on_error);
+			break;
+		case GROUP_MIN:
+			res[k] = BATgroupmin(b, g, e, s, tps[k],
+					     skip_nils, abort_on_error);
+			break;
+		case GROUP_MAX:
+			res[k] = BATgroupmax(b, g, e, s, tps[k],
+					     skip_nils, abort_on_error);
+			break;
+		case GROUP_AVG:
+			res[k] = BATgroupavg(b, g, e, s, tps[k],
+					     skip_nils, abort_on_error);
+			break;
+		}
+		if (res[k] == NULL)
+			goto bailout;
+	}
+	return GDK_SUCCEED;
+
+  alloc_fail:
+	GDKerror("BATgroupaggr_multi: cannot allocate enough memory.\n");
+  bailout:
+	GDKfree(m.seen);
+	GDKfree(m.acnts);
+	GDKfree(m.avgs);
+	GDKfree(m.rems);
+	for (j = GROUP_SUM; j <= GROUP_AVG; j++)
+		if (bn[j])
+			BBPunfix(bn[j]->batCacheid);
+	for (k = 0; k < naggrs; k++) {
+		if (res[k])
+			BBPunfix(res[k]->batCacheid);
+		res[k] = NULL;
 	}
+	return GDK_FAIL;
+}
+
+/* ---------------------------------------------------------------------- */
+/* quantile and median */
+
+/* Find the k-th smallest (0-based) of the n values in v, reordering
+ * v: quickselect with median-of-three pivots, in expected linear
+ * time; if partitioning does not converge fast enough (adversarial
+ * input), the rest of the range is sorted instead. */
+#define QUANTILE_SELECT(TYPE)						\
+static TYPE								\
+quantile_select_##TYPE(TYPE *v, BUN n, BUN k)				\
+{									\
+	SBUN lo = 0, hi = (SBUN) n - 1, i, j, m;			\
+	int depth = 8;							\
+	BUN x;								\
+	TYPE pivot, t;							\
+									\
+	for (x = n; x > 1; x >>= 1)					\
+		depth += 2;						\
+	while (hi > lo) {						\
+		if (depth-- == 0) {					\
+			GDKqsort(v + lo, NULL, NULL,			\
+				 (size_t) (hi - lo + 1),		\
+				 (int) sizeof(TYPE), 0, TYPE_##TYPE);	\
+			break;						\
+		}							\
+		m = lo + (hi - lo) / 2;					\
+		if (v[m] < v[lo]) {					\
+			t = v[m]; v[m] = v[lo]; v[lo] = t;		\
+		}							\
+		if (v[hi] < v[m]) {					\
+			t = v[m]; v[m] = v[hi]; v[hi] = t;		\
+			if (v[m] < v[lo]) {				\
+				t = v[m]; v[m] = v[lo]; v[lo] = t;	\
+			}						\
+		}							\
+		pivot = v[m];						\
+		i = lo;							\
+		j = hi;							\
+		while (i <= j) {					\
+			while (v[i] < pivot)				\
+				i++;					\
+			while (pivot < v[j])				\
+				j--;					\
+			if (i <= j) {					\
+				t = v[i]; v[i] = v[j]; v[j] = t;	\
+				i++;					\
+				j--;					\
+			}						\
+		}							\
+		/* now v[lo..j] <= pivot <= v[i..hi] and */		\
+		/* v[j+1..i-1] == pivot */				\
+		if ((SBUN) k <= j)					\
+			hi = j;						\
+		else if ((SBUN) k >= i)					\
+			lo = i;						\
+		else							\
+			break;						\
+	}								\
+	return v[k];							\
+}
+
+QUANTILE_SELECT(bte)
+QUANTILE_SELECT(sht)
+QUANTILE_SELECT(int)
+QUANTILE_SELECT(lng)
+QUANTILE_SELECT(flt)
+QUANTILE_SELECT(dbl)
+
+/* Bucket the non-nil values by group (a counting sort on the group
+ * id, so two passes over the input), then select the wanted element
+ * in each bucket.  Nil values are the smallest, so if they are not
+ * skipped, only their number per group is needed. */
+#define QUANTILE_FIXED(TYPE)						\
+	do {								\
+		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
+		TYPE *buf, *res = (TYPE *) Tloc(bn, BUNfirst(bn));	\
+		BUN nvals = 0;						\
+		if (ci)							\
+			cit = *ci;	/* a fresh copy for each pass */ \
+		for (c = ci ? &cit : NULL, r = start;;) {		\
+			if (c) {					\
+				if (c->next == oid_nil)			\
+					break;				\
+				i = CANDiternext(c) - b->hseqbase;	\
+				if (i >= end)				\
+					break;				\
+			} else {					\
+				i = r++;				\
+				if (i == end)				\
+					break;				\
+			}						\
+			gid = gids ? gids[i] : g ? g->tseqbase + i : 0;	\
+			if (gid < min || gid > max)			\
+				continue;				\
+			gid -= min;					\
+			if (vals[i] == TYPE##_nil) {			\
+				if (nnils)				\
+					nnils[gid]++;			\
+			} else {					\
+				offs[gid]++;				\
+				nvals++;				\
+			}						\
+		}							\
+		buf = GDKmalloc(nvals ? nvals * sizeof(TYPE) : 1);	\
+		if (buf == NULL)					\
+			goto alloc_fail;				\
+		/* offs[gid] becomes the start of the bucket and, */	\
+		/* after the scatter, its end */			\
+		for (gid = 0, r = 0; gid < ngrp; gid++) {		\
+			BUN t = offs[gid];				\
+			offs[gid] = r;					\
+			r += t;						\
+		}							\
+		if (ci)							\
+			cit = *ci;	/* a fresh copy for each pass */ \
+		for (c = ci ? &cit : NULL, r = start;;) {		\
+			if (c) {					\
+				if (c->next == oid_nil)			\
+					break;				\
+				i = CANDiternext(c) - b->hseqbase;	\
+				if (i >= end)				\
+					break;				\
+			} else {					\
+				i = r++;				\
+				if (i == end)				\
+					break;				\
+			}						\
+			gid = gids ? gids[i] : g ? g->tseqbase + i : 0;	\
+			if (gid < min || gid > max)			\
+				continue;				\
+			if (vals[i] != TYPE##_nil)			\
+				buf[offs[gid - min]++] = vals[i];	\
+		}							\
+		for (gid = 0, r = 0; gid < ngrp; gid++) {		\
+			BUN n = offs[gid] - r;				\
+			BUN nnil = nnils ? nnils[gid] : 0;		\
+			BUN k;						\
+			if (n + nnil == 0) {				\
+				res[gid] = TYPE##_nil;			\
+				nils++;					\
+			} else {					\
+				k = (BUN) ((n + nnil - 1) * quantile);	\
+				if (k < nnil) {				\
+					res[gid] = TYPE##_nil;		\
+					nils++;				\
+				} else {				\
+					res[gid] = quantile_select_##TYPE( \
+						buf + r, n, k - nnil);	\
+				}					\
+			}						\
+			r = offs[gid];					\
+		}							\
+		GDKfree(buf);						\
+	} while (0)
+
+/* the old way: sort b on group and value and pick the elements from
+ * the groups; used for types that have no natural order in C */
+static BAT *
+doquantile_sort(BAT *b, BAT *g, BAT *s, int tp, dbl quantile,
+		BUN ngrp, oid min, int skip_nils)
+{
+	int freeb = 0, freeg = 0;
+	BUN nils = 0;
+	BAT *bn = NULL;
+	BAT *t1, *t2;
+	BATiter bi;
+	const void *v;
+	const void *nil;
+	int (*atomcmp)(const void *, const void *);
 
 	if (s) {
 		b = BATleftjoin(s, b, BATcount(s));
@@ -2081,9 +4383,9 @@ BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_
 	if (t2)
 		BBPunfix(t2->batCacheid);
 
-	bn = BATnew(TYPE_void, b->ttype, ngrp);
+	bn = BATnew(TYPE_void, tp, ngrp);
 	if (bn == NULL)
-		return NULL;
+		goto bunins_failed;
 
 	bi = bat_iterator(b);
 	nil = ATOMnilptr(b->ttype);
@@ -2112,7 +4414,7 @@ BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_
 							   nil, 0, Tsize(bn));
 					nils++;
 				} else {
-					v = BUNtail(bi, BUNfirst(b) + (r + p - 1) / 2);
+					v = BUNtail(bi, BUNfirst(b) + r + (BUN) ((p - r - 1) * quantile));
 					bunfastins_nocheck(bn, BUNlast(bn), 0,
 							   v, 0, Tsize(bn));
 					nils += (*atomcmp)(v, nil) == 0;
@@ -2125,10 +4427,20 @@ BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_
 		while (BATcount(bn) < ngrp) {
 			bunfastins_nocheck(bn, BUNlast(bn), 0,
 					   nil, 0, Tsize(bn));
+			nils++;
 		}
 		BATseqbase(bn, min);
 	} else {
-		v = BUNtail(bi, BUNfirst(b) + (BATcount(b) - 1) / 2);
+		BUN r = 0, q = BATcount(b);
+
+		if (skip_nils) {
+			while (r < q && (*atomcmp)(BUNtail(bi, BUNfirst(b) + r), nil) == 0)
+				r++;
+		}
+		if (r == q)
+			v = nil;
+		else
+			v = BUNtail(bi, BUNfirst(b) + r + (BUN) ((q - r - 1) * quantile));
 		BUNappend(bn, v, FALSE);
 		BATseqbase(bn, 0);
 		nils += (*atomcmp)(v, nil) == 0;
@@ -2151,37 +4463,1019 @@ BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_
 		BBPunfix(b->batCacheid);
 	if (freeg)
 		BBPunfix(g->batCacheid);
-	BBPunfix(bn->batCacheid);
+	if (bn)
+		BBPunfix(bn->batCacheid);
 	return NULL;
 }
 
-/* ---------------------------------------------------------------------- */
-/* standard deviation (both biased and non-biased) */
-
-#define AGGR_STDEV_SINGLE(TYPE)						\
-	do {								\
-		TYPE x;							\
-		for (i = 0; i < cnt; i++) {				\
-			x = ((const TYPE *) values)[i];			\
-			if (x == TYPE##_nil)				\
-				continue;				\
-			n++;						\
+/* calculate group quantiles with optional candidates list
+ *
+ * the result for a group is the element at position
+ * (BUN) ((cnt - 1) * quantile) of the group's values in sorted order
+ * (nils first), where cnt is the number of values (not counting nils
+ * if skip_nils is set), so quantile 0.5 gives the lower median */
+BAT *
+BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, dbl quantile,
+		 int skip_nils, int abort_on_error)
+{
+	oid min, max;
+	BUN ngrp;
+	BUN nils = 0;
+	BAT *bn = NULL;
+	BUN start, end, cnt;
+	CandIter cis, *ci = NULL, cit, *c;
+	const oid *gids = NULL;
+	BUN i, r, *offs = NULL, *nnils = NULL;
+	oid gid;
+	int t;
+	const void *nil;
+	int (*atomcmp)(const void *, const void *);
+	const char *err;
+
+	(void) abort_on_error;
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cnt, &cis, &ci)) != NULL) {
+		GDKerror("BATgroupquantile: %s\n", err);
+		return NULL;
+	}
+	assert(tp == b->ttype);
+	if (!ATOMlinear(b->ttype)) {
+		GDKerror("BATgroupquantile: cannot determine quantile on "
+			 "non-linear type %s\n", ATOMname(b->ttype));
+		return NULL;
+	}
+	if (!(quantile >= 0 && quantile <= 1)) {
+		GDKerror("BATgroupquantile: cannot determine quantile for "
+			 "p=%f (p has to be in [0,1])\n", quantile);
+		return NULL;
+	}
+
+	if (BATcount(b) == 0 || ngrp == 0) {
+		/* trivial: no values, so return bat aligned with e with
+		 * nil in the tail */
+		bn = BATconstant(tp, ATOMnilptr(tp), ngrp);
+		BATseqbase(bn, ngrp == 0 ? 0 : min);
+		return bn;
+	}
+
+	t = b->T->type;
+	nil = ATOMnilptr(t);
+	atomcmp = BATatoms[t].atomCmp;
+	if (t != ATOMstorage(t) &&
+	    ATOMnilptr(ATOMstorage(t)) == nil &&
+	    BATatoms[ATOMstorage(t)].atomCmp == atomcmp)
+		t = ATOMstorage(t);
+	switch (t) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		break;
+	default:
+		ALGODEBUG fprintf(stderr, "#BATgroupquantile: sort\n");
+		if (s && BATtcand(s)) {
+			/* the joins need the candidates as a list */
+			if ((s = BATcandlist(s)) == NULL)
+				return NULL;
+			bn = doquantile_sort(b, g, s, tp, quantile, ngrp, min,
+					     skip_nils);
+			BBPunfix(s->batCacheid);
+			return bn;
+		}
+		return doquantile_sort(b, g, s, tp, quantile, ngrp, min,
+				       skip_nils);
+	}
+	ALGODEBUG fprintf(stderr, "#BATgroupquantile: select, " BUNFMT
+			  " groups\n", ngrp);
+
+	offs = GDKzalloc(ngrp * sizeof(BUN));
+	if (offs == NULL)
+		goto alloc_fail;
+	if (!skip_nils && !b->T->nonil) {
+		nnils = GDKzalloc(ngrp * sizeof(BUN));
+		if (nnils == NULL)
+			goto alloc_fail;
+	}
+	bn = BATnew(TYPE_void, tp, ngrp);
+	if (bn == NULL)
+		goto alloc_fail;
+	if (g && !BATtdense(g))
+		gids = (const oid *) Tloc(g, BUNfirst(g));
+
+	switch (t) {
+	case TYPE_bte:
+		QUANTILE_FIXED(bte);
+		break;
+	case TYPE_sht:
+		QUANTILE_FIXED(sht);
+		break;
+	case TYPE_int:
+		QUANTILE_FIXED(int);
+		break;
+	case TYPE_lng:
+		QUANTILE_FIXED(lng);
+		break;
+	case TYPE_flt:
+		QUANTILE_FIXED(flt);
+		break;
+	case TYPE_dbl:
+		QUANTILE_FIXED(dbl);
+		break;
+	}
+	GDKfree(offs);
+	GDKfree(nnils);
+
+	BATsetcount(bn, ngrp);
+	BATseqbase(bn, min);
+	bn->tkey = BATcount(bn) <= 1;
+	bn->tsorted = BATcount(bn) <= 1;
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->T->nil = nils != 0;
+	bn->T->nonil = nils == 0;
+	return bn;
+
+  alloc_fail:
+	if (bn)
+		BBPunfix(bn->batCacheid);
+	GDKfree(offs);
+	GDKfree(nnils);
+	GDKerror("BATgroupquantile: cannot allocate enough memory.\n");
+	return NULL;
+}
+
+BAT *
+BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error)
+{
+	return BATgroupquantile(b, g, e, s, tp, 0.5, skip_nils,
+				abort_on_error);
+}
+
+/* ---------------------------------------------------------------------- */
+/* approximate distinct count and quantiles */
+
+/* murmur3 64-bit finalizer: all 64 bits depend on all input bits;
+ * the offset moves the fixed point at 0 away from common values (a
+ * zero hash has the maximum HyperLogLog rank) */
+static inline ulng
+sketch_fmix(ulng h)
+{
+	h += 0x9e3779b97f4a7c15ULL;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+static inline ulng
+sketch_hash_dbl(dbl v)
+{
+	union {
+		dbl d;
+		ulng u;
+	} x;
+
+	x.d = v == 0 ? 0 : v;	/* -0 == 0 */
+	return sketch_fmix(x.u);
+}
+
+/* FNV-1a over the bytes of a fixed-width value */
+static inline ulng
+sketch_hash_bytes(const void *v, int width)
+{
+	const unsigned char *p = v;
+	ulng h = 0xcbf29ce484222325ULL;
+
+	while (width-- > 0) {
+		h ^= *p++;
+		h *= 0x100000001b3ULL;
+	}
+	return sketch_fmix(h);
+}
+
+/* HyperLogLog (Flajolet, Fusy, Gandouet and Meunier, 2007).  Each
+ * group has 2^p one-byte registers.  The top p bits of the hash of a
+ * value select a register, which keeps the maximum over its values of
+ * the position of the first 1 bit in the rest of the hash.  The
+ * relative standard error of the estimate is 1.04 / sqrt(2^p).  The
+ * registers of partial results are merged by taking the maximum,
+ * which gives exactly the registers of the combined input. */
+
+#define HLL_MINP	4	/* 26% standard error */
+#define HLL_MAXP	14	/* 0.8% standard error */
+
+static inline void
+hll_add(unsigned char *regs, int p, ulng h)
+{
+	/* the guard bit limits the rank to 64 - p + 1 */
+	ulng w = (h << p) | ((ulng) 1 << (p - 1));
+	unsigned char r = 1;
+
+#ifdef __GNUC__
+	r += (unsigned char) __builtin_clzll(w);
+#else
+	while ((w & ((ulng) 1 << 63)) == 0) {
+		w <<= 1;
+		r++;
+	}
+#endif
+	if (regs[h >> (64 - p)] < r)
+		regs[h >> (64 - p)] = r;
+}
+
+/* The estimator of Ertl (2017), which unlike the original one needs
+ * no bias correction or switch to linear counting for small counts:
+ * only the histogram of the register values is needed. */
+static wrd
+hll_estimate(const unsigned char *regs, int p)
+{
+	BUN m = (BUN) 1 << p, j;
+	BUN c[66];
+	int q = 64 - p, k;
+	dbl z, x, y, s, t;
+
+	memset(c, 0, sizeof(c));
+	for (j = 0; j < m; j++)
+		c[regs[j]]++;
+	if (c[0] == m)
+		return 0;
+	/* z = m * tau(1 - c[q+1] / m) */
+	x = 1 - (dbl) c[q + 1] / m;
+	if (x == 0 || x == 1) {
+		z = 0;
+	} else {
+		s = 1 - x;
+		t = 1;
+		do {
+			x = sqrt(x);
+			t *= 0.5;
+			y = s;
+			s -= (1 - x) * (1 - x) * t;
+		} while (s != y);
+		z = m * s / 3;
+	}
+	for (k = q; k >= 1; k--)
+		z = 0.5 * (z + c[k]);
+	/* z += m * sigma(c[0] / m) */
+	x = (dbl) c[0] / m;
+	if (x == 1) {
+		return 0;
+	} else if (x > 0) {
+		s = x;
+		t = 1;
+		do {
+			x *= x;
+			y = s;
+			s += x * t;
+			t += t;
+		} while (s != y);
+		z += m * s;
+	}
+	return (wrd) (m * m / (2 * log(2.0) * z) + 0.5);
+}
+
+#define HLL_LOOP(TYPE, HASH)						\
+	do {								\
+		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
+		for (;;) {						\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
+					break;				\
+				i = CANDiternext(ci) - b->hseqbase;	\
+				if (i >= end)				\
+					break;				\
+			} else {					\
+				i = start++;				\
+				if (i == end)				\
+					break;				\
+			}						\
+			if (gids == NULL ||				\
+			    (gids[i] >= min && gids[i] <= max)) {	\
+				gid = gids ? gids[i] - min :		\
+					grouped ? (oid) i : 0;		\
+				if (skip_nils && vals[i] == TYPE##_nil)	\
+					continue;			\
+				hll_add(regs + (gid << p), p, HASH(vals[i])); \
+			}						\
+		}							\
+	} while (0)
+
+#define HLL_HASH_INT(v)	sketch_fmix((ulng) (lng) (v))
+
+/* add the values of the given rows to the registers of their groups
+ * (with gids NULL, row i is group i, or if not grouped, all rows are
+ * group 0); unless skipped, nil counts as a value */
+static void
+hll_update(BAT *b, int grouped, const oid *gids, oid min, oid max,
+	   BUN start, BUN end, CandIter *ci,
+	   int skip_nils, int p, unsigned char *regs)
+{
+	BUN i;
+	oid gid;
+	int t = b->T->type;
+	const void *nil = ATOMnilptr(t);
+	int (*atomcmp)(const void *, const void *) = BATatoms[t].atomCmp;
+	BUN (*atomhash)(const void *) = BATatoms[t].atomHash;
+	int width = t == TYPE_void ? (int) sizeof(oid) : Tsize(b);
+	BATiter bi;
+
+	if (t != ATOMstorage(t) &&
+	    ATOMnilptr(ATOMstorage(t)) == nil &&
+	    BATatoms[ATOMstorage(t)].atomCmp == atomcmp)
+		t = ATOMstorage(t);
+	switch (t) {
+	case TYPE_bte:
+		HLL_LOOP(bte, HLL_HASH_INT);
+		break;
+	case TYPE_sht:
+		HLL_LOOP(sht, HLL_HASH_INT);
+		break;
+	case TYPE_int:
+		HLL_LOOP(int, HLL_HASH_INT);
+		break;
+	case TYPE_lng:
+		HLL_LOOP(lng, HLL_HASH_INT);
+		break;
+	case TYPE_flt:
+		HLL_LOOP(flt, sketch_hash_dbl);
+		break;
+	case TYPE_dbl:
+		HLL_LOOP(dbl, sketch_hash_dbl);
+		break;
+	default:
+		bi = bat_iterator(b);
+		for (;;) {
+			const void *v;
+
+			if (ci) {
+				if (ci->next == oid_nil)
+					break;
+				i = CANDiternext(ci) - b->hseqbase;
+				if (i >= end)
+					break;
+			} else {
+				i = start++;
+				if (i == end)
+					break;
+			}
+			if (gids == NULL ||
+			    (gids[i] >= min && gids[i] <= max)) {
+				gid = gids ? gids[i] - min :
+					grouped ? (oid) i : 0;
+				v = BUNtail(bi, i + BUNfirst(b));
+				if (skip_nils && (*atomcmp)(v, nil) == 0)
+					continue;
+				hll_add(regs + (gid << p), p,
+					b->T->varsized ?
+					sketch_fmix((ulng) (*atomhash)(v)) :
+					sketch_hash_bytes(v, width));
+			}
+		}
+		break;
+	}
+}
+
+static void
+aggr_hll_piece(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	BUN start, end;
+	CandIter cis, *ci;
+	oid min, max;
+	BUN p = aggr_piece(a, lo, hi, &start, &end, &cis, &ci,
+			   &min, &max);
+	unsigned char *regs;
+
+	if (a->local) {
+		regs = a->part[p][0];
+		memset(regs, 0, a->ngrp << a->prec);
+	} else {
+		regs = (unsigned char *) a->res[0] + (lo << a->prec);
+	}
+	hll_update(a->b, 1, a->gids, min, max, start, end, ci,
+		   a->skip_nils, a->prec, regs);
+}
+
+static void
+aggr_hll_merge(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	unsigned char *regs = a->res[0];
+	BUN p, j;
+
+	for (p = 0; p < a->npieces; p++) {
+		const unsigned char *pregs = a->part[p][0];
+		for (j = lo << a->prec; j < hi << a->prec; j++)
+			if (regs[j] < pregs[j])
+				regs[j] = pregs[j];
+	}
+}
+
+/* calculate approximate group distinct counts with optional
+ * candidates list
+ *
+ * unless skip_nils is set, nil counts as a value; empty groups get
+ * count 0; the number of registers per group is the largest power of
+ * two up to 2^HLL_MAXP such that all registers together take no more
+ * than four bytes per input row (but at least 4MB), and at least
+ * 2^HLL_MINP */
+BAT *
+BATgroupcountdistinct_approx(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+			     int skip_nils, int abort_on_error)
+{
+	const oid *gids;
+	oid min, max;
+	BUN i, ngrp, lim;
+	unsigned char *regs;
+	wrd *cnts;
+	BAT *bn = NULL;
+	BUN start, end, cnt;
+	CandIter cis, *ci = NULL;
+	const char *err;
+	aggrpar_t a;
+	int p;
+
+	assert(tp == TYPE_wrd);
+	(void) tp;		/* compatibility (with other BATgroup* */
+	(void) abort_on_error;	/* functions) argument */
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cnt, &cis, &ci)) != NULL) {
+		GDKerror("BATgroupcountdistinct_approx: %s\n", err);
+		return NULL;
+	}
+
+	if (BATcount(b) == 0 || ngrp == 0) {
+		/* trivial: no values, so return bat aligned with g
+		 * with zero in the tail */
+		wrd zero = 0;
+		bn = BATconstant(TYPE_wrd, &zero, ngrp);
+		BATseqbase(bn, ngrp == 0 ? 0 : min);
+		return bn;
+	}
+
+	lim = cnt > ((BUN) 1 << 20) ? cnt * 4 : ((BUN) 1 << 22);
+	for (p = HLL_MAXP; p > HLL_MINP && ngrp > lim >> p; p--)
+		;
+	ALGODEBUG fprintf(stderr, "#BATgroupcountdistinct_approx: " BUNFMT
+			  " groups, 2^%d registers each\n", ngrp, p);
+
+	regs = GDKzalloc(ngrp << p);
+	if (regs == NULL) {
+		GDKerror("BATgroupcountdistinct_approx: cannot allocate "
+			 "enough memory.\n");
+		return NULL;
+	}
+	bn = BATnew(TYPE_void, TYPE_wrd, ngrp);
+	if (bn == NULL) {
+		GDKfree(regs);
+		return NULL;
+	}
+	cnts = (wrd *) Tloc(bn, BUNfirst(bn));
+
+	if (g == NULL || BATtdense(g))
+		gids = NULL;
+	else
+		gids = (const oid *) Tloc(g, BUNfirst(g));
+
+	if (g != NULL &&
+	    aggr_parallel_init(&a, b, gids, min, max, ngrp, start, end,
+			       ci, skip_nils, abort_on_error,
+			       b->ttype, TYPE_wrd, ngrp << p <= cnt,
+			       "BATgroupcountdistinct_approx")) {
+		int widths[3] = {1 << p, 0, 0};
+
+		a.prec = p;
+		a.res[0] = regs;
+		if (aggr_parallel_run(&a, widths, aggr_hll_piece,
+				      aggr_hll_merge,
+				      "BATgroupcountdistinct_approx") == BUN_NONE) {
+			GDKfree(regs);
+			BBPunfix(bn->batCacheid);
+			return NULL;
+		}
+	} else {
+		hll_update(b, g != NULL, gids, min, max, start, end,
+			   ci, skip_nils, p, regs);
+	}
+	for (i = 0; i < ngrp; i++)
+		cnts[i] = hll_estimate(regs + (i << p), p);
+	GDKfree(regs);
+
+	BATsetcount(bn, ngrp);
+	BATseqbase(bn, min);
+	bn->tkey = BATcount(bn) <= 1;
+	bn->tsorted = BATcount(bn) <= 1;
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->T->nil = 0;
+	bn->T->nonil = 1;
+	return bn;
+}
+
+/* Quantile sketch: a hierarchy of compactors (Manku, Rajagopalan and
+ * Lindsay, 1998, as in KLL by Karnin, Lang and Liberty, 2016, but
+ * with the same capacity on all levels).  Level h holds up to QSK_K
+ * values that each stand for 2^h input values.  When a level is
+ * full, it is sorted and every other value moves up a level, starting
+ * alternately with the first and the second; an odd one out stays.
+ * The total weight remains exactly the number of values.  Compacting
+ * level h moves the rank of any value by at most 2^h, and level h is
+ * compacted at most n / ((QSK_K - 1) * 2^h) times, so ranks are off
+ * by at most n * L / (QSK_K - 1) for L levels (L = log2(n / QSK_K) +
+ * 2), and usually much less since the alternating errors cancel.
+ * Groups with at most QSK_K values are exact.  A sketch is merged
+ * into another by adding each of its levels to the same level of the
+ * other. */
+
+#define QSK_K		256
+#define QSK_MAXLEV	48
+#define QSK_INIT	8	/* initial capacity of level 0 */
+
+typedef struct {
+	BUN n;			/* number of non-nil values */
+	BUN nnil;		/* number of nils */
+	ulng flip;		/* per level offset of the next compaction */
+	unsigned int cap;	/* number of values allocated */
+	unsigned short nlev;	/* number of levels */
+	unsigned short cnt[QSK_MAXLEV];	/* number of values per level */
+	/* followed by the values, level h starting at h * QSK_K */
+} qsketch;
+
+#define qsk_val(sk, h, j, w)	((char *) ((sk) + 1) + (((h) * QSK_K + (j)) * (w)))
+
+static qsketch *
+qsk_new(int width)
+{
+	qsketch *sk = GDKmalloc(sizeof(qsketch) + QSK_INIT * width);
+
+	if (sk != NULL) {
+		memset(sk, 0, sizeof(qsketch));
+		sk->cap = QSK_INIT;
+		sk->nlev = 1;
+	}
+	return sk;
+}
+
+/* make room for cap values */
+static gdk_return
+qsk_grow(qsketch **skp, unsigned int cap, int width)
+{
+	qsketch *sk = GDKrealloc(*skp, sizeof(qsketch) + cap * width);
+
+	if (sk == NULL)
+		return GDK_FAIL;
+	sk->cap = cap;
+	*skp = sk;
+	return GDK_SUCCEED;
+}
+
+static gdk_return qsk_insert(qsketch **skp, int h, const void *v,
+			     int width, int tpe);
+
+static gdk_return
+qsk_compact(qsketch **skp, int h, int width, int tpe)
+{
+	qsketch *sk = *skp;
+	unsigned int j, n2 = sk->cnt[h] / 2, off;
+	char *src;
+
+	assert(sk->cnt[h] >= 2);
+	if (h + 1 >= sk->nlev) {
+		assert(h + 2 <= QSK_MAXLEV);
+		if (qsk_grow(skp, (h + 2) * QSK_K, width) != GDK_SUCCEED)
+			return GDK_FAIL;
+		sk = *skp;
+		sk->nlev = h + 2;
+	}
+	if (sk->cnt[h + 1] + n2 > QSK_K) {
+		if (qsk_compact(skp, h + 1, width, tpe) != GDK_SUCCEED)
+			return GDK_FAIL;
+		sk = *skp;
+	}
+	src = qsk_val(sk, h, 0, width);
+	GDKqsort(src, NULL, NULL, sk->cnt[h], width, 0, tpe);
+	off = (unsigned int) (sk->flip >> h) & 1;
+	sk->flip ^= (ulng) 1 << h;
+	for (j = 0; j < n2; j++)
+		memcpy(qsk_val(sk, h + 1, sk->cnt[h + 1] + j, width),
+		       src + (2 * j + off) * width, width);
+	sk->cnt[h + 1] += n2;
+	if (sk->cnt[h] & 1) {
+		/* the largest is left over */
+		memcpy(src, src + (sk->cnt[h] - 1) * width, width);
+		sk->cnt[h] = 1;
+	} else {
+		sk->cnt[h] = 0;
+	}
+	return GDK_SUCCEED;
+}
+
+/* add a value of weight 2^h */
+static gdk_return
+qsk_insert(qsketch **skp, int h, const void *v, int width, int tpe)
+{
+	qsketch *sk = *skp;
+
+	if (h >= sk->nlev) {
+		assert(h < QSK_MAXLEV);
+		if (qsk_grow(skp, (h + 1) * QSK_K, width) != GDK_SUCCEED)
+			return GDK_FAIL;
+		sk = *skp;
+		sk->nlev = h + 1;
+	} else if (sk->cnt[h] == QSK_K) {
+		if (qsk_compact(skp, h, width, tpe) != GDK_SUCCEED)
+			return GDK_FAIL;
+		sk = *skp;
+	} else if (sk->nlev == 1 && sk->cnt[0] == sk->cap) {
+		if (qsk_grow(skp, sk->cap * 2, width) != GDK_SUCCEED)
+			return GDK_FAIL;
+		sk = *skp;
+	}
+	memcpy(qsk_val(sk, h, sk->cnt[h], width), v, width);
+	sk->cnt[h]++;
+	return GDK_SUCCEED;
+}
+
+/* add a value (or a nil) to the sketch in *skp, creating it if needed */
+static gdk_return
+qsk_add(qsketch **skp, const void *v, int isnil, int width, int tpe)
+{
+	if (*skp == NULL && (*skp = qsk_new(width)) == NULL)
+		return GDK_FAIL;
+	if (isnil) {
+		(*skp)->nnil++;
+		return GDK_SUCCEED;
+	}
+	(*skp)->n++;
+	return qsk_insert(skp, 0, v, width, tpe);
+}
+
+/* merge src into *dst; src is freed */
+static gdk_return
+qsk_merge(qsketch **dst, qsketch *src, int width, int tpe)
+{
+	int h;
+	unsigned int j;
+	gdk_return ret = GDK_SUCCEED;
+
+	if (*dst == NULL) {
+		*dst = src;
+		return GDK_SUCCEED;
+	}
+	(*dst)->n += src->n;
+	(*dst)->nnil += src->nnil;
+	for (h = 0; h < src->nlev && ret == GDK_SUCCEED; h++)
+		for (j = 0; j < src->cnt[h] && ret == GDK_SUCCEED; j++)
+			ret = qsk_insert(dst, h, qsk_val(src, h, j, width),
+					 width, tpe);
+	GDKfree(src);
+	return ret;
+}
+
+/* Find the value at position (BUN) ((cnt - 1) * quantile) in sorted
+ * order, nils first, as BATgroupquantile does; vals and wgts are
+ * scratch space for QSK_MAXLEV * QSK_K values and weights.  Returns
+ * NULL for nil. */
+static const void *
+qsk_quantile(qsketch *sk, dbl quantile, int skip_nils, int width, int tpe,
+	     char *vals, BUN *wgts)
+{
+	BUN nnil = skip_nils ? 0 : sk->nnil, k, tot, w;
+	unsigned int j, m;
+	int h;
+
+	if (sk->n + nnil == 0)
+		return NULL;
+	k = (BUN) ((sk->n + nnil - 1) * quantile);
+	if (k < nnil)
+		return NULL;
+	k -= nnil;
+	if (sk->nlev == 1) {
+		/* exact */
+		GDKqsort(qsk_val(sk, 0, 0, width), NULL, NULL, sk->cnt[0],
+			 width, 0, tpe);
+		return qsk_val(sk, 0, k, width);
+	}
+	for (h = 0, m = 0; h < sk->nlev; h++) {
+		memcpy(vals + m * width, qsk_val(sk, h, 0, width),
+		       sk->cnt[h] * width);
+		for (j = 0; j < sk->cnt[h]; j++)
+			wgts[m++] = (BUN) 1 << h;
+	}
+	GDKqsort(vals, wgts, NULL, m, width, sizeof(BUN), tpe);
+	for (j = 0, tot = 0; j < m - 1; j++) {
+		w = wgts[j];
+		if (tot + w > k)
+			break;
+		tot += w;
+	}
+	return vals + j * width;
+}
+
+/* add the values of the given rows to the sketches of their groups
+ * (with gids NULL, row i is group i, or if not grouped, all rows are
+ * group 0) */
+static gdk_return
+qsk_update(BAT *b, int grouped, const oid *gids, oid min, oid max,
+	   BUN start, BUN end, CandIter *ci,
+	   qsketch **sks)
+{
+	BUN i;
+	oid gid;
+	int tpe = b->ttype;
+	int width = Tsize(b);
+	const void *nil = ATOMnilptr(tpe);
+	int (*atomcmp)(const void *, const void *) = BATatoms[tpe].atomCmp;
+	int nonil = b->T->nonil;
+	BATiter bi = bat_iterator(b);
+
+	for (;;) {
+		const void *v;
+
+		if (ci) {
+			if (ci->next == oid_nil)
+				break;
+			i = CANDiternext(ci) - b->hseqbase;
+			if (i >= end)
+				break;
+		} else {
+			i = start++;
+			if (i == end)
+				break;
+		}
+		if (gids == NULL || (gids[i] >= min && gids[i] <= max)) {
+			gid = gids ? gids[i] - min : grouped ? (oid) i : 0;
+			v = BUNtail(bi, i + BUNfirst(b));
+			if (qsk_add(&sks[gid], v,
+				    !nonil && (*atomcmp)(v, nil) == 0,
+				    width, tpe) != GDK_SUCCEED)
+				return GDK_FAIL;
+		}
+	}
+	return GDK_SUCCEED;
+}
+
+static void
+qsk_free(qsketch **sks, BUN n)
+{
+	BUN i;
+
+	for (i = 0; i < n; i++) {
+		if (sks[i]) {
+			GDKfree(sks[i]);
+			sks[i] = NULL;
+		}
+	}
+}
+
+static void
+aggr_qsk_piece(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	BUN start, end, ngrp;
+	CandIter cis, *ci;
+	oid min, max;
+	BUN p = aggr_piece(a, lo, hi, &start, &end, &cis, &ci,
+			   &min, &max);
+	qsketch **sks;
+
+	if (a->local) {
+		ngrp = a->ngrp;
+		sks = a->part[p][0];
+		memset(sks, 0, ngrp * sizeof(qsketch *));
+	} else {
+		ngrp = hi - lo;
+		sks = (qsketch **) a->res[0] + lo;
+	}
+	if (qsk_update(a->b, 1, a->gids, min, max, start, end,
+		       ci, sks) != GDK_SUCCEED) {
+		qsk_free(sks, ngrp);
+		a->err[p] = AGGR_ERR_MALLOC;
+	}
+}
+
+/* also run after a failure (mergeall) to free the partial sketches */
+static void
+aggr_qsk_merge(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	qsketch **sks = a->res[0];
+	int width = ATOMsize(a->b->ttype), tpe = a->b->ttype;
+	int failed = a->failed;
+	BUN p, g;
+
+	for (g = lo; g < hi; g++) {
+		for (p = 0; p < a->npieces; p++) {
+			qsketch **psks = a->part[p][0];
+			qsketch *sk = psks[g];
+
+			if (sk == NULL)
+				continue;
+			psks[g] = NULL;
+			if (failed)
+				GDKfree(sk);
+			else if (qsk_merge(&sks[g], sk, width, tpe) != GDK_SUCCEED)
+				failed = AGGR_ERR_MALLOC;
+		}
+	}
+	if (failed && !a->failed)
+		a->err[lo / a->mgrain] = failed;
+}
+
+/* calculate approximate group quantiles with optional candidates list
+ *
+ * the result is the value BATgroupquantile would give for a rank at
+ * most a bounded distance away (see qsketch above), and exactly that
+ * for groups with at most QSK_K values */
+BAT *
+BATgroupquantile_approx(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+			dbl quantile, int skip_nils, int abort_on_error)
+{
+	const oid *gids;
+	oid min, max;
+	BUN i, ngrp;
+	BUN nils = 0;
+	qsketch **sks;
+	BAT *bn = NULL;
+	BUN start, end, cnt;
+	CandIter cis, *ci = NULL;
+	const char *err;
+	aggrpar_t a;
+	int width;
+	const void *nil, *v;
+	char *vals = NULL;
+	BUN *wgts = NULL;
+
+	(void) abort_on_error;
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cnt, &cis, &ci)) != NULL) {
+		GDKerror("BATgroupquantile_approx: %s\n", err);
+		return NULL;
+	}
+	assert(tp == b->ttype);
+	if (!ATOMlinear(b->ttype) || b->T->varsized ||
+	    b->ttype == TYPE_void) {
+		GDKerror("BATgroupquantile_approx: cannot determine quantile "
+			 "on type %s\n", ATOMname(b->ttype));
+		return NULL;
+	}
+	if (!(quantile >= 0 && quantile <= 1)) {
+		GDKerror("BATgroupquantile_approx: cannot determine quantile "
+			 "for p=%f (p has to be in [0,1])\n", quantile);
+		return NULL;
+	}
+
+	if (BATcount(b) == 0 || ngrp == 0) {
+		/* trivial: no values, so return bat aligned with e with
+		 * nil in the tail */
+		bn = BATconstant(tp, ATOMnilptr(tp), ngrp);
+		BATseqbase(bn, ngrp == 0 ? 0 : min);
+		return bn;
+	}
+
+	width = Tsize(b);
+	nil = ATOMnilptr(tp);
+	sks = GDKzalloc(ngrp * sizeof(qsketch *));
+	vals = GDKmalloc(QSK_MAXLEV * QSK_K * width);
+	wgts = GDKmalloc(QSK_MAXLEV * QSK_K * sizeof(BUN));
+	bn = BATnew(TYPE_void, tp, ngrp);
+	if (sks == NULL || vals == NULL || wgts == NULL || bn == NULL)
+		goto alloc_fail;
+
+	if (g == NULL || BATtdense(g))
+		gids = NULL;
+	else
+		gids = (const oid *) Tloc(g, BUNfirst(g));
+
+	if (g != NULL &&
+	    aggr_parallel_init(&a, b, gids, min, max, ngrp, start, end,
+			       ci, skip_nils, abort_on_error,
+			       b->ttype, tp, 1, "BATgroupquantile_approx")) {
+		int widths[3] = {sizeof(qsketch *), 0, 0};
+
+		a.res[0] = sks;
+		a.mergeall = 1;
+		if (aggr_parallel_run(&a, widths, aggr_qsk_piece,
+				      aggr_qsk_merge,
+				      "BATgroupquantile_approx") == BUN_NONE) {
+			qsk_free(sks, ngrp);
+			GDKfree(sks);
+			GDKfree(vals);
+			GDKfree(wgts);
+			BBPunfix(bn->batCacheid);
+			return NULL;
+		}
+	} else if (qsk_update(b, g != NULL, gids, min, max, start, end,
+			      ci, sks) != GDK_SUCCEED) {
+		goto alloc_fail;
+	}
+
+	for (i = 0; i < ngrp; i++) {
+		v = sks[i] ? qsk_quantile(sks[i], quantile, skip_nils, width,
+					  tp, vals, wgts) : NULL;
+		if (v == NULL) {
+			v = nil;
+			nils++;
+		}
+		memcpy(Tloc(bn, BUNfirst(bn) + i), v, width);
+	}
+	qsk_free(sks, ngrp);
+	GDKfree(sks);
+	GDKfree(vals);
+	GDKfree(wgts);
+
+	BATsetcount(bn, ngrp);
+	BATseqbase(bn, min);
+	bn->tkey = BATcount(bn) <= 1;
+	bn->tsorted = BATcount(bn) <= 1;
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->T->nil = nils != 0;
+	bn->T->nonil = nils == 0;
+	return bn;
+
+  alloc_fail:
+	if (sks) {
+		qsk_free(sks, ngrp);
+		GDKfree(sks);
+	}
+	GDKfree(vals);
+	GDKfree(wgts);
+	if (bn)
+		BBPunfix(bn->batCacheid);
+	GDKerror("BATgroupquantile_approx: cannot allocate enough memory.\n");
+	return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+/* standard deviation (both biased and non-biased) */
+
+/* The variance is computed from moments: the number of values, their
+ * mean and the sum of the squared differences from the mean (M2),
+ * which are updated one value at a time (Welford).  Moments of two
+ * sets of values can be merged into the moments of their union
+ * (Chan et al.), so big inputs are cut into pieces of which the
+ * moments are computed by several threads and merged afterwards, in
+ * input order.  The merged results may differ from those of a single
+ * pass in the last bits.  Since the update does not need the earlier
+ * values, the moments of a column can also be kept up to date as it
+ * grows (BATcalcmoments). */
+
+void
+MOMENTSmerge(moments_t *m, const moments_t *o)
+{
+	BUN n;
+	dbl delta;
+
+	if (o->n == 0)
+		return;
+	if (m->n == 0) {
+		*m = *o;
+		return;
+	}
+	n = m->n + o->n;
+	delta = o->mean - m->mean;
+	m->mean += delta * o->n / n;
+	m->m2 += o->m2 + delta * delta * ((dbl) m->n * o->n / n);
+	m->n = n;
+}
+
+dbl
+MOMENTSvariance(const moments_t *m, int issample)
+{
+	assert(issample == 0 || issample == 1);
+	if (m->n <= (BUN) issample)
+		return dbl_nil;
+	return m->m2 / (m->n - issample);
+}
+
+#define AGGR_STDEV_SINGLE(TYPE)						\
+	do {								\
+		TYPE x;							\
+		for (i = start; i < end; i++) {				\
+			x = ((const TYPE *) values)[i];			\
+			if (x == TYPE##_nil)				\
+				continue;				\
+			n++;						\
 			delta = (dbl) x - mean;				\
 			mean += delta / n;				\
 			m2 += delta * ((dbl) x - mean);			\
 		}							\
 	} while (0)
 
-static dbl
-calcvariance(dbl *avgp, const void *values, BUN cnt, int tp, int issample)
+/* add the non-nil values in values[start..end) to the moments */
+static int
+moments_range(moments_t *m, const void *values, BUN start, BUN end, int tp)
 {
-	BUN n = 0, i;
-	dbl mean = 0;
-	dbl m2 = 0;
+	BUN n = m->n, i;
+	dbl mean = m->mean;
+	dbl m2 = m->m2;
 	dbl delta;
 
-	assert(issample == 0 || issample == 1);
-
 	switch (ATOMstorage(tp)) {
 	case TYPE_bte:
 		AGGR_STDEV_SINGLE(bte);
@@ -2202,16 +5496,99 @@ calcvariance(dbl *avgp, const void *values, BUN cnt, int tp, int issample)
 		AGGR_STDEV_SINGLE(dbl);
 		break;
 	default:
-		return dbl_nil;
+		return 0;
 	}
-	if (n <= (BUN) issample) {
+	m->n = n;
+	m->mean = mean;
+	m->m2 = m2;
+	return 1;
+}
+
+typedef struct {
+	const void *values;
+	int tp;
+	BUN base, grain;
+	moments_t m[AGGR_MAXPIECES];
+} momentspar_t;
+
+static void
+moments_piece(BUN lo, BUN hi, void *arg)
+{
+	momentspar_t *a = arg;
+
+	moments_range(&a->m[(lo - a->base) / a->grain], a->values, lo, hi,
+		      a->tp);
+}
+
+/* add the values in values[start..end) to the moments, in parallel
+ * if there are many; returns 0 for an unsupported type */
+static int
+calcmoments(moments_t *m, const void *values, BUN start, BUN end, int tp)
+{
+	int nthreads = GDKnr_threads;
+	momentspar_t a;
+	BUN p, np;
+
+	if (!aggr_fixedtype(ATOMstorage(tp)))
+		return 0;
+	if (nthreads <= 1 || end - start < AGGR_PARALLEL_MINSIZE)
+		return moments_range(m, values, start, end, tp);
+	if (nthreads > AGGR_MAXPIECES)
+		nthreads = AGGR_MAXPIECES;
+	memset(&a, 0, sizeof(a));
+	a.values = values;
+	a.tp = tp;
+	a.base = start;
+	a.grain = (end - start + nthreads - 1) / nthreads;
+	np = (end - start + a.grain - 1) / a.grain;
+	ALGODEBUG fprintf(stderr, "#calcmoments: parallel, " BUNFMT
+			  " pieces\n", np);
+	MRparallel_for(start, end, a.grain, moments_piece, &a);
+	for (p = 0; p < np; p++)
+		MOMENTSmerge(m, &a.m[p]);
+	return 1;
+}
+
+static dbl
+calcvariance(dbl *avgp, const void *values, BUN cnt, int tp, int issample)
+{
+	moments_t m;
+
+	assert(issample == 0 || issample == 1);
+
+	memset(&m, 0, sizeof(m));
+	if (!calcmoments(&m, values, 0, cnt, tp))
+		return dbl_nil;
+	if (m.n <= (BUN) issample) {
 		if (avgp)
 			*avgp = dbl_nil;
 		return dbl_nil;
 	}
 	if (avgp)
-		*avgp = mean;
-	return m2 / (n - issample);
+		*avgp = m.mean;
+	return MOMENTSvariance(&m, issample);
+}
+
+/* Add the non-nil values of b from position start onwards to the
+ * moments in *m.  To keep the variance of a growing column, start
+ * with zeroed moments and position 0, and after appending continue
+ * from the count of the previous call; the result equals that of a
+ * single pass over the whole column up to rounding, since big
+ * appended ranges are done in parallel pieces that are merged. */
+gdk_return
+BATcalcmoments(moments_t *m, BAT *b, BUN start)
+{
+	if (start > BATcount(b)) {
+		GDKerror("BATcalcmoments: start beyond end of b.\n");
+		return GDK_FAIL;
+	}
+	if (!calcmoments(m, Tloc(b, BUNfirst(b)), start, BATcount(b),
+			 b->ttype)) {
+		GDKerror("BATcalcmoments: type (%s) not supported.\n",
+			 ATOMname(b->ttype));
+		return GDK_FAIL;
+	}
+	return GDK_SUCCEED;
 }
 
 dbl
@@ -2244,14 +5621,16 @@ BATcalcvariance_sample(dbl *avgp, BAT *b)
 			    BATcount(b), b->ttype, 1);
 }
 
+/* the moments of a group become n == BUN_NONE when it has a nil that
+ * is not skipped */
 #define AGGR_STDEV(TYPE)						\
 	do {								\
 		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
 		for (;;) {						\
-			if (cand) {					\
-				if (cand == candend)			\
+			if (ci) {					\
+				if (ci->next == oid_nil)		\
 					break;				\
-				i = *cand++ - b->hseqbase;			\
+				i = CANDiternext(ci) - b->hseqbase;	\
 				if (i >= end)				\
 					break;				\
 			} else {					\
@@ -2267,31 +5646,81 @@ BATcalcvariance_sample(dbl *avgp, BAT *b)
 					gid = (oid) i;			\
 				if (vals[i] == TYPE##_nil) {		\
 					if (!skip_nils)			\
-						cnts[gid] = BUN_NONE;	\
-				} else if (cnts[gid] != BUN_NONE) {	\
-					cnts[gid]++;			\
-					delta[gid] = (dbl) vals[i] - mean[gid]; \
-					mean[gid] += delta[gid] / cnts[gid]; \
-					m2[gid] += delta[gid] * ((dbl) vals[i] - mean[gid]); \
+						moms[gid].n = BUN_NONE;	\
+				} else if (moms[gid].n != BUN_NONE) {	\
+					moms[gid].n++;			\
+					delta = (dbl) vals[i] - moms[gid].mean; \
+					moms[gid].mean += delta / moms[gid].n; \
+					moms[gid].m2 += delta * ((dbl) vals[i] - moms[gid].mean); \
 				}					\
 			}						\
 		}							\
-		for (i = 0; i < ngrp; i++) {				\
-			if (cnts[i] == 0 || cnts[i] == BUN_NONE) {	\
-				dbls[i] = dbl_nil;			\
-				mean[i] = dbl_nil;			\
-				nils++;					\
-			} else if (cnts[i] == 1) {			\
-				dbls[i] = issample ? dbl_nil : 0;	\
-				nils2++;				\
-			} else if (variance) {				\
-				dbls[i] = m2[i] / (cnts[i] - issample);	\
-			} else {					\
-				dbls[i] = sqrt(m2[i] / (cnts[i] - issample)); \
-			}						\
-		}							\
 	} while (0)
 
+/* moments per group of the rows of a piece */
+static void
+aggr_stdev_piece(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	BAT *b = a->b;
+	const oid *gids = a->gids;
+	CandIter cis, *ci;
+	BUN start, end, i;
+	oid min, max, gid;
+	int skip_nils = a->skip_nils;
+	BUN p = aggr_piece(a, lo, hi, &start, &end, &cis, &ci,
+			   &min, &max);
+	moments_t *moms;
+	dbl delta;
+
+	if (a->local) {
+		moms = a->part[p][0];
+		memset(moms, 0, a->ngrp * sizeof(moments_t));
+	} else {
+		moms = (moments_t *) a->res[0] + lo;
+	}
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_bte:
+		AGGR_STDEV(bte);
+		break;
+	case TYPE_sht:
+		AGGR_STDEV(sht);
+		break;
+	case TYPE_int:
+		AGGR_STDEV(int);
+		break;
+	case TYPE_lng:
+		AGGR_STDEV(lng);
+		break;
+	case TYPE_flt:
+		AGGR_STDEV(flt);
+		break;
+	case TYPE_dbl:
+		AGGR_STDEV(dbl);
+		break;
+	default:
+		assert(0);
+	}
+}
+
+static void
+aggr_stdev_merge(BUN lo, BUN hi, void *arg)
+{
+	aggrpar_t *a = arg;
+	moments_t *moms = a->res[0];
+	BUN p, g;
+
+	for (p = 0; p < a->npieces; p++) {
+		const moments_t *pmoms = a->part[p][0];
+		for (g = lo; g < hi; g++) {
+			if (pmoms[g].n == BUN_NONE)
+				moms[g].n = BUN_NONE;
+			else if (moms[g].n != BUN_NONE)
+				MOMENTSmerge(&moms[g], &pmoms[g]);
+		}
+	}
+}
+
 /* Calculate group standard deviation (population (i.e. biased) or
  * sample (i.e. non-biased)) with optional candidates list.
  *
@@ -2309,19 +5738,20 @@ dogroupstdev(BAT **avgb, BAT *b, BAT *g, BAT *e, BAT *s, int tp,
 	oid min, max;
 	BUN i, ngrp;
 	BUN nils = 0, nils2 = 0;
-	BUN *cnts = NULL;
-	dbl *dbls, *mean, *delta, *m2;
+	moments_t *moms = NULL;
+	dbl *dbls, *mean = NULL, delta;
 	BAT *bn = NULL;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	const char *err;
+	aggrpar_t a;
 
 	assert(tp == TYPE_dbl);
 	(void) tp;		/* compatibility (with other BATgroup*
 				 * functions) argument */
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
+				    &cnt, &cis, &ci)) != NULL) {
 		GDKerror("%s: %s\n", func, err);
 		return NULL;
 	}
@@ -2349,19 +5779,19 @@ dogroupstdev(BAT **avgb, BAT *b, BAT *g, BAT *e, BAT *s, int tp,
 		return bn;
 	}
 
-	delta = GDKmalloc(ngrp * sizeof(dbl));
-	m2 = GDKmalloc(ngrp * sizeof(dbl));
-	cnts = GDKzalloc(ngrp * sizeof(BUN));
+	if (!aggr_fixedtype(ATOMstorage(b->ttype))) {
+		GDKerror("%s: type (%s) not supported.\n",
+			 func, ATOMname(b->ttype));
+		return NULL;
+	}
+
+	moms = GDKzalloc(ngrp * sizeof(moments_t));
 	if (avgb) {
-		if ((*avgb = BATnew(TYPE_void, TYPE_dbl, ngrp)) == NULL) {
-			mean = NULL;
+		if ((*avgb = BATnew(TYPE_void, TYPE_dbl, ngrp)) == NULL)
 			goto alloc_fail;
-		}
 		mean = (dbl *) Tloc(*avgb, BUNfirst(*avgb));
-	} else {
-		mean = GDKmalloc(ngrp * sizeof(dbl));
 	}
-	if (mean == NULL || delta == NULL || m2 == NULL || cnts == NULL)
+	if (moms == NULL)
 		goto alloc_fail;
 
 	bn = BATnew(TYPE_void, TYPE_dbl, ngrp);
@@ -2369,48 +5799,66 @@ dogroupstdev(BAT **avgb, BAT *b, BAT *g, BAT *e, BAT *s, int tp,
 		goto alloc_fail;
 	dbls = (dbl *) Tloc(bn, BUNfirst(bn));
 
-	for (i = 0; i < ngrp; i++) {
-		mean[i] = 0;
-		delta[i] = 0;
-		m2[i] = 0;
-	}
-
 	if (BATtdense(g))
 		gids = NULL;
 	else
 		gids = (const oid *) Tloc(g, BUNfirst(g) + start);
 
-	switch (ATOMstorage(b->ttype)) {
-	case TYPE_bte:
-		AGGR_STDEV(bte);
-		break;
-	case TYPE_sht:
-		AGGR_STDEV(sht);
-		break;
-	case TYPE_int:
-		AGGR_STDEV(int);
-		break;
-	case TYPE_lng:
-		AGGR_STDEV(lng);
-		break;
-	case TYPE_flt:
-		AGGR_STDEV(flt);
-		break;
-	case TYPE_dbl:
-		AGGR_STDEV(dbl);
-		break;
-	default:
-		if (avgb)
-			BBPreclaim(*avgb);
-		else
-			GDKfree(mean);
-		GDKfree(delta);
-		GDKfree(m2);
-		GDKfree(cnts);
-		BBPunfix(bn->batCacheid);
-		GDKerror("%s: type (%s) not supported.\n",
-			 func, ATOMname(b->ttype));
-		return NULL;
+	if (aggr_parallel_init(&a, b, gids, min, max, ngrp, start, end,
+			       ci, skip_nils, 0,
+			       b->ttype, TYPE_dbl, 1, func)) {
+		/* partial moments */
+		int widths[3] = {sizeof(moments_t), 0, 0};
+
+		a.res[0] = moms;
+		if (aggr_parallel_run(&a, widths, aggr_stdev_piece,
+				      aggr_stdev_merge, func) == BUN_NONE) {
+			if (avgb)
+				BBPreclaim(*avgb);
+			GDKfree(moms);
+			BBPunfix(bn->batCacheid);
+			return NULL;
+		}
+	} else {
+		switch (ATOMstorage(b->ttype)) {
+		case TYPE_bte:
+			AGGR_STDEV(bte);
+			break;
+		case TYPE_sht:
+			AGGR_STDEV(sht);
+			break;
+		case TYPE_int:
+			AGGR_STDEV(int);
+			break;
+		case TYPE_lng:
+			AGGR_STDEV(lng);
+			break;
+		case TYPE_flt:
+			AGGR_STDEV(flt);
+			break;
+		case TYPE_dbl:
+			AGGR_STDEV(dbl);
+			break;
+		}
+	}
+	for (i = 0; i < ngrp; i++) {
+		if (moms[i].n == 0 || moms[i].n == BUN_NONE) {
+			dbls[i] = dbl_nil;
+			if (mean)
+				mean[i] = dbl_nil;
+			nils++;
+			continue;
+		}
+		if (mean)
+			mean[i] = moms[i].mean;
+		if (moms[i].n == 1) {
+			dbls[i] = issample ? dbl_nil : 0;
+			nils2++;
+		} else if (variance) {
+			dbls[i] = MOMENTSvariance(&moms[i], issample);
+		} else {
+			dbls[i] = sqrt(MOMENTSvariance(&moms[i], issample));
+		}
 	}
 	if (avgb) {
 		BATsetcount(*avgb, ngrp);
@@ -2420,13 +5868,9 @@ dogroupstdev(BAT **avgb, BAT *b, BAT *g, BAT *e, BAT *s, int tp,
 		(*avgb)->trevsorted = ngrp <= 1;
 		(*avgb)->T->nil = nils != 0;
 		(*avgb)->T->nonil = nils == 0;
-	} else {
-		GDKfree(mean);
 	}
 	nils += nils2;
-	GDKfree(delta);
-	GDKfree(m2);
-	GDKfree(cnts);
+	GDKfree(moms);
 	BATsetcount(bn, ngrp);
 	BATseqbase(bn, min);
 	bn->tkey = ngrp <= 1;
@@ -2441,10 +5885,7 @@ dogroupstdev(BAT **avgb, BAT *b, BAT *g, BAT *e, BAT *s, int tp,
 		BBPreclaim(*avgb);
 	if (bn)
 		BBPreclaim(bn);
-	GDKfree(mean);
-	GDKfree(delta);
-	GDKfree(m2);
-	GDKfree(cnts);
+	GDKfree(moms);
 	GDKerror("%s: cannot allocate enough memory.\n", func);
 	return NULL;
 }
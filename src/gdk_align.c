@@ -242,6 +242,10 @@ VIEWhcreate(BAT *h)
 		bn->H->heap.parentid = hp;
 	if (hp && isVIEW(h))
 		bn->H->hash = NULL;
+	bn->H->zonemap = NULL;
+	bn->H->stats = NULL;
+	bn->H->cracker = NULL;
+	bn->H->cand = NULL;
 	BATinit_idents(bn);
 	/* The b->P structure cannot be shared and must be copied
 	 * individually. */
@@ -349,6 +353,16 @@ VIEWcreate_(BAT *h, BAT *t, int slice_view)
 		bn->T->hash = NULL;
 	else
 		bn->T->hash = t->T->hash;
+	/* zone maps, statistics, cracker indices and compressed
+	 * candidates are never shared */
+	bn->H->zonemap = NULL;
+	bn->T->zonemap = NULL;
+	bn->H->stats = NULL;
+	bn->T->stats = NULL;
+	bn->H->cracker = NULL;
+	bn->T->cracker = NULL;
+	bn->H->cand = NULL;
+	bn->T->cand = NULL;
 	BBPcacheit(bs, 1);	/* enter in BBP */
 	/* View of VIEW combine, ie we need to fix the head of the mirror */
 	if (vc) {
@@ -387,6 +401,10 @@ VIEWhead(BAT *b)
 	bn->T->width = 0;
 	bn->T->heap.parentid = 0;
 	bn->T->hash = NULL;
+	bn->T->zonemap = NULL;
+	bn->T->stats = NULL;
+	bn->T->cracker = NULL;
+	bn->T->cand = NULL;
 	bn->T->heap.maxsize = bn->T->heap.size = bn->T->heap.free = 0;
 	bn->T->heap.base = NULL;
 	BATseqbase(bm, oid_nil);
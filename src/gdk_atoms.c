@@ -73,6 +73,14 @@ dblCmp(const dbl *l, const dbl *r)
 	return simple_CMP(l, r, dbl);
 }
 
+#ifdef HAVE_HGE
+static int
+hgeCmp(const hge *l, const hge *r)
+{
+	return simple_CMP(l, r, hge);
+}
+#endif
+
 /*
  * @- inline hash routines
  * Return some positive integer derived from one atom value.
@@ -101,6 +109,15 @@ lngHash(const lng *v)
 	return (BUN) mix_int(((const unsigned int *) v)[0] ^ ((const unsigned int *) v)[1]);
 }
 
+#ifdef HAVE_HGE
+static BUN
+hgeHash(const hge *v)
+{
+	return (BUN) mix_int(((const unsigned int *) v)[0] ^ ((const unsigned int *) v)[1] ^
+			     ((const unsigned int *) v)[2] ^ ((const unsigned int *) v)[3]);
+}
+#endif
+
 /*
  * @+ Standard Atoms
  */
@@ -122,6 +139,14 @@ lngConvert(lng *s)
 	*s = long_long_SWAP(*s);
 }
 
+#ifdef HAVE_HGE
+static inline void
+hgeConvert(hge *s)
+{
+	*s = huge_int_SWAP(*s);
+}
+#endif
+
 static inline int
 batFix(const bat *b)
 {
@@ -338,6 +363,9 @@ const int int_nil = GDK_int_min;
 const flt flt_nil = GDK_flt_min;
 const dbl dbl_nil = GDK_dbl_min;
 const lng lng_nil = GDK_lng_min;
+#ifdef HAVE_HGE
+const hge hge_nil = GDK_hge_min;
+#endif
 const oid oid_nil = (oid) 1 << (sizeof(oid) * 8 - 1);
 const wrd wrd_nil = GDK_wrd_min;
 const char str_nil[2] = { '\200', 0 };
@@ -393,6 +421,10 @@ ATOMcmp(int t, const void *l, const void *r)
 		return simple_CMP(l, r, flt);
 	case TYPE_lng:
 		return simple_CMP(l, r, lng);
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		return simple_CMP(l, r, hge);
+#endif
 	case TYPE_dbl:
 		return simple_CMP(l, r, dbl);
 	default:
@@ -813,6 +845,90 @@ atomtostr(lng, LLFMT, )
 
 atom_io(lng, Lng, lng)
 
+#ifdef HAVE_HGE
+/* numFromStr works in lng, so hge has its own parser */
+int
+hgeFromStr(const char *src, int *len, hge **dst)
+{
+	const char *p = src;
+	hge base = 0;
+	const hge maxdiv10 = GDK_hge_max / 10;
+	const int maxmod10 = (int) (GDK_hge_max % 10);
+	int sign = 1;
+
+	atommem(hge, sizeof(hge));
+	while (GDKisspace(*p))
+		p++;
+	**dst = hge_nil;
+	if (p[0] == 'n' && p[1] == 'i' && p[2] == 'l') {
+		p += 3;
+		return (int) (p - src);
+	}
+	if (*p == '-') {
+		sign = -1;
+		p++;
+	} else if (*p == '+') {
+		p++;
+	}
+	if (!num10(*p)) {
+		/* not a number */
+		return 0;
+	}
+	do {
+		if (base > maxdiv10 ||
+		    (base == maxdiv10 && base10(*p) > maxmod10)) {
+			/* overflow */
+			return 0;
+		}
+		base = 10 * base + base10(*p);
+		p++;
+	} while (num10(*p));
+	**dst = sign * base;
+	if (p[0] == 'L' && p[1] == 'L')
+		p += 2;
+	return (int) (p - src);
+}
+
+/* there is no printf format for hge */
+int
+hgeToStr(char **dst, int *len, const hge *src)
+{
+	char buf[hgeStrlen], *p = buf + sizeof(buf);
+	hge v = *src;
+	int l;
+
+	atommem(char, hgeStrlen);
+	if (v == hge_nil) {
+		strncpy(*dst, "nil", *len);
+		return 3;
+	}
+	*--p = 0;
+	do {
+		int d = (int) (v % 10);
+		*--p = (char) ('0' + (d < 0 ? -d : d));
+		v /= 10;
+	} while (v != 0);
+	if (*src < 0)
+		*--p = '-';
+	l = (int) (buf + sizeof(buf) - 1 - p);
+	memcpy(*dst, p, l + 1);
+	return l;
+}
+
+static hge *
+hgeRead(hge *a, stream *s, size_t cnt)
+{
+	mnstr_readHgeArray(s, a, cnt);
+	return mnstr_errnr(s) ? NULL : a;
+}
+
+static int
+hgeWrite(const hge *a, stream *s, size_t cnt)
+{
+	return mnstr_writeHgeArray(s, a, cnt) ? GDK_SUCCEED : GDK_FAIL;
+}
+#endif
+
 int
 ptrFromStr(const char *src, int *len, ptr **dst)
 {
@@ -1908,6 +2024,17 @@ atomDesc BATatoms[MAXATOMS] = {
 	 0, 0,
 	 0, 0,
 	 0, 0},
+#ifdef HAVE_HGE
+	{"hge", TYPE_hge, 1, sizeof(hge), sizeof(hge), 0, 0, (ptr) &hge_nil,
+	 (int (*)(const char *, int *, ptr *)) hgeFromStr, (int (*)(str *, int *, const void *)) hgeToStr,
+	 (void *(*)(void *, stream *, size_t)) hgeRead, (int (*)(const void *, stream *, size_t)) hgeWrite,
+	 (int (*)(const void *, const void *)) hgeCmp,
+	 (BUN (*)(const void *)) hgeHash, (void (*)(ptr, int)) hgeConvert,
+	 0, 0,
+	 0, 0,
+	 0, 0,
+	 0, 0},
+#endif
 	{"str", TYPE_str, 1, sizeof(var_t), sizeof(var_t), 0, 1, (ptr) str_nil,
 	 (int (*)(const char *, int *, ptr *)) strFromStr, (int (*)(str *, int *, const void *)) strToStr,
 	 (void *(*)(void *, stream *, size_t)) strRead, (int (*)(const void *, stream *, size_t)) strWrite,
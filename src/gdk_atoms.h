@@ -74,6 +74,9 @@
 #define ptrStrlen	48
 #endif
 #define lngStrlen	48
+#ifdef HAVE_HGE
+#define hgeStrlen	96
+#endif
 #define fltStrlen	48
 #define dblStrlen	96
 
@@ -86,6 +89,10 @@
 
 gdk_export int lngFromStr(const char *src, int *len, lng **dst);
 gdk_export int lngToStr(str *dst, int *len, const lng *src);
+#ifdef HAVE_HGE
+gdk_export int hgeFromStr(const char *src, int *len, hge **dst);
+gdk_export int hgeToStr(str *dst, int *len, const hge *src);
+#endif
 gdk_export int intFromStr(const char *src, int *len, int **dst);
 gdk_export int intToStr(str *dst, int *len, const int *src);
 gdk_export int batFromStr(const char *src, int *len, bat **dst);
@@ -132,6 +139,10 @@ gdk_export int escapedStr(char *dst, const char *src, int dstlen);
 #define GDK_flt_min (-GDK_flt_max)
 #define GDK_lng_max ((lng) LLONG_MAX)
 #define GDK_lng_min ((lng) LLONG_MIN)
+#ifdef HAVE_HGE
+#define GDK_hge_max ((((hge) 1) << 126) - 1 + (((hge) 1) << 126))
+#define GDK_hge_min (-GDK_hge_max - 1)
+#endif
 #define GDK_dbl_max ((dbl) DBL_MAX)
 #define GDK_dbl_min (-GDK_dbl_max)
 /* GDK_oid_max see below */
@@ -143,6 +154,9 @@ gdk_export const int int_nil;
 gdk_export const flt flt_nil;
 gdk_export const dbl dbl_nil;
 gdk_export const lng lng_nil;
+#ifdef HAVE_HGE
+gdk_export const hge hge_nil;
+#endif
 gdk_export const oid oid_nil;
 gdk_export const wrd wrd_nil;
 gdk_export const char str_nil[2];
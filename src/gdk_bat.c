@@ -549,6 +549,10 @@ BATclear(BAT *b, int force)
 	if (b->T->hash) {
 		HASHremove(bm);
 	}
+	ZONEdestroy(b);
+	STATSdestroy(b);
+	CRACKdestroy(b);
+	CANDfree(b);
 
 	/* we must dispose of all inserted atoms */
 	if (b->batDeleted == b->batInserted &&
@@ -641,6 +645,10 @@ BATfree(BAT *b)
 		PROPdestroy(b->T->props);
 	b->T->props = NULL;
 	HASHdestroy(b);
+	ZONEdestroy(b);
+	STATSdestroy(b);
+	CRACKdestroy(b);
+	CANDfree(b);
 	if (b->htype)
 		HEAPfree(&b->H->heap);
 	else
@@ -2101,6 +2109,8 @@ BATvmsize(BAT *b, int dirty)
 		(!dirty || b->T->heap.dirty ? HEAPvmsize(&b->T->heap) : 0) +
 		((!dirty || b->H->heap.dirty) && b->H->hash ? HEAPvmsize(b->H->hash->heap) : 0) +
 		((!dirty || b->T->heap.dirty) && b->T->hash ? HEAPvmsize(b->T->hash->heap) : 0) +
+		((!dirty || b->H->heap.dirty) && b->H->zonemap ? HEAPvmsize(b->H->zonemap->heap) : 0) +
+		((!dirty || b->T->heap.dirty) && b->T->zonemap ? HEAPvmsize(b->T->zonemap->heap) : 0) +
 		(b->H->vheap && (!dirty || b->H->vheap->dirty) ? HEAPvmsize(b->H->vheap) : 0) +
 		(b->T->vheap && (!dirty || b->T->vheap->dirty) ? HEAPvmsize(b->T->vheap) : 0);
 }
@@ -2117,6 +2127,8 @@ BATmemsize(BAT *b, int dirty)
 		(!dirty || b->T->heap.dirty ? HEAPmemsize(&b->T->heap) : 0) +
 		((!dirty || b->H->heap.dirty) && b->H->hash ? HEAPmemsize(b->H->hash->heap) : 0) +
 		((!dirty || b->T->heap.dirty) && b->T->hash ? HEAPmemsize(b->T->hash->heap) : 0) +
+		((!dirty || b->H->heap.dirty) && b->H->zonemap ? HEAPmemsize(b->H->zonemap->heap) : 0) +
+		((!dirty || b->T->heap.dirty) && b->T->zonemap ? HEAPmemsize(b->T->zonemap->heap) : 0) +
 		(b->H->vheap && (!dirty || b->H->vheap->dirty) ? HEAPmemsize(b->H->vheap) : 0) +
 		(b->T->vheap && (!dirty || b->T->vheap->dirty) ? HEAPmemsize(b->T->vheap) : 0);
 }
@@ -676,6 +676,11 @@ BATappend(BAT *b, BAT *n, bit force)
 	}
 	b->H->nonil &= n->H->nonil;
 	b->T->nonil &= n->T->nonil;
+	/* extend the zone maps, statistics and cracker indices with
+	 * the appended values */
+	ZONEappend(b);
+	STATSappend(b);
+	CRACKappend(b);
 	return b;
       bunins_failed:
 	return NULL;
@@ -874,6 +879,9 @@ BATtopN(BAT *b, BUN topN)
 			BUNdelete(b, BUNlast(b), FALSE);
 	} else {
 		HASHremove(b);
+		ZONEdestroy(b);
+		STATSdestroy(b);
+		CRACKdestroy(b);
 		BATsetcount(b, topN);
 	}
 	/* we no longer know if there are NILs */
@@ -1097,17 +1105,34 @@ BATordered_rev(BAT* b)
 	return b->hrevsorted;
 }
 
+/* below this many entries a parallel sort does not pay off */
+#define PSORT_MINSIZE	((size_t) 1 << 20)
+
 /* figure out which sort function is to be called
  * 指出哪个排序方法会被采用
  * stable sort can produce an error (not enough memory available),
  * 稳定排序GDKssort会产生错误，但是“快速”排序GDKqsort不会产生错误
- * "quick" sort does not produce errors */
+ * "quick" sort does not produce errors
+ * large inputs are sorted on all cores by GDKpsort; if that cannot
+ * get its scratch memory we fall back to the sequential sorts
+ * fixed-width integer heads are radix sorted by GDKrsort, which is
+ * stable and so serves both sort flavours */
 static gdk_return
 do_sort(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe,
 	int reverse, int stable)
 {
 	if (n <= 1)		/* trivially sorted */
 		return GDK_SUCCEED;
+	if (n >= PSORT_MINSIZE && GDKnr_threads > 1) {
+		ALGODEBUG fprintf(stderr, "#do_sort: parallel sort of " SZFMT
+				  " entries on %d threads\n", n, GDKnr_threads);
+		if (GDKpsort(h, t, base, n, hs, ts, tpe, reverse, stable,
+			     GDKnr_threads) == GDK_SUCCEED)
+			return GDK_SUCCEED;
+	}
+	if (n >= RSORT_MINSIZE && GDKrsortable(base, tpe) &&
+	    GDKrsort(h, t, n, hs, ts, tpe, reverse) == GDK_SUCCEED)
+		return GDK_SUCCEED;
 	if (reverse) {
 		if (stable) {
 			if (GDKssort_rev(h, t, base, n, hs, ts, tpe) < 0) {
@@ -2201,10 +2226,29 @@ BATcount_no_nil(BAT *b)
 	return cnt;
 }
 
+/* union (op == 1) or intersection (op == 0) of two candidate lists,
+ * at least one of which is compact (see CANDtoBAT) */
+static BAT *
+cand_setop(BAT *a, BAT *b, int op)
+{
+	Cand *ca, *cb, *c = NULL;
+
+	/* compact candidates are used in place, others converted */
+	ca = BATtcand(a) ? a->T->cand : CANDfromBAT(a);
+	cb = BATtcand(b) ? b->T->cand : CANDfromBAT(b);
+	if (ca && cb)
+		c = op ? CANDunion(ca, cb) : CANDintersect(ca, cb);
+	if (!BATtcand(a))
+		CANDdestroy(ca);
+	if (!BATtcand(b))
+		CANDdestroy(cb);
+	return c ? CANDtoBAT(c) : NULL;
+}
+
 /* merge two candidate lists and produce a new one
  *
  * candidate lists are VOID-headed BATs with an OID tail which is
- * sorted and unique.
+ * sorted and unique, or compact candidates (see CANDtoBAT).
  */
 BAT *
 BATmergecand(BAT *a, BAT *b)
@@ -2215,6 +2259,8 @@ BATmergecand(BAT *a, BAT *b)
 
 	BATcheck(a, "BATmergecand");
 	BATcheck(b, "BATmergecand");
+	if (BATtcand(a) || BATtcand(b))
+		return cand_setop(a, b, 1);
 	assert(a->htype == TYPE_void);
 	assert(b->htype == TYPE_void);
 	assert(ATOMtype(a->htype) == TYPE_oid);
@@ -2299,7 +2345,7 @@ BATmergecand(BAT *a, BAT *b)
 /* intersect two candidate lists and produce a new one
  *
  * candidate lists are VOID-headed BATs with an OID tail which is
- * sorted and unique.
+ * sorted and unique, or compact candidates (see CANDtoBAT).
  */
 BAT *
 BATintersectcand(BAT *a, BAT *b)
@@ -2310,6 +2356,8 @@ BATintersectcand(BAT *a, BAT *b)
 
 	BATcheck(a, "BATintersectcand");
 	BATcheck(b, "BATintersectcand");
+	if (BATtcand(a) || BATtcand(b))
+		return cand_setop(a, b, 0);
 	assert(a->htype == TYPE_void);
 	assert(b->htype == TYPE_void);
 	assert(ATOMtype(a->htype) == TYPE_oid);
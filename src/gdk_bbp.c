@@ -3674,6 +3674,12 @@ BBPdiskscan(const char *parent)
 		} else if (strncmp(p + 1, "thash", 5) == 0) {
 			BAT *b = getdesc(bid);
 			delete = (b == NULL || !b->T->hash);
+		} else if (strncmp(p + 1, "hzonemap", 8) == 0 ||
+			   strncmp(p + 1, "tzonemap", 8) == 0 ||
+			   strncmp(p + 1, "hstats", 6) == 0 ||
+			   strncmp(p + 1, "tstats", 6) == 0) {
+			BAT *b = getdesc(bid);
+			delete = (b == NULL || b->batCopiedtodisk == 0);
 		} else if (strncmp(p + 1, "priv", 4) != 0 && strncmp(p + 1, "new", 3) != 0 && strncmp(p + 1, "head", 4) != 0 && strncmp(p + 1, "tail", 4) != 0) {
 			ok = FALSE;
 		}
@@ -110,6 +110,7 @@ gdk_export void BBPshare(bat b);
 		BBP_status_set(bid, BBP_status(bid) & ~(flags), nme)
 
 #define BBPswappable(b) ((b) && (b)->batCacheid && BBP_refs((b)->batCacheid) == 0)
-#define BBPtrimmable(b) (BBPswappable(b) && isVIEW(b) == 0 && (BBP_status((b)->batCacheid)&BBPWAITING) == 0)
+/* compact candidate BATs cannot be saved: their candidates would be lost */
+#define BBPtrimmable(b) (BBPswappable(b) && isVIEW(b) == 0 && (BBP_status((b)->batCacheid)&BBPWAITING) == 0 && (b)->H->cand == NULL && (b)->T->cand == NULL)
 
 #endif /* _GDK_BBP_H_ */
@@ -21,6 +21,7 @@
 #include "gdk.h"
 #include "gdk_private.h"
 #include "gdk_calc_private.h"
+#include "gdk_mapreduce.h"
 #include <math.h>
 
 /* Define symbol FULL_IMPLEMENTATION to get implementations for all
@@ -44,6 +45,22 @@
 #define FMTflt	"%.9g"
 #define FMTdbl	"%.17g"
 #define FMToid	OIDFMT
+#ifdef HAVE_HGE
+/* there is no printf conversion for hge, so we print an approximation */
+#define FMThge	"%.40g"
+#endif
+
+/* cast applied to a value printed with the above format strings */
+#define CSTbte
+#define CSTsht
+#define CSTint
+#define CSTlng
+#define CSTflt
+#define CSTdbl
+#define CSToid
+#ifdef HAVE_HGE
+#define CSThge	(dbl)
+#endif
 
 /* Most of the internal routines return a count of the number of NIL
  * values the produced.  They indicate an error by returning a value
@@ -70,14 +87,15 @@ checkbats(BAT *b1, BAT *b2, const char *func)
 
 #define CHECKCAND(dst, i, candoff, NIL)				\
 	/* cannot use do/while trick because of continue */	\
-	if (cand) {						\
-		if ((i) < *cand - (candoff)) {			\
+	if (ci) {							\
+		if ((i) < ci->next - (candoff)) {			\
 			nils++;					\
 			(dst)[i] = (NIL);			\
 			continue;				\
 		}						\
-		assert((i) == *cand - (candoff));		\
-		if (++cand == (candend))			\
+		assert((i) == ci->next - (candoff));			\
+		CANDiternext(ci);					\
+		if (ci->next == oid_nil)				\
 			end = (i) + 1;				\
 	}
 
@@ -93,7 +111,7 @@ checkbats(BAT *b1, BAT *b2, const char *func)
 		const TYPE1 *src = (const TYPE1 *) Tloc(b, b->U->first); \
 		TYPE2 *dst = (TYPE2 *) Tloc(bn, bn->U->first);		\
 		CANDLOOP(dst, i, TYPE2##_nil, 0, start);		\
-		if (b->T->nonil && cand == NULL) {			\
+		if (b->T->nonil && ci == NULL) {			\
 			for (i = start; i < end; i++)			\
 				dst[i] = FUNC(src[i]);			\
 		} else {						\
@@ -168,6 +186,574 @@ checkbats(BAT *b1, BAT *b2, const char *func)
 		CANDLOOP((TYPE3 *) dst, k, TYPE3##_nil, end, cnt);	\
 	} while (0)
 
+/* ---------------------------------------------------------------------- */
+/* blocked and parallel evaluation of binary arithmetic */
+
+/* The BATcalc{add,sub,mul,div} functions (and their constant
+ * variants) do not call the type-specific loops below directly, but
+ * go through calc_blocked.  If there is no candidate list and the
+ * input is big enough, the range is cut into blocks of CALC_BLOCK
+ * values.  For the common case where both operands and the result
+ * have the same type, each block is first handed to a branch-free
+ * kernel that computes all values and only records whether anything
+ * in the block may have overflowed; nils are dealt with using a mask
+ * instead of a branch, and not at all if the caller knows there are
+ * none.  These loops are simple enough for the compiler to
+ * vectorize (the ones on 64-bit values need 64-bit vector compares,
+ * i.e. SSE4.2 or better on x86-64).  Only a block for which the kernel raised the flag is
+ * redone by the checked loop, so the results (including nil counts
+ * and error messages) are exactly those of the checked loop.
+ *
+ * Large inputs are furthermore split into pieces that are processed
+ * in parallel.  Worker threads never report errors: they run the
+ * checked loops with abort_on_error off and, when the caller asked
+ * for an abort, remember where trouble may have started.  The caller
+ * then redoes those ranges, in order, with abort_on_error set so
+ * that the first offending value is the one reported, and in the
+ * caller's thread. */
+
+#define CALC_BLOCK		((BUN) 4096)
+#define CALC_BLOCKED_MINSIZE	(4 * CALC_BLOCK)
+#define CALC_PARALLEL_MINSIZE	((BUN) 1 << 20)
+
+typedef BUN (*calc_loop)(const void *lft, int tp1, int incr1,
+			 const void *rgt, int tp2, int incr2,
+			 void *dst, int tp, BUN cnt,
+			 BUN start, BUN end, CandIter *ci, oid candoff,
+			 int abort_on_error, const char *func);
+
+typedef BUN (*calc_kernel)(const void *lft, int incr1,
+			   const void *rgt, int incr2,
+			   void *dst, BUN n, int nonil, int *bad);
+
+/* the loop body of the kernels: compute d from l and r, and set bad
+ * if d may not be the right answer (overflow, or a result that
+ * happens to be nil); bad may be set too eagerly, never too
+ * lazily */
+#define CALCBLK_ADD_wide(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		WTYPE w = (WTYPE) (l) + (r);				\
+		(bad) = (w <= GDK_##TYPE##_min) | (w > GDK_##TYPE##_max); \
+		(d) = (TYPE) w;						\
+	} while (0)
+#define CALCBLK_SUB_wide(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		WTYPE w = (WTYPE) (l) - (r);				\
+		(bad) = (w <= GDK_##TYPE##_min) | (w > GDK_##TYPE##_max); \
+		(d) = (TYPE) w;						\
+	} while (0)
+#define CALCBLK_MUL_wide(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		WTYPE w = (WTYPE) (l) * (r);				\
+		(bad) = (w <= GDK_##TYPE##_min) | (w > GDK_##TYPE##_max); \
+		(d) = (TYPE) w;						\
+	} while (0)
+/* two's complement wrap-around (WTYPE is the unsigned version of
+ * TYPE), overflow iff the sign comes out wrong */
+#define CALCBLK_ADD_wrap(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		(d) = (TYPE) ((WTYPE) (l) + (WTYPE) (r));		\
+		(bad) = ((((l) ^ (d)) & ((r) ^ (d))) < 0) |		\
+			((d) == GDK_##TYPE##_min);			\
+	} while (0)
+#define CALCBLK_SUB_wrap(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		(d) = (TYPE) ((WTYPE) (l) - (WTYPE) (r));		\
+		(bad) = ((((l) ^ (r)) & ((l) ^ (d))) < 0) |		\
+			((d) == GDK_##TYPE##_min);			\
+	} while (0)
+/* for floating point, only operands of moderate magnitude are known
+ * not to overflow */
+#define CALCBLK_small(TYPE, x, lim)	(((x) > (lim)) | ((x) < -(lim)))
+#define CALCBLK_ADD_float(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		(d) = (l) + (r);					\
+		(bad) = CALCBLK_small(TYPE, l, GDK_##TYPE##_max / 4) |	\
+			CALCBLK_small(TYPE, r, GDK_##TYPE##_max / 4) |	\
+			((d) == TYPE##_nil);				\
+	} while (0)
+#define CALCBLK_SUB_float(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		(d) = (l) - (r);					\
+		(bad) = CALCBLK_small(TYPE, l, GDK_##TYPE##_max / 4) |	\
+			CALCBLK_small(TYPE, r, GDK_##TYPE##_max / 4) |	\
+			((d) == TYPE##_nil);				\
+	} while (0)
+/* a little below the square root of GDK_TYPE_max */
+#define CALCBLK_MULLIM_flt	1e18f
+#define CALCBLK_MULLIM_dbl	1e150
+#define CALCBLK_MUL_float(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		(d) = (l) * (r);					\
+		(bad) = CALCBLK_small(TYPE, l, CALCBLK_MULLIM_##TYPE) |	\
+			CALCBLK_small(TYPE, r, CALCBLK_MULLIM_##TYPE) |	\
+			((d) == TYPE##_nil);				\
+	} while (0)
+#define CALCBLK_DIV_float(TYPE, WTYPE, l, r, d, bad)			\
+	do {								\
+		(d) = (l) / (r);					\
+		(bad) = !(((r) >= 1) | ((r) <= -1)) |			\
+			((d) == TYPE##_nil);				\
+	} while (0)
+
+#define CALCBLK_LOOP(TYPE, WTYPE, LFT, RGT, BODY)			\
+	do {								\
+		if (nonil) {						\
+			for (k = 0; k < n; k++) {			\
+				const TYPE l = (LFT), r = (RGT);	\
+				TYPE d;					\
+				int b;					\
+				BODY(TYPE, WTYPE, l, r, d, b);		\
+				bads |= b;				\
+				dst[k] = d;				\
+			}						\
+		} else {						\
+			for (k = 0; k < n; k++) {			\
+				const TYPE l = (LFT), r = (RGT);	\
+				const int isnil = (l == TYPE##_nil) |	\
+					(r == TYPE##_nil);		\
+				TYPE d;					\
+				int b;					\
+				BODY(TYPE, WTYPE, l, r, d, b);		\
+				bads |= b & !isnil;			\
+				dst[k] = isnil ? TYPE##_nil : d;	\
+				nils += isnil;				\
+			}						\
+		}							\
+	} while (0)
+
+#define CALCBLK(OP, TYPE, WTYPE, BODY)					\
+static BUN								\
+calcblk_##OP##_##TYPE(const void *lft_, int incr1,			\
+		      const void *rgt_, int incr2,			\
+		      void *dst_, BUN n, int nonil, int *bad)		\
+{									\
+	const TYPE *lft = (const TYPE *) lft_;				\
+	const TYPE *rgt = (const TYPE *) rgt_;				\
+	TYPE *dst = (TYPE *) dst_;					\
+	BUN k, nils = 0;						\
+	int bads = 0;							\
+									\
+	if (incr1 && incr2) {						\
+		CALCBLK_LOOP(TYPE, WTYPE, lft[k], rgt[k], BODY);	\
+	} else if (incr1) {						\
+		const TYPE rc = *rgt;					\
+		CALCBLK_LOOP(TYPE, WTYPE, lft[k], rc, BODY);		\
+	} else {							\
+		const TYPE lc = *lft;					\
+		CALCBLK_LOOP(TYPE, WTYPE, lc, rgt[k], BODY);		\
+	}								\
+	*bad = bads;							\
+	return nils;							\
+}
+
+CALCBLK(add, bte, int, CALCBLK_ADD_wide)
+CALCBLK(add, sht, int, CALCBLK_ADD_wide)
+CALCBLK(add, int, unsigned int, CALCBLK_ADD_wrap)
+CALCBLK(add, lng, ulng, CALCBLK_ADD_wrap)
+CALCBLK(add, flt, flt, CALCBLK_ADD_float)
+CALCBLK(add, dbl, dbl, CALCBLK_ADD_float)
+CALCBLK(sub, bte, int, CALCBLK_SUB_wide)
+CALCBLK(sub, sht, int, CALCBLK_SUB_wide)
+CALCBLK(sub, int, unsigned int, CALCBLK_SUB_wrap)
+CALCBLK(sub, lng, ulng, CALCBLK_SUB_wrap)
+CALCBLK(sub, flt, flt, CALCBLK_SUB_float)
+CALCBLK(sub, dbl, dbl, CALCBLK_SUB_float)
+CALCBLK(mul, bte, int, CALCBLK_MUL_wide)
+CALCBLK(mul, sht, int, CALCBLK_MUL_wide)
+CALCBLK(mul, int, lng, CALCBLK_MUL_wide)
+CALCBLK(mul, flt, flt, CALCBLK_MUL_float)
+CALCBLK(mul, dbl, dbl, CALCBLK_MUL_float)
+CALCBLK(div, flt, flt, CALCBLK_DIV_float)
+CALCBLK(div, dbl, dbl, CALCBLK_DIV_float)
+
+/* find the kernel for operator op ('+', '-', '*', '/'); there only
+ * are kernels for operands and result of the same type, and not for
+ * lng multiplication (no wider type) or integer division (which
+ * doesn't vectorize anyway) */
+static calc_kernel
+calc_findkernel(char op, int tp1, int tp2, int tp)
+{
+	tp = ATOMstorage(tp);
+	if (ATOMstorage(tp1) != tp || ATOMstorage(tp2) != tp)
+		return NULL;
+	switch (op) {
+	case '+':
+		switch (tp) {
+		case TYPE_bte: return calcblk_add_bte;
+		case TYPE_sht: return calcblk_add_sht;
+		case TYPE_int: return calcblk_add_int;
+		case TYPE_lng: return calcblk_add_lng;
+		case TYPE_flt: return calcblk_add_flt;
+		case TYPE_dbl: return calcblk_add_dbl;
+		}
+		break;
+	case '-':
+		switch (tp) {
+		case TYPE_bte: return calcblk_sub_bte;
+		case TYPE_sht: return calcblk_sub_sht;
+		case TYPE_int: return calcblk_sub_int;
+		case TYPE_lng: return calcblk_sub_lng;
+		case TYPE_flt: return calcblk_sub_flt;
+		case TYPE_dbl: return calcblk_sub_dbl;
+		}
+		break;
+	case '*':
+		switch (tp) {
+		case TYPE_bte: return calcblk_mul_bte;
+		case TYPE_sht: return calcblk_mul_sht;
+		case TYPE_int: return calcblk_mul_int;
+		case TYPE_flt: return calcblk_mul_flt;
+		case TYPE_dbl: return calcblk_mul_dbl;
+		}
+		break;
+	case '/':
+		switch (tp) {
+		case TYPE_flt: return calcblk_div_flt;
+		case TYPE_dbl: return calcblk_div_dbl;
+		}
+		break;
+	}
+	return NULL;
+}
+
+/* count the positions where either operand is nil */
+#define CALC_NILMASK(TYPE, src, incr, n, m, first)			\
+	do {								\
+		const TYPE *v = (const TYPE *) (src);			\
+		BUN k;							\
+		if (incr == 0) {					\
+			bit isnil = *v == TYPE##_nil;			\
+			for (k = 0; k < (n); k++)			\
+				m[k] = first ? isnil : m[k] | isnil;	\
+		} else {						\
+			for (k = 0; k < (n); k++)			\
+				m[k] = first ? v[k] == TYPE##_nil :	\
+					m[k] | (v[k] == TYPE##_nil);	\
+		}							\
+	} while (0)
+
+static BUN
+calc_countnils(const char *lft, int tp1, int incr1,
+	       const char *rgt, int tp2, int incr2, BUN cnt)
+{
+	bit m[CALC_BLOCK];
+	BUN i, k, n, nils = 0;
+	int s, first;
+	const char *src;
+
+	for (i = 0; i < cnt; i += n) {
+		n = cnt - i < CALC_BLOCK ? cnt - i : CALC_BLOCK;
+		for (s = 0; s < 2; s++) {
+			int tpe = s ? tp2 : tp1;
+			int incr = s ? incr2 : incr1;
+
+			first = s == 0;
+			src = s ? rgt : lft;
+			src += i * incr * ATOMsize(tpe);
+			switch (ATOMstorage(tpe)) {
+			case TYPE_bte:
+				CALC_NILMASK(bte, src, incr, n, m, first);
+				break;
+			case TYPE_sht:
+				CALC_NILMASK(sht, src, incr, n, m, first);
+				break;
+			case TYPE_int:
+				CALC_NILMASK(int, src, incr, n, m, first);
+				break;
+			case TYPE_lng:
+				CALC_NILMASK(lng, src, incr, n, m, first);
+				break;
+			case TYPE_flt:
+				CALC_NILMASK(flt, src, incr, n, m, first);
+				break;
+			case TYPE_dbl:
+				CALC_NILMASK(dbl, src, incr, n, m, first);
+				break;
+#ifdef HAVE_HGE
+			case TYPE_hge:
+				CALC_NILMASK(hge, src, incr, n, m, first);
+				break;
+#endif
+			default:
+				/* no such loops */
+				return BUN_NONE;
+			}
+		}
+		for (k = 0; k < n; k++)
+			nils += m[k];
+	}
+	return nils;
+}
+
+typedef struct {
+	calc_loop loop;
+	calc_kernel kernel;
+	const char *lft, *rgt;
+	char *dst;
+	int tp1, tp2, tp;
+	int incr1, incr2;
+	int nonil, abort_on_error;
+	const char *func;
+	BUN base, grain;
+	BUN *nils;		/* per piece: nils produced */
+	BUN *resume;		/* per piece: where the caller must take over */
+} calcpar_t;
+
+#define CALC_LFT(c, i)	((c)->lft + (i) * (c)->incr1 * ATOMsize((c)->tp1))
+#define CALC_RGT(c, i)	((c)->rgt + (i) * (c)->incr2 * ATOMsize((c)->tp2))
+#define CALC_DST(c, i)	((c)->dst + (i) * ATOMsize((c)->tp))
+
+static void
+calc_piece(BUN lo, BUN hi, void *arg)
+{
+	calcpar_t *c = arg;
+	BUN p = (lo - c->base) / c->grain;
+	BUN i, n, r, nils = 0;
+	int bad;
+
+	c->resume[p] = hi;
+	if (c->kernel == NULL) {
+		r = (*c->loop)(CALC_LFT(c, lo), c->tp1, c->incr1,
+			       CALC_RGT(c, lo), c->tp2, c->incr2,
+			       CALC_DST(c, lo), c->tp, hi - lo,
+			       0, hi - lo, NULL, 0, 0, c->func);
+		/* any nil not due to a nil operand is an error the
+		 * caller must report */
+		if (c->abort_on_error &&
+		    r != (c->nonil ? 0 : calc_countnils(CALC_LFT(c, lo), c->tp1, c->incr1,
+							CALC_RGT(c, lo), c->tp2, c->incr2,
+							hi - lo)))
+			c->resume[p] = lo;
+		else
+			nils = r;
+	} else {
+		for (i = lo; i < hi; i += n) {
+			n = hi - i < CALC_BLOCK ? hi - i : CALC_BLOCK;
+			r = (*c->kernel)(CALC_LFT(c, i), c->incr1,
+					 CALC_RGT(c, i), c->incr2,
+					 CALC_DST(c, i), n, c->nonil, &bad);
+			if (bad) {
+				if (c->abort_on_error) {
+					c->resume[p] = i;
+					break;
+				}
+				r = (*c->loop)(CALC_LFT(c, i), c->tp1, c->incr1,
+					       CALC_RGT(c, i), c->tp2, c->incr2,
+					       CALC_DST(c, i), c->tp, n,
+					       0, n, NULL, 0, 0, c->func);
+			}
+			nils += r;
+		}
+	}
+	c->nils[p] = nils;
+}
+
+static BUN
+calc_blocked_intern(calc_loop loop, char op, int nonil,
+		    const void *lft, int tp1, int incr1,
+		    const void *rgt, int tp2, int incr2,
+		    void *dst, int tp, BUN cnt,
+		    BUN start, BUN end, CandIter *ci, oid candoff,
+		    int abort_on_error, const char *func)
+{
+	calcpar_t c;
+	BUN npieces, p, lo, hi, r, nils;
+	BUN pnils[64], presume[64];
+	int nthreads = GDKnr_threads > 1 ? GDKnr_threads : 1;
+
+	c.kernel = calc_findkernel(op, tp1, tp2, tp);
+	if (ci != NULL ||
+	    end - start < CALC_BLOCKED_MINSIZE ||
+	    (c.kernel == NULL &&
+	     (nthreads == 1 || end - start < CALC_PARALLEL_MINSIZE)))
+		return (*loop)(lft, tp1, incr1, rgt, tp2, incr2,
+			       dst, tp, cnt, start, end,
+			       ci, candoff,
+			       abort_on_error, func);
+
+	c.loop = loop;
+	c.lft = lft;
+	c.rgt = rgt;
+	c.dst = dst;
+	c.tp1 = tp1;
+	c.tp2 = tp2;
+	c.tp = tp;
+	c.incr1 = incr1;
+	c.incr2 = incr2;
+	c.nonil = nonil;
+	c.abort_on_error = abort_on_error;
+	c.func = func;
+	c.base = start;
+	c.nils = pnils;
+	c.resume = presume;
+
+	/* values outside [start,end) become nil; this call also
+	 * takes care of reporting unsupported type combinations
+	 * before any work is handed out */
+	nils = (*loop)(lft, tp1, incr1, rgt, tp2, incr2,
+		       dst, tp, start, 0, 0, NULL, 0,
+		       abort_on_error, func);
+	if (nils >= BUN_NONE)
+		return nils;
+
+	if (nthreads > 1 && end - start >= CALC_PARALLEL_MINSIZE) {
+		c.grain = (end - start) / ((BUN) nthreads * 4);
+		if (c.grain < 16 * CALC_BLOCK)
+			c.grain = 16 * CALC_BLOCK;
+		c.grain = (c.grain + CALC_BLOCK - 1) & ~(CALC_BLOCK - 1);
+		if ((end - start + c.grain - 1) / c.grain > 64)
+			c.grain = (end - start + 63) / 64;
+	} else {
+		c.grain = end - start;
+	}
+	npieces = (end - start + c.grain - 1) / c.grain;
+	ALGODEBUG fprintf(stderr, "#%s: %c blocked%s, " BUNFMT " pieces\n",
+			  func, op, c.kernel ? " (kernel)" : "", npieces);
+	if (npieces > 1)
+		MRparallel_for(start, end, c.grain, calc_piece, &c);
+	else
+		calc_piece(start, end, &c);
+
+	for (p = 0; p < npieces; p++) {
+		lo = start + p * c.grain;
+		hi = lo + c.grain < end ? lo + c.grain : end;
+		nils += pnils[p];
+		if (presume[p] < hi) {
+			lo = presume[p];
+			r = (*loop)(CALC_LFT(&c, lo), tp1, incr1,
+				    CALC_RGT(&c, lo), tp2, incr2,
+				    CALC_DST(&c, lo), tp, hi - lo,
+				    0, hi - lo, NULL, 0,
+				    abort_on_error, func);
+			if (r >= BUN_NONE)
+				return r;
+			nils += r;
+		}
+	}
+
+	if (end < cnt) {
+		r = (*loop)(CALC_LFT(&c, end), tp1, incr1,
+			    CALC_RGT(&c, end), tp2, incr2,
+			    CALC_DST(&c, end), tp, cnt - end,
+			    0, 0, NULL, 0,
+			    abort_on_error, func);
+		nils += r;
+	}
+	return nils;
+}
+
+#ifdef HAVE_HGE
+/* The hge arithmetic only has loops for lng and hge operands, so a
+ * bte, sht or int operand of an operation on or into hge is first
+ * widened to lng: a constant (incr == 0) into *val, anything else
+ * into a copy which is returned in *bufp for the caller to free. */
+#define CALC_WIDEN(TYPE)						\
+	do {								\
+		const TYPE *v = (const TYPE *) *srcp;			\
+		for (i = 0; i < n; i++)					\
+			buf[i] = v[i] == TYPE##_nil ? lng_nil : (lng) v[i]; \
+	} while (0)
+
+static gdk_return
+calc_widen(const void **srcp, int *tpp, int incr, BUN cnt,
+	   lng *val, lng **bufp)
+{
+	BUN i, n = incr ? cnt : 1;
+	lng *buf = val;
+
+	*bufp = NULL;
+	switch (ATOMstorage(*tpp)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+		break;
+	default:
+		return GDK_SUCCEED;
+	}
+	if (incr &&
+	    (buf = *bufp = GDKmalloc((n ? n : 1) * sizeof(lng))) == NULL)
+		return GDK_FAIL;
+	switch (ATOMstorage(*tpp)) {
+	case TYPE_bte:
+		CALC_WIDEN(bte);
+		break;
+	case TYPE_sht:
+		CALC_WIDEN(sht);
+		break;
+	default:
+		CALC_WIDEN(int);
+		break;
+	}
+	*srcp = buf;
+	*tpp = TYPE_lng;
+	return GDK_SUCCEED;
+}
+
+#define CALC_ISHGE(tp1, tp2, tp)					\
+	(ATOMstorage(tp) == TYPE_hge ||					\
+	 ATOMstorage(tp1) == TYPE_hge || ATOMstorage(tp2) == TYPE_hge)
+#endif
+
+/* Evaluate loop (one of the *_typeswitchloop functions) for operator
+ * op.  The arguments after nonil are those of loop; nonil tells that
+ * neither operand contains nils. */
+static BUN
+calc_blocked(calc_loop loop, char op, int nonil,
+	     const void *lft, int tp1, int incr1,
+	     const void *rgt, int tp2, int incr2,
+	     void *dst, int tp, BUN cnt,
+	     BUN start, BUN end, CandIter *ci, oid candoff,
+	     int abort_on_error, const char *func)
+{
+#ifdef HAVE_HGE
+	lng val1, val2, *buf1 = NULL, *buf2 = NULL;
+	BUN nils;
+
+	if (CALC_ISHGE(tp1, tp2, tp)) {
+		if (calc_widen(&lft, &tp1, incr1, cnt, &val1, &buf1) != GDK_SUCCEED ||
+		    calc_widen(&rgt, &tp2, incr2, cnt, &val2, &buf2) != GDK_SUCCEED) {
+			GDKfree(buf1);
+			return BUN_NONE;
+		}
+		nils = calc_blocked_intern(loop, op, nonil,
+					   lft, tp1, incr1,
+					   rgt, tp2, incr2,
+					   dst, tp, cnt, start, end,
+					   ci, candoff,
+					   abort_on_error, func);
+		GDKfree(buf1);
+		GDKfree(buf2);
+		return nils;
+	}
+#endif
+	return calc_blocked_intern(loop, op, nonil,
+				   lft, tp1, incr1, rgt, tp2, incr2,
+				   dst, tp, cnt, start, end,
+				   ci, candoff,
+				   abort_on_error, func);
+}
+
+/* Evaluate loop for two constants into ret. */
+static BUN
+calc_values(calc_loop loop, ValPtr ret, const ValRecord *lft,
+	    const ValRecord *rgt, int abort_on_error, const char *func)
+{
+	const void *l = VALptr(lft), *r = VALptr(rgt);
+	int tp1 = lft->vtype, tp2 = rgt->vtype;
+#ifdef HAVE_HGE
+	lng val1, val2, *buf;
+
+	/* constants are never copied, so there is nothing to free */
+	if (CALC_ISHGE(tp1, tp2, ret->vtype)) {
+		(void) calc_widen(&l, &tp1, 0, 1, &val1, &buf);
+		(void) calc_widen(&r, &tp2, 0, 1, &val2, &buf);
+	}
+#endif
+	return (*loop)(l, tp1, 0, r, tp2, 0, VALget(ret), ret->vtype, 1,
+		       0, 1, NULL, 0, abort_on_error, func);
+}
+
 /* ---------------------------------------------------------------------- */
 /* logical (for type bit) or bitwise (for integral types) NOT */
 
@@ -180,7 +766,7 @@ BATcalcnot(BAT *b, BAT *s)
 	BAT *bn;
 	BUN nils = 0;
 	BUN i, cnt, start, end;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcnot");
 	if (checkbats(b, NULL, "BATcalcnot") == GDK_FAIL)
@@ -292,7 +878,7 @@ BATcalcnegate(BAT *b, BAT *s)
 	BAT *bn;
 	BUN nils = 0;
 	BUN i, cnt, start, end;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcnegate");
 	if (checkbats(b, NULL, "BATcalcnegate") == GDK_FAIL)
@@ -409,7 +995,7 @@ BATcalcabsolute(BAT *b, BAT *s)
 	BAT *bn;
 	BUN nils= 0;
 	BUN i, cnt, start, end;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcabsolute");
 	if (checkbats(b, NULL, "BATcalcabsolute") == GDK_FAIL)
@@ -530,7 +1116,7 @@ BATcalciszero(BAT *b, BAT *s)
 	BAT *bn;
 	BUN nils = 0;
 	BUN i, cnt, start, end;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalciszero");
 	if (checkbats(b, NULL, "BATcalciszero") == GDK_FAIL)
@@ -649,7 +1235,7 @@ BATcalcsign(BAT *b, BAT *s)
 	BAT *bn;
 	BUN nils = 0;
 	BUN i, cnt, start, end;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcsign");
 	if (checkbats(b, NULL, "BATcalcsign") == GDK_FAIL)
@@ -776,7 +1362,7 @@ BATcalcisnil(BAT *b, BAT *s)
 {
 	BAT *bn;
 	BUN i, cnt, start, end;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	bit *dst;
 	int t;
 	const void *nil;
@@ -787,7 +1373,7 @@ BATcalcisnil(BAT *b, BAT *s)
 
 	CANDINIT(b, s);
 
-	if (start == 0 && end == cnt && cand == NULL) {
+	if (start == 0 && end == cnt && ci == NULL) {
 		if (b->T->nonil ||
 		    (b->T->type == TYPE_void && b->T->seq != oid_nil)) {
 			bit zero = 0;
@@ -890,7 +1476,7 @@ VARcalcisnotnil(ValPtr ret, const ValRecord *v)
 	do {							\
 		GDKerror("22003!overflow in calculation "	\
 			 FMT##TYPE1 OP FMT##TYPE2 ".\n",	\
-			 lft[i], rgt[j]);			\
+			 CST##TYPE1 lft[i], CST##TYPE2 rgt[j]);	\
 		return BUN_NONE;				\
 	} while (0)
 
@@ -899,8 +1485,7 @@ static BUN								\
 add_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff,	\
+				BUN end, CandIter *ci, oid candoff,	\
 				int abort_on_error)			\
 {									\
 	BUN i, j, k;							\
@@ -929,8 +1514,7 @@ static BUN								\
 add_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff)	\
+				BUN end, CandIter *ci, oid candoff)	\
 {									\
 	BUN i, j, k;							\
 	BUN nils = 0;							\
@@ -1073,13 +1657,19 @@ ADD_3TYPE(dbl, int, dbl)
 ADD_3TYPE(dbl, lng, dbl)
 ADD_3TYPE(dbl, flt, dbl)
 ADD_3TYPE(dbl, dbl, dbl)
+#ifdef HAVE_HGE
+/* two lng values always fit in a hge, so no check needed */
+ADD_3TYPE_enlarge(lng, lng, hge)
+ADD_3TYPE(lng, hge, hge)
+ADD_3TYPE(hge, lng, hge)
+ADD_3TYPE(hge, hge, hge)
+#endif
 
 static BUN
 add_typeswitchloop(const void *lft, int tp1, int incr1,
 		   const void *rgt, int tp2, int incr2,
 		   void *dst, int tp, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int abort_on_error, const char *func)
 {
 	BUN nils;
@@ -1092,34 +1682,34 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = add_bte_bte_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_sht:
 				nils = add_bte_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = add_bte_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_lng:
 				nils = add_bte_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = add_bte_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_bte_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1131,29 +1721,29 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = add_bte_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = add_bte_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = add_bte_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = add_bte_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_bte_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1165,24 +1755,24 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = add_bte_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = add_bte_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_bte_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_bte_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1194,19 +1784,19 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = add_bte_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_bte_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_bte_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1218,13 +1808,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_bte_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_bte_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1235,7 +1825,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_bte_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1253,29 +1843,29 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = add_sht_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = add_sht_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = add_sht_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = add_sht_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_sht_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1287,29 +1877,29 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = add_sht_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = add_sht_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = add_sht_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = add_sht_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_sht_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1321,24 +1911,24 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = add_sht_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = add_sht_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_sht_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_sht_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1350,19 +1940,19 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = add_sht_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_sht_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_sht_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1374,13 +1964,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_sht_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_sht_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1391,7 +1981,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_sht_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1409,24 +1999,24 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = add_int_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = add_int_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_int_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_int_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1438,24 +2028,24 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = add_int_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = add_int_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_int_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_int_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1467,24 +2057,24 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = add_int_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = add_int_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_int_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_int_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1496,19 +2086,19 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = add_int_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_int_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_int_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1520,13 +2110,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_int_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_int_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1537,7 +2127,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_int_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1555,19 +2145,19 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = add_lng_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_lng_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_lng_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1579,19 +2169,19 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = add_lng_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_lng_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_lng_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1603,19 +2193,19 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = add_lng_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_lng_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_lng_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1627,19 +2217,26 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = add_lng_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = add_lng_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = add_lng_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
+				break;
+#endif
+#ifdef HAVE_HGE
+			case TYPE_hge:
+				nils = add_lng_lng_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -1651,13 +2248,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_lng_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_lng_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1668,7 +2265,52 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_lng_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = add_lng_hge_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+#endif
+		default:
+			goto unsupported;
+		}
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		switch (ATOMstorage(tp2)) {
+		case TYPE_lng:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = add_hge_lng_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+		case TYPE_hge:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = add_hge_hge_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1679,6 +2321,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			goto unsupported;
 		}
 		break;
+#endif
 	case TYPE_flt:
 		switch (ATOMstorage(tp2)) {
 		case TYPE_bte:
@@ -1686,13 +2329,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_flt_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_flt_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1703,13 +2346,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_flt_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_flt_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1720,13 +2363,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_flt_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_flt_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1737,13 +2380,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_flt_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_flt_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1754,13 +2397,13 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = add_flt_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = add_flt_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -1771,7 +2414,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_flt_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1789,7 +2432,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_dbl_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1801,7 +2444,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_dbl_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1813,7 +2456,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_dbl_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1825,7 +2468,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_dbl_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1837,7 +2480,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_dbl_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1849,7 +2492,7 @@ add_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = add_dbl_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -1878,7 +2521,7 @@ BATcalcadd(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcadd");
 	BATcheck(b2, "BATcalcadd");
@@ -1892,12 +2535,14 @@ BATcalcadd(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = add_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
-				  Tloc(b2, b2->U->first), b2->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b1->H->seq,
-				  abort_on_error, "BATcalcadd");
+	nils = calc_blocked(add_typeswitchloop, '+',
+			    b1->T->nonil && b2->T->nonil,
+			    Tloc(b1, b1->U->first), b1->T->type, 1,
+			    Tloc(b2, b2->U->first), b2->T->type, 1,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b1->H->seq,
+			    abort_on_error, "BATcalcadd");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -1927,7 +2572,7 @@ BATcalcaddcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcaddcst");
 
@@ -1940,12 +2585,14 @@ BATcalcaddcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = add_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  VALptr(v), v->vtype, 0,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcaddcst");
+	nils = calc_blocked(add_typeswitchloop, '+',
+			    b->T->nonil && !VALisnil(v),
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    VALptr(v), v->vtype, 0,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalcaddcst");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -1975,7 +2622,7 @@ BATcalccstadd(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstadd");
 
@@ -1988,12 +2635,14 @@ BATcalccstadd(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = add_typeswitchloop(VALptr(v), v->vtype, 0,
-				  Tloc(b, b->U->first), b->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalccstadd");
+	nils = calc_blocked(add_typeswitchloop, '+',
+			    b->T->nonil && !VALisnil(v),
+			    VALptr(v), v->vtype, 0,
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalccstadd");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -2021,11 +2670,8 @@ int
 VARcalcadd(ValPtr ret, const ValRecord *lft, const ValRecord *rgt,
 	   int abort_on_error)
 {
-	if (add_typeswitchloop(VALptr(lft), lft->vtype, 0,
-			       VALptr(rgt), rgt->vtype, 0,
-			       VALget(ret), ret->vtype, 1,
-			       0, 1, NULL, NULL, 0,
-			       abort_on_error, "VARcalcadd") == BUN_NONE)
+	if (calc_values(add_typeswitchloop, ret, lft, rgt,
+			abort_on_error, "VARcalcadd") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
 }
@@ -2036,7 +2682,7 @@ BATcalcincr(BAT *b, BAT *s, int abort_on_error)
 	BAT *bn;
 	BUN nils= 0;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	bte one = 1;
 
 	BATcheck(b, "BATcalcincr");
@@ -2049,12 +2695,14 @@ BATcalcincr(BAT *b, BAT *s, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = add_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  &one, TYPE_bte, 0,
-				  Tloc(bn, bn->U->first), bn->T->type,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcincr");
+	nils = calc_blocked(add_typeswitchloop, '+',
+			    b->T->nonil,
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    &one, TYPE_bte, 0,
+			    Tloc(bn, bn->U->first), bn->T->type,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalcincr");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -2095,7 +2743,7 @@ VARcalcincr(ValPtr ret, const ValRecord *v, int abort_on_error)
 	if (add_typeswitchloop(VALptr(v), v->vtype, 0,
 			       &one, TYPE_bte, 0,
 			       VALget(ret), ret->vtype, 1,
-			       0, 1, NULL, NULL, 0,
+			       0, 1, NULL, 0,
 			       abort_on_error, "VARcalcincr") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
@@ -2109,8 +2757,7 @@ static BUN								\
 sub_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff,	\
+				BUN end, CandIter *ci, oid candoff,	\
 				int abort_on_error)			\
 {									\
 	BUN i, j, k;							\
@@ -2152,8 +2799,7 @@ static BUN								\
 sub_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff)	\
+				BUN end, CandIter *ci, oid candoff)	\
 {									\
 	BUN i, j, k;							\
 	BUN nils = 0;							\
@@ -2296,13 +2942,18 @@ SUB_3TYPE(dbl, int, dbl)
 SUB_3TYPE(dbl, lng, dbl)
 SUB_3TYPE(dbl, flt, dbl)
 SUB_3TYPE(dbl, dbl, dbl)
+#ifdef HAVE_HGE
+SUB_3TYPE_enlarge(lng, lng, hge)
+SUB_3TYPE(lng, hge, hge)
+SUB_3TYPE(hge, lng, hge)
+SUB_3TYPE(hge, hge, hge)
+#endif
 
 static BUN
 sub_typeswitchloop(const void *lft, int tp1, int incr1,
 		   const void *rgt, int tp2, int incr2,
 		   void *dst, int tp, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int abort_on_error, const char *func)
 {
 	BUN nils;
@@ -2315,34 +2966,34 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = sub_bte_bte_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_sht:
 				nils = sub_bte_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = sub_bte_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_lng:
 				nils = sub_bte_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = sub_bte_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_bte_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2354,29 +3005,29 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = sub_bte_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = sub_bte_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = sub_bte_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = sub_bte_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_bte_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2388,24 +3039,24 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = sub_bte_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = sub_bte_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_bte_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_bte_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2417,19 +3068,19 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = sub_bte_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_bte_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_bte_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2441,13 +3092,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_bte_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_bte_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2458,7 +3109,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_bte_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -2476,29 +3127,29 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = sub_sht_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = sub_sht_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = sub_sht_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = sub_sht_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_sht_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2510,29 +3161,29 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = sub_sht_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = sub_sht_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = sub_sht_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = sub_sht_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_sht_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2544,24 +3195,24 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = sub_sht_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = sub_sht_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_sht_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_sht_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2573,19 +3224,19 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = sub_sht_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_sht_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_sht_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2597,13 +3248,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_sht_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_sht_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2614,7 +3265,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_sht_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -2632,24 +3283,24 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = sub_int_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = sub_int_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_int_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_int_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2661,24 +3312,24 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = sub_int_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = sub_int_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_int_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_int_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2690,24 +3341,24 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = sub_int_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = sub_int_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_int_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_int_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2719,19 +3370,19 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = sub_int_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_int_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_int_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2743,13 +3394,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_int_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_int_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2760,7 +3411,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_int_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -2778,19 +3429,19 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = sub_lng_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_lng_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_lng_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2802,19 +3453,19 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = sub_lng_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_lng_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_lng_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2826,19 +3477,19 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = sub_lng_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_lng_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_lng_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2850,19 +3501,26 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = sub_lng_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = sub_lng_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = sub_lng_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
+				break;
+#endif
+#ifdef HAVE_HGE
+			case TYPE_hge:
+				nils = sub_lng_lng_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -2874,13 +3532,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_lng_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_lng_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2891,17 +3549,63 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_lng_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = sub_lng_hge_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
 				goto unsupported;
 			}
 			break;
+#endif
 		default:
 			goto unsupported;
 		}
 		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		switch (ATOMstorage(tp2)) {
+		case TYPE_lng:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = sub_hge_lng_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+		case TYPE_hge:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = sub_hge_hge_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+#endif
 	case TYPE_flt:
 		switch (ATOMstorage(tp2)) {
 		case TYPE_bte:
@@ -2909,13 +3613,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_flt_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_flt_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2926,13 +3630,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_flt_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_flt_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2943,13 +3647,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_flt_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_flt_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2960,13 +3664,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_flt_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_flt_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2977,13 +3681,13 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = sub_flt_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = sub_flt_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -2994,7 +3698,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_flt_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3012,7 +3716,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_dbl_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3024,7 +3728,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_dbl_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3036,7 +3740,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_dbl_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3048,7 +3752,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_dbl_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3060,7 +3764,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_dbl_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3072,7 +3776,7 @@ sub_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = sub_dbl_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3101,7 +3805,7 @@ BATcalcsub(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcsub");
 	BATcheck(b2, "BATcalcsub");
@@ -3115,12 +3819,14 @@ BATcalcsub(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = sub_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
-				  Tloc(b2, b2->U->first), b2->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b1->H->seq,
-				  abort_on_error, "BATcalcsub");
+	nils = calc_blocked(sub_typeswitchloop, '-',
+			    b1->T->nonil && b2->T->nonil,
+			    Tloc(b1, b1->U->first), b1->T->type, 1,
+			    Tloc(b2, b2->U->first), b2->T->type, 1,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b1->H->seq,
+			    abort_on_error, "BATcalcsub");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -3145,7 +3851,7 @@ BATcalcsubcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcsubcst");
 
@@ -3158,12 +3864,14 @@ BATcalcsubcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = sub_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  VALptr(v), v->vtype, 0,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcsubcst");
+	nils = calc_blocked(sub_typeswitchloop, '-',
+			    b->T->nonil && !VALisnil(v),
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    VALptr(v), v->vtype, 0,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalcsubcst");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -3193,7 +3901,7 @@ BATcalccstsub(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstsub");
 
@@ -3206,12 +3914,14 @@ BATcalccstsub(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = sub_typeswitchloop(VALptr(v), v->vtype, 0,
-				  Tloc(b, b->U->first), b->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalccstsub");
+	nils = calc_blocked(sub_typeswitchloop, '-',
+			    b->T->nonil && !VALisnil(v),
+			    VALptr(v), v->vtype, 0,
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalccstsub");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -3240,11 +3950,8 @@ int
 VARcalcsub(ValPtr ret, const ValRecord *lft, const ValRecord *rgt,
 	   int abort_on_error)
 {
-	if (sub_typeswitchloop(VALptr(lft), lft->vtype, 0,
-			       VALptr(rgt), rgt->vtype, 0,
-			       VALget(ret), ret->vtype, 1,
-			       0, 1, NULL, NULL, 0,
-			       abort_on_error, "VARcalcsub") == BUN_NONE)
+	if (calc_values(sub_typeswitchloop, ret, lft, rgt,
+			abort_on_error, "VARcalcsub") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
 }
@@ -3255,7 +3962,7 @@ BATcalcdecr(BAT *b, BAT *s, int abort_on_error)
 	BAT *bn;
 	BUN nils= 0;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 	bte one = 1;
 
 	BATcheck(b, "BATcalcdecr");
@@ -3268,12 +3975,14 @@ BATcalcdecr(BAT *b, BAT *s, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = sub_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  &one, TYPE_bte, 0,
-				  Tloc(bn, bn->U->first), bn->T->type,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcdecr");
+	nils = calc_blocked(sub_typeswitchloop, '-',
+			    b->T->nonil,
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    &one, TYPE_bte, 0,
+			    Tloc(bn, bn->U->first), bn->T->type,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalcdecr");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -3314,7 +4023,7 @@ VARcalcdecr(ValPtr ret, const ValRecord *v, int abort_on_error)
 	if (sub_typeswitchloop(VALptr(v), v->vtype, 0,
 			       &one, TYPE_bte, 0,
 			       VALget(ret), ret->vtype, 1,
-			       0, 1, NULL, NULL, 0,
+			       0, 1, NULL, 0,
 			       abort_on_error, "VARcalcdecr") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
@@ -3330,8 +4039,7 @@ static BUN								\
 mul_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff,	\
+				BUN end, CandIter *ci, oid candoff,	\
 				int abort_on_error)			\
 {									\
 	BUN i, j, k;							\
@@ -3361,8 +4069,7 @@ static BUN								\
 mul_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff)	\
+				BUN end, CandIter *ci, oid candoff)	\
 {									\
 	BUN i, j, k;							\
 	BUN nils = 0;							\
@@ -3382,6 +4089,37 @@ mul_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 	return nils;							\
 }
 
+#ifdef HAVE_HGE
+#define MUL_2TYPE_hge(TYPE1, TYPE2)					\
+static BUN								\
+mul_##TYPE1##_##TYPE2##_hge(const TYPE1 *lft, int incr1,		\
+			    const TYPE2 *rgt, int incr2,		\
+			    hge *dst, BUN cnt, BUN start,		\
+			    BUN end, CandIter *ci, oid candoff,		\
+			    int abort_on_error)				\
+{									\
+	BUN i, j, k;							\
+	BUN nils = 0;							\
+									\
+	CANDLOOP(dst, k, hge_nil, 0, start);				\
+	for (i = start * incr1, j = start * incr2, k = start;		\
+	     k < end; i += incr1, j += incr2, k++) {			\
+		CHECKCAND(dst, k, candoff, hge_nil);			\
+		if (lft[i] == TYPE1##_nil || rgt[j] == TYPE2##_nil) {	\
+			dst[k] = hge_nil;				\
+			nils++;						\
+		} else {						\
+			HGEMUL_CHECK(TYPE1, lft[i],			\
+				     TYPE2, rgt[j],			\
+				     dst[k],				\
+				     ON_OVERFLOW(TYPE1, TYPE2, "*"));	\
+		}							\
+	}								\
+	CANDLOOP(dst, k, hge_nil, end, cnt);				\
+	return nils;							\
+}
+#endif
+
 #ifdef HAVE__MUL128
 #include <intrin.h>
 #pragma intrinsic(_mul128)
@@ -3391,8 +4129,7 @@ static BUN								\
 mul_##TYPE1##_##TYPE2##_lng(const TYPE1 *lft, int incr1,		\
 			    const TYPE2 *rgt, int incr2,		\
 			    lng *dst, BUN cnt, BUN start,		\
-			    BUN end, const oid *cand,			\
-			    const oid *candend, oid candoff,		\
+			    BUN end, CandIter *ci, oid candoff,		\
 			    int abort_on_error)				\
 {									\
 	BUN i, j, k;							\
@@ -3429,8 +4166,7 @@ static BUN								\
 mul_##TYPE1##_##TYPE2##_lng(const TYPE1 *lft, int incr1,		\
 			    const TYPE2 *rgt, int incr2,		\
 			    lng *dst, BUN cnt, BUN start,		\
-			    BUN end, const oid *cand,			\
-			    const oid *candend, oid candoff,		\
+			    BUN end, CandIter *ci, oid candoff,		\
 			    int abort_on_error)				\
 {									\
 	BUN i, j, k;							\
@@ -3460,8 +4196,7 @@ static BUN								\
 mul_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff,	\
+				BUN end, CandIter *ci, oid candoff,	\
 				int abort_on_error)			\
 {									\
 	BUN i, j, k;							\
@@ -3642,13 +4377,19 @@ MUL_2TYPE_float(dbl, int, dbl)
 MUL_2TYPE_float(dbl, lng, dbl)
 MUL_2TYPE_float(dbl, flt, dbl)
 MUL_2TYPE_float(dbl, dbl, dbl)
+#ifdef HAVE_HGE
+/* the product of two lng values always fits in a hge */
+MUL_3TYPE_enlarge(lng, lng, hge)
+MUL_2TYPE_hge(lng, hge)
+MUL_2TYPE_hge(hge, lng)
+MUL_2TYPE_hge(hge, hge)
+#endif
 
 static BUN
 mul_typeswitchloop(const void *lft, int tp1, int incr1,
 		   const void *rgt, int tp2, int incr2,
 		   void *dst, int tp, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int abort_on_error, const char *func)
 {
 	BUN nils;
@@ -3661,34 +4402,34 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = mul_bte_bte_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_sht:
 				nils = mul_bte_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = mul_bte_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_lng:
 				nils = mul_bte_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = mul_bte_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_bte_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -3700,29 +4441,29 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = mul_bte_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mul_bte_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = mul_bte_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = mul_bte_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_bte_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -3734,24 +4475,24 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = mul_bte_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mul_bte_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_bte_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_bte_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -3763,19 +4504,19 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = mul_bte_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_bte_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_bte_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -3787,13 +4528,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_bte_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_bte_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -3804,7 +4545,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_bte_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3822,29 +4563,29 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = mul_sht_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mul_sht_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = mul_sht_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = mul_sht_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_sht_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -3856,29 +4597,29 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = mul_sht_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mul_sht_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = mul_sht_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_flt:
 				nils = mul_sht_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_sht_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -3890,24 +4631,24 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = mul_sht_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mul_sht_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_sht_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_sht_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -3919,19 +4660,19 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = mul_sht_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_sht_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_sht_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -3943,13 +4684,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_sht_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_sht_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -3960,7 +4701,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_sht_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -3978,24 +4719,24 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = mul_int_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mul_int_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_int_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_int_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -4007,24 +4748,24 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = mul_int_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mul_int_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_int_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_int_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -4036,24 +4777,24 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = mul_int_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mul_int_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_int_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_int_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -4065,19 +4806,19 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = mul_int_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_int_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_int_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -4089,13 +4830,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_int_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_int_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -4106,7 +4847,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_int_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4124,19 +4865,19 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = mul_lng_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_lng_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_lng_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -4148,19 +4889,19 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = mul_lng_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_lng_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_lng_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -4172,19 +4913,19 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = mul_lng_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_lng_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_lng_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -4196,19 +4937,26 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = mul_lng_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_flt:
 				nils = mul_lng_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			case TYPE_dbl:
 				nils = mul_lng_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
+				break;
+#endif
+#ifdef HAVE_HGE
+			case TYPE_hge:
+				nils = mul_lng_lng_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff);
 				break;
 #endif
 			default:
@@ -4220,13 +4968,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_lng_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_lng_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -4237,17 +4985,63 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_lng_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = mul_lng_hge_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
 				goto unsupported;
 			}
 			break;
+#endif
 		default:
 			goto unsupported;
 		}
 		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		switch (ATOMstorage(tp2)) {
+		case TYPE_lng:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = mul_hge_lng_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+		case TYPE_hge:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = mul_hge_hge_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+#endif
 	case TYPE_flt:
 		switch (ATOMstorage(tp2)) {
 		case TYPE_bte:
@@ -4255,13 +5049,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_flt_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_flt_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -4272,13 +5066,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_flt_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_flt_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -4289,13 +5083,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_flt_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_flt_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -4306,13 +5100,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_flt_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_flt_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -4323,13 +5117,13 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mul_flt_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = mul_flt_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff);
+						       ci, candoff);
 				break;
 			default:
 				goto unsupported;
@@ -4340,7 +5134,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_flt_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4358,7 +5152,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_dbl_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4370,7 +5164,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_dbl_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4382,7 +5176,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_dbl_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4394,7 +5188,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_dbl_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4406,7 +5200,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_dbl_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4418,7 +5212,7 @@ mul_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mul_dbl_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4447,7 +5241,7 @@ BATcalcmul(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcmul");
 	BATcheck(b2, "BATcalcmul");
@@ -4461,12 +5255,14 @@ BATcalcmul(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = mul_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
-				  Tloc(b2, b2->U->first), b2->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b1->H->seq,
-				  abort_on_error, "BATcalcmul");
+	nils = calc_blocked(mul_typeswitchloop, '*',
+			    b1->T->nonil && b2->T->nonil,
+			    Tloc(b1, b1->U->first), b1->T->type, 1,
+			    Tloc(b2, b2->U->first), b2->T->type, 1,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b1->H->seq,
+			    abort_on_error, "BATcalcmul");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -4491,7 +5287,7 @@ BATcalcmulcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcmulcst");
 
@@ -4504,12 +5300,14 @@ BATcalcmulcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = mul_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  VALptr(v), v->vtype, 0,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcmulcst");
+	nils = calc_blocked(mul_typeswitchloop, '*',
+			    b->T->nonil && !VALisnil(v),
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    VALptr(v), v->vtype, 0,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalcmulcst");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -4549,7 +5347,7 @@ BATcalccstmul(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstmul");
 
@@ -4562,12 +5360,14 @@ BATcalccstmul(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = mul_typeswitchloop(VALptr(v), v->vtype, 0,
-				  Tloc(b, b->U->first), b->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalccstmul");
+	nils = calc_blocked(mul_typeswitchloop, '*',
+			    b->T->nonil && !VALisnil(v),
+			    VALptr(v), v->vtype, 0,
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalccstmul");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -4605,11 +5405,8 @@ int
 VARcalcmul(ValPtr ret, const ValRecord *lft, const ValRecord *rgt,
 	   int abort_on_error)
 {
-	if (mul_typeswitchloop(VALptr(lft), lft->vtype, 0,
-			       VALptr(rgt), rgt->vtype, 0,
-			       VALget(ret), ret->vtype, 1,
-			       0, 1, NULL, NULL, 0,
-			       abort_on_error, "VARcalcmul") == BUN_NONE)
+	if (calc_values(mul_typeswitchloop, ret, lft, rgt,
+			abort_on_error, "VARcalcmul") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
 }
@@ -4622,8 +5419,7 @@ static BUN								\
 div_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff,	\
+				BUN end, CandIter *ci, oid candoff,	\
 				int abort_on_error)			\
 {									\
 	BUN i, j, k;							\
@@ -4654,8 +5450,7 @@ static BUN								\
 div_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff,	\
+				BUN end, CandIter *ci, oid candoff,	\
 				int abort_on_error)			\
 {									\
 	BUN i, j, k;							\
@@ -4812,13 +5607,17 @@ DIV_3TYPE(dbl, int, dbl)
 DIV_3TYPE(dbl, lng, dbl)
 DIV_3TYPE_float(dbl, flt, dbl)
 DIV_3TYPE_float(dbl, dbl, dbl)
+#ifdef HAVE_HGE
+DIV_3TYPE(lng, hge, hge)
+DIV_3TYPE(hge, lng, hge)
+DIV_3TYPE(hge, hge, hge)
+#endif
 
 static BUN
 div_typeswitchloop(const void *lft, int tp1, int incr1,
 		   const void *rgt, int tp2, int incr2,
 		   void *dst, int tp, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int abort_on_error, const char *func)
 {
 	BUN nils;
@@ -4831,39 +5630,39 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = div_bte_bte_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = div_bte_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = div_bte_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = div_bte_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_bte_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_bte_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4875,39 +5674,39 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = div_bte_sht_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = div_bte_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = div_bte_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = div_bte_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_bte_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_bte_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4919,39 +5718,39 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = div_bte_int_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = div_bte_int_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = div_bte_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = div_bte_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_bte_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_bte_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -4963,39 +5762,39 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = div_bte_lng_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = div_bte_lng_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = div_bte_lng_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = div_bte_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_bte_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_bte_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5007,13 +5806,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_bte_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_bte_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5025,7 +5824,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_bte_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5043,33 +5842,33 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = div_sht_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = div_sht_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = div_sht_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_sht_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_sht_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5081,33 +5880,33 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = div_sht_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = div_sht_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = div_sht_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_sht_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_sht_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5119,33 +5918,33 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = div_sht_int_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = div_sht_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = div_sht_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_sht_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_sht_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5157,33 +5956,33 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = div_sht_lng_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = div_sht_lng_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = div_sht_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_sht_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_sht_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5195,13 +5994,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_sht_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_sht_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5213,7 +6012,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_sht_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5231,27 +6030,27 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = div_int_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = div_int_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_int_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_int_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5263,27 +6062,27 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = div_int_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = div_int_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_int_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_int_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5295,27 +6094,27 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = div_int_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = div_int_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_int_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_int_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5327,27 +6126,27 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = div_int_lng_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = div_int_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
 			case TYPE_flt:
 				nils = div_int_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_int_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5359,13 +6158,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_int_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_int_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5377,7 +6176,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_int_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5395,19 +6194,19 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = div_lng_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_flt:
 				nils = div_lng_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_lng_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5419,19 +6218,19 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = div_lng_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_flt:
 				nils = div_lng_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_lng_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5443,19 +6242,19 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = div_lng_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_flt:
 				nils = div_lng_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_lng_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5467,19 +6266,19 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = div_lng_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_flt:
 				nils = div_lng_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_lng_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5491,13 +6290,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_lng_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_lng_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5509,17 +6308,63 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_lng_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
 				goto unsupported;
 			}
 			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = div_lng_hge_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+#endif
 		default:
 			goto unsupported;
 		}
 		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		switch (ATOMstorage(tp2)) {
+		case TYPE_lng:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = div_hge_lng_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+		case TYPE_hge:
+			switch (ATOMstorage(tp)) {
+			case TYPE_hge:
+				nils = div_hge_hge_hge(lft, incr1, rgt, incr2,
+						       dst, cnt, start, end,
+						       ci, candoff,
+						       abort_on_error);
+				break;
+			default:
+				goto unsupported;
+			}
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+#endif
 	case TYPE_flt:
 		switch (ATOMstorage(tp2)) {
 		case TYPE_bte:
@@ -5527,13 +6372,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_flt_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_flt_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5545,13 +6390,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_flt_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_flt_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5563,13 +6408,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_flt_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_flt_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5581,13 +6426,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_flt_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_flt_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5599,13 +6444,13 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = div_flt_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_dbl:
 				nils = div_flt_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5617,7 +6462,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_flt_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5635,7 +6480,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_dbl_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5647,7 +6492,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_dbl_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5659,7 +6504,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_dbl_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5671,7 +6516,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_dbl_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5683,7 +6528,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_dbl_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5695,7 +6540,7 @@ div_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = div_dbl_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -5727,7 +6572,7 @@ BATcalcdiv(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcdiv");
 	BATcheck(b2, "BATcalcdiv");
@@ -5741,12 +6586,14 @@ BATcalcdiv(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = div_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
-				  Tloc(b2, b2->U->first), b2->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b1->H->seq,
-				  abort_on_error, "BATcalcdiv");
+	nils = calc_blocked(div_typeswitchloop, '/',
+			    b1->T->nonil && b2->T->nonil,
+			    Tloc(b1, b1->U->first), b1->T->type, 1,
+			    Tloc(b2, b2->U->first), b2->T->type, 1,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b1->H->seq,
+			    abort_on_error, "BATcalcdiv");
 
 	if (nils >= BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -5771,7 +6618,7 @@ BATcalcdivcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcdivcst");
 
@@ -5784,12 +6631,14 @@ BATcalcdivcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = div_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  VALptr(v), v->vtype, 0,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcdivcst");
+	nils = calc_blocked(div_typeswitchloop, '/',
+			    b->T->nonil && !VALisnil(v),
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    VALptr(v), v->vtype, 0,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalcdivcst");
 
 	if (nils >= BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -5832,7 +6681,7 @@ BATcalccstdiv(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstdiv");
 
@@ -5845,12 +6694,14 @@ BATcalccstdiv(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = div_typeswitchloop(VALptr(v), v->vtype, 0,
-				  Tloc(b, b->U->first), b->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalccstdiv");
+	nils = calc_blocked(div_typeswitchloop, '/',
+			    b->T->nonil && !VALisnil(v),
+			    VALptr(v), v->vtype, 0,
+			    Tloc(b, b->U->first), b->T->type, 1,
+			    Tloc(bn, bn->U->first), tp,
+			    cnt, start, end,
+			    ci, b->H->seq,
+			    abort_on_error, "BATcalccstdiv");
 
 	if (nils >= BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -5873,11 +6724,8 @@ int
 VARcalcdiv(ValPtr ret, const ValRecord *lft, const ValRecord *rgt,
 	   int abort_on_error)
 {
-	if (div_typeswitchloop(VALptr(lft), lft->vtype, 0,
-			       VALptr(rgt), rgt->vtype, 0,
-			       VALget(ret), ret->vtype, 1,
-			       0, 1, NULL, NULL, 0,
-			       abort_on_error, "VARcalcdiv") >= BUN_NONE)
+	if (calc_values(div_typeswitchloop, ret, lft, rgt,
+			abort_on_error, "VARcalcdiv") >= BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
 }
@@ -5890,8 +6738,7 @@ static BUN								\
 mod_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff,	\
+				BUN end, CandIter *ci, oid candoff,	\
 				int abort_on_error)			\
 {									\
 	BUN i, j, k;							\
@@ -5922,8 +6769,7 @@ static BUN								\
 mod_##TYPE1##_##TYPE2##_##TYPE3(const TYPE1 *lft, int incr1,		\
 				const TYPE2 *rgt, int incr2,		\
 				TYPE3 *dst, BUN cnt, BUN start,		\
-				BUN end, const oid *cand,		\
-				const oid *candend, oid candoff,	\
+				BUN end, CandIter *ci, oid candoff,	\
 				int abort_on_error)			\
 {									\
 	BUN i, j, k;							\
@@ -6056,8 +6902,7 @@ static BUN
 mod_typeswitchloop(const void *lft, int tp1, int incr1,
 		   const void *rgt, int tp2, int incr2,
 		   void *dst, int tp, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int abort_on_error, const char *func)
 {
 	BUN nils;
@@ -6070,26 +6915,26 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = mod_bte_bte_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = mod_bte_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mod_bte_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_bte_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6102,26 +6947,26 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = mod_bte_sht_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = mod_bte_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mod_bte_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_bte_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6134,26 +6979,26 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = mod_bte_int_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = mod_bte_int_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mod_bte_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_bte_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6166,26 +7011,26 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = mod_bte_lng_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = mod_bte_lng_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mod_bte_lng_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_bte_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6198,7 +7043,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_bte_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6210,7 +7055,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_bte_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6228,26 +7073,26 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = mod_sht_bte_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = mod_sht_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mod_sht_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_sht_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6260,20 +7105,20 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = mod_sht_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = mod_sht_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_sht_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6286,20 +7131,20 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = mod_sht_int_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = mod_sht_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_sht_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6312,20 +7157,20 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = mod_sht_lng_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = mod_sht_lng_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_sht_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6338,7 +7183,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_sht_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6350,7 +7195,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_sht_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6368,26 +7213,26 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = mod_int_bte_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = mod_int_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mod_int_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_int_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6400,20 +7245,20 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = mod_int_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = mod_int_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_int_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6426,14 +7271,14 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = mod_int_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = mod_int_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6446,14 +7291,14 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = mod_int_lng_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = mod_int_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6466,7 +7311,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_int_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6478,7 +7323,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_int_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6496,26 +7341,26 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_bte:
 				nils = mod_lng_bte_bte(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_sht:
 				nils = mod_lng_bte_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_int:
 				nils = mod_lng_bte_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_lng_bte_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6528,20 +7373,20 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_sht:
 				nils = mod_lng_sht_sht(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_int:
 				nils = mod_lng_sht_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			case TYPE_lng:
 				nils = mod_lng_sht_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6554,14 +7399,14 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_int:
 				nils = mod_lng_int_int(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #ifdef FULL_IMPLEMENTATION
 			case TYPE_lng:
 				nils = mod_lng_int_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 #endif
@@ -6574,7 +7419,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_lng:
 				nils = mod_lng_lng_lng(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6586,7 +7431,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_lng_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6598,7 +7443,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_lng_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6616,7 +7461,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_flt_bte_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6628,7 +7473,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_flt_sht_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6640,7 +7485,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_flt_int_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6652,7 +7497,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_flt_lng_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6664,7 +7509,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_flt:
 				nils = mod_flt_flt_flt(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6676,7 +7521,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_flt_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6694,7 +7539,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_dbl_bte_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6706,7 +7551,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_dbl_sht_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6718,7 +7563,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_dbl_int_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6730,7 +7575,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_dbl_lng_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6742,7 +7587,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_dbl_flt_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6754,7 +7599,7 @@ mod_typeswitchloop(const void *lft, int tp1, int incr1,
 			case TYPE_dbl:
 				nils = mod_dbl_dbl_dbl(lft, incr1, rgt, incr2,
 						       dst, cnt, start, end,
-						       cand, candend, candoff,
+						       ci, candoff,
 						       abort_on_error);
 				break;
 			default:
@@ -6786,7 +7631,7 @@ BATcalcmod(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcmod");
 	BATcheck(b2, "BATcalcmod");
@@ -6804,7 +7649,7 @@ BATcalcmod(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 				  Tloc(b2, b2->U->first), b2->T->type, 1,
 				  Tloc(bn, bn->U->first), tp,
 				  cnt, start, end,
-				  cand, candend, b1->H->seq,
+				  ci, b1->H->seq,
 				  abort_on_error, "BATcalcmod");
 
 	if (nils >= BUN_NONE) {
@@ -6830,7 +7675,7 @@ BATcalcmodcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcmodcst");
 
@@ -6847,7 +7692,7 @@ BATcalcmodcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 				  VALptr(v), v->vtype, 0,
 				  Tloc(bn, bn->U->first), tp,
 				  cnt, start, end,
-				  cand, candend, b->H->seq,
+				  ci, b->H->seq,
 				  abort_on_error, "BATcalcmodcst");
 
 	if (nils >= BUN_NONE) {
@@ -6873,7 +7718,7 @@ BATcalccstmod(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstmod");
 
@@ -6890,7 +7735,7 @@ BATcalccstmod(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 				  Tloc(b, b->U->first), b->T->type, 1,
 				  Tloc(bn, bn->U->first), tp,
 				  cnt, start, end,
-				  cand, candend, b->H->seq,
+				  ci, b->H->seq,
 				  abort_on_error, "BATcalccstmod");
 
 	if (nils >= BUN_NONE) {
@@ -6917,7 +7762,7 @@ VARcalcmod(ValPtr ret, const ValRecord *lft, const ValRecord *rgt,
 	if (mod_typeswitchloop(VALptr(lft), lft->vtype, 0,
 			       VALptr(rgt), rgt->vtype, 0,
 			       VALget(ret), ret->vtype, 1,
-			       0, 1, NULL, NULL, 0,
+			       0, 1, NULL, 0,
 			       abort_on_error, "VARcalcmod") >= BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
@@ -6933,8 +7778,7 @@ static BUN
 xor_typeswitchloop(const void *lft, int incr1,
 		   const void *rgt, int incr2,
 		   void *dst, int tp, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int nonil, const char *func)
 {
 	BUN nils = 0;
@@ -6986,7 +7830,7 @@ BATcalcxor(BAT *b1, BAT *b2, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcxor");
 	BATcheck(b2, "BATcalcxor");
@@ -7009,8 +7853,8 @@ BATcalcxor(BAT *b1, BAT *b2, BAT *s)
 				  Tloc(b2, b2->U->first), 1,
 				  Tloc(bn, bn->U->first),
 				  b1->T->type, cnt,
-				  start, end, cand, candend, b1->H->seq,
-				  cand == NULL && b1->T->nonil && b2->T->nonil,
+				  start, end, ci, b1->H->seq,
+				  ci == NULL && b1->T->nonil && b2->T->nonil,
 				  "BATcalcxor");
 
 	if (nils == BUN_NONE) {
@@ -7036,7 +7880,7 @@ BATcalcxorcst(BAT *b, const ValRecord *v, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcxorcst");
 
@@ -7058,8 +7902,8 @@ BATcalcxorcst(BAT *b, const ValRecord *v, BAT *s)
 				  VALptr(v), 0,
 				  Tloc(bn, bn->U->first), b->T->type,
 				  cnt,
-				  start, end, cand, candend, b->H->seq,
-				  cand == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
+				  start, end, ci, b->H->seq,
+				  ci == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
 				  "BATcalcxorcst");
 
 	if (nils == BUN_NONE) {
@@ -7085,7 +7929,7 @@ BATcalccstxor(const ValRecord *v, BAT *b, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstxor");
 
@@ -7107,8 +7951,8 @@ BATcalccstxor(const ValRecord *v, BAT *b, BAT *s)
 				  Tloc(b, b->U->first), 1,
 				  Tloc(bn, bn->U->first), b->T->type,
 				  cnt,
-				  start, end, cand, candend, b->H->seq,
-				  cand == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
+				  start, end, ci, b->H->seq,
+				  ci == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
 				  "BATcalccstxor");
 
 	if (nils == BUN_NONE) {
@@ -7139,7 +7983,7 @@ VARcalcxor(ValPtr ret, const ValRecord *lft, const ValRecord *rgt)
 	if (xor_typeswitchloop(VALptr(lft), 0,
 			       VALptr(rgt), 0,
 			       VALget(ret), lft->vtype,
-			       1, 0, 1, NULL, NULL, 0, 0,
+			       1, 0, 1, NULL, 0, 0,
 			       "VARcalcxor") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
@@ -7154,8 +7998,7 @@ static BUN
 or_typeswitchloop(const void *lft, int incr1,
 		  const void *rgt, int incr2,
 		  void *dst, int tp, BUN cnt,
-		  BUN start, BUN end, const oid *cand,
-		  const oid *candend, oid candoff,
+		  BUN start, BUN end, CandIter *ci, oid candoff,
 		  int nonil, const char *func)
 {
 	BUN nils = 0;
@@ -7225,7 +8068,7 @@ BATcalcor(BAT *b1, BAT *b2, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcor");
 	BATcheck(b2, "BATcalcor");
@@ -7248,7 +8091,7 @@ BATcalcor(BAT *b1, BAT *b2, BAT *s)
 				 Tloc(b2, b2->U->first), 1,
 				 Tloc(bn, bn->U->first),
 				 b1->T->type, cnt,
-				 start, end, cand, candend, b1->H->seq,
+				 start, end, ci, b1->H->seq,
 				 b1->T->nonil && b2->T->nonil,
 				 "BATcalcor");
 
@@ -7275,7 +8118,7 @@ BATcalcorcst(BAT *b, const ValRecord *v, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcorcst");
 
@@ -7297,8 +8140,8 @@ BATcalcorcst(BAT *b, const ValRecord *v, BAT *s)
 				 VALptr(v), 0,
 				 Tloc(bn, bn->U->first), b->T->type,
 				 cnt,
-				 start, end, cand, candend, b->H->seq,
-				 cand == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
+				 start, end, ci, b->H->seq,
+				 ci == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
 				 "BATcalcorcst");
 
 	if (nils == BUN_NONE) {
@@ -7324,7 +8167,7 @@ BATcalccstor(const ValRecord *v, BAT *b, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstor");
 
@@ -7346,8 +8189,8 @@ BATcalccstor(const ValRecord *v, BAT *b, BAT *s)
 				 Tloc(b, b->U->first), 1,
 				 Tloc(bn, bn->U->first), b->T->type,
 				 cnt,
-				 start, end, cand, candend, b->H->seq,
-				 cand == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
+				 start, end, ci, b->H->seq,
+				 ci == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
 				 "BATcalccstor");
 
 	if (nils == BUN_NONE) {
@@ -7378,7 +8221,7 @@ VARcalcor(ValPtr ret, const ValRecord *lft, const ValRecord *rgt)
 	if (or_typeswitchloop(VALptr(lft), 0,
 			      VALptr(rgt), 0,
 			      VALget(ret), lft->vtype,
-			      1, 0, 1, NULL, NULL, 0, 0,
+			      1, 0, 1, NULL, 0, 0,
 			      "VARcalcor") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
@@ -7393,8 +8236,7 @@ static BUN
 and_typeswitchloop(const void *lft, int incr1,
 		   const void *rgt, int incr2,
 		   void *dst, int tp, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int nonil, const char *func)
 {
 	BUN nils = 0;
@@ -7461,7 +8303,7 @@ BATcalcand(BAT *b1, BAT *b2, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcand");
 	BATcheck(b2, "BATcalcand");
@@ -7484,7 +8326,7 @@ BATcalcand(BAT *b1, BAT *b2, BAT *s)
 				  Tloc(b2, b2->U->first), 1,
 				  Tloc(bn, bn->U->first),
 				  b1->T->type, cnt,
-				  start, end, cand, candend, b1->H->seq,
+				  start, end, ci, b1->H->seq,
 				  b1->T->nonil && b2->T->nonil,
 				  "BATcalcand");
 
@@ -7511,7 +8353,7 @@ BATcalcandcst(BAT *b, const ValRecord *v, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcandcst");
 
@@ -7532,7 +8374,7 @@ BATcalcandcst(BAT *b, const ValRecord *v, BAT *s)
 	nils = and_typeswitchloop(Tloc(b, b->U->first), 1,
 				  VALptr(v), 0,
 				  Tloc(bn, bn->U->first), b->T->type,
-				  cnt, start, end, cand, candend, b->H->seq,
+				  cnt, start, end, ci, b->H->seq,
 				  b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
 				  "BATcalcandcst");
 
@@ -7559,7 +8401,7 @@ BATcalccstand(const ValRecord *v, BAT *b, BAT *s)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstand");
 
@@ -7580,7 +8422,7 @@ BATcalccstand(const ValRecord *v, BAT *b, BAT *s)
 	nils = and_typeswitchloop(VALptr(v), 0,
 				  Tloc(b, b->U->first), 1,
 				  Tloc(bn, bn->U->first), b->T->type,
-				  cnt, start, end, cand, candend, b->H->seq,
+				  cnt, start, end, ci, b->H->seq,
 				  b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
 				  "BATcalccstand");
 
@@ -7612,7 +8454,7 @@ VARcalcand(ValPtr ret, const ValRecord *lft, const ValRecord *rgt)
 	if (and_typeswitchloop(VALptr(lft), 0,
 			       VALptr(rgt), 0,
 			       VALget(ret), lft->vtype,
-			       1, 0, 1, NULL, NULL, 0, 0,
+			       1, 0, 1, NULL, 0, 0,
 			       "VARcalcand") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
@@ -7629,8 +8471,7 @@ static BUN
 lsh_typeswitchloop(const void *lft, int tp1, int incr1,
 		   const void *rgt, int tp2, int incr2,
 		   void *dst, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int abort_on_error, const char *func)
 {
 	BUN nils = 0;
@@ -7744,7 +8585,7 @@ BATcalclsh(BAT *b1, BAT *b2, BAT *s, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalclsh");
 	BATcheck(b2, "BATcalclsh");
@@ -7761,7 +8602,7 @@ BATcalclsh(BAT *b1, BAT *b2, BAT *s, int abort_on_error)
 	nils = lsh_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
 				  Tloc(b2, b2->U->first), b2->T->type, 1,
 				  Tloc(bn, bn->U->first),
-				  cnt, start, end, cand, candend, b1->H->seq,
+				  cnt, start, end, ci, b1->H->seq,
 				  abort_on_error, "BATcalclsh");
 
 	if (nils == BUN_NONE) {
@@ -7787,7 +8628,7 @@ BATcalclshcst(BAT *b, const ValRecord *v, BAT *s, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalclshcst");
 
@@ -7803,7 +8644,7 @@ BATcalclshcst(BAT *b, const ValRecord *v, BAT *s, int abort_on_error)
 	nils = lsh_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
 				  VALptr(v), v->vtype, 0,
 				  Tloc(bn, bn->U->first),
-				  cnt, start, end, cand, candend, b->H->seq,
+				  cnt, start, end, ci, b->H->seq,
 				  abort_on_error, "BATcalclshcst");
 
 	if (nils == BUN_NONE) {
@@ -7829,7 +8670,7 @@ BATcalccstlsh(const ValRecord *v, BAT *b, BAT *s, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstlsh");
 
@@ -7845,7 +8686,7 @@ BATcalccstlsh(const ValRecord *v, BAT *b, BAT *s, int abort_on_error)
 	nils = lsh_typeswitchloop(VALptr(v), v->vtype, 0,
 				  Tloc(b, b->U->first), b->T->type, 1,
 				  Tloc(bn, bn->U->first),
-				  cnt, start, end, cand, candend, b->H->seq,
+				  cnt, start, end, ci, b->H->seq,
 				  abort_on_error, "BATcalccstlsh");
 
 	if (nils == BUN_NONE) {
@@ -7872,7 +8713,7 @@ VARcalclsh(ValPtr ret, const ValRecord *lft, const ValRecord *rgt,
 	ret->vtype = lft->vtype;
 	if (lsh_typeswitchloop(VALptr(lft), lft->vtype, 0,
 			       VALptr(rgt), rgt->vtype, 0,
-			       VALget(ret), 1, 0, 1, NULL, NULL, 0,
+			       VALget(ret), 1, 0, 1, NULL, 0,
 			       abort_on_error, "VARcalclsh") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
@@ -7887,8 +8728,7 @@ static BUN
 rsh_typeswitchloop(const void *lft, int tp1, int incr1,
 		   const void *rgt, int tp2, int incr2,
 		   void *dst, BUN cnt,
-		   BUN start, BUN end, const oid *cand,
-		   const oid *candend, oid candoff,
+		   BUN start, BUN end, CandIter *ci, oid candoff,
 		   int abort_on_error, const char *func)
 {
 	BUN nils = 0;
@@ -8002,7 +8842,7 @@ BATcalcrsh(BAT *b1, BAT *b2, BAT *s, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, "BATcalcrsh");
 	BATcheck(b2, "BATcalcrsh");
@@ -8019,7 +8859,7 @@ BATcalcrsh(BAT *b1, BAT *b2, BAT *s, int abort_on_error)
 	nils = rsh_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
 				  Tloc(b2, b2->U->first), b2->T->type, 1,
 				  Tloc(bn, bn->U->first),
-				  cnt, start, end, cand, candend, b1->H->seq,
+				  cnt, start, end, ci, b1->H->seq,
 				  abort_on_error, "BATcalcrsh");
 
 	if (nils == BUN_NONE) {
@@ -8045,7 +8885,7 @@ BATcalcrshcst(BAT *b, const ValRecord *v, BAT *s, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcrshcst");
 
@@ -8061,7 +8901,7 @@ BATcalcrshcst(BAT *b, const ValRecord *v, BAT *s, int abort_on_error)
 	nils = rsh_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
 				  VALptr(v), v->vtype, 0,
 				  Tloc(bn, bn->U->first),
-				  cnt, start, end, cand, candend, b->H->seq,
+				  cnt, start, end, ci, b->H->seq,
 				  abort_on_error, "BATcalcrshcst");
 
 	if (nils == BUN_NONE) {
@@ -8087,7 +8927,7 @@ BATcalccstrsh(const ValRecord *v, BAT *b, BAT *s, int abort_on_error)
 	BAT *bn;
 	BUN nils;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalccstrsh");
 
@@ -8103,7 +8943,7 @@ BATcalccstrsh(const ValRecord *v, BAT *b, BAT *s, int abort_on_error)
 	nils = rsh_typeswitchloop(VALptr(v), v->vtype, 0,
 				  Tloc(b, b->U->first), b->T->type, 1,
 				  Tloc(bn, bn->U->first),
-				  cnt, start, end, cand, candend, b->H->seq,
+				  cnt, start, end, ci, b->H->seq,
 				  abort_on_error, "BATcalccstrsh");
 
 	if (nils == BUN_NONE) {
@@ -8130,7 +8970,7 @@ VARcalcrsh(ValPtr ret, const ValRecord *lft, const ValRecord *rgt,
 	ret->vtype = lft->vtype;
 	if (rsh_typeswitchloop(VALptr(lft), lft->vtype, 0,
 			       VALptr(rgt), rgt->vtype, 0,
-			       VALget(ret), 1, 0, 1, NULL, NULL, 0,
+			       VALget(ret), 1, 0, 1, NULL, 0,
 			       abort_on_error, "VARcalcrsh") == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
@@ -8395,8 +9235,8 @@ static BAT *
 BATcalcbetween_intern(const void *src, int incr1, const char *hp1, int wd1,
 		      const void *lo, int incr2, const char *hp2, int wd2,
 		      const void *hi, int incr3, const char *hp3, int wd3,
-		      int tp, BUN cnt, BUN start, BUN end, const oid *cand,
-		      const oid *candend, oid seqbase,
+		      int tp, BUN cnt, BUN start, BUN end, CandIter *ci,
+		      oid seqbase,
 		      const char *func)
 {
 	BAT *bn;
@@ -8498,7 +9338,7 @@ BATcalcbetween(BAT *b, BAT *lo, BAT *hi, BAT *s)
 {
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcbetween");
 	BATcheck(lo, "BATcalcbetween");
@@ -8538,7 +9378,7 @@ BATcalcbetween(BAT *b, BAT *lo, BAT *hi, BAT *s)
 				   hi->T->vheap ? hi->T->vheap->base : NULL,
 				   hi->T->width,
 				   b->T->type, cnt,
-				   start, end, cand, candend,
+				   start, end, ci,
 				   b->H->seq, "BATcalcbetween");
 
 	return bn;
@@ -8549,7 +9389,7 @@ BATcalcbetweencstcst(BAT *b, const ValRecord *lo, const ValRecord *hi, BAT *s)
 {
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcbetweencstcst");
 
@@ -8570,7 +9410,7 @@ BATcalcbetweencstcst(BAT *b, const ValRecord *lo, const ValRecord *hi, BAT *s)
 				   VALptr(lo), 0, NULL, 0,
 				   VALptr(hi), 0, NULL, 0,
 				   b->T->type, cnt,
-				   start, end, cand, candend,
+				   start, end, ci,
 				   b->H->seq, "BATcalcbetweencstcst");
 
 	return bn;
@@ -8581,7 +9421,7 @@ BATcalcbetweenbatcst(BAT *b, BAT *lo, const ValRecord *hi, BAT *s)
 {
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcbetweenbatcst");
 
@@ -8603,7 +9443,7 @@ BATcalcbetweenbatcst(BAT *b, BAT *lo, const ValRecord *hi, BAT *s)
 				   lo->T->width,
 				   VALptr(hi), 0, NULL, 0,
 				   b->T->type, cnt,
-				   start, end, cand, candend,
+				   start, end, ci,
 				   b->H->seq, "BATcalcbetweenbatcst");
 
 	return bn;
@@ -8614,7 +9454,7 @@ BATcalcbetweencstbat(BAT *b, const ValRecord *lo, BAT *hi, BAT *s)
 {
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, "BATcalcbetweencstbat");
 
@@ -8636,7 +9476,7 @@ BATcalcbetweencstbat(BAT *b, const ValRecord *lo, BAT *hi, BAT *s)
 				   hi->T->vheap ? hi->T->vheap->base : NULL,
 				   hi->T->width,
 				   b->T->type, cnt,
-				   start, end, cand, candend,
+				   start, end, ci,
 				   b->H->seq, "BATcalcbetweencstbat");
 
 	return bn;
@@ -8927,8 +9767,8 @@ BATcalcifthencstelsecst(BAT *b, const ValRecord *c1, const ValRecord *c2)
 #define convertimpl_copy(TYPE)					\
 static BUN							\
 convert_##TYPE##_##TYPE(const TYPE *src, TYPE *dst, BUN cnt,	\
-			BUN start, BUN end, const oid *cand,	\
-			const oid *candend, oid candoff)	\
+			BUN start, BUN end, CandIter *ci,		\
+			oid candoff)					\
 {								\
 	BUN i, nils = 0;					\
 								\
@@ -8945,8 +9785,8 @@ convert_##TYPE##_##TYPE(const TYPE *src, TYPE *dst, BUN cnt,	\
 #define convertimpl_enlarge(TYPE1, TYPE2)				\
 static BUN								\
 convert_##TYPE1##_##TYPE2(const TYPE1 *src, TYPE2 *dst, BUN cnt,	\
-			  BUN start, BUN end, const oid *cand,		\
-			  const oid *candend, oid candoff)		\
+			  BUN start, BUN end, CandIter *ci,		\
+			  oid candoff)					\
 {									\
 	BUN i, nils = 0;						\
 									\
@@ -8968,15 +9808,14 @@ convert_##TYPE1##_##TYPE2(const TYPE1 *src, TYPE2 *dst, BUN cnt,	\
 #define CONV_OVERFLOW(TYPE1, TYPE2, value)				\
 	do {								\
 		GDKerror("22003!overflow in conversion of "		\
-			 FMT##TYPE1 " to %s.\n", (value), TYPE2);	\
+			 FMT##TYPE1 " to %s.\n", CST##TYPE1 (value), TYPE2); \
 		return BUN_NONE;					\
 	} while (0)
 
 #define convertimpl_oid_enlarge(TYPE1)					\
 static BUN								\
 convert_##TYPE1##_oid(const TYPE1 *src, oid *dst, BUN cnt,		\
-		      BUN start, BUN end, const oid *cand,		\
-		      const oid *candend, oid candoff,			\
+		      BUN start, BUN end, CandIter *ci, oid candoff,	\
 		      int abort_on_error)				\
 {									\
 	BUN i, nils = 0;						\
@@ -9005,8 +9844,7 @@ convert_##TYPE1##_oid(const TYPE1 *src, oid *dst, BUN cnt,		\
 #define convertimpl_oid_reduce(TYPE1)					\
 static BUN								\
 convert_##TYPE1##_oid(const TYPE1 *src, oid *dst, BUN cnt,		\
-		      BUN start, BUN end, const oid *cand,		\
-		      const oid *candend, oid candoff,			\
+		      BUN start, BUN end, CandIter *ci, oid candoff,	\
 		      int abort_on_error)				\
 {									\
 	BUN i, nils = 0;						\
@@ -9036,8 +9874,8 @@ convert_##TYPE1##_oid(const TYPE1 *src, oid *dst, BUN cnt,		\
 #define convertimpl_reduce(TYPE1, TYPE2)				\
 static BUN								\
 convert_##TYPE1##_##TYPE2(const TYPE1 *src, TYPE2 *dst, BUN cnt,	\
-			  BUN start, BUN end, const oid *cand,		\
-			  const oid *candend, oid candoff,		\
+			  BUN start, BUN end, CandIter *ci,		\
+			  oid candoff,					\
 			  int abort_on_error)				\
 {									\
 	BUN i, nils = 0;						\
@@ -9069,8 +9907,8 @@ convert_##TYPE1##_##TYPE2(const TYPE1 *src, TYPE2 *dst, BUN cnt,	\
 #define convertimpl_reduce_float(TYPE1, TYPE2)				\
 static BUN								\
 convert_##TYPE1##_##TYPE2(const TYPE1 *src, TYPE2 *dst, BUN cnt,	\
-			  BUN start, BUN end, const oid *cand,		\
-			  const oid *candend, oid candoff,		\
+			  BUN start, BUN end, CandIter *ci,		\
+			  oid candoff,					\
 			  int abort_on_error)				\
 {									\
 	BUN i, nils = 0;						\
@@ -9100,8 +9938,8 @@ convert_##TYPE1##_##TYPE2(const TYPE1 *src, TYPE2 *dst, BUN cnt,	\
 #define convert2bit_impl(TYPE)					\
 static BUN							\
 convert_##TYPE##_bit(const TYPE *src, bit *dst, BUN cnt,	\
-		     BUN start, BUN end, const oid *cand,	\
-		     const oid *candend, oid candoff)		\
+		     BUN start, BUN end, CandIter *ci,			\
+		     oid candoff)					\
 {								\
 	BUN i, nils = 0;					\
 								\
@@ -9179,10 +10017,26 @@ convert2bit_impl(lng)
 convert2bit_impl(flt)
 convert2bit_impl(dbl)
 
+#ifdef HAVE_HGE
+convertimpl_enlarge(bte, hge)
+convertimpl_enlarge(sht, hge)
+convertimpl_enlarge(int, hge)
+convertimpl_enlarge(lng, hge)
+convertimpl_reduce(hge, bte)
+convertimpl_reduce(hge, sht)
+convertimpl_reduce(hge, int)
+convertimpl_reduce(hge, lng)
+convertimpl_copy(hge)
+convertimpl_enlarge(hge, flt)
+convertimpl_enlarge(hge, dbl)
+convertimpl_reduce_float(flt, hge)
+convertimpl_reduce_float(dbl, hge)
+convert2bit_impl(hge)
+#endif
+
 static BUN
 convert_any_str(int tp, const void *src, BAT *bn, BUN cnt,
-		BUN start, BUN end, const oid *cand,
-		const oid *candend, oid candoff)
+		BUN start, BUN end, CandIter *ci, oid candoff)
 {
 	str dst = 0;
 	int len = 0;
@@ -9195,14 +10049,15 @@ convert_any_str(int tp, const void *src, BAT *bn, BUN cnt,
 	for (i = 0; i < start; i++)
 		tfastins_nocheck(bn, i, str_nil, bn->T->width);
 	for (i = start; i < end; i++) {
-		if (cand) {
-			if (i < *cand - candoff) {
+		if (ci) {
+			if (i < ci->next - candoff) {
 				nils++;
 				tfastins_nocheck(bn, i, str_nil, bn->T->width);
 				continue;
 			}
-			assert(i == *cand - candoff);
-			if (++cand == candend)
+			assert(i == ci->next - candoff);
+			CANDiternext(ci);
+			if (ci->next == oid_nil)
 				end = i + 1;
 		}
 		(*atomtostr)(&dst, &len, src);
@@ -9225,8 +10080,8 @@ convert_any_str(int tp, const void *src, BAT *bn, BUN cnt,
 
 static BUN
 convert_str_any(BAT *b, int tp, void *dst,
-		BUN start, BUN end, const oid *cand,
-		const oid *candend, oid candoff, int abort_on_error)
+		BUN start, BUN end, CandIter *ci,
+		oid candoff, int abort_on_error)
 {
 	BUN i, cnt = BATcount(b);
 	BUN nils = 0;
@@ -9243,14 +10098,15 @@ convert_str_any(BAT *b, int tp, void *dst,
 	}
 	nils += start;
 	for (i = start; i < end; i++, dst = (void *) ((char *) dst + len)) {
-		if (cand) {
-			if (i < *cand - candoff) {
+		if (ci) {
+			if (i < ci->next - candoff) {
 				nils++;
 				memcpy(dst, nil, len);
 				continue;
 			}
-			assert(i == *cand - candoff);
-			if (++cand == candend)
+			assert(i == ci->next - candoff);
+			CANDiternext(ci);
+			if (ci->next == oid_nil)
 				end = i + 1;
 		}
 		s = BUNtail(bi, i);
@@ -9283,8 +10139,8 @@ convert_str_any(BAT *b, int tp, void *dst,
 
 static BUN
 convert_void_any(oid seq, BUN cnt, BAT *bn,
-		 BUN start, BUN end, const oid *cand,
-		 const oid *candend, oid candoff, int abort_on_error)
+		 BUN start, BUN end, CandIter *ci,
+		 oid candoff, int abort_on_error)
 {
 	BUN nils = 0;
 	BUN i = 0;
@@ -9317,7 +10173,7 @@ convert_void_any(oid seq, BUN cnt, BAT *bn,
 			if (tp == TYPE_bit) {
 				/* only the first one could be 0 */
 				if (i == 0 && i < end && seq == 0 &&
-				    (cand == NULL || *cand != candoff)) {
+				    (ci == NULL || ci->next != candoff)) {
 					((bte *) dst)[0] = 0;
 					i++;
 				}
@@ -9373,15 +10229,16 @@ convert_void_any(oid seq, BUN cnt, BAT *bn,
 			for (i = 0; i < start; i++)
 				tfastins_nocheck(bn, i, str_nil, bn->T->width);
 			for (i = 0; i < end; i++) {
-				if (cand) {
-					if (i < *cand - candoff) {
+				if (ci) {
+					if (i < ci->next - candoff) {
 						nils++;
 						tfastins_nocheck(bn, i, str_nil,
 								 bn->T->width);
 						continue;
 					}
-					assert(i == *cand - candoff);
-					if (++cand == candend)
+					assert(i == ci->next - candoff);
+					CANDiternext(ci);
+					if (ci->next == oid_nil)
 						end = i + 1;
 				}
 				(*atomtostr)(&s, &len, &seq);
@@ -9442,8 +10299,8 @@ convert_void_any(oid seq, BUN cnt, BAT *bn,
 
 static BUN
 convert_typeswitchloop(const void *src, int stp, void *dst, int dtp,
-		       BUN cnt, BUN start, BUN end, const oid *cand,
-		       const oid *candend, oid candoff, int abort_on_error)
+		       BUN cnt, BUN start, BUN end, CandIter *ci,
+		       oid candoff, int abort_on_error)
 {
 	switch (ATOMstorage(stp)) {
 	case TYPE_bte:
@@ -9451,45 +10308,41 @@ convert_typeswitchloop(const void *src, int stp, void *dst, int dtp,
 		case TYPE_bte:
 			if (dtp == TYPE_bit)
 				return convert_bte_bit(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff);
+						       start, end, ci, candoff);
 			return convert_bte_bte(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_sht:
 			return convert_bte_sht(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_int:
 #if SIZEOF_OID == SIZEOF_INT
 			if (dtp == TYPE_oid)
 				return convert_bte_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_bte_int(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_lng:
 #if SIZEOF_OID == SIZEOF_LNG
 			if (dtp == TYPE_oid)
 				return convert_bte_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_bte_lng(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_flt:
 			return convert_bte_flt(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_dbl:
 			return convert_bte_dbl(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			return convert_bte_hge(src, dst, cnt,
+					       start, end, ci, candoff);
+#endif
 		default:
 			return BUN_NONE + 1;
 		}
@@ -9498,46 +10351,42 @@ convert_typeswitchloop(const void *src, int stp, void *dst, int dtp,
 		case TYPE_bte:
 			if (dtp == TYPE_bit)
 				return convert_sht_bit(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff);
+						       start, end, ci, candoff);
 			return convert_sht_bte(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_sht:
 			return convert_sht_sht(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_int:
 #if SIZEOF_OID == SIZEOF_INT
 			if (dtp == TYPE_oid)
 				return convert_sht_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_sht_int(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_lng:
 #if SIZEOF_OID == SIZEOF_LNG
 			if (dtp == TYPE_oid)
 				return convert_sht_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_sht_lng(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_flt:
 			return convert_sht_flt(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_dbl:
 			return convert_sht_dbl(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			return convert_sht_hge(src, dst, cnt,
+					       start, end, ci, candoff);
+#endif
 		default:
 			return BUN_NONE + 1;
 		}
@@ -9546,48 +10395,44 @@ convert_typeswitchloop(const void *src, int stp, void *dst, int dtp,
 		case TYPE_bte:
 			if (dtp == TYPE_bit) {
 				return convert_int_bit(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff);
+						       start, end, ci, candoff);
 			}
 			return convert_int_bte(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_sht:
 			return convert_int_sht(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_int:
 #if SIZEOF_OID == SIZEOF_INT
 			if (dtp == TYPE_oid)
 				return convert_int_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_int_int(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_lng:
 #if SIZEOF_OID == SIZEOF_LNG
 			if (dtp == TYPE_oid)
 				return convert_int_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_int_lng(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_flt:
 			return convert_int_flt(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_dbl:
 			return convert_int_dbl(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			return convert_int_hge(src, dst, cnt,
+					       start, end, ci, candoff);
+#endif
 		default:
 			return BUN_NONE + 1;
 		}
@@ -9596,101 +10441,130 @@ convert_typeswitchloop(const void *src, int stp, void *dst, int dtp,
 		case TYPE_bte:
 			if (dtp == TYPE_bit) {
 				return convert_lng_bit(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff);
+						       start, end, ci, candoff);
 			}
 			return convert_lng_bte(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_sht:
 			return convert_lng_sht(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_int:
 #if SIZEOF_OID == SIZEOF_INT
 			if (dtp == TYPE_oid)
 				return convert_lng_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_lng_int(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_lng:
 #if SIZEOF_OID == SIZEOF_LNG
 			if (dtp == TYPE_oid)
 				return convert_lng_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_lng_lng(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_flt:
 			return convert_lng_flt(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_dbl:
 			return convert_lng_dbl(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			return convert_lng_hge(src, dst, cnt,
+					       start, end, ci, candoff);
+#endif
 		default:
 			return BUN_NONE + 1;
 		}
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		switch (ATOMstorage(dtp)) {
+		case TYPE_bte:
+			if (dtp == TYPE_bit) {
+				return convert_hge_bit(src, dst, cnt,
+						       start, end, ci, candoff);
+			}
+			return convert_hge_bte(src, dst, cnt,
+					       start, end, ci, candoff,
+					       abort_on_error);
+		case TYPE_sht:
+			return convert_hge_sht(src, dst, cnt,
+					       start, end, ci, candoff,
+					       abort_on_error);
+		case TYPE_int:
+			return convert_hge_int(src, dst, cnt,
+					       start, end, ci, candoff,
+					       abort_on_error);
+		case TYPE_lng:
+			return convert_hge_lng(src, dst, cnt,
+					       start, end, ci, candoff,
+					       abort_on_error);
+		case TYPE_hge:
+			return convert_hge_hge(src, dst, cnt,
+					       start, end, ci, candoff);
+		case TYPE_flt:
+			return convert_hge_flt(src, dst, cnt,
+					       start, end, ci, candoff);
+		case TYPE_dbl:
+			return convert_hge_dbl(src, dst, cnt,
+					       start, end, ci, candoff);
+		default:
+			return BUN_NONE + 1;
+		}
+#endif
 	case TYPE_flt:
 		switch (ATOMstorage(dtp)) {
 		case TYPE_bte:
 			if (dtp == TYPE_bit) {
 				return convert_flt_bit(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff);
+						       start, end, ci, candoff);
 			}
 			return convert_flt_bte(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_sht:
 			return convert_flt_sht(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_int:
 #if SIZEOF_OID == SIZEOF_INT
 			if (dtp == TYPE_oid)
 				return convert_flt_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_flt_int(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_lng:
 #if SIZEOF_OID == SIZEOF_LNG
 			if (dtp == TYPE_oid)
 				return convert_flt_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_flt_lng(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_flt:
 			return convert_flt_flt(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
 		case TYPE_dbl:
 			return convert_flt_dbl(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			return convert_flt_hge(src, dst, cnt,
+					       start, end, ci, candoff,
+					       abort_on_error);
+#endif
 		default:
 			return BUN_NONE + 1;
 		}
@@ -9699,51 +10573,48 @@ convert_typeswitchloop(const void *src, int stp, void *dst, int dtp,
 		case TYPE_bte:
 			if (dtp == TYPE_bit) {
 				return convert_dbl_bit(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff);
+						       start, end, ci, candoff);
 			}
 			return convert_dbl_bte(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_sht:
 			return convert_dbl_sht(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_int:
 #if SIZEOF_OID == SIZEOF_INT
 			if (dtp == TYPE_oid)
 				return convert_dbl_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_dbl_int(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_lng:
 #if SIZEOF_OID == SIZEOF_LNG
 			if (dtp == TYPE_oid)
 				return convert_dbl_oid(src, dst, cnt,
-						       start, end, cand,
-						       candend, candoff,
+						       start, end, ci, candoff,
 						       abort_on_error);
 #endif
 			return convert_dbl_lng(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_flt:
 			return convert_dbl_flt(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff,
+					       start, end, ci, candoff,
 					       abort_on_error);
 		case TYPE_dbl:
 			return convert_dbl_dbl(src, dst, cnt,
-					       start, end, cand,
-					       candend, candoff);
+					       start, end, ci, candoff);
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			return convert_dbl_hge(src, dst, cnt,
+					       start, end, ci, candoff,
+					       abort_on_error);
+#endif
 		default:
 			return BUN_NONE + 1;
 		}
@@ -9758,7 +10629,7 @@ BATconvert(BAT *b, BAT *s, int tp, int abort_on_error)
 	BAT *bn;
 	BUN nils = 0;	/* in case no conversion defined */
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	assert(ATOMstorage(TYPE_wrd) == ATOMstorage(TYPE_int) ||
 	       ATOMstorage(TYPE_wrd) == ATOMstorage(TYPE_lng));
@@ -9780,21 +10651,21 @@ BATconvert(BAT *b, BAT *s, int tp, int abort_on_error)
 
 	if (b->T->type == TYPE_void)
 		nils = convert_void_any(b->T->seq, b->U->count, bn,
-					start, end, cand, candend, b->H->seq,
+					start, end, ci, b->H->seq,
 					abort_on_error);
 	else if (tp == TYPE_str)
 		nils = convert_any_str(b->T->type, Tloc(b, b->U->first), bn,
-				       cnt, start, end, cand, candend,
+				       cnt, start, end, ci,
 				       b->H->seq);
 	else if (b->T->type == TYPE_str)
 		nils = convert_str_any(b, tp, Tloc(bn, bn->U->first),
-				       start, end, cand, candend, b->H->seq,
+				       start, end, ci, b->H->seq,
 				       abort_on_error);
 	else
 		nils = convert_typeswitchloop(Tloc(b, b->U->first), b->T->type,
 					      Tloc(bn, bn->U->first), tp,
 					      b->U->count, start, end,
-					      cand, candend, b->H->seq,
+					      ci, b->H->seq,
 					      abort_on_error);
 
 	if (nils >= BUN_NONE) {
@@ -9855,13 +10726,13 @@ VARconvert(ValPtr ret, const ValRecord *v, int abort_on_error)
 	} else if (v->vtype == TYPE_void) {
 		nils = convert_typeswitchloop(&oid_nil, TYPE_oid,
 					      VALget(ret), ret->vtype,
-					      1, 0, 1, NULL, NULL, 0,
+					      1, 0, 1, NULL, 0,
 					      abort_on_error);
 	} else if (v->vtype == TYPE_str) {
 		if (v->val.sval == NULL || strcmp(v->val.sval, str_nil) == 0) {
 			nils = convert_typeswitchloop(&bte_nil, TYPE_bte,
 						      VALget(ret), ret->vtype,
-						      1, 0, 1, NULL, NULL, 0,
+						      1, 0, 1, NULL, 0,
 						      abort_on_error);
 		} else {
 			p = VALget(ret);
@@ -9879,7 +10750,7 @@ VARconvert(ValPtr ret, const ValRecord *v, int abort_on_error)
 	} else {
 		nils = convert_typeswitchloop(VALptr(v), v->vtype,
 					      VALget(ret), ret->vtype,
-					      1, 0, 1, NULL, NULL, 0,
+					      1, 0, 1, NULL, 0,
 					      abort_on_error);
 	}
 	if (nils == BUN_NONE + 1) {
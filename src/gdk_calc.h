@@ -126,15 +126,29 @@ gdk_export BAT *BATgroupsize(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_ni
 gdk_export BAT *BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
 gdk_export BAT *BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
 gdk_export BAT *BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, dbl quantile, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgroupcountdistinct_approx(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgroupquantile_approx(BAT *b, BAT *g, BAT *e, BAT *s, int tp, dbl quantile, int skip_nils, int abort_on_error);
+/* aggregates computed by BATgroupaggr_multi */
+typedef enum {
+	GROUP_SUM,		/* as BATgroupsum */
+	GROUP_COUNT,		/* as BATgroupcount */
+	GROUP_MIN,		/* as BATgroupmin (positions) */
+	GROUP_MAX,		/* as BATgroupmax (positions) */
+	GROUP_AVG		/* as BATgroupavg */
+} groupaggr_t;
+gdk_export gdk_return BATgroupaggr_multi(BAT **res, const groupaggr_t *aggrs, const int *tps, int naggrs, BAT *b, BAT *g, BAT *e, BAT *s, int skip_nils, int abort_on_error);
 /* helper function for grouped aggregates */
 gdk_export const char *BATgroupaggrinit(
 	const BAT *b, const BAT *g, const BAT *e, const BAT *s,
 	/* outputs: */
 	oid *minp, oid *maxp, BUN *ngrpp, BUN *startp, BUN *endp, BUN *cntp,
-	const oid **candp, const oid **candendp);
+	CandIter *cisp, CandIter **cip);
 
 gdk_export gdk_return BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int nil_if_empty);
 gdk_export gdk_return BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int nil_if_empty);
+gdk_export void *BATmin(BAT *b, void *aggr);
+gdk_export void *BATmax(BAT *b, void *aggr);
 
 gdk_export dbl BATcalcstdev_population(dbl *avgp, BAT *b);
 gdk_export dbl BATcalcstdev_sample(dbl *avgp, BAT *b);
@@ -144,3 +158,13 @@ gdk_export dbl BATcalcvariance_population(dbl *avgp, BAT *b);
 gdk_export dbl BATcalcvariance_sample(dbl *avgp, BAT *b);
 gdk_export BAT *BATgroupvariance_sample(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
 gdk_export BAT *BATgroupvariance_population(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+/* moments of a set of values, from which the variance follows; they
+ * can be merged and extended with more values */
+typedef struct {
+	BUN n;			/* number of (non-nil) values */
+	dbl mean;
+	dbl m2;			/* sum of squared differences from the mean */
+} moments_t;
+gdk_export gdk_return BATcalcmoments(moments_t *m, BAT *b, BUN start);
+gdk_export void MOMENTSmerge(moments_t *m, const moments_t *o);
+gdk_export dbl MOMENTSvariance(const moments_t *m, int issample);
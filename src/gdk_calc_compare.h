@@ -22,8 +22,8 @@
 static BUN
 op_typeswitchloop(const void *lft, int tp1, int incr1, const char *hp1, int wd1,
 		  const void *rgt, int tp2, int incr2, const char *hp2, int wd2,
-		  TPE *dst, BUN cnt, BUN start, BUN end, const oid *cand,
-		  const oid *candend, oid candoff, int nonil, const char *func)
+		  TPE *dst, BUN cnt, BUN start, BUN end, CandIter *ci,
+		  oid candoff, int nonil, const char *func)
 {
 	BUN nils = 0;
 	BUN i, j, k;
@@ -43,7 +43,7 @@ op_typeswitchloop(const void *lft, int tp1, int incr1, const char *hp1, int wd1,
 				TPE_nil :
 				OP(v, * (const oid *) rgt);
 
-			if (res == TPE_nil || cand == NULL) {
+			if (res == TPE_nil || ci == NULL) {
 				for (k = start; k < end; k++)
 					dst[k] = res;
 				if (res == TPE_nil)
@@ -467,8 +467,8 @@ op_typeswitchloop(const void *lft, int tp1, int incr1, const char *hp1, int wd1,
 static BAT *
 BATcalcop_intern(const void *lft, int tp1, int incr1, const char *hp1, int wd1,
 		 const void *rgt, int tp2, int incr2, const char *hp2, int wd2,
-		 BUN cnt, BUN start, BUN end, const oid *cand,
-		 const oid *candend, oid candoff, int nonil, oid seqbase,
+		 BUN cnt, BUN start, BUN end, CandIter *ci,
+		 oid candoff, int nonil, oid seqbase,
 		 const char *func)
 {
 	BAT *bn;
@@ -483,7 +483,7 @@ BATcalcop_intern(const void *lft, int tp1, int incr1, const char *hp1, int wd1,
 
 	nils = op_typeswitchloop(lft, tp1, incr1, hp1, wd1,
 				 rgt, tp2, incr2, hp2, wd2,
-				 dst, cnt, start, end, cand, candend, candoff,
+				 dst, cnt, start, end, ci, candoff,
 				 nonil, func);
 
 	if (nils == BUN_NONE) {
@@ -508,7 +508,7 @@ BATcalcop(BAT *b1, BAT *b2, BAT *s)
 {
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b1, BATcalcop_name);
 	BATcheck(b2, BATcalcop_name);
@@ -518,7 +518,7 @@ BATcalcop(BAT *b1, BAT *b2, BAT *s)
 
 	CANDINIT(b1, s);
 
-	if (BATtvoid(b1) && BATtvoid(b2) && cand == NULL) {
+	if (BATtvoid(b1) && BATtvoid(b2) && ci == NULL) {
 		TPE res;
 
 		if (b1->T->seq == oid_nil || b2->T->seq == oid_nil)
@@ -537,8 +537,8 @@ BATcalcop(BAT *b1, BAT *b2, BAT *s)
 			      b2->T->type == TYPE_void ? (void *) &b2->T->seq : (void *) Tloc(b2, b2->U->first), b2->T->type, 1,
 			      b2->T->vheap ? b2->T->vheap->base : NULL,
 			      b2->T->width,
-			      cnt, start, end, cand, candend, b1->hseqbase,
-			      cand == NULL && b1->T->nonil && b2->T->nonil,
+			      cnt, start, end, ci, b1->hseqbase,
+			      ci == NULL && b1->T->nonil && b2->T->nonil,
 			      b1->H->seq, BATcalcop_name);
 
 	return bn;
@@ -549,7 +549,7 @@ BATcalcopcst(BAT *b, const ValRecord *v, BAT *s)
 {
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, BATcalcopcst_name);
 
@@ -563,8 +563,8 @@ BATcalcopcst(BAT *b, const ValRecord *v, BAT *s)
 			      b->T->width,
 			      VALptr(v), v->vtype, 0,
 			      NULL, 0,
-			      cnt, start, end, cand, candend, b->hseqbase,
-			      cand == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
+			      cnt, start, end, ci, b->hseqbase,
+			      ci == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
 			      b->H->seq, BATcalcopcst_name);
 
 	return bn;
@@ -575,7 +575,7 @@ BATcalccstop(const ValRecord *v, BAT *b, BAT *s)
 {
 	BAT *bn;
 	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
+	CandIter cis, *ci = NULL;
 
 	BATcheck(b, BATcalccstop_name);
 
@@ -589,8 +589,8 @@ BATcalccstop(const ValRecord *v, BAT *b, BAT *s)
 			      Tloc(b, b->U->first), b->T->type, 1,
 			      b->T->vheap ? b->T->vheap->base : NULL,
 			      b->T->width,
-			      cnt, start, end, cand, candend, b->hseqbase,
-			      cand == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
+			      cnt, start, end, ci, b->hseqbase,
+			      ci == NULL && b->T->nonil && ATOMcmp(v->vtype, VALptr(v), ATOMnilptr(v->vtype)) != 0,
 			      b->H->seq, BATcalccstop_name);
 
 	return bn;
@@ -602,7 +602,7 @@ VARcalcop(ValPtr ret, const ValRecord *lft, const ValRecord *rgt)
 	ret->vtype = TYPE_TPE;
 	if (op_typeswitchloop(VALptr(lft), lft->vtype, 0, NULL, 0,
 			      VALptr(rgt), rgt->vtype, 0, NULL, 0,
-			      VALget(ret), 1, 0, 1, NULL, NULL, 0, 0,
+			      VALget(ret), 1, 0, 1, NULL, 0, 0,
 			      VARcalcop_name) == BUN_NONE)
 		return GDK_FAIL;
 	return GDK_SUCCEED;
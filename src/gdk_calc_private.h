@@ -42,24 +42,20 @@ typedef unsigned __int64 ulng;
 
 #define GT(a, b)	((bit) ((a) > (b)))
 
+/* Set start and end to the range of positions of b with candidates
+ * in s, and ci to an iterator over them (using cis), or to NULL if
+ * all positions in the range are candidates. */
 #define CANDINIT(b, s)							\
 	do {								\
 		start = 0;						\
 		end = cnt = BATcount(b);				\
 		if (s) {						\
-			assert(BATttype(s) == TYPE_oid);		\
+			assert(BATttype(s) == TYPE_oid || BATtcand(s)); \
 			if (BATcount(s) == 0) {				\
 				start = end = 0;			\
-			} else {					\
-				if (BATtdense(s)) {			\
-					start = (s)->T->seq;		\
-					end = start + BATcount(s);	\
-				} else {				\
-					cand = (const oid *) Tloc((s), BUNfirst(s)); \
-					candend = cand + BATcount(s);	\
-					start = *cand;			\
-					end = candend[-1] + 1;		\
-				}					\
+			} else if (BATtdense(s)) {			\
+				start = (s)->T->seq;			\
+				end = start + BATcount(s);		\
 				assert(start <= end);			\
 				if (start <= (b)->H->seq)		\
 					start = 0;			\
@@ -73,6 +69,16 @@ typedef unsigned __int64 ulng;
 					end = 0;			\
 				else					\
 					end -= (b)->H->seq;		\
+			} else {					\
+				CANDiter(&cis, (s), (b)->H->seq,	\
+					 (b)->H->seq + cnt);		\
+				ci = &cis;				\
+				if (cis.next == oid_nil) {		\
+					start = end = 0;		\
+				} else {				\
+					start = cis.next - (b)->H->seq;	\
+					end = cis.last - (b)->H->seq;	\
+				}					\
 			}						\
 		}							\
 	} while (0)
@@ -146,3 +152,22 @@ typedef unsigned __int64 ulng;
 			nils++;						\
 		}							\
 	} while (0)
+
+#ifdef HAVE_HGE
+/* there is no wider type to multiply into, so check by dividing;
+ * neither operand is nil, so taking the absolute value is safe */
+#define HGEMUL_CHECK(TYPE1, lft, TYPE2, rgt, dst, on_overflow)		\
+	do {								\
+		hge a = (lft), b = (rgt);				\
+									\
+		if (b != 0 &&						\
+		    ABSOLUTE(a) > GDK_hge_max / ABSOLUTE(b)) {		\
+			if (abort_on_error)				\
+				on_overflow;				\
+			(dst) = hge_nil;				\
+			nils++;						\
+		} else {						\
+			(dst) = a * b;					\
+		}							\
+	} while (0)
+#endif
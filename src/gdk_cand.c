@@ -0,0 +1,804 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * Compressed candidate lists.
+ * 候选列表的压缩表示
+ *
+ * A candidate list is normally a VOID-headed BAT with a sorted, unique
+ * OID tail, i.e. 8 bytes per candidate with 64-bit oids.  A Cand
+ * describes the same set of oids in one of four ways:
+ *	CAND_DENSE	all oids in [first, last)
+ *	CAND_LIST	the tail of a candidate BAT
+ *	CAND_RUNS	the oids in the ranges [runs[2i], runs[2i+1])
+ *	CAND_BITMAP	first + i for every bit i that is set in bits
+ * The first word of a bitmap starts at a multiple of CANDWORDBITS, so
+ * that the words of two bitmaps line up and can be combined with
+ * plain AND and OR loops (which the compiler vectorizes).
+ *
+ * CANDcompact picks the smallest representation for a set: a clustered
+ * result becomes a short run list, a large unclustered one a bitmap
+ * (one bit per oid in the range instead of 64 per candidate), and a
+ * sparse one stays (or becomes) an oid list.  BATsubselect_cand
+ * produces a Cand directly.
+ *
+ * CANDtoBAT wraps a run list or a bitmap in a compact candidate BAT
+ * (see gdk.h) without materializing the oids, and CANDfromBAT gets
+ * the Cand back out.  The functions that take a candidate list
+ * iterate over its candidates with CANDiter and CANDiternext, which
+ * hide the representation: CANDINIT in gdk_calc_private.h sets up the
+ * iterator for the BATcalc and aggregate functions, the fetchjoins
+ * fetch the values of the candidates, and the selections evaluate
+ * directly into a bitmap that is intersected with the candidates (or
+ * select a window of candidates at a time).  BATmergecand and
+ * BATintersectcand combine the Cands.  BATcandlist materializes a
+ * compact candidate BAT for all other functions.
+ */
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+#define CANDWORD(o)	((o) / CANDWORDBITS)
+#define CANDBIT(o)	((candword) 1 << ((o) % CANDWORDBITS))
+
+Cand *
+CANDnew(int kind, oid first, oid last)
+{
+	Cand *c;
+	BUN nwords;
+
+	if ((c = GDKzalloc(sizeof(Cand))) == NULL)
+		return NULL;
+	c->kind = kind;
+	c->first = first;
+	c->last = last;
+	switch (kind) {
+	case CAND_DENSE:
+		c->count = last - first;
+		break;
+	case CAND_BITMAP:
+		/* align the bitmap */
+		c->first = first - first % CANDWORDBITS;
+		nwords = (BUN) (CANDWORD(last - c->first) + 1);
+		if ((c->bits = GDKzalloc(nwords * sizeof(candword))) == NULL) {
+			GDKfree(c);
+			return NULL;
+		}
+		break;
+	}
+	return c;
+}
+
+void
+CANDdestroy(Cand *c)
+{
+	if (c == NULL)
+		return;
+	if (c->list)
+		BBPunfix(c->list->batCacheid);
+	if (c->runs)
+		GDKfree(c->runs);
+	if (c->bits)
+		GDKfree(c->bits);
+	GDKfree(c);
+}
+
+/* set the bits for [lo, hi) in the bitmap that starts at base */
+static void
+cand_setrange(candword *bits, oid base, oid lo, oid hi)
+{
+	BUN w, wl, wh;
+
+	if (lo >= hi)
+		return;
+	lo -= base;
+	hi -= base;
+	wl = (BUN) CANDWORD(lo);
+	wh = (BUN) CANDWORD(hi - 1);
+	if (wl == wh) {
+		bits[wl] |= (CANDBIT(hi - 1) - CANDBIT(lo)) | CANDBIT(hi - 1);
+		return;
+	}
+	bits[wl] |= ~(CANDBIT(lo) - 1);
+	for (w = wl + 1; w < wh; w++)
+		bits[w] = ~(candword) 0;
+	bits[wh] |= (CANDBIT(hi - 1) - 1) | CANDBIT(hi - 1);
+}
+
+/* set the bits of the candidates of c that are in [lo, hi) in the
+ * bitmap that starts at base (a multiple of CANDWORDBITS) */
+static void
+cand_tobits(const Cand *c, candword *bits, oid base, oid lo, oid hi)
+{
+	BUN i, n;
+
+	switch (c->kind) {
+	case CAND_DENSE:
+		cand_setrange(bits, base, MAX(lo, c->first), MIN(hi, c->last));
+		break;
+	case CAND_RUNS:
+		for (i = 0; i < c->nruns; i++)
+			cand_setrange(bits, base, MAX(lo, c->runs[2 * i]),
+				      MIN(hi, c->runs[2 * i + 1]));
+		break;
+	case CAND_LIST: {
+		const oid *o = (const oid *) Tloc(c->list, BUNfirst(c->list));
+
+		for (i = 0, n = BATcount(c->list); i < n; i++)
+			if (o[i] >= lo && o[i] < hi)
+				bits[CANDWORD(o[i] - base)] |= CANDBIT(o[i] - base);
+		break;
+	}
+	case CAND_BITMAP: {
+		/* both bitmaps are aligned: OR whole words (W is the
+		 * absolute word number), leaving out the bits outside
+		 * [lo, hi) of the first and last word */
+		oid l = MAX(lo, c->first), h = MIN(hi, c->last), W;
+		candword m;
+
+		if (l >= h)
+			break;
+		for (W = CANDWORD(l); W <= CANDWORD(h - 1); W++) {
+			m = c->bits[W - CANDWORD(c->first)];
+			if (W == CANDWORD(l))
+				m &= ~(CANDBIT(l) - 1);
+			if (W == CANDWORD(h - 1) && h % CANDWORDBITS)
+				m &= CANDBIT(h) - 1;
+			bits[W - CANDWORD(base)] |= m;
+		}
+		break;
+	}
+	}
+}
+
+static BUN
+cand_popcount(const candword *bits, BUN nwords)
+{
+	BUN i, n = 0;
+
+	for (i = 0; i < nwords; i++)
+		n += (BUN) candword_popcount(bits[i]);
+	return n;
+}
+
+/* number of runs of consecutive set bits */
+static BUN
+cand_bitruns(const candword *bits, BUN nwords)
+{
+	BUN i, n = 0;
+	candword carry = 0;
+
+	for (i = 0; i < nwords; i++) {
+		/* a run starts at every set bit whose lower neighbour
+		 * isn't set */
+		n += (BUN) candword_popcount(bits[i] & ~((bits[i] << 1) | carry));
+		carry = bits[i] >> (CANDWORDBITS - 1);
+	}
+	return n;
+}
+
+/* Change c into the smallest representation of its set of oids.
+ * Returns c, or NULL (after destroying c) if we ran out of memory. */
+Cand *
+CANDcompact(Cand *c)
+{
+	BUN nwords, nruns, i, j;
+	oid o, *runs = NULL;
+
+	switch (c->kind) {
+	case CAND_DENSE:
+		return c;
+	case CAND_LIST: {
+		const oid *l = (const oid *) Tloc(c->list, BUNfirst(c->list));
+		BUN n = BATcount(c->list);
+
+		if (n == 0) {
+			BBPunfix(c->list->batCacheid);
+			c->list = NULL;
+			c->kind = CAND_DENSE;
+			c->first = c->last = 0;
+			return c;
+		}
+		for (i = 1, nruns = 1; i < n; i++)
+			nruns += l[i] != l[i - 1] + 1;
+		if (nruns == 1) {
+			BBPunfix(c->list->batCacheid);
+			c->list = NULL;
+			c->kind = CAND_DENSE;
+			return c;
+		}
+		if (2 * nruns < n / 2) {
+			if ((runs = GDKmalloc(2 * nruns * sizeof(oid))) == NULL) {
+				CANDdestroy(c);
+				return NULL;
+			}
+			runs[0] = l[0];
+			for (i = 1, j = 1; i < n; i++) {
+				if (l[i] != l[i - 1] + 1) {
+					runs[j++] = l[i - 1] + 1;
+					runs[j++] = l[i];
+				}
+			}
+			runs[j++] = l[n - 1] + 1;
+			assert(j == 2 * nruns);
+			BBPunfix(c->list->batCacheid);
+			c->list = NULL;
+			c->runs = runs;
+			c->nruns = nruns;
+			c->kind = CAND_RUNS;
+			return c;
+		}
+		if ((c->last - c->first) / CANDWORDBITS + 1 < n / 2) {
+			Cand *r = CANDnew(CAND_BITMAP, c->first, c->last);
+
+			if (r == NULL) {
+				CANDdestroy(c);
+				return NULL;
+			}
+			for (i = 0; i < n; i++)
+				r->bits[CANDWORD(l[i] - r->first)] |= CANDBIT(l[i] - r->first);
+			r->count = n;
+			CANDdestroy(c);
+			return r;
+		}
+		return c;
+	}
+	case CAND_RUNS:
+		if (c->nruns == 0) {
+			GDKfree(c->runs);
+			c->runs = NULL;
+			c->kind = CAND_DENSE;
+			c->first = c->last = 0;
+		} else if (c->nruns == 1) {
+			GDKfree(c->runs);
+			c->runs = NULL;
+			c->kind = CAND_DENSE;
+		}
+		return c;
+	case CAND_BITMAP:
+		break;
+	}
+
+	/* a bitmap: trim it to its first and last candidate, then see
+	 * whether a run list or an oid list is smaller */
+	nwords = (BUN) CANDWORD(c->last - 1 - c->first) + 1;
+	if (c->count == 0) {
+		GDKfree(c->bits);
+		c->bits = NULL;
+		c->kind = CAND_DENSE;
+		c->first = c->last = 0;
+		return c;
+	}
+	for (i = 0; c->bits[i] == 0; i++)
+		;
+	o = c->first + (oid) i * CANDWORDBITS + (oid) candword_ctz(c->bits[i]);
+	for (j = nwords - 1; c->bits[j] == 0; j--)
+		;
+	c->last = c->first + (oid) j * CANDWORDBITS +
+		(oid) (CANDWORDBITS - candword_clz(c->bits[j]));
+	if (i > 0) {
+		memmove(c->bits, c->bits + i, (j - i + 1) * sizeof(candword));
+		c->first += (oid) i * CANDWORDBITS;
+	}
+	nwords = j - i + 1;
+	if (c->count == c->last - o) {
+		GDKfree(c->bits);
+		c->bits = NULL;
+		c->kind = CAND_DENSE;
+		c->first = o;
+		return c;
+	}
+	nruns = cand_bitruns(c->bits, nwords);
+	if (2 * nruns < nwords || c->count < nwords / 2) {
+		BAT *bn = NULL;
+		oid *dst;
+
+		if (2 * nruns < nwords) {
+			if ((runs = GDKmalloc(2 * nruns * sizeof(oid))) == NULL) {
+				CANDdestroy(c);
+				return NULL;
+			}
+			dst = runs;
+		} else {
+			if ((bn = BATnew(TYPE_void, TYPE_oid, c->count)) == NULL) {
+				CANDdestroy(c);
+				return NULL;
+			}
+			dst = (oid *) Tloc(bn, BUNfirst(bn));
+		}
+		for (i = 0, j = 0; i < nwords; i++) {
+			candword w = c->bits[i];
+
+			while (w) {
+				o = c->first + (oid) i * CANDWORDBITS +
+					(oid) candword_ctz(w);
+				w &= w - 1;
+				if (bn) {
+					dst[j++] = o;
+				} else if (j > 0 && dst[j - 1] == o) {
+					/* extend the current run */
+					dst[j - 1]++;
+				} else {
+					dst[j++] = o;
+					dst[j++] = o + 1;
+				}
+			}
+		}
+		GDKfree(c->bits);
+		c->bits = NULL;
+		if (bn) {
+			assert(j == c->count);
+			BATsetcount(bn, c->count);
+			BATseqbase(bn, 0);
+			bn->tsorted = 1;
+			bn->trevsorted = c->count <= 1;
+			bn->tkey = 1;
+			bn->T->nil = 0;
+			bn->T->nonil = 1;
+			c->list = bn;
+			c->kind = CAND_LIST;
+		} else {
+			assert(j == 2 * nruns);
+			c->runs = runs;
+			c->nruns = nruns;
+			c->kind = CAND_RUNS;
+		}
+		c->first = dst[0];
+	}
+	return c;
+}
+
+/* a copy of the candidates of the compact candidate BAT s */
+static Cand *
+cand_copy(const Cand *c)
+{
+	Cand *r;
+	size_t size = 0;
+
+	if ((r = GDKmalloc(sizeof(Cand))) == NULL)
+		return NULL;
+	*r = *c;
+	assert(c->kind == CAND_RUNS || c->kind == CAND_BITMAP);
+	if (c->kind == CAND_RUNS) {
+		size = 2 * c->nruns * sizeof(oid);
+		r->runs = GDKmalloc(size);
+		if (r->runs)
+			memcpy(r->runs, c->runs, size);
+	} else {
+		size = ((BUN) CANDWORD(c->last - 1 - c->first) + 1) * sizeof(candword);
+		r->bits = GDKmalloc(size);
+		if (r->bits)
+			memcpy(r->bits, c->bits, size);
+	}
+	if (r->runs == NULL && r->bits == NULL) {
+		GDKfree(r);
+		return NULL;
+	}
+	return r;
+}
+
+Cand *
+CANDfromBAT(BAT *s)
+{
+	Cand *c;
+
+	BATcheck(s, "CANDfromBAT");
+	assert(s->htype == TYPE_void);
+	if (BATtcand(s))
+		return cand_copy(s->T->cand);
+	assert(s->tsorted);
+	assert(s->tkey);
+	if (BATcount(s) == 0)
+		return CANDnew(CAND_DENSE, 0, 0);
+	if (BATtdense(s))
+		return CANDnew(CAND_DENSE, s->tseqbase, s->tseqbase + BATcount(s));
+	if ((c = CANDnew(CAND_LIST, 0, 0)) == NULL)
+		return NULL;
+	c->first = *(const oid *) Tloc(s, BUNfirst(s));
+	c->last = *(const oid *) Tloc(s, BUNlast(s) - 1) + 1;
+	c->count = BATcount(s);
+	c->list = s;
+	BBPfix(s->batCacheid);
+	return CANDcompact(c);
+}
+
+/* an ordinary candidate BAT with the candidates of c */
+static BAT *
+cand_materialize(const Cand *c)
+{
+	BAT *bn;
+	oid *dst, o;
+	BUN i, j;
+
+	if (c->kind == CAND_LIST) {
+		BBPfix(c->list->batCacheid);
+		return c->list;
+	}
+	if (c->kind == CAND_DENSE) {
+		bn = BATnew(TYPE_void, TYPE_void, 0);
+		if (bn == NULL)
+			return NULL;
+		BATsetcount(bn, c->count);
+		BATseqbase(bn, 0);
+		BATseqbase(BATmirror(bn), c->count ? c->first : 0);
+		return bn;
+	}
+	if ((bn = BATnew(TYPE_void, TYPE_oid, c->count)) == NULL)
+		return NULL;
+	dst = (oid *) Tloc(bn, BUNfirst(bn));
+	j = 0;
+	if (c->kind == CAND_RUNS) {
+		for (i = 0; i < c->nruns; i++)
+			for (o = c->runs[2 * i]; o < c->runs[2 * i + 1]; o++)
+				dst[j++] = o;
+	} else {
+		for (i = 0; i <= CANDWORD(c->last - 1 - c->first); i++) {
+			candword w = c->bits[i];
+
+			while (w) {
+				dst[j++] = c->first + (oid) i * CANDWORDBITS +
+					(oid) candword_ctz(w);
+				w &= w - 1;
+			}
+		}
+	}
+	assert(j == c->count);
+	BATsetcount(bn, j);
+	BATseqbase(bn, 0);
+	bn->tsorted = 1;
+	bn->trevsorted = j <= 1;
+	bn->tkey = 1;
+	bn->tdense = j <= 1;
+	if (j == 1)
+		bn->tseqbase = dst[0];
+	bn->T->nil = 0;
+	bn->T->nonil = 1;
+	return bn;
+}
+
+/* Turn c into a candidate BAT, which is compact if c is a run list
+ * or a bitmap.  c is consumed. */
+BAT *
+CANDtoBAT(Cand *c)
+{
+	BAT *bn;
+
+	if (c->kind == CAND_DENSE || c->kind == CAND_LIST) {
+		bn = cand_materialize(c);
+		CANDdestroy(c);
+		return bn;
+	}
+	if ((bn = BATnew(TYPE_void, TYPE_void, 0)) == NULL) {
+		CANDdestroy(c);
+		return NULL;
+	}
+	BATsetcount(bn, c->count);
+	BATseqbase(bn, 0);
+	BATseqbase(BATmirror(bn), oid_nil);
+	bn->T->cand = c;
+	return bn;
+}
+
+/* An ordinary candidate BAT with the candidates of s, which may be
+ * compact.  Like BATnew, the result has to be unfixed by the caller,
+ * also if it is s itself. */
+BAT *
+BATcandlist(BAT *s)
+{
+	BATcheck(s, "BATcandlist");
+	if (!BATtcand(s)) {
+		BBPfix(s->batCacheid);
+		return s;
+	}
+	return cand_materialize(s->T->cand);
+}
+
+/* destroy the compressed candidates of b, if any */
+void
+CANDfree(BAT *b)
+{
+	if (b->H->cand) {
+		CANDdestroy(b->H->cand);
+		b->H->cand = NULL;
+	}
+	if (b->T->cand) {
+		CANDdestroy(b->T->cand);
+		b->T->cand = NULL;
+	}
+}
+
+/* the index of the first of the n sorted values of v that is >= o */
+static BUN
+cand_search(const oid *v, BUN n, oid o)
+{
+	BUN lo = 0, hi = n, m;
+
+	while (lo < hi) {
+		m = (lo + hi) / 2;
+		if (v[m] < o)
+			lo = m + 1;
+		else
+			hi = m;
+	}
+	return lo;
+}
+
+/* Set up ci for the n candidates in the sorted array l, which has to
+ * stay around while iterating; ci->s is NULL. */
+void
+CANDiterlist(CandIter *ci, const oid *l, BUN n)
+{
+	memset(ci, 0, sizeof(*ci));
+	ci->next = oid_nil;
+	ci->kind = CAND_LIST;
+	if (n == 0)
+		return;
+	ci->next = l[0];
+	ci->last = l[n - 1] + 1;
+	ci->list = l + 1;
+	ci->listend = l + n;
+	ci->count = n;
+}
+
+/* Set up ci for the candidates of s in [lo, hi).  s is a candidate BAT
+ * that is not dense, but may be compact.  If there are no candidates
+ * in the range, ci->next is oid_nil and ci->count 0. */
+void
+CANDiter(CandIter *ci, const BAT *s, oid lo, oid hi)
+{
+	const Cand *c = s->T->cand;
+	const oid *o;
+	BUN i, j, m, n;
+	oid l, h;
+
+	memset(ci, 0, sizeof(*ci));
+	ci->s = s;
+	ci->next = oid_nil;
+	ci->kind = CAND_LIST;
+	if (c == NULL || c->kind == CAND_LIST) {
+		const BAT *b = c ? c->list : s;
+
+		assert(!BATtdense(b));
+		o = (const oid *) Tloc(b, BUNfirst(b));
+		n = BATcount(b);
+		i = cand_search(o, n, lo);
+		j = cand_search(o, n, hi);
+		if (i < j) {
+			ci->next = o[i];
+			ci->last = o[j - 1] + 1;
+			ci->list = o + i + 1;
+			ci->listend = o + j;
+			ci->count = j - i;
+		}
+		return;
+	}
+	l = MAX(lo, c->first);
+	h = MIN(hi, c->last);
+	if (c->count == 0 || l >= h)
+		return;
+	switch (c->kind) {
+	case CAND_DENSE:
+		/* a single run */
+		ci->kind = CAND_RUNS;
+		ci->next = l;
+		ci->runend = ci->last = h;
+		ci->count = h - l;
+		break;
+	case CAND_RUNS:
+		/* the runs i, ..., j - 1 end after l and start before h */
+		for (i = 0, n = c->nruns; i < n; ) {
+			m = (i + n) / 2;
+			if (c->runs[2 * m + 1] <= l)
+				i = m + 1;
+			else
+				n = m;
+		}
+		for (j = i, n = c->nruns; j < n; ) {
+			m = (j + n) / 2;
+			if (c->runs[2 * m] < h)
+				j = m + 1;
+			else
+				n = m;
+		}
+		if (i >= j)
+			return;
+		ci->kind = CAND_RUNS;
+		ci->last = MIN(h, c->runs[2 * j - 1]);
+		ci->next = MAX(l, c->runs[2 * i]);
+		ci->runend = MIN(ci->last, c->runs[2 * i + 1]);
+		ci->runs = c->runs + 2 * (i + 1);
+		ci->runsend = c->runs + 2 * j;
+		ci->count = ci->runend - ci->next;
+		for (n = i + 1; n < j; n++)
+			ci->count += MIN(ci->last, c->runs[2 * n + 1]) - c->runs[2 * n];
+		break;
+	case CAND_BITMAP: {
+		BUN wl = (BUN) CANDWORD(l - c->first);
+		BUN wh = (BUN) CANDWORD(h - 1 - c->first);
+		candword w;
+
+		/* count the candidates, and find the last one */
+		for (i = wl; i <= wh; i++) {
+			w = c->bits[i];
+			if (i == wl)
+				w &= ~(CANDBIT(l - c->first) - 1);
+			if (i == wh && (h - c->first) % CANDWORDBITS)
+				w &= CANDBIT(h - c->first) - 1;
+			if (w) {
+				ci->count += (BUN) candword_popcount(w);
+				ci->last = c->first + (oid) i * CANDWORDBITS +
+					(oid) (CANDWORDBITS - candword_clz(w));
+			}
+		}
+		if (ci->count == 0)
+			return;
+		ci->kind = CAND_BITMAP;
+		ci->bits = c->bits + wl;
+		ci->base = c->first + (oid) wl * CANDWORDBITS;
+		ci->w = c->bits[wl] & ~(CANDBIT(l - c->first) - 1);
+		CANDiternext(ci);
+		break;
+	}
+	}
+}
+
+/* merge two sorted lists of ranges; op is 0 for intersection and 1
+ * for union */
+static Cand *
+cand_runmerge(const oid *ar, BUN an, const oid *br, BUN bn, int op)
+{
+	Cand *c;
+	BUN i = 0, j = 0, k = 0;
+	oid *runs, lo, hi;
+
+	if ((c = CANDnew(CAND_RUNS, 0, 0)) == NULL)
+		return NULL;
+	if ((runs = GDKmalloc(2 * (an + bn) * sizeof(oid))) == NULL) {
+		GDKfree(c);
+		return NULL;
+	}
+	if (op == 0) {
+		while (i < an && j < bn) {
+			lo = MAX(ar[2 * i], br[2 * j]);
+			hi = MIN(ar[2 * i + 1], br[2 * j + 1]);
+			if (lo < hi) {
+				runs[k++] = lo;
+				runs[k++] = hi;
+				c->count += hi - lo;
+			}
+			if (ar[2 * i + 1] < br[2 * j + 1])
+				i++;
+			else
+				j++;
+		}
+	} else {
+		while (i < an || j < bn) {
+			const oid *r;
+
+			if (j == bn || (i < an && ar[2 * i] <= br[2 * j]))
+				r = &ar[2 * i++];
+			else
+				r = &br[2 * j++];
+			if (k > 0 && r[0] <= runs[k - 1]) {
+				/* overlaps or touches the previous run */
+				if (r[1] > runs[k - 1]) {
+					c->count += r[1] - runs[k - 1];
+					runs[k - 1] = r[1];
+				}
+			} else {
+				runs[k++] = r[0];
+				runs[k++] = r[1];
+				c->count += r[1] - r[0];
+			}
+		}
+	}
+	c->runs = runs;
+	c->nruns = k / 2;
+	if (k > 0) {
+		c->first = runs[0];
+		c->last = runs[k - 1];
+	}
+	return CANDcompact(c);
+}
+
+/* intersection (op == 0) or union (op == 1) of a and b */
+static Cand *
+cand_combine(const Cand *a, const Cand *b, int op, const char *func)
+{
+	Cand *c;
+	oid lo, hi, ar[2], br[2];
+	BUN i, nwords;
+
+	if (a->count == 0 || b->count == 0) {
+		if (op == 0 || (a->count == 0 && b->count == 0))
+			return CANDnew(CAND_DENSE, 0, 0);
+		/* union with the empty set: copy the other */
+		if (a->count == 0)
+			a = b;
+		b = a;
+	}
+	if ((a->kind == CAND_DENSE || a->kind == CAND_RUNS) &&
+	    (b->kind == CAND_DENSE || b->kind == CAND_RUNS)) {
+		ALGODEBUG fprintf(stderr, "#%s: merge runs\n", func);
+		ar[0] = br[0] = 0; /* silence compiler */
+		if (a->kind == CAND_DENSE) {
+			ar[0] = a->first;
+			ar[1] = a->last;
+		}
+		if (b->kind == CAND_DENSE) {
+			br[0] = b->first;
+			br[1] = b->last;
+		}
+		return cand_runmerge(a->kind == CAND_DENSE ? ar : a->runs,
+				     a->kind == CAND_DENSE ? 1 : a->nruns,
+				     b->kind == CAND_DENSE ? br : b->runs,
+				     b->kind == CAND_DENSE ? 1 : b->nruns,
+				     op);
+	}
+	if (op == 0) {
+		lo = MAX(a->first, b->first);
+		hi = MIN(a->last, b->last);
+		if (lo >= hi)
+			return CANDnew(CAND_DENSE, 0, 0);
+	} else {
+		lo = MIN(a->first, b->first);
+		hi = MAX(a->last, b->last);
+	}
+	ALGODEBUG fprintf(stderr, "#%s: bitmap %s over " OIDFMT " oids\n",
+			  func, op == 0 ? "AND" : "OR", hi - lo);
+	if ((c = CANDnew(CAND_BITMAP, lo, hi)) == NULL)
+		return NULL;
+	nwords = (BUN) CANDWORD(hi - 1 - c->first) + 1;
+	cand_tobits(a, c->bits, c->first, lo, hi);
+	if (op == 1) {
+		/* OR b into it */
+		cand_tobits(b, c->bits, c->first, lo, hi);
+	} else if (b->kind == CAND_BITMAP) {
+		/* AND the overlapping words of b into it */
+		BUN d = (BUN) CANDWORD(c->first - b->first);
+
+		for (i = 0; i < nwords; i++)
+			c->bits[i] &= b->bits[i + d];
+	} else {
+		candword *bits = GDKzalloc(nwords * sizeof(candword));
+
+		if (bits == NULL) {
+			CANDdestroy(c);
+			return NULL;
+		}
+		cand_tobits(b, bits, c->first, lo, hi);
+		for (i = 0; i < nwords; i++)
+			c->bits[i] &= bits[i];
+		GDKfree(bits);
+	}
+	c->count = cand_popcount(c->bits, nwords);
+	return CANDcompact(c);
+}
+
+Cand *
+CANDintersect(const Cand *a, const Cand *b)
+{
+	return cand_combine(a, b, 0, "CANDintersect");
+}
+
+Cand *
+CANDunion(const Cand *a, const Cand *b)
+{
+	return cand_combine(a, b, 1, "CANDunion");
+}
@@ -0,0 +1,534 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * Cracker indices.
+ * 自适应索引（database cracking）
+ *
+ * A cracker index of a fixed-width numeric column is a copy of its
+ * values, each with the position it came from, that is partitioned
+ * a little further by every range select on the column.  The copy
+ * consists of pieces separated by pivots: a pivot (v, incl, pos) says
+ * that the values before pos are less than v (less than or equal to
+ * v if incl) and the values from pos on are not.  A select finds the
+ * pivots of its two bounds, or makes them by partitioning (only) the
+ * piece that the bound falls in, and then copies the positions between
+ * them.  Successive selects thus touch smaller and smaller pieces and
+ * the copy converges to sorted where the selects go.
+ *
+ * Nils and NaNs are left out of the copy: they never qualify for a
+ * range select.  Pieces smaller than CRACK_MINPIECE values get no
+ * pivots of their own; partitioning them again is cheap.
+ *
+ * Appended values are merged by "rippling": each piece moves up to
+ * make room for the new values of the pieces before it, by moving
+ * (some of) its first values to its end, and gets its own new values
+ * at its end.  A large append instead adds the values at the end and
+ * drops the pivots, starting the cracking afresh.  Any
+ * other update drops the cracker index (see the ALIGN* macros).
+ *
+ * The selects that crack the same column are serialized on a lock of
+ * the cracker index; they only hold it while partitioning and copying
+ * out the qualifying positions.  A few positions are sorted
+ * afterwards; many are put in order through a bitmap over the column,
+ * in O(count/64 + n) rather than O(n log n).
+ */
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+#define CRACK_MINPIECE	((BUN) 1 << 10)	/* smallest piece with its own pivots */
+#define CRACK_RESTART	8	/* restart if an append adds more than n/8 values */
+#define CRACK_SORTMAX	256	/* sort a result of less than n/256 positions */
+
+static int
+crack_type(int tpe)
+{
+	switch (ATOMstorage(tpe)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* does value x lie before pivot p? */
+#define CRACKBEFORE(x, p, FLD)	((p).incl ? (x) <= (p).v.FLD : (x) < (p).v.FLD)
+
+#define crackappend(TYPE)						\
+	do {								\
+		const TYPE *v = (const TYPE *) Hloc(b, BUNfirst(b));	\
+		TYPE *cv = (TYPE *) c->vals;				\
+		BUN i;							\
+									\
+		for (i = c->count; i < cnt; i++) {			\
+			if (v[i] == TYPE##_nil || v[i] != v[i])		\
+				continue;				\
+			cv[c->n] = v[i];				\
+			c->oids[c->n++] = (oid) i;			\
+		}							\
+	} while (0)
+
+/* Merge the new values in one pass over the pieces.  The new values
+ * are first bucketed by the piece they go to (piece k lies between
+ * pivots k - 1 and k).  Then, last piece first, each piece moves up by
+ * the number of new values of the pieces before it, and gets its own
+ * new values at its end.  Since the order within a piece is free, a
+ * piece that moves up by s only moves its first min(s, size) values
+ * to its end.  The cost is thus linear in the size of the copy, and
+ * much less than that if the new values go to the last pieces. */
+#define crackripple(TYPE, FLD)						\
+	do {								\
+		const TYPE *v = (const TYPE *) Hloc(b, BUNfirst(b));	\
+		TYPE *cv = (TYPE *) c->vals, *nv = (TYPE *) newvals;	\
+		BUN i, j, s, l, st, en;					\
+		int k, lo, hi, m;					\
+									\
+		for (i = c->count, j = 0; i < cnt; i++) {		\
+			if (v[i] == TYPE##_nil || v[i] != v[i])		\
+				continue;				\
+			/* the value belongs before pivot lo */		\
+			for (lo = 0, hi = c->npivots; lo < hi; ) {	\
+				m = (lo + hi) / 2;			\
+				if (CRACKBEFORE(v[i], c->pivots[m], FLD)) \
+					hi = m;				\
+				else					\
+					lo = m + 1;			\
+			}						\
+			piece[j++] = lo;				\
+			next[lo]++;					\
+		}							\
+		for (k = 0, s = 0; k <= c->npivots; k++) {		\
+			l = next[k];					\
+			next[k] = s;					\
+			s += l;						\
+		}							\
+		for (i = c->count, j = 0; i < cnt; i++) {		\
+			if (v[i] == TYPE##_nil || v[i] != v[i])		\
+				continue;				\
+			l = next[piece[j++]]++;				\
+			nv[l] = v[i];					\
+			newoids[l] = (oid) i;				\
+		}							\
+		/* now the new values of piece k are [s_k, next[k]),	\
+		 * with s_k = next[k - 1] the number of new values	\
+		 * of the pieces before k */				\
+		en = c->n;						\
+		for (k = c->npivots; k >= 0; k--) {			\
+			st = k > 0 ? c->pivots[k - 1].pos : 0;		\
+			s = k > 0 ? next[k - 1] : 0;			\
+			l = MIN(s, en - st);				\
+			for (i = 0; i < l; i++) {			\
+				cv[en + s - l + i] = cv[st + i];	\
+				c->oids[en + s - l + i] = c->oids[st + i]; \
+			}						\
+			for (i = s; i < next[k]; i++) {			\
+				cv[en + i] = nv[i];			\
+				c->oids[en + i] = newoids[i];		\
+			}						\
+			if (k < c->npivots)				\
+				c->pivots[k].pos = en + next[k];	\
+			en = st;					\
+		}							\
+		c->n += next[c->npivots];				\
+	} while (0)
+
+/* add the values [c->count, cnt) of the head of b to the copy */
+static gdk_return
+crack_add(BAT *b, Cracker *c, BUN cnt)
+{
+	BUN need = c->n + (cnt - c->count);
+	BUN *next = NULL;
+	void *vals, *newvals = NULL;
+	oid *oids, *newoids = NULL;
+	int *piece = NULL;
+
+	if (cnt == c->count)
+		return GDK_SUCCEED;
+	if (need > c->cap) {
+		BUN cap = MAX(need, c->cap + c->cap / 2);
+
+		if ((vals = GDKrealloc(c->vals, cap * ATOMsize(c->type))) == NULL)
+			return GDK_FAIL;
+		c->vals = vals;
+		if ((oids = GDKrealloc(c->oids, cap * sizeof(oid))) == NULL)
+			return GDK_FAIL;
+		c->oids = oids;
+		c->cap = cap;
+	}
+	if (c->npivots > 0 && cnt - c->count <= c->n / CRACK_RESTART) {
+		/* scratch space for rippling; without it we restart */
+		next = GDKzalloc((c->npivots + 1) * sizeof(BUN));
+		piece = GDKmalloc((cnt - c->count) * sizeof(int));
+		newvals = GDKmalloc((cnt - c->count) * ATOMsize(c->type));
+		newoids = GDKmalloc((cnt - c->count) * sizeof(oid));
+	}
+	if (newoids == NULL || newvals == NULL || piece == NULL || next == NULL) {
+		c->npivots = 0;
+		switch (c->type) {
+		case TYPE_bte:
+			crackappend(bte);
+			break;
+		case TYPE_sht:
+			crackappend(sht);
+			break;
+		case TYPE_int:
+			crackappend(int);
+			break;
+		case TYPE_lng:
+			crackappend(lng);
+			break;
+		case TYPE_flt:
+			crackappend(flt);
+			break;
+		case TYPE_dbl:
+			crackappend(dbl);
+			break;
+		}
+	} else {
+		switch (c->type) {
+		case TYPE_bte:
+			crackripple(bte, l);
+			break;
+		case TYPE_sht:
+			crackripple(sht, l);
+			break;
+		case TYPE_int:
+			crackripple(int, l);
+			break;
+		case TYPE_lng:
+			crackripple(lng, l);
+			break;
+		case TYPE_flt:
+			crackripple(flt, d);
+			break;
+		case TYPE_dbl:
+			crackripple(dbl, d);
+			break;
+		}
+	}
+	GDKfree(next);
+	GDKfree(piece);
+	GDKfree(newvals);
+	GDKfree(newoids);
+	c->count = cnt;
+	return GDK_SUCCEED;
+}
+
+static void
+crack_free(Cracker *c)
+{
+	MT_lock_destroy(&c->lock);
+	if (c->vals)
+		GDKfree(c->vals);
+	if (c->oids)
+		GDKfree(c->oids);
+	if (c->pivots)
+		GDKfree(c->pivots);
+	GDKfree(c);
+}
+
+BAT *
+BATcrack(BAT *b)
+{
+	Cracker *c;
+
+	BATcheck(b, "BATcrack");
+	if (isVIEW(b) || !crack_type(b->htype) || !BATtdense(b))
+		return NULL;
+	MT_lock_set(&GDKhashLock(ABS(b->batCacheid)), "BATcrack");
+	if (b->H->cracker == NULL) {
+		if ((c = (Cracker *) GDKzalloc(sizeof(Cracker))) == NULL) {
+			MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BATcrack");
+			return NULL;
+		}
+		c->type = ATOMstorage(b->htype);
+		MT_lock_init(&c->lock, "BATcrack");
+		ALGODEBUG fprintf(stderr, "#BATcrack: create cracker index(" BUNFMT ")\n", BATcount(b));
+		if (crack_add(b, c, BATcount(b)) != GDK_SUCCEED) {
+			MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BATcrack");
+			crack_free(c);
+			return NULL;
+		}
+		b->H->cracker = c;
+	}
+	MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BATcrack");
+	return b;
+}
+
+void
+CRACKremove(BAT *b)
+{
+	if (b && b->H->cracker) {
+		Cracker *c = b->H->cracker;
+
+		b->H->cracker = NULL;
+		crack_free(c);
+	}
+}
+
+void
+CRACKdestroy(BAT *b)
+{
+	if (b) {
+		CRACKremove(b);
+		if (BATmirror(b))
+			CRACKremove(BATmirror(b));
+	}
+}
+
+/* merge the values appended to either column of b */
+void
+CRACKappend(BAT *b)
+{
+	BAT *bm = BATmirror(b);
+	Cracker *c;
+
+	if ((c = b->H->cracker) != NULL) {
+		MT_lock_set(&c->lock, "CRACKappend");
+		if (BATcount(b) > c->count)
+			crack_add(b, c, BATcount(b));
+		MT_lock_unset(&c->lock, "CRACKappend");
+	}
+	if (bm && (c = bm->H->cracker) != NULL) {
+		MT_lock_set(&c->lock, "CRACKappend");
+		if (BATcount(bm) > c->count)
+			crack_add(bm, c, BATcount(bm));
+		MT_lock_unset(&c->lock, "CRACKappend");
+	}
+}
+
+/* partition [lo, hi) so that the values before pivot p come first;
+ * lo ends up at the first value that does not */
+#define crackpartition(TYPE, FLD, OP)					\
+	do {								\
+		TYPE *cv = (TYPE *) c->vals, pv = (TYPE) p->v.FLD, tv;	\
+		oid to;							\
+									\
+		while (lo < hi) {					\
+			if (cv[lo] OP pv) {				\
+				lo++;					\
+			} else if (!(cv[hi - 1] OP pv)) {		\
+				hi--;					\
+			} else {					\
+				hi--;					\
+				tv = cv[lo];				\
+				cv[lo] = cv[hi];			\
+				cv[hi] = tv;				\
+				to = c->oids[lo];			\
+				c->oids[lo] = c->oids[hi];		\
+				c->oids[hi] = to;			\
+				lo++;					\
+			}						\
+		}							\
+	} while (0)
+
+#define crackpiece(TYPE, FLD)						\
+	do {								\
+		if (p->incl)						\
+			crackpartition(TYPE, FLD, <=);			\
+		else							\
+			crackpartition(TYPE, FLD, <);			\
+	} while (0)
+
+/* is pivot a before pivot b? */
+static int
+crack_before(int type, const Crackpivot *a, const Crackpivot *b)
+{
+	if (type == TYPE_flt || type == TYPE_dbl) {
+		if (a->v.d != b->v.d)
+			return a->v.d < b->v.d;
+	} else if (a->v.l != b->v.l) {
+		return a->v.l < b->v.l;
+	}
+	return a->incl < b->incl;
+}
+
+/* the position of bound p in the copy, cracking its piece if needed */
+static BUN
+crack_bound(Cracker *c, Crackpivot *p)
+{
+	int k = 0, m, n = c->npivots;
+	BUN lo, hi, plo, phi;
+	Crackpivot *pivots;
+
+	while (k < n) {
+		m = (k + n) / 2;
+		if (crack_before(c->type, &c->pivots[m], p))
+			k = m + 1;
+		else
+			n = m;
+	}
+	if (k < c->npivots && !crack_before(c->type, p, &c->pivots[k]))
+		return c->pivots[k].pos;	/* cracked before */
+	lo = plo = k > 0 ? c->pivots[k - 1].pos : 0;
+	hi = phi = k < c->npivots ? c->pivots[k].pos : c->n;
+	ALGODEBUG fprintf(stderr, "#crack_bound: crack piece [" BUNFMT "," BUNFMT ")\n", plo, phi);
+	switch (c->type) {
+	case TYPE_bte:
+		crackpiece(bte, l);
+		break;
+	case TYPE_sht:
+		crackpiece(sht, l);
+		break;
+	case TYPE_int:
+		crackpiece(int, l);
+		break;
+	case TYPE_lng:
+		crackpiece(lng, l);
+		break;
+	case TYPE_flt:
+		crackpiece(flt, d);
+		break;
+	case TYPE_dbl:
+		crackpiece(dbl, d);
+		break;
+	}
+	p->pos = lo;
+	if (lo - plo < CRACK_MINPIECE || phi - lo < CRACK_MINPIECE)
+		return p->pos;	/* a piece would be too small */
+	if (c->npivots == c->maxpivots) {
+		m = c->maxpivots ? 2 * c->maxpivots : 64;
+		pivots = GDKrealloc(c->pivots, m * sizeof(Crackpivot));
+		if (pivots == NULL)
+			return p->pos;	/* just don't remember it */
+		c->pivots = pivots;
+		c->maxpivots = m;
+	}
+	memmove(&c->pivots[k + 1], &c->pivots[k],
+		(c->npivots - k) * sizeof(Crackpivot));
+	c->pivots[k] = *p;
+	c->npivots++;
+	return p->pos;
+}
+
+static void
+crack_value(int type, const void *v, Crackpivot *p)
+{
+	switch (type) {
+	case TYPE_bte:
+		p->v.l = *(const bte *) v;
+		break;
+	case TYPE_sht:
+		p->v.l = *(const sht *) v;
+		break;
+	case TYPE_int:
+		p->v.l = *(const int *) v;
+		break;
+	case TYPE_lng:
+		p->v.l = *(const lng *) v;
+		break;
+	case TYPE_flt:
+		p->v.d = *(const flt *) v;
+		break;
+	case TYPE_dbl:
+		p->v.d = *(const dbl *) v;
+		break;
+	}
+}
+
+/*
+ * Select the positions of the values of the head of b in the range
+ * given by tl, th, li and hi, where lval and hval tell whether there
+ * is a lower and an upper bound, as BATsubselect has normalized them
+ * (no anti, no nil point select).  The result is a candidate list
+ * into the tail of b, which must be dense.  Returns NULL if the
+ * cracker index cannot be used, so that the caller falls back to a
+ * scan.
+ */
+BAT *
+CRACKselect(BAT *b, const void *tl, const void *th, int li, int hi, int lval, int hval)
+{
+	Cracker *c = b->H->cracker;
+	Crackpivot pl, ph;
+	BUN l = 0, h, n, i, j, cnt = BATcount(b);
+	oid *dst, off = b->tseqbase;
+	candword *bits = NULL, w;
+	BAT *bn;
+
+	if (c == NULL || c->type != ATOMstorage(b->htype) || !BATtdense(b))
+		return NULL;
+	MT_lock_set(&c->lock, "CRACKselect");
+	if (cnt < c->count ||
+	    (cnt > c->count && crack_add(b, c, cnt) != GDK_SUCCEED)) {
+		MT_lock_unset(&c->lock, "CRACKselect");
+		return NULL;
+	}
+	h = c->n;
+	if (lval) {
+		crack_value(c->type, tl, &pl);
+		pl.incl = !li;
+		l = crack_bound(c, &pl);
+	}
+	if (hval) {
+		crack_value(c->type, th, &ph);
+		ph.incl = hi;
+		h = crack_bound(c, &ph);
+	}
+	n = h > l ? h - l : 0;
+	if ((bn = BATnew(TYPE_void, TYPE_oid, n)) == NULL) {
+		MT_lock_unset(&c->lock, "CRACKselect");
+		return NULL;
+	}
+	dst = (oid *) Tloc(bn, BUNfirst(bn));
+	if (n >= cnt / CRACK_SORTMAX &&
+	    (bits = GDKzalloc((cnt / CANDWORDBITS + 1) * sizeof(candword))) != NULL) {
+		/* the positions are in [0, cnt): put them in order
+		 * through a bitmap rather than sorting them */
+		for (i = l; i < h; i++)
+			bits[c->oids[i] / CANDWORDBITS] |=
+				(candword) 1 << (c->oids[i] % CANDWORDBITS);
+		MT_lock_unset(&c->lock, "CRACKselect");
+		for (i = 0, j = 0; j < n; i++) {
+			for (w = bits[i]; w; w &= w - 1)
+				dst[j++] = off + i * CANDWORDBITS +
+					(oid) candword_ctz(w);
+		}
+		GDKfree(bits);
+	} else {
+		if (n > 0)
+			memcpy(dst, c->oids + l, n * sizeof(oid));
+		MT_lock_unset(&c->lock, "CRACKselect");
+
+		for (i = 0; i < n; i++)
+			dst[i] += off;
+		if (n > 1)
+			GDKqsort(dst, NULL, NULL, n, sizeof(oid), 0, TYPE_oid);
+	}
+	BATsetcount(bn, n);
+	bn->tsorted = 1;
+	bn->trevsorted = bn->U->count <= 1;
+	bn->tkey = 1;
+	bn->tdense = bn->U->count <= 1;
+	if (bn->U->count == 1)
+		bn->tseqbase = *(oid *) Tloc(bn, BUNfirst(bn));
+	bn->T->nonil = 1;
+	bn->T->nil = 0;
+	bn->hsorted = 1;
+	bn->hdense = 1;
+	bn->hseqbase = 0;
+	bn->hkey = 1;
+	bn->hrevsorted = bn->U->count <= 1;
+	return bn;
+}
@@ -137,6 +137,9 @@ BATundo(BAT *b)
 	BATcheck(b, "BATundo");
 	DELTADEBUG printf("#BATundo %s \n", BATgetId(b));
 	ALIGNundo(b);
+	ZONEdestroy(b);
+	STATSdestroy(b);
+	CRACKdestroy(b);
 	if (b->batDirtyflushed) {
 		b->batDirtydesc = b->H->heap.dirty = b->T->heap.dirty = 1;
 	} else {
@@ -20,6 +20,8 @@
 #include "monetdb_config.h"
 #include "gdk.h"
 #include "gdk_private.h"
+#include "gdk_mapreduce.h"
+#include "gdk_calc_private.h"	/* for ulng */
 
 /* how much to extend the extent and histo bats when we run out of space */
 #define GROUPBATINCR	8192
@@ -44,7 +46,7 @@
  * is always created.  In other words, the groups argument may not be
  * NULL, but the extents and histo arguments may be NULL.
  *
- * There are six different implementations of the grouping code.
+ * There are nine different implementations of the grouping code.
  *
  * If it can be trivially determined that all groups are singletons,
  * we can produce the outputs trivially.
@@ -60,8 +62,19 @@
  * consecutive values in b and need to scan sections of g for equal
  * groups.
  *
+ * If b is a bte, sht or int column with a small value range, we use
+ * the values as index into an array of group ids.
+ *
  * If a hash table already exists on b, we can make use of it.
  *
+ * If b is large, we group in parallel: the input is partitioned on
+ * the hash of value and input group, and each partition is grouped on
+ * its own, unless b is of a fixed-width type and the column
+ * statistics tell there are few groups.
+ *
+ * If b is of a fixed-width type, we use an open-addressing hash table
+ * whose size depends on the number of groups.
+ *
  * Otherwise we build a partial hash table on the fly.
  *
  * A decision should be made on the order in which grouping occurs.
@@ -167,6 +180,598 @@
 		}							\
 	} while (0)
 
+/* Parallel partitioned grouping.
+ *
+ * For large inputs without a hash table the partial hash table is
+ * replaced by a parallel algorithm.  A hash of each value, combined
+ * with its incoming group id, is computed by a parallel scan, and the
+ * positions are radix-partitioned on the high bits of that hash.
+ * Partitioning is stable, so every partition lists its positions in
+ * ascending order.  Equal (value, group) combinations always land in
+ * the same partition, so each partition is grouped on its own by a
+ * worker using a local hash table over the low bits.  A worker does
+ * not number the groups it finds: it sets the groups entry of each
+ * position to the position of the first member of its group (the
+ * representative), which for a new group is the position itself.
+ *
+ * A sequential scan over the positions then numbers the groups in
+ * order of their representatives, i.e. in order of first appearance,
+ * exactly as the sequential algorithm does; the extents and histo
+ * outputs are filled in that same scan.  The result is therefore
+ * identical to that of the partial hash table. */
+
+#define GROUP_PARALLEL_MINSIZE	((BUN) 1 << 20) /* don't bother below */
+#define GROUP_PARTSIZE		((BUN) 1 << 16) /* target partition size */
+#define GROUP_MAXBITS		10	/* at most 1 << GROUP_MAXBITS partitions */
+
+typedef struct {
+	BATiter bi;		/* the input column */
+	const void *vals;	/* its values, for the fixed-width types */
+	int type;		/* its type */
+	int tpe;		/* its storage type, TYPE_any if not fixed-width */
+	int (*cmp)(const void *, const void *);
+	BUN first;		/* BUNfirst(b) */
+	const oid *grps;	/* incoming groups, or NULL */
+	BUN grain;		/* positions per chunk of a parallel scan */
+	int bits;		/* 1 << bits partitions */
+	unsigned int *hv;	/* hash of each position */
+	BUN *cnt;		/* per chunk per partition counters */
+	BUN *pos;		/* positions in partition order */
+	BUN *bnd;		/* partition bounds in pos */
+	BUN *boff;		/* start of the buckets of each partition */
+	BUN *bucket;		/* local hash tables of the partitions */
+	BUN *link;		/* bucket chains, parallel to pos */
+	oid *ngrps;		/* output: representative of each position */
+} grppar_t;
+
+/* murmur3 finalizer: we use the high bits for the partition number
+ * and the low bits for the bucket */
+static inline unsigned int
+grp_fmix(unsigned int h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35U;
+	h ^= h >> 16;
+	return h;
+}
+
+/* the value part of the hash; flt and dbl add 0 so that -0 and +0,
+ * which compare equal, hash equal */
+#define grp_key_bte(v)	((unsigned int) (unsigned char) (v))
+#define grp_key_sht(v)	((unsigned int) (unsigned short) (v))
+#define grp_key_int(v)	((unsigned int) (v))
+#define grp_key_lng(v)	((unsigned int) ((v) ^ ((v) >> 32)))
+static inline unsigned int
+grp_key_flt(flt v)
+{
+	unsigned int k;
+
+	v += 0;
+	memcpy(&k, &v, sizeof(k));
+	return k;
+}
+static inline unsigned int
+grp_key_dbl(dbl v)
+{
+	lng k;
+
+	v += 0;
+	memcpy(&k, &v, sizeof(k));
+	return grp_key_lng(k);
+}
+
+static inline unsigned int
+grp_hash(unsigned int k, const oid *grps, BUN i)
+{
+	if (grps)
+		k ^= grp_fmix((unsigned int) (grps[i] ^ (grps[i] >> 16 >> 16))) * 0x9e3779b9U;
+	return grp_fmix(k);
+}
+
+/* hash the chunk [lo, hi) and count the positions per partition */
+static void
+grp_histo(BUN lo, BUN hi, void *arg)
+{
+	grppar_t *gp = arg;
+	BUN *cnt = gp->cnt + ((lo / gp->grain) << gp->bits);
+	unsigned int *hv = gp->hv;
+	const oid *grps = gp->grps;
+	int shift = 32 - gp->bits;
+	BUN i;
+
+	switch (gp->tpe) {
+	case TYPE_bte:
+		for (i = lo; i < hi; i++)
+			hv[i] = grp_hash(grp_key_bte(((const bte *) gp->vals)[i]), grps, i);
+		break;
+	case TYPE_sht:
+		for (i = lo; i < hi; i++)
+			hv[i] = grp_hash(grp_key_sht(((const sht *) gp->vals)[i]), grps, i);
+		break;
+	case TYPE_int:
+		for (i = lo; i < hi; i++)
+			hv[i] = grp_hash(grp_key_int(((const int *) gp->vals)[i]), grps, i);
+		break;
+	case TYPE_lng:
+		for (i = lo; i < hi; i++)
+			hv[i] = grp_hash(grp_key_lng(((const lng *) gp->vals)[i]), grps, i);
+		break;
+	case TYPE_flt:
+		for (i = lo; i < hi; i++)
+			hv[i] = grp_hash(grp_key_flt(((const flt *) gp->vals)[i]), grps, i);
+		break;
+	case TYPE_dbl:
+		for (i = lo; i < hi; i++)
+			hv[i] = grp_hash(grp_key_dbl(((const dbl *) gp->vals)[i]), grps, i);
+		break;
+	default:
+		for (i = lo; i < hi; i++)
+			hv[i] = grp_hash((unsigned int) ATOMhash(gp->type, BUNtail(gp->bi, gp->first + i)),
+					 grps, i);
+		break;
+	}
+	if (shift == 32)
+		cnt[0] += hi - lo;
+	else
+		for (i = lo; i < hi; i++)
+			cnt[hv[i] >> shift]++;
+}
+
+/* distribute the positions of the chunk [lo, hi) over the partitions */
+static void
+grp_scatter(BUN lo, BUN hi, void *arg)
+{
+	grppar_t *gp = arg;
+	BUN *cnt = gp->cnt + ((lo / gp->grain) << gp->bits);
+	const unsigned int *hv = gp->hv;
+	int shift = 32 - gp->bits;
+	BUN i;
+
+	if (shift == 32) {
+		for (i = lo; i < hi; i++)
+			gp->pos[cnt[0]++] = i;
+	} else {
+		for (i = lo; i < hi; i++)
+			gp->pos[cnt[hv[i] >> shift]++] = i;
+	}
+}
+
+#define GRPpartloop(EQ)							\
+	do {								\
+		for (k = s; k < e; k++) {				\
+			i = pos[k];					\
+			prb = hv[i] & mask;				\
+			for (hb = bucket[prb];				\
+			     hb != BUN_NONE;				\
+			     hb = link[hb]) {				\
+				j = pos[hb];				\
+				if ((grps == NULL || grps[i] == grps[j]) && \
+				    (EQ)) {				\
+					ngrps[i] = (oid) j;		\
+					break;				\
+				}					\
+			}						\
+			if (hb == BUN_NONE) {				\
+				/* new group, represented by i */	\
+				ngrps[i] = (oid) i;			\
+				link[k] = bucket[prb];			\
+				bucket[prb] = k;			\
+			}						\
+		}							\
+	} while (0)
+
+/* group the partitions [lo, hi) */
+static void
+grp_partition(BUN lo, BUN hi, void *arg)
+{
+	grppar_t *gp = arg;
+	const BUN *pos = gp->pos;
+	const unsigned int *hv = gp->hv;
+	const oid *grps = gp->grps;
+	oid *ngrps = gp->ngrps;
+	BUN *link = gp->link, *bucket;
+	BUN c, s, e, k, i, j, hb, prb, mask;
+
+	for (c = lo; c < hi; c++) {
+		s = gp->bnd[c];
+		e = gp->bnd[c + 1];
+		bucket = gp->bucket + gp->boff[c];
+		mask = gp->boff[c + 1] - gp->boff[c] - 1;
+		for (k = 0; k <= mask; k++)
+			bucket[k] = BUN_NONE;
+		switch (gp->tpe) {
+		case TYPE_bte: {
+			const bte *w = gp->vals;
+			GRPpartloop(w[i] == w[j]);
+			break;
+		}
+		case TYPE_sht: {
+			const sht *w = gp->vals;
+			GRPpartloop(w[i] == w[j]);
+			break;
+		}
+		case TYPE_int: {
+			const int *w = gp->vals;
+			GRPpartloop(w[i] == w[j]);
+			break;
+		}
+		case TYPE_lng: {
+			const lng *w = gp->vals;
+			GRPpartloop(w[i] == w[j]);
+			break;
+		}
+		case TYPE_flt: {
+			const flt *w = gp->vals;
+			GRPpartloop(w[i] == w[j]);
+			break;
+		}
+		case TYPE_dbl: {
+			const dbl *w = gp->vals;
+			GRPpartloop(w[i] == w[j]);
+			break;
+		}
+		default:
+			GRPpartloop((*gp->cmp)(BUNtail(gp->bi, gp->first + i),
+					       BUNtail(gp->bi, gp->first + j)) == 0);
+			break;
+		}
+	}
+}
+
+/* Set ngrps[i] to the position of the first value of the group of
+ * position i, using all threads. */
+static gdk_return
+grp_parallel(BAT *b, const oid *grps, oid *ngrps)
+{
+	grppar_t gp;
+	BUN n = BATcount(b), nchunks, npart, c, i, s, t, sz;
+	int nthreads = GDKnr_threads > 0 ? GDKnr_threads : 1;
+	gdk_return ret = GDK_FAIL;
+
+	memset(&gp, 0, sizeof(gp));
+	gp.bi = bat_iterator(b);
+	gp.first = BUNfirst(b);
+	gp.tpe = ATOMstorage(b->ttype);
+	gp.type = b->ttype;
+	switch (gp.tpe) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		/* like GRPhashloop, compare the stored values */
+		gp.vals = Tloc(b, BUNfirst(b));
+		break;
+	default:
+		gp.tpe = TYPE_any;
+		break;
+	}
+	gp.cmp = BATatoms[b->ttype].atomCmp;
+	gp.grps = grps;
+	gp.ngrps = ngrps;
+	for (gp.bits = 0;
+	     gp.bits < GROUP_MAXBITS &&
+		     ((n >> gp.bits) > GROUP_PARTSIZE ||
+		      ((BUN) 1 << gp.bits) < (BUN) nthreads * 4);
+	     gp.bits++)
+		;
+	npart = (BUN) 1 << gp.bits;
+	gp.grain = (n + nthreads - 1) / nthreads;
+	nchunks = (n + gp.grain - 1) / gp.grain;
+
+	gp.hv = GDKmalloc(n * sizeof(unsigned int));
+	gp.pos = GDKmalloc(n * sizeof(BUN));
+	gp.link = GDKmalloc(n * sizeof(BUN));
+	gp.cnt = GDKzalloc((nchunks << gp.bits) * sizeof(BUN));
+	gp.bnd = GDKmalloc((npart + 1) * sizeof(BUN));
+	gp.boff = GDKmalloc((npart + 1) * sizeof(BUN));
+	if (gp.hv == NULL || gp.pos == NULL || gp.link == NULL ||
+	    gp.cnt == NULL || gp.bnd == NULL || gp.boff == NULL)
+		goto bailout;
+
+	/* partition */
+	MRparallel_for(0, n, gp.grain, grp_histo, &gp);
+	for (c = 0, s = 0; c < npart; c++) {
+		gp.bnd[c] = s;
+		for (i = 0; i < nchunks; i++) {
+			t = gp.cnt[(i << gp.bits) + c];
+			gp.cnt[(i << gp.bits) + c] = s;
+			s += t;
+		}
+	}
+	gp.bnd[npart] = s;
+	assert(s == n);
+	MRparallel_for(0, n, gp.grain, grp_scatter, &gp);
+
+	/* a power-of-two number of buckets for each partition, at
+	 * least as many as the partition has values; we use the low
+	 * bits of the hash, the high bits are the partition number */
+	for (c = 0, s = 0; c < npart; c++) {
+		gp.boff[c] = s;
+		for (sz = 1;
+		     sz < gp.bnd[c + 1] - gp.bnd[c] && sz < ((BUN) 1 << (32 - gp.bits));
+		     sz <<= 1)
+			;
+		s += sz;
+	}
+	gp.boff[npart] = s;
+	if ((gp.bucket = GDKmalloc(s * sizeof(BUN))) == NULL)
+		goto bailout;
+
+	/* group the partitions */
+	MRparallel_for(0, npart, 1, grp_partition, &gp);
+	ret = GDK_SUCCEED;
+
+  bailout:
+	if (gp.hv)
+		GDKfree(gp.hv);
+	if (gp.pos)
+		GDKfree(gp.pos);
+	if (gp.link)
+		GDKfree(gp.link);
+	if (gp.cnt)
+		GDKfree(gp.cnt);
+	if (gp.bnd)
+		GDKfree(gp.bnd);
+	if (gp.boff)
+		GDKfree(gp.boff);
+	if (gp.bucket)
+		GDKfree(gp.bucket);
+	if (ret != GDK_SUCCEED)
+		GDKerror("BATgroup: cannot allocate enough memory\n");
+	return ret;
+}
+
+/* Open-addressing group hash table.
+ *
+ * For fixed-width types without a persistent hash table we don't
+ * build a partial hash table (which needs a link entry per row), but
+ * a linear-probing table whose slots contain a group id and a
+ * one-byte fingerprint taken from the high bits of the hash (0 marks
+ * an empty slot).  A probe only looks at the value of a group's
+ * representative if the fingerprints match.  The table is kept at
+ * most half full and is doubled when needed, so its size depends on
+ * the number of groups, not on the number of rows.  Per group we
+ * remember the position of its first member (to compare values) and
+ * its hash (to reinsert it when the table grows). */
+
+#define GROUP_OA_MINSIZE	((BUN) 1 << 10) /* initial number of slots */
+#define GROUP_OA_MAXGRPS	((BUN) 1 << 16) /* preferred over parallel below */
+
+typedef struct {
+	unsigned char *fp;	/* fingerprint of each slot, 0 if empty */
+	oid *gid;		/* group id of each slot */
+	BUN mask;		/* number of slots - 1 */
+	BUN *rep;		/* first member of each group */
+	unsigned int *ghv;	/* hash of each group */
+	BUN maxgrps;		/* allocated size of rep and ghv */
+} grpoa_t;
+
+#define grp_oa_fp(h)	((unsigned char) (((h) >> 25) | 0x80))
+
+static void
+grp_oa_destroy(grpoa_t *oa)
+{
+	if (oa->fp)
+		GDKfree(oa->fp);
+	if (oa->gid)
+		GDKfree(oa->gid);
+	if (oa->rep)
+		GDKfree(oa->rep);
+	if (oa->ghv)
+		GDKfree(oa->ghv);
+	memset(oa, 0, sizeof(*oa));
+}
+
+static gdk_return
+grp_oa_init(grpoa_t *oa, BUN maxgrps)
+{
+	BUN sz;
+
+	memset(oa, 0, sizeof(*oa));
+	for (sz = GROUP_OA_MINSIZE; sz < 2 * maxgrps; sz <<= 1)
+		;
+	oa->mask = sz - 1;
+	oa->maxgrps = maxgrps < GROUP_OA_MINSIZE ? GROUP_OA_MINSIZE : maxgrps;
+	oa->fp = GDKzalloc(sz);
+	oa->gid = GDKmalloc(sz * sizeof(oid));
+	oa->rep = GDKmalloc(oa->maxgrps * sizeof(BUN));
+	oa->ghv = GDKmalloc(oa->maxgrps * sizeof(unsigned int));
+	if (oa->fp == NULL || oa->gid == NULL ||
+	    oa->rep == NULL || oa->ghv == NULL) {
+		grp_oa_destroy(oa);
+		return GDK_FAIL;
+	}
+	return GDK_SUCCEED;
+}
+
+static inline void
+grp_oa_insert(grpoa_t *oa, unsigned int h, oid grp)
+{
+	BUN k;
+
+	for (k = h & oa->mask; oa->fp[k]; k = (k + 1) & oa->mask)
+		;
+	oa->fp[k] = grp_oa_fp(h);
+	oa->gid[k] = grp;
+}
+
+/* make room for group number ngrp */
+static gdk_return
+grp_oa_grow(grpoa_t *oa, oid ngrp)
+{
+	if (ngrp >= oa->maxgrps) {
+		BUN *rep;
+		unsigned int *ghv;
+
+		rep = GDKrealloc(oa->rep, 2 * oa->maxgrps * sizeof(BUN));
+		if (rep == NULL)
+			return GDK_FAIL;
+		oa->rep = rep;
+		ghv = GDKrealloc(oa->ghv, 2 * oa->maxgrps * sizeof(unsigned int));
+		if (ghv == NULL)
+			return GDK_FAIL;
+		oa->ghv = ghv;
+		oa->maxgrps *= 2;
+	}
+	if (2 * (ngrp + 1) > oa->mask + 1) {
+		BUN sz = 2 * (oa->mask + 1);
+		unsigned char *fp;
+		oid *gid, grp;
+
+		if ((fp = GDKzalloc(sz)) == NULL)
+			return GDK_FAIL;
+		if ((gid = GDKmalloc(sz * sizeof(oid))) == NULL) {
+			GDKfree(fp);
+			return GDK_FAIL;
+		}
+		GDKfree(oa->fp);
+		GDKfree(oa->gid);
+		oa->fp = fp;
+		oa->gid = gid;
+		oa->mask = sz - 1;
+		for (grp = 0; grp < ngrp; grp++)
+			grp_oa_insert(oa, oa->ghv[grp], grp);
+	}
+	return GDK_SUCCEED;
+}
+
+#define GRPoaloop(TYPE)							\
+	do {								\
+		const TYPE *w = (const TYPE *) Tloc(b, BUNfirst(b));	\
+		for (r = BUNfirst(b), p = r, q = r + BATcount(b); p < q; p++) { \
+			BUN i = p - r, k;				\
+			unsigned int hv = grp_hash(grp_key_##TYPE(w[i]), grps, i); \
+			unsigned char f = grp_oa_fp(hv);		\
+			for (k = hv & oa.mask; oa.fp[k]; k = (k + 1) & oa.mask) { \
+				if (oa.fp[k] == f) {			\
+					oid grp = oa.gid[k];		\
+					BUN j = oa.rep[grp];		\
+					if (w[i] == w[j] &&		\
+					    (grps == NULL || grps[i] == grps[j])) { \
+						ngrps[i] = grp;		\
+						if (histo)		\
+							cnts[grp]++;	\
+						if (gn->tsorted &&	\
+						    grp != ngrp - 1)	\
+							gn->tsorted = 0; \
+						break;			\
+					}				\
+				}					\
+			}						\
+			if (oa.fp[k] == 0) {				\
+				/* new group */				\
+				if (grp_oa_grow(&oa, ngrp) != GDK_SUCCEED) { \
+					grp_oa_destroy(&oa);		\
+					GDKerror("BATgroup: cannot allocate hash table\n"); \
+					goto error;			\
+				}					\
+				oa.rep[ngrp] = i;			\
+				oa.ghv[ngrp] = hv;			\
+				grp_oa_insert(&oa, hv, ngrp);		\
+				GRPnotfound();				\
+			}						\
+		}							\
+	} while (0)
+
+/* Direct-array grouping.
+ *
+ * If a bte, sht or int column has a small value range, we don't need
+ * a hash table at all: value v with incoming group g is mapped
+ * straight onto slot g * range + (v - min + 1) of an array of group
+ * ids, slot 0 of each incoming group being reserved for nil.  A quick
+ * pre-pass determines the value range and the largest incoming group
+ * id; it gives up as soon as the array would get too large. */
+
+#define GROUP_DIRECT_MAXSLOTS	((BUN) 1 << 20) /* at most this many slots */
+#define GROUP_DIRECT_BLOCK	((BUN) 1 << 12) /* check range per block */
+
+#define GRPdirectrange(TYPE)						\
+	do {								\
+		const TYPE *w = (const TYPE *) Tloc(b, BUNfirst(b));	\
+		for (k = i; k < j; k++) {				\
+			if (w[k] == TYPE##_nil)				\
+				continue;				\
+			if (w[k] < mn)					\
+				mn = w[k];				\
+			if (w[k] > mx)					\
+				mx = w[k];				\
+		}							\
+	} while (0)
+
+/* Determine whether b (with incoming groups grps) can be grouped
+ * using an array of at most GROUP_DIRECT_MAXSLOTS slots.  If so,
+ * return 1 and set *minp to the smallest non-nil value, *rangep to
+ * the number of slots per incoming group, and *nslotsp to the total
+ * number of slots. */
+static int
+grp_direct_range(BAT *b, const oid *grps, lng *minp, BUN *rangep, BUN *nslotsp)
+{
+	BUN n = BATcount(b), i, j, k, range = 1;
+	lng mn = GDK_lng_max, mx = GDK_lng_min;
+	oid gmax = 0;
+
+	for (i = 0; i < n; i = j) {
+		j = i + GROUP_DIRECT_BLOCK;
+		if (j > n)
+			j = n;
+		switch (ATOMstorage(b->ttype)) {
+		case TYPE_bte:
+			GRPdirectrange(bte);
+			break;
+		case TYPE_sht:
+			GRPdirectrange(sht);
+			break;
+		case TYPE_int:
+			GRPdirectrange(int);
+			break;
+		default:
+			return 0;
+		}
+		if (grps) {
+			for (k = i; k < j; k++)
+				if (grps[k] > gmax)
+					gmax = grps[k];
+		}
+		range = mn > mx ? 1 : (BUN) (mx - mn) + 2;
+		if (range > GROUP_DIRECT_MAXSLOTS ||
+		    gmax >= GROUP_DIRECT_MAXSLOTS / range)
+			return 0;
+	}
+	/* an array much larger than the input isn't worth it */
+	if (range * (gmax + 1) > n && range * (gmax + 1) > GROUP_OA_MINSIZE)
+		return 0;
+	*minp = mn > mx ? 0 : mn;
+	*rangep = range;
+	*nslotsp = range * (gmax + 1);
+	return 1;
+}
+
+#define GRPdirectloop(TYPE)						\
+	do {								\
+		const TYPE *w = (const TYPE *) Tloc(b, BUNfirst(b));	\
+		for (r = BUNfirst(b), p = r, q = r + BATcount(b); p < q; p++) { \
+			BUN i = p - r, k;				\
+			oid grp;					\
+			k = w[i] == TYPE##_nil ? 0 : (BUN) (w[i] - mn) + 1; \
+			if (grps)					\
+				k += (BUN) grps[i] * range;		\
+			if ((grp = slots[k]) != oid_nil) {		\
+				ngrps[i] = grp;				\
+				if (histo)				\
+					cnts[grp]++;			\
+				if (gn->tsorted && grp != ngrp - 1)	\
+					gn->tsorted = 0;		\
+			} else {					\
+				slots[k] = ngrp;			\
+				GRPnotfound();				\
+			}						\
+		}							\
+	} while (0)
+
 gdk_return
 BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 		  BAT *b, BAT *g, BAT *e, BAT *h, int subsorted)
@@ -183,7 +788,10 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 	char *ext = NULL;
 	Hash *hs = NULL;
 	BUN hb;
-	BUN maxgrps;
+	BUN maxgrps, ngrpest;
+	int fixed;
+	lng mn;
+	BUN range, nslots;
 
 	if (b == NULL || !BAThdense(b)) {
 		GDKerror("BATgroup: b must be dense-headed\n");
@@ -326,13 +934,37 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 	if (gn == NULL)
 		goto error;
 	ngrps = (oid *) Tloc(gn, BUNfirst(gn));
-	maxgrps = BATcount(b) / 10;
-	if (e && maxgrps < BATcount(e))
-		maxgrps += BATcount(e);
-	if (h && maxgrps < BATcount(h))
-		maxgrps += BATcount(h);
-	if (maxgrps < GROUPBATINCR)
-		maxgrps = BATcount(b);
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		fixed = 1;
+		break;
+	default:
+		fixed = 0;
+		break;
+	}
+	if (g == NULL &&
+	    (ngrpest = STATSdistinct(BATmirror(b))) != BUN_NONE) {
+		/* the column statistics estimate the number of groups */
+		maxgrps = ngrpest + ngrpest / 8;
+		if (maxgrps < GROUPBATINCR)
+			maxgrps = GROUPBATINCR;
+		if (maxgrps > BATcount(b))
+			maxgrps = BATcount(b);
+	} else {
+		ngrpest = 0;
+		maxgrps = BATcount(b) / 10;
+		if (e && maxgrps < BATcount(e))
+			maxgrps += BATcount(e);
+		if (h && maxgrps < BATcount(h))
+			maxgrps += BATcount(h);
+		if (maxgrps < GROUPBATINCR)
+			maxgrps = BATcount(b);
+	}
 	if (extents) {
 		en = BATnew(TYPE_void, TYPE_oid, maxgrps);
 		if (en == NULL)
@@ -447,6 +1079,45 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 			/* start a new group */
 			GRPnotfound();
 		}
+	} else if ((ATOMstorage(b->ttype) == TYPE_bte ||
+		    ATOMstorage(b->ttype) == TYPE_sht ||
+		    ATOMstorage(b->ttype) == TYPE_int) &&
+		   grp_direct_range(b, grps, &mn, &range, &nslots)) {
+		oid *slots;
+
+		/* small value range: use the value (and input group)
+		 * as index into an array of group ids */
+		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT ","
+				  "g=%s#" BUNFMT ","
+				  "e=%s#" BUNFMT ","
+				  "h=%s#" BUNFMT ",subsorted=%d): "
+				  "direct array of " BUNFMT " slots\n",
+				  BATgetId(b), BATcount(b),
+				  g ? BATgetId(g) : "NULL", g ? BATcount(g) : 0,
+				  e ? BATgetId(e) : "NULL", e ? BATcount(e) : 0,
+				  h ? BATgetId(h) : "NULL", h ? BATcount(h) : 0,
+				  subsorted, nslots);
+		if ((slots = GDKmalloc(nslots * sizeof(oid))) == NULL) {
+			GDKerror("BATgroup: cannot allocate group array\n");
+			goto error;
+		}
+		for (r = 0; r < nslots; r++)
+			slots[r] = oid_nil;
+		gn->tsorted = 1; /* be optimistic */
+		switch (ATOMstorage(b->ttype)) {
+		case TYPE_bte:
+			GRPdirectloop(bte);
+			break;
+		case TYPE_sht:
+			GRPdirectloop(sht);
+			break;
+		case TYPE_int:
+			GRPdirectloop(int);
+			break;
+		default:
+			assert(0);
+		}
+		GDKfree(slots);
 	} else if (b->T->hash) {
 		/* we already have a hash table on b */
 		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT ","
@@ -506,6 +1177,89 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 				GRPnotfound();
 			}
 		}
+	} else if (GDKnr_threads > 1 &&
+		   BATcount(b) >= GROUP_PARALLEL_MINSIZE &&
+		   !(fixed && ngrpest > 0 && ngrpest <= GROUP_OA_MAXGRPS)) {
+		/* large and no hash table: parallel partitioned
+		 * grouping, then number the groups in order of their
+		 * first member; it needs some 28 bytes per row, so if
+		 * the statistics tell there are few groups, the
+		 * open-addressing table below, which only needs space
+		 * per group, does better */
+		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT ","
+				  "g=%s#" BUNFMT ","
+				  "e=%s#" BUNFMT ","
+				  "h=%s#" BUNFMT ",subsorted=%d): "
+				  "parallel partitioned grouping\n",
+				  BATgetId(b), BATcount(b),
+				  g ? BATgetId(g) : "NULL", g ? BATcount(g) : 0,
+				  e ? BATgetId(e) : "NULL", e ? BATcount(e) : 0,
+				  h ? BATgetId(h) : "NULL", h ? BATcount(h) : 0,
+				  subsorted);
+		if (grp_parallel(b, grps, ngrps) != GDK_SUCCEED)
+			goto error;
+		gn->tsorted = 1; /* be optimistic */
+		for (r = BUNfirst(b), p = r, q = r + BATcount(b); p < q; p++) {
+			if (ngrps[p - r] == (oid) (p - r)) {
+				/* first member of its group */
+				GRPnotfound();
+			} else {
+				/* the representative comes earlier and
+				 * has been numbered already */
+				oid grp = ngrps[ngrps[p - r]];
+				ngrps[p - r] = grp;
+				if (histo)
+					cnts[grp]++;
+				if (gn->tsorted && grp != ngrp - 1)
+					gn->tsorted = 0;
+			}
+		}
+	} else if (fixed) {
+		grpoa_t oa;
+
+		/* fixed-width and no hash table: group using an
+		 * open-addressing table sized by the number of
+		 * groups; there are at least as many groups as there
+		 * are in the input grouping, and without one the
+		 * column statistics may tell */
+		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT ","
+				  "g=%s#" BUNFMT ","
+				  "e=%s#" BUNFMT ","
+				  "h=%s#" BUNFMT ",subsorted=%d): "
+				  "open-addressing hash table\n",
+				  BATgetId(b), BATcount(b),
+				  g ? BATgetId(g) : "NULL", g ? BATcount(g) : 0,
+				  e ? BATgetId(e) : "NULL", e ? BATcount(e) : 0,
+				  h ? BATgetId(h) : "NULL", h ? BATcount(h) : 0,
+				  subsorted);
+		if (grp_oa_init(&oa, e ? BATcount(e) : ngrpest) != GDK_SUCCEED) {
+			GDKerror("BATgroup: cannot allocate hash table\n");
+			goto error;
+		}
+		gn->tsorted = 1; /* be optimistic */
+		switch (ATOMstorage(b->ttype)) {
+		case TYPE_bte:
+			GRPoaloop(bte);
+			break;
+		case TYPE_sht:
+			GRPoaloop(sht);
+			break;
+		case TYPE_int:
+			GRPoaloop(int);
+			break;
+		case TYPE_lng:
+			GRPoaloop(lng);
+			break;
+		case TYPE_flt:
+			GRPoaloop(flt);
+			break;
+		case TYPE_dbl:
+			GRPoaloop(dbl);
+			break;
+		default:
+			assert(0);
+		}
+		grp_oa_destroy(&oa);
 	} else {
 		bit gc = g && (g->tsorted || g->trevsorted);
 		const char *nme;
@@ -698,3 +1452,369 @@ BATgroup(BAT **groups, BAT **extents, BAT **histo,
 {
 	return BATgroup_internal(groups, extents, histo, b, g, e, h, 0);
 }
+
+/* Multi-column grouping.
+ *
+ * BATgroup_multi groups on the combination of the values of the
+ * aligned columns cols[0..ncols-1] in one go instead of through a
+ * chain of BATgroup calls, each of which would rehash the previous
+ * grouping.  The outputs are as for BATgroup.
+ *
+ * If all columns are of a fixed-width integer type and the value
+ * ranges together fit in 64 bits, each row's values are packed into a
+ * single lng key (value - min + 1 per column, 0 for nil) and the keys
+ * are grouped by BATgroup, which then picks its best algorithm for a
+ * single fixed-width column.  Otherwise a hash of the composite key is
+ * computed column by column and the rows are grouped with the
+ * open-addressing table, comparing all columns of a group's first
+ * member on a fingerprint match. */
+
+#define GRPmultirange(TYPE)						\
+	do {								\
+		const TYPE *w = (const TYPE *) Tloc(b, BUNfirst(b));	\
+		for (i = 0; i < n; i++) {				\
+			if (w[i] == TYPE##_nil)				\
+				continue;				\
+			if (w[i] < mn)					\
+				mn = w[i];				\
+			if (w[i] > mx)					\
+				mx = w[i];				\
+		}							\
+	} while (0)
+
+#define GRPmultipack(TYPE)						\
+	do {								\
+		const TYPE *w = (const TYPE *) Tloc(b, BUNfirst(b));	\
+		for (i = 0; i < n; i++)					\
+			keys[i] |= (w[i] == TYPE##_nil ? 0 :		\
+				    ((ulng) (lng) w[i] - (ulng) mins[c]) + 1) << shift; \
+	} while (0)
+
+/* Pack the values of the columns into one lng key per row.  Returns
+ * NULL if a type isn't supported or the key doesn't fit, setting
+ * *failed only if we ran out of memory. */
+static BAT *
+grp_multi_pack(BAT **cols, int ncols, int *failed)
+{
+	BAT *b, *kb;
+	BUN n = BATcount(cols[0]), i;
+	lng *mins, mn, mx;
+	ulng *keys, d;
+	int c, *widths, shift, totbits = 0;
+
+	*failed = 0;
+	for (c = 0; c < ncols; c++) {
+		switch (ATOMstorage(cols[c]->ttype)) {
+		case TYPE_bte:
+		case TYPE_sht:
+		case TYPE_int:
+		case TYPE_lng:
+			break;
+		default:
+			return NULL;
+		}
+	}
+	mins = GDKmalloc(ncols * sizeof(lng));
+	widths = GDKmalloc(ncols * sizeof(int));
+	if (mins == NULL || widths == NULL) {
+		if (mins)
+			GDKfree(mins);
+		if (widths)
+			GDKfree(widths);
+		*failed = 1;
+		return NULL;
+	}
+	for (c = 0; c < ncols; c++) {
+		b = cols[c];
+		mn = GDK_lng_max;
+		mx = GDK_lng_min;
+		switch (ATOMstorage(b->ttype)) {
+		case TYPE_bte:
+			GRPmultirange(bte);
+			break;
+		case TYPE_sht:
+			GRPmultirange(sht);
+			break;
+		case TYPE_int:
+			GRPmultirange(int);
+			break;
+		case TYPE_lng:
+			GRPmultirange(lng);
+			break;
+		}
+		if (mn > mx)
+			mn = mx = 0;	/* all nil */
+		mins[c] = mn;
+		/* we need the values 0 (nil) up to and including d + 1 */
+		d = (ulng) mx - (ulng) mn;
+		if (d + 1 == 0) {
+			totbits = 65;
+		} else {
+			for (widths[c] = 1;
+			     widths[c] < 64 && d + 1 >= (ulng) 1 << widths[c];
+			     widths[c]++)
+				;
+			totbits += widths[c];
+		}
+		if (totbits > 64) {
+			GDKfree(mins);
+			GDKfree(widths);
+			return NULL;
+		}
+	}
+	if ((kb = BATnew(TYPE_void, TYPE_lng, n)) == NULL) {
+		GDKfree(mins);
+		GDKfree(widths);
+		*failed = 1;
+		return NULL;
+	}
+	keys = (ulng *) Tloc(kb, BUNfirst(kb));
+	memset(keys, 0, n * sizeof(ulng));
+	for (c = 0, shift = 0; c < ncols; shift += widths[c], c++) {
+		b = cols[c];
+		switch (ATOMstorage(b->ttype)) {
+		case TYPE_bte:
+			GRPmultipack(bte);
+			break;
+		case TYPE_sht:
+			GRPmultipack(sht);
+			break;
+		case TYPE_int:
+			GRPmultipack(int);
+			break;
+		case TYPE_lng:
+			GRPmultipack(lng);
+			break;
+		}
+	}
+	GDKfree(mins);
+	GDKfree(widths);
+	BATsetcount(kb, n);
+	BATseqbase(kb, cols[0]->hseqbase);
+	kb->tsorted = kb->trevsorted = n <= 1;
+	kb->tkey = n <= 1;
+	kb->T->nonil = 0;
+	kb->T->nil = 0;
+	return kb;
+}
+
+gdk_return
+BATgroup_multi(BAT **groups, BAT **extents, BAT **histo,
+	       BAT **cols, int ncols)
+{
+	BAT *b, *kb, *gn = NULL, *en = NULL, *hn = NULL;
+	BATiter *bis = NULL;
+	int (**cmps)(const void *, const void *) = NULL;
+	unsigned int *hv = NULL;
+	oid *ngrps, ngrp = 0;
+	oid *exts = NULL;
+	wrd *cnts = NULL;
+	BUN n, i, j, k, p, q, r, maxgrps;
+	grpoa_t oa;
+	int c, failed;
+	gdk_return ret;
+
+	memset(&oa, 0, sizeof(oa));
+	if (cols == NULL || ncols <= 0) {
+		GDKerror("BATgroup_multi: no columns\n");
+		return GDK_FAIL;
+	}
+	b = cols[0];
+	for (c = 0; c < ncols; c++) {
+		if (cols[c] == NULL || !BAThdense(cols[c])) {
+			GDKerror("BATgroup_multi: columns must be dense-headed\n");
+			return GDK_FAIL;
+		}
+		if (BATcount(cols[c]) != BATcount(b) ||
+		    (BATcount(b) > 0 && cols[c]->hseqbase != b->hseqbase)) {
+			GDKerror("BATgroup_multi: columns must be aligned\n");
+			return GDK_FAIL;
+		}
+	}
+	/* a key column makes every group a singleton */
+	for (c = 0; c < ncols; c++)
+		if (cols[c]->tkey || ncols == 1 || BATcount(b) <= 1)
+			return BATgroup(groups, extents, histo,
+					cols[c], NULL, NULL, NULL);
+
+	if ((kb = grp_multi_pack(cols, ncols, &failed)) != NULL) {
+		ALGODEBUG fprintf(stderr, "#BATgroup_multi(b=%s#" BUNFMT
+				  ",ncols=%d): packed 64-bit key\n",
+				  BATgetId(b), BATcount(b), ncols);
+		ret = BATgroup(groups, extents, histo, kb, NULL, NULL, NULL);
+		BBPunfix(kb->batCacheid);
+		return ret;
+	}
+	if (failed) {
+		GDKerror("BATgroup_multi: cannot allocate key column\n");
+		return GDK_FAIL;
+	}
+
+	ALGODEBUG fprintf(stderr, "#BATgroup_multi(b=%s#" BUNFMT
+			  ",ncols=%d): composite hash key\n",
+			  BATgetId(b), BATcount(b), ncols);
+	n = BATcount(b);
+	bis = GDKmalloc(ncols * sizeof(BATiter));
+	cmps = GDKmalloc(ncols * sizeof(*cmps));
+	hv = GDKmalloc(n * sizeof(unsigned int));
+	gn = BATnew(TYPE_void, TYPE_oid, n);
+	if (bis == NULL || cmps == NULL || hv == NULL || gn == NULL)
+		goto error;
+	ngrps = (oid *) Tloc(gn, BUNfirst(gn));
+	maxgrps = n / 10;
+	if (maxgrps < GROUPBATINCR)
+		maxgrps = n;
+	if (extents) {
+		if ((en = BATnew(TYPE_void, TYPE_oid, maxgrps)) == NULL)
+			goto error;
+		exts = (oid *) Tloc(en, BUNfirst(en));
+	}
+	if (histo) {
+		if ((hn = BATnew(TYPE_void, TYPE_wrd, maxgrps)) == NULL)
+			goto error;
+		cnts = (wrd *) Tloc(hn, BUNfirst(hn));
+	}
+	if (grp_oa_init(&oa, 0) != GDK_SUCCEED)
+		goto error;
+
+	/* hash the composite key, one column at a time */
+	for (c = 0; c < ncols; c++) {
+		BAT *cb = cols[c];
+		BUN f = BUNfirst(cb);
+
+		bis[c] = bat_iterator(cb);
+		cmps[c] = BATatoms[cb->ttype].atomCmp;
+		switch (ATOMstorage(cb->ttype)) {
+		case TYPE_bte: {
+			const bte *w = (const bte *) Tloc(cb, f);
+			for (i = 0; i < n; i++)
+				hv[i] = grp_fmix((c ? hv[i] * 0x9e3779b9U : 0) ^ grp_key_bte(w[i]));
+			break;
+		}
+		case TYPE_sht: {
+			const sht *w = (const sht *) Tloc(cb, f);
+			for (i = 0; i < n; i++)
+				hv[i] = grp_fmix((c ? hv[i] * 0x9e3779b9U : 0) ^ grp_key_sht(w[i]));
+			break;
+		}
+		case TYPE_int: {
+			const int *w = (const int *) Tloc(cb, f);
+			for (i = 0; i < n; i++)
+				hv[i] = grp_fmix((c ? hv[i] * 0x9e3779b9U : 0) ^ grp_key_int(w[i]));
+			break;
+		}
+		case TYPE_lng: {
+			const lng *w = (const lng *) Tloc(cb, f);
+			for (i = 0; i < n; i++)
+				hv[i] = grp_fmix((c ? hv[i] * 0x9e3779b9U : 0) ^ grp_key_lng(w[i]));
+			break;
+		}
+		case TYPE_flt: {
+			const flt *w = (const flt *) Tloc(cb, f);
+			for (i = 0; i < n; i++)
+				hv[i] = grp_fmix((c ? hv[i] * 0x9e3779b9U : 0) ^ grp_key_flt(w[i]));
+			break;
+		}
+		case TYPE_dbl: {
+			const dbl *w = (const dbl *) Tloc(cb, f);
+			for (i = 0; i < n; i++)
+				hv[i] = grp_fmix((c ? hv[i] * 0x9e3779b9U : 0) ^ grp_key_dbl(w[i]));
+			break;
+		}
+		default:
+			for (i = 0; i < n; i++)
+				hv[i] = grp_fmix((c ? hv[i] * 0x9e3779b9U : 0) ^
+						 (unsigned int) ATOMhash(cb->ttype, BUNtail(bis[c], f + i)));
+			break;
+		}
+	}
+
+	/* group the rows */
+	gn->tsorted = 1; /* be optimistic */
+	for (r = BUNfirst(b), p = r, q = r + n; p < q; p++) {
+		unsigned char fp;
+
+		i = p - r;
+		fp = grp_oa_fp(hv[i]);
+		for (k = hv[i] & oa.mask; oa.fp[k]; k = (k + 1) & oa.mask) {
+			if (oa.fp[k] == fp) {
+				oid grp = oa.gid[k];
+
+				j = oa.rep[grp];
+				for (c = 0; c < ncols; c++) {
+					BUN f = BUNfirst(cols[c]);
+
+					if ((*cmps[c])(BUNtail(bis[c], f + i),
+						       BUNtail(bis[c], f + j)) != 0)
+						break;
+				}
+				if (c == ncols) {
+					ngrps[i] = grp;
+					if (histo)
+						cnts[grp]++;
+					if (gn->tsorted && grp != ngrp - 1)
+						gn->tsorted = 0;
+					break;
+				}
+			}
+		}
+		if (oa.fp[k] == 0) {
+			/* new group */
+			if (grp_oa_grow(&oa, ngrp) != GDK_SUCCEED)
+				goto error;
+			oa.rep[ngrp] = i;
+			oa.ghv[ngrp] = hv[i];
+			grp_oa_insert(&oa, hv[i], ngrp);
+			GRPnotfound();
+		}
+	}
+	grp_oa_destroy(&oa);
+	GDKfree(hv);
+	GDKfree(bis);
+	GDKfree(cmps);
+
+	if (extents) {
+		BATsetcount(en, (BUN) ngrp);
+		BATseqbase(en, 0);
+		en->tkey = 1;
+		en->tsorted = 1;
+		en->trevsorted = BATcount(en) <= 1;
+		en->T->nonil = 1;
+		en->T->nil = 0;
+		*extents = en;
+	}
+	if (histo) {
+		BATsetcount(hn, (BUN) ngrp);
+		BATseqbase(hn, 0);
+		hn->tkey = 0;
+		hn->tsorted = 0;
+		hn->trevsorted = 0;
+		hn->T->nonil = 1;
+		hn->T->nil = 0;
+		*histo = hn;
+	}
+	BATsetcount(gn, n);
+	BATseqbase(gn, b->hseqbase);
+	gn->tkey = ngrp == BATcount(gn);
+	gn->trevsorted = BATcount(gn) <= 1;
+	gn->T->nonil = 1;
+	gn->T->nil = 0;
+	*groups = gn;
+	return GDK_SUCCEED;
+  error:
+	grp_oa_destroy(&oa);
+	if (hv)
+		GDKfree(hv);
+	if (bis)
+		GDKfree(bis);
+	if (cmps)
+		GDKfree(cmps);
+	if (gn)
+		BBPunfix(gn->batCacheid);
+	if (en)
+		BBPunfix(en->batCacheid);
+	if (hn)
+		BBPunfix(hn->batCacheid);
+	GDKerror("BATgroup_multi: cannot allocate memory\n");
+	return GDK_FAIL;
+}
@@ -18,139 +18,593 @@
  */
 
 /*
- * (co)  Martin L. Kersten 
+ * (co)  Martin L. Kersten
  * This module provide a lightweight map-reduce scheduler for multicore systems.
- * A limited number of workers are initialized upfront, which take the tasks
- * from a central queue. The header of these task descriptors should comply
- * with the MRtask structure.
+ * A limited number of workers are initialized upfront. The header of
+ * the task descriptors should comply with the MRtask structure.
  *
+ * Each worker owns a double-ended queue of tasks.  A worker takes
+ * tasks from the bottom of its own deque (LIFO, cache friendly) and,
+ * when that is empty, steals from the top of the deques of the other
+ * workers (FIFO, i.e. the oldest and typically largest work).  There
+ * is no single lock all workers serialize on: a deque lock is only
+ * ever contended by a thief, and idle workers sleep on a semaphore
+ * that is only touched when they run out of work.
+ *
+ * A thread that waits for its tasks to finish executes queued tasks
+ * itself in the mean time.  This keeps the caller's core busy and
+ * means that workers may schedule nested tasks without deadlocking.
+ *
+ * MRparallel_for is a fork/join loop over a range of BUNs.  The range
+ * is handed out in pieces of grain BUNs through an atomic counter, so
+ * the scheduler is entered once per worker rather than once per piece.
  */
 #include "monetdb_config.h"
 #include "gdk.h"
+#include "gdk_private.h"
 #include "gdk_mapreduce.h"
 
-/* each entry in the queue contains a list of tasks */
-typedef struct MRQUEUE {
+/* each worker owns one deque, a ring buffer of tasks */
+typedef struct MRDEQUE {
+	MT_Lock lock;
 	MRtask **tasks;
-	int index;		/* next available task */
-	int size;		/* number of tasks */
-} MRqueue;
-
-static MRqueue *mrqueue;
-static int mrqsize = -1;	/* size of queue */
-static int mrqlast = -1;
-static MT_Lock mrqlock;		/* it's a shared resource, ie we need locks */
-static MT_Sema mrqsema;		/* threads wait on empty queues */
+	int size;		/* capacity, power of two */
+	volatile int top;	/* thieves take from here */
+	volatile int bot;	/* the owner pushes and pops here */
+} MRdeque;
 
+static MRdeque *mrdeques;
+static MT_Id *mrworkers;		/* thread id of each worker */
+static int mrnworkers = 0;
+static MT_Sema mrsema;			/* idle workers sleep here */
+static volatile ATOMIC_TYPE mrqueued = 0; /* tasks sitting in deques */
+static volatile ATOMIC_TYPE mrsleeping = 0; /* workers on mrsema */
+#ifdef ATOMIC_LOCK
+static MT_Lock mrlock;
+#endif
 
 static void MRworker(void *);
 
-/* There is just a single queue for the workers */
 static void
-MRqueueCreate(int sz)
+MRqueueCreate(int nworkers)
 {
 	int i;
-	MT_Id tid;
-
-	MT_lock_init(&mrqlock, "q_create");
-	MT_lock_set(&mrqlock, "q_create");
-	MT_sema_init(&mrqsema, 0, "q_create");
-	if ( mrqueue ) {
-		MT_lock_unset(&mrqlock, "q_create");
-		GDKerror("One map-reduce queue allowed");
+
+	MT_lock_set(&GDKthreadLock, "MRqueueCreate");
+	if (mrnworkers > 0) {
+		/* somebody beat us to it */
+		MT_lock_unset(&GDKthreadLock, "MRqueueCreate");
 		return;
 	}
-	sz *= 2;
-	mrqueue = (MRqueue *) GDKzalloc(sizeof(MRqueue) * sz);
-	if ( mrqueue == 0) {
-		MT_lock_unset(&mrqlock, "q_create");
-		GDKerror("Could not create the map-reduce queue");
+	if (nworkers < 1)
+		nworkers = 1;
+	mrdeques = (MRdeque *) GDKzalloc(sizeof(MRdeque) * nworkers);
+	mrworkers = (MT_Id *) GDKzalloc(sizeof(MT_Id) * nworkers);
+	if (mrdeques == NULL || mrworkers == NULL) {
+		if (mrdeques)
+			GDKfree(mrdeques);
+		if (mrworkers)
+			GDKfree(mrworkers);
+		mrdeques = NULL;
+		mrworkers = NULL;
+		MT_lock_unset(&GDKthreadLock, "MRqueueCreate");
+		GDKerror("Could not create the map-reduce queues");
 		return;
 	}
-	mrqsize = sz;
-	mrqlast = 0;
-	/* create a worker thread for each core as specified as system parameter */
-	for (i = 0; i < GDKnr_threads; i++)
-		MT_create_thread(&tid, MRworker, (void *) 0, MT_THR_DETACHED);
-	MT_lock_unset(&mrqlock, "q_create");
+	ATOMIC_INIT(mrlock, "MRqueueCreate");
+	MT_sema_init(&mrsema, 0, "MRqueueCreate");
+	for (i = 0; i < nworkers; i++)
+		MT_lock_init(&mrdeques[i].lock, "MRqueueCreate");
+	/* create a worker thread for each core as specified as system
+	 * parameter; its id is recorded here, before any task can
+	 * reach it, so that MRwhoami never races with the worker */
+	for (i = 0; i < nworkers; i++)
+		MT_create_thread(&mrworkers[i], MRworker, (void *) (size_t) i, MT_THR_DETACHED);
+	mrnworkers = nworkers;
+	MT_lock_unset(&GDKthreadLock, "MRqueueCreate");
 }
 
-static void
-MRenqueue(int taskcnt, MRtask ** tasks)
-{
-	assert(taskcnt > 0);
-	MT_lock_set(&mrqlock, "mrqlock");
-	if (mrqlast == mrqsize) {
-		mrqsize <<= 1;
-		mrqueue = (MRqueue *) GDKrealloc(mrqueue, sizeof(MRqueue) * mrqsize);
-		if ( mrqueue == 0) {
-			MT_lock_unset(&mrqlock, "mrqlock");
+/* the deque index of the calling thread, or -1 if it is no worker */
+static int
+MRwhoami(void)
+{
+	MT_Id me = MT_getpid();
+	int i;
+
+	for (i = 0; i < mrnworkers; i++)
+		if (mrworkers[i] == me)
+			return i;
+	return -1;
+}
+
+/* push n tasks on the bottom of deque d */
+static int
+MRpush(MRdeque *d, MRtask **tasks, int n)
+{
+	int i;
+
+	MT_lock_set(&d->lock, "MRpush");
+	if (d->bot - d->top + n > d->size) {
+		int sz = d->size ? d->size : 64;
+		MRtask **t;
+
+		while (d->bot - d->top + n > sz)
+			sz <<= 1;
+		t = (MRtask **) GDKmalloc(sizeof(MRtask *) * sz);
+		if (t == NULL) {
+			MT_lock_unset(&d->lock, "MRpush");
 			GDKerror("Could not enlarge the map-reduce queue");
-			return;
+			return -1;
 		}
+		for (i = d->top; i < d->bot; i++)
+			t[i & (sz - 1)] = d->tasks[i & (d->size - 1)];
+		if (d->tasks)
+			GDKfree(d->tasks);
+		d->tasks = t;
+		d->size = sz;
 	}
-	mrqueue[mrqlast].index = 0;
-	mrqueue[mrqlast].tasks = tasks;
-	mrqueue[mrqlast].size = taskcnt;
-	mrqlast++;
-	MT_lock_unset(&mrqlock, "mrqlock");
-	/* a task list is added for consumption */
-	while (taskcnt-- > 0)
-		MT_sema_up(&mrqsema, "mrqsema");
+	for (i = 0; i < n; i++)
+		d->tasks[(d->bot + i) & (d->size - 1)] = tasks[i];
+	d->bot += n;
+	MT_lock_unset(&d->lock, "MRpush");
+	return 0;
 }
 
+/* take a task from the bottom (own deque) or top (stealing) of d */
 static MRtask *
-MRdequeue(void)
+MRtake(MRdeque *d, int steal)
 {
-	MRtask *r = NULL;
-	int idx;
+	MRtask *t = NULL;
 
-	MT_sema_down(&mrqsema, "mrqsema");
-	assert(mrqlast);
-	MT_lock_set(&mrqlock, "mrqlock");
-	if (mrqlast > 0) {
-		idx = mrqueue[mrqlast - 1].index;
-		r = mrqueue[mrqlast - 1].tasks[idx++];
-		if (mrqueue[mrqlast - 1].size == idx)
-			mrqlast--;
+	if (d->bot == d->top)
+		return NULL;	/* cheap unlocked check */
+	MT_lock_set(&d->lock, "MRtake");
+	if (d->bot > d->top) {
+		if (steal)
+			t = d->tasks[d->top++ & (d->size - 1)];
 		else
-			mrqueue[mrqlast - 1].index = idx;
+			t = d->tasks[--d->bot & (d->size - 1)];
+	}
+	MT_lock_unset(&d->lock, "MRtake");
+	if (t)
+		ATOMIC_DEC(mrqueued, mrlock, "MRtake");
+	return t;
+}
+
+/* find work for worker me (-1 for a thread that is no worker) */
+static MRtask *
+MRfind(int me)
+{
+	MRtask *t;
+	int i, j;
+
+	if (me >= 0 && (t = MRtake(&mrdeques[me], 0)) != NULL)
+		return t;
+	for (i = 1; i <= mrnworkers; i++) {
+		j = (me + i) % mrnworkers;
+		if (j < 0)
+			j += mrnworkers;
+		if ((t = MRtake(&mrdeques[j], 1)) != NULL)
+			return t;
 	}
-	MT_lock_unset(&mrqlock, "mrqlock");
-	assert(r);
-	return r;
+	return NULL;
+}
+
+static void
+MRrun(MRtask *task)
+{
+	MT_Sema *sema = task->sema;
+
+	(task->cmd) (task);
+	/* the last task of a batch wakes up whoever waits for it; the
+	 * task may be gone as soon as the counter drops */
+	if (ATOMIC_DEC(*task->pending, mrlock, "MRrun") == 0)
+		MT_sema_up(sema, "mrqsema");
 }
 
 static void
 MRworker(void *arg)
 {
+	int me = (int) (size_t) arg;
 	MRtask *task;
-	(void) arg;
+
 	do {
-		task = MRdequeue();
-		(task->cmd) (task);
-		MT_sema_up(task->sema, "mrqsema");
+		if ((task = MRfind(me)) != NULL) {
+			MRrun(task);
+			continue;
+		}
+		/* announce we go to sleep, then look once more so
+		 * that we cannot miss a wake up */
+		ATOMIC_INC(mrsleeping, mrlock, "MRworker");
+		if (ATOMIC_GET(mrqueued, mrlock, "MRworker") == 0)
+			MT_sema_down(&mrsema, "mrqsema");
+		ATOMIC_DEC(mrsleeping, mrlock, "MRworker");
 	} while (1);
 }
 
+/* account for n newly queued tasks and wake up as many sleepers */
+static void
+MRwake(int n)
+{
+	int i, sleeping;
+
+	ATOMIC_ADD(mrqueued, n, mrlock, "MRwake");
+	sleeping = (int) ATOMIC_GET(mrsleeping, mrlock, "MRwake");
+	for (i = 0; i < n && i < sleeping; i++)
+		MT_sema_up(&mrsema, "mrqsema");
+}
+
+/* queue taskcnt tasks that share sema and pending */
+static void
+MRspawn(int me, int taskcnt, MRtask **task)
+{
+	int i, n, w;
+
+	if (me >= 0) {
+		/* a worker keeps its children local, idle workers
+		 * will steal them */
+		if (MRpush(&mrdeques[me], task, taskcnt) < 0)
+			i = 0;
+		else
+			i = taskcnt;
+	} else {
+		/* spread the tasks over all deques */
+		for (w = 0, i = 0; w < mrnworkers && i < taskcnt; w++) {
+			n = (taskcnt - i) / (mrnworkers - w);
+			if (n == 0)
+				n = 1;
+			if (MRpush(&mrdeques[w], task + i, n) < 0)
+				break;
+			i += n;
+		}
+	}
+	if (i > 0)
+		MRwake(i);
+	/* what could not be queued (out of memory) we do ourselves */
+	for (; i < taskcnt; i++)
+		MRrun(task[i]);
+}
+
+/* wait for all tasks of the batch, helping out in the mean time */
+static void
+MRwait(int me, MT_Sema *sema, volatile ATOMIC_TYPE *pending)
+{
+	MRtask *task;
+
+	while (ATOMIC_GET(*pending, mrlock, "MRwait") > 0 &&
+	       (task = MRfind(me)) != NULL)
+		MRrun(task);
+	MT_sema_down(sema, "mrqsema");
+}
+
 /* schedule the tasks and return when all are done */
 void
 MRschedule(int taskcnt, void **arg, void (*cmd) (void *p))
 {
-	int i;
+	int i, me;
 	MT_Sema sema;
+	volatile ATOMIC_TYPE pending = taskcnt;
 	MRtask **task = (MRtask **) arg;
 
-	if (mrqueue == 0)
-		MRqueueCreate(1024);
+	if (taskcnt <= 0)
+		return;
+	if (mrnworkers == 0)
+		MRqueueCreate(GDKnr_threads);
 
 	MT_sema_init(&sema, 0, "q_create");
 	for (i = 0; i < taskcnt; i++) {
 		task[i]->sema = &sema;
 		task[i]->cmd = cmd;
+		task[i]->pending = &pending;
 	}
-	MRenqueue(taskcnt, task);
+	me = MRwhoami();
+	MRspawn(me, taskcnt, task);
 	/* waiting for all report result */
+	MRwait(me, &sema, &pending);
+	MT_sema_destroy(&sema);
+}
+
+typedef struct {
+	volatile ATOMIC_TYPE next;	/* first BUN not handed out yet */
+	BUN hi, grain;
+	void (*fcn) (BUN, BUN, void *);
+	void *arg;
+} MRloop;
+
+typedef struct {
+	MRtask task;		/* header required by the scheduler */
+	MRloop *loop;
+} MRlooptask;
+
+static void
+MRloopbody(void *arg)
+{
+	MRloop *l = ((MRlooptask *) arg)->loop;
+	BUN p;
+
+	while ((p = (BUN) ATOMIC_ADD(l->next, (ATOMIC_TYPE) l->grain,
+				     mrlock, "MRloop")) < l->hi)
+		(*l->fcn) (p, p + l->grain < l->hi ? p + l->grain : l->hi,
+			   l->arg);
+}
+
+/* run the pieces one after the other in the calling thread; callers
+ * may rely on getting pieces of exactly grain BUNs (except the last),
+ * e.g. to index per-piece state */
+static void
+MRloopinline(BUN lo, BUN hi, BUN grain,
+	     void (*fcn) (BUN l, BUN h, void *arg), void *arg)
+{
+	BUN l;
+
+	for (l = lo; l < hi; l += grain)
+		(*fcn) (l, hi - l > grain ? l + grain : hi, arg);
+}
+
+void
+MRparallel_for(BUN lo, BUN hi, BUN grain,
+	       void (*fcn) (BUN l, BUN h, void *arg), void *arg)
+{
+	MRloop loop;
+	MRlooptask self, *tasks;
+	MRtask **tp;
+	MT_Sema sema;
+	volatile ATOMIC_TYPE pending;
+	BUN npieces;
+	int i, n, me;
+
+	if (lo >= hi)
+		return;
+	if (grain == 0)
+		grain = 1;
+	npieces = (hi - lo + grain - 1) / grain;
+	if (GDKnr_threads <= 1 || npieces <= 1) {
+		MRloopinline(lo, hi, grain, fcn, arg);
+		return;
+	}
+	if (mrnworkers == 0)
+		MRqueueCreate(GDKnr_threads);
+	/* the caller takes part, so one piece less to hand out */
+	n = npieces - 1 < (BUN) mrnworkers ? (int) npieces - 1 : mrnworkers;
+	tasks = (MRlooptask *) GDKmalloc(sizeof(MRlooptask) * n);
+	tp = (MRtask **) GDKmalloc(sizeof(MRtask *) * n);
+	if (tasks == NULL || tp == NULL) {
+		if (tasks)
+			GDKfree(tasks);
+		if (tp)
+			GDKfree(tp);
+		MRloopinline(lo, hi, grain, fcn, arg);
+		return;
+	}
+	loop.next = (ATOMIC_TYPE) lo;
+	loop.hi = hi;
+	loop.grain = grain;
+	loop.fcn = fcn;
+	loop.arg = arg;
+	pending = n;
+	MT_sema_init(&sema, 0, "MRparallel_for");
+	for (i = 0; i < n; i++) {
+		tasks[i].task.sema = &sema;
+		tasks[i].task.cmd = MRloopbody;
+		tasks[i].task.pending = &pending;
+		tasks[i].loop = &loop;
+		tp[i] = &tasks[i].task;
+	}
+	me = MRwhoami();
+	MRspawn(me, n, tp);
+	self.loop = &loop;
+	MRloopbody(&self);
+	MRwait(me, &sema, &pending);
+	MT_sema_destroy(&sema);
+	GDKfree(tasks);
+	GDKfree(tp);
+}
+
+/*
+ * Micro benchmark: the throughput of the scheduler for many short
+ * tasks, compared with the single central queue that MRschedule used
+ * before (one mutex and one semaphore operation per task).  The old
+ * queue is kept here, with its own workers, only for this comparison.
+ */
+typedef struct {
+	MRtask **tasks;
+	int index;		/* next available task */
+	int size;		/* number of tasks */
+} MRcqueue;
+
+static MRcqueue *mrcqueue;
+static int mrcqsize = -1;	/* size of queue */
+static int mrcqlast = -1;
+static int mrcqstop = 0;	/* workers must exit */
+static MT_Lock mrcqlock;
+static MT_Sema mrcqsema;
+
+static void
+MRcworker(void *arg)
+{
+	MRtask *r;
+	int idx;
+
+	(void) arg;
+	do {
+		MT_sema_down(&mrcqsema, "mrcqsema");
+		MT_lock_set(&mrcqlock, "mrcqlock");
+		if (mrcqstop) {
+			MT_lock_unset(&mrcqlock, "mrcqlock");
+			break;
+		}
+		idx = mrcqueue[mrcqlast - 1].index;
+		r = mrcqueue[mrcqlast - 1].tasks[idx++];
+		if (mrcqueue[mrcqlast - 1].size == idx)
+			mrcqlast--;
+		else
+			mrcqueue[mrcqlast - 1].index = idx;
+		MT_lock_unset(&mrcqlock, "mrcqlock");
+		(r->cmd) (r);
+		MT_sema_up(r->sema, "mrcqsema");
+	} while (1);
+}
+
+/* create the central queue and start at most nthreads joinable
+ * workers on it, their ids go in tids; return the number of workers
+ * started, -1 if the queue could not be allocated */
+static int
+MRcqueueCreate(int nthreads, MT_Id *tids)
+{
+	int i;
+
+	mrcqueue = (MRcqueue *) GDKzalloc(sizeof(MRcqueue) * 2048);
+	if (mrcqueue == NULL)
+		return -1;
+	MT_lock_init(&mrcqlock, "mrcqlock");
+	MT_sema_init(&mrcqsema, 0, "mrcqsema");
+	mrcqsize = 2048;
+	mrcqlast = 0;
+	mrcqstop = 0;
+	for (i = 0; i < nthreads; i++)
+		if (MT_create_thread(&tids[i], MRcworker, NULL, MT_THR_JOINABLE) < 0)
+			break;
+	return i;
+}
+
+/* stop and join the nthreads central queue workers, then free the
+ * queue */
+static void
+MRcqueueDestroy(int nthreads, MT_Id *tids)
+{
+	int i;
+
+	MT_lock_set(&mrcqlock, "mrcqlock");
+	mrcqstop = 1;
+	MT_lock_unset(&mrcqlock, "mrcqlock");
+	for (i = 0; i < nthreads; i++)
+		MT_sema_up(&mrcqsema, "mrcqsema");
+	for (i = 0; i < nthreads; i++)
+		MT_join_thread(tids[i]);
+	MT_sema_destroy(&mrcqsema);
+	MT_lock_destroy(&mrcqlock);
+	GDKfree(mrcqueue);
+	mrcqueue = NULL;
+	mrcqsize = -1;
+	mrcqlast = -1;
+}
+
+static void
+MRschedule_central(int taskcnt, MRtask **task, void (*cmd) (void *p))
+{
+	int i;
+	MT_Sema sema;
+
+	MT_sema_init(&sema, 0, "mrcqsema");
+	for (i = 0; i < taskcnt; i++) {
+		task[i]->sema = &sema;
+		task[i]->cmd = cmd;
+	}
+	MT_lock_set(&mrcqlock, "mrcqlock");
+	assert(mrcqlast < mrcqsize);
+	mrcqueue[mrcqlast].index = 0;
+	mrcqueue[mrcqlast].tasks = task;
+	mrcqueue[mrcqlast].size = taskcnt;
+	mrcqlast++;
+	MT_lock_unset(&mrcqlock, "mrcqlock");
+	for (i = 0; i < taskcnt; i++)
+		MT_sema_up(&mrcqsema, "mrcqsema");
+	for (i = 0; i < taskcnt; i++)
+		MT_sema_down(&sema, "mrcqsema");
+	MT_sema_destroy(&sema);
+}
+
+typedef struct {
+	MRtask task;
+	lng sum;
+} MRbenchtask;
+
+static void
+MRbenchwork(void *arg)
+{
+	MRbenchtask *t = (MRbenchtask *) arg;
+	int i;
+
+	for (i = 0; i < 100; i++)
+		t->sum += i;
+}
+
+static void
+MRbenchloop(BUN l, BUN h, void *arg)
+{
+	volatile lng *sum = (volatile lng *) arg;
+	lng s = 0;
+
+	while (l < h)
+		s += l++;
+	if (s == -1)		/* keep the loop alive */
+		*sum = s;
+}
+
+void
+MRbenchmark(int taskcnt, int rounds)
+{
+	MRbenchtask *tasks;
+	MRtask **tp;
+	MT_Id *tids;
+	lng t0, tc, tw, tl;
+	volatile lng sum = 0;
+	int i, r, nthreads = GDKnr_threads > 0 ? GDKnr_threads : 1;
+
+	if (taskcnt <= 0 || rounds <= 0)
+		return;
+	tasks = (MRbenchtask *) GDKzalloc(sizeof(MRbenchtask) * taskcnt);
+	tp = (MRtask **) GDKmalloc(sizeof(MRtask *) * taskcnt);
+	tids = (MT_Id *) GDKmalloc(sizeof(MT_Id) * nthreads);
+	if (tasks == NULL || tp == NULL || tids == NULL) {
+		if (tasks)
+			GDKfree(tasks);
+		if (tp)
+			GDKfree(tp);
+		if (tids)
+			GDKfree(tids);
+		return;
+	}
 	for (i = 0; i < taskcnt; i++)
-		MT_sema_down(&sema, "mrqsema");
+		tp[i] = &tasks[i].task;
+
+	/* the central queue workers only live for this run */
+	nthreads = MRcqueueCreate(nthreads, tids);
+	if (nthreads <= 0) {
+		if (nthreads == 0)
+			MRcqueueDestroy(0, tids);
+		GDKfree(tasks);
+		GDKfree(tp);
+		GDKfree(tids);
+		GDKerror("MRbenchmark: cannot start the central queue\n");
+		return;
+	}
+	t0 = GDKusec();
+	for (r = 0; r < rounds; r++)
+		MRschedule_central(taskcnt, tp, MRbenchwork);
+	tc = GDKusec() - t0;
+	MRcqueueDestroy(nthreads, tids);
+
+	t0 = GDKusec();
+	for (r = 0; r < rounds; r++)
+		MRschedule(taskcnt, (void **) tp, MRbenchwork);
+	tw = GDKusec() - t0;
+
+	t0 = GDKusec();
+	for (r = 0; r < rounds; r++)
+		MRparallel_for(0, (BUN) taskcnt * 100, 100, MRbenchloop,
+			       (void *) &sum);
+	tl = GDKusec() - t0;
+
+	printf("# MRbenchmark: %d rounds of %d tasks on %d threads\n",
+	       rounds, taskcnt, GDKnr_threads);
+	printf("# central queue:   " LLFMT " usec, %.0f tasks/sec\n",
+	       tc, (dbl) taskcnt * rounds / ((dbl) (tc ? tc : 1) / 1e6));
+	printf("# work stealing:   " LLFMT " usec, %.0f tasks/sec\n",
+	       tw, (dbl) taskcnt * rounds / ((dbl) (tw ? tw : 1) / 1e6));
+	printf("# parallel for:    " LLFMT " usec, %.0f pieces/sec\n",
+	       tl, (dbl) taskcnt * rounds / ((dbl) (tl ? tl : 1) / 1e6));
+	GDKfree(tasks);
+	GDKfree(tp);
+	GDKfree(tids);
 }
@@ -21,11 +21,23 @@
 #ifndef _GDK_MAPREDUCE_H_
 #define _GDK_MAPREDUCE_H_
 
+#include "gdk_atomic.h"
+
 typedef struct {
 	MT_Sema *sema;			/* micro scheduler handle */
 	void (*cmd) (void *);		/* the function to be executed */
+	volatile ATOMIC_TYPE *pending;	/* tasks of the batch still to do */
 } MRtask;
 
 gdk_export void MRschedule(int taskcnt, void **arg, void (*cmd) (void *p));
 
+/* fork/join loop: call fcn(l, h, arg) on consecutive pieces [l, h) of
+ * at most grain BUNs that together cover [lo, hi), in parallel; the
+ * caller takes part and the call returns when all pieces are done */
+gdk_export void MRparallel_for(BUN lo, BUN hi, BUN grain,
+			       void (*fcn) (BUN l, BUN h, void *arg),
+			       void *arg);
+
+gdk_export void MRbenchmark(int taskcnt, int rounds);
+
 #endif /* _GDK_MAPREDUCE_H_ */
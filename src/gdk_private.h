@@ -49,6 +49,10 @@ void BBPinit(void);
 bat BBPinsert(BATstore *bs);
 void BBPtrim(size_t delta);
 void BBPunshare(bat b);
+void CANDfree(BAT *b);
+void CANDiterlist(CandIter *ci, const oid *l, BUN n);
+void CRACKappend(BAT *b);
+BAT *CRACKselect(BAT *b, const void *tl, const void *th, int li, int hi, int lval, int hval);
 void GDKclrerr(void);
 int GDKextend(const char *fn, size_t size);
 int GDKfdlocate(const char *nme, const char *mode, const char *ext);
@@ -62,6 +66,13 @@ int GDKmunmap(void *addr, size_t len);
 void *GDKreallocmax(void *pold, size_t size, size_t *maxsize, int emergency);
 int GDKremovedir(const char *nme);
 int GDKsave(const char *nme, const char *ext, void *buf, size_t size, storage_t mode);
+gdk_return GDKrsort(void *h, void *t, size_t n, int hs, int ts, int tpe, int reverse);
+int GDKrsortable(const void *base, int tpe);
+gdk_return GDKpsort(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe, int reverse, int stable, int nthreads);
+BUN GDKsimdselect(int tpe, int kind, const void *src, BUN n, oid base, const void *vl, const void *vh, const void *nil, oid *dst);
+const char *GDKsimdselect_isa(void);
+int GDKradixjoinable(BAT *l, BAT *r);
+BAT *GDKradixjoin(BAT *l, BAT *r);
 int GDKssort_rev(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe);
 int GDKssort(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe);
 int GDKunlink(const char *dir, const char *nme, const char *extension);
@@ -86,16 +97,39 @@ int OIDdirty(void);
 int OIDinit(void);
 oid OIDread(str buf);
 int OIDwrite(stream *fp);
+void STATSappend(BAT *b);
+BUN STATSdistinct(BAT *b);
+BUN STATSjoin(BAT *l, BAT *r);
+void STATSload(BAT *b);
+void STATSsave(BAT *b);
+BUN STATSselect(BAT *b, const void *tl, const void *th, int li, int hi, int equi, int anti);
 void strCleanHash(Heap *hp, int rebuild);
 int strCmpNoNil(const unsigned char *l, const unsigned char *r);
 int strElimDoubles(Heap *h);
 var_t strLocate(Heap *h, const char *v);
 void VIEWdestroy(BAT *b);
 BAT *VIEWreset(BAT *b);
+void ZONEappend(BAT *b);
+void ZONEload(BAT *b);
+void ZONEsave(BAT *b);
 
 #define BBP_BATMASK	511
 #define BBP_THREADMASK	63
 
+/* below this many entries GDKrsort's histograms cost more than they
+ * save over GDKqsort */
+#define RSORT_MINSIZE	((size_t) 1 << 12)
+
+/* below this many BUNs in r the hash table of BAThashjoin stays in
+ * the cache, and below this many BUNs in l there are too few probes,
+ * for radix clustering to pay */
+#define RADIX_MINSIZE	((BUN) 1 << 18)
+
+/* predicates evaluated by GDKsimdselect */
+#define SIMDSEL_EQ	0	/* v == vl */
+#define SIMDSEL_RANGE	1	/* vl <= v && v <= vh */
+#define SIMDSEL_ANTI	2	/* (v <= vl || v >= vh) && v != nil */
+
 typedef struct {
 	MT_Lock swap;
 	MT_Lock hash;
@@ -0,0 +1,378 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * Parallel sort.
+ * 多核排序
+ *
+ * The input (head array h plus optional tail array t) is cut into
+ * one chunk per worker.  Each chunk is sorted with GDKrsort, GDKqsort
+ * or GDKssort on a map-reduce worker.  The sorted chunks are then merged
+ * pairwise in rounds until a single run remains.  Every pairwise merge
+ * is itself cut into pieces along the merge path (a binary search
+ * finds where output position d splits the two input runs), so all
+ * workers stay busy during the last rounds as well.
+ *
+ * Ties are always taken from the left run first, hence if the chunks
+ * are sorted stably (GDKssort), the complete sort is stable too.
+ */
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_mapreduce.h"
+
+/* common parameters of all tasks of one sort */
+struct psort_t {
+	const char *base;	/* var heap base or NULL */
+	int hs, ts;		/* width of head and tail entries */
+	int tpe;		/* head type */
+	int (*cmp)(const void *, const void *);
+	int reverse;
+	int stable;
+};
+
+/* sort one chunk */
+struct psort_chunk {
+	MRtask task;		/* header required by MRschedule */
+	const struct psort_t *ps;
+	char *h, *t;
+	size_t n;
+	int ret;		/* result of GDKssort */
+};
+
+/* merge output range [lo, hi) of two adjacent runs */
+struct psort_merge {
+	MRtask task;		/* header required by MRschedule */
+	const struct psort_t *ps;
+	const char *h1, *t1;	/* left run */
+	size_t n1;
+	const char *h2, *t2;	/* right run */
+	size_t n2;
+	char *h, *t;		/* destination of the complete merge */
+	size_t lo, hi;
+};
+
+static void
+psort_chunk(void *arg)
+{
+	struct psort_chunk *c = (struct psort_chunk *) arg;
+	const struct psort_t *ps = c->ps;
+
+	c->ret = 0;
+	if (c->n >= RSORT_MINSIZE && GDKrsortable(ps->base, ps->tpe) &&
+	    GDKrsort(c->h, c->t, c->n, ps->hs, ps->ts, ps->tpe,
+		     ps->reverse) == GDK_SUCCEED)
+		return;
+	if (ps->reverse) {
+		if (ps->stable)
+			c->ret = GDKssort_rev(c->h, c->t, ps->base, c->n,
+					      ps->hs, ps->ts, ps->tpe);
+		else
+			GDKqsort_rev(c->h, c->t, ps->base, c->n,
+				     ps->hs, ps->ts, ps->tpe);
+	} else {
+		if (ps->stable)
+			c->ret = GDKssort(c->h, c->t, ps->base, c->n,
+					  ps->hs, ps->ts, ps->tpe);
+		else
+			GDKqsort(c->h, c->t, ps->base, c->n,
+				 ps->hs, ps->ts, ps->tpe);
+	}
+}
+
+/* LT(x, y): does value x (from the right run) sort before value y
+ * (from the left run).  Since we only move right-run values before
+ * left-run values when they are strictly smaller, the merge is
+ * stable. */
+#define PSORT_GENERIC_CMP(x, y)						\
+	(ps->base ?							\
+	 (*ps->cmp)(ps->base + VarHeapVal(x, 0, ps->hs),		\
+		    ps->base + VarHeapVal(y, 0, ps->hs)) :		\
+	 (*ps->cmp)(x, y))
+
+#define PSORT_MERGE(LT, COPYH)					\
+	do {								\
+		size_t i, j, d, l, h, e;				\
+									\
+		/* find where output positions lo and hi cut the	\
+		 * two runs (the merge path) */				\
+		for (e = 0; e < 2; e++) {				\
+			d = e ? m->hi : m->lo;				\
+			l = d > m->n2 ? d - m->n2 : 0;			\
+			h = d < m->n1 ? d : m->n1;			\
+			while (l < h) {					\
+				i = l + (h - l) / 2;			\
+				j = d - i;				\
+				if (!LT(h2 + (j - 1) * hs, h1 + i * hs)) \
+					l = i + 1;			\
+				else					\
+					h = i;				\
+			}						\
+			if (e == 0)					\
+				i1 = l;					\
+			else						\
+				i2 = l;					\
+		}							\
+		i = i1;							\
+		j = m->lo - i1;						\
+		for (d = m->lo; d < m->hi; d++) {			\
+			if (j < m->n2 &&				\
+			    (i == i2 || LT(h2 + j * hs, h1 + i * hs))) { \
+				COPYH(m->h + d * hs, h2 + j * hs);	\
+				if (ts)					\
+					memcpy(m->t + d * ts, m->t2 + j * ts, ts); \
+				j++;					\
+			} else {					\
+				COPYH(m->h + d * hs, h1 + i * hs);	\
+				if (ts)					\
+					memcpy(m->t + d * ts, m->t1 + i * ts, ts); \
+				i++;					\
+			}						\
+		}							\
+	} while (0)
+
+#define PSORT_LT_SIMPLE(x, y, TYPE)	(*(const TYPE *) (x) < *(const TYPE *) (y))
+#define PSORT_GT_SIMPLE(x, y, TYPE)	(*(const TYPE *) (x) > *(const TYPE *) (y))
+#define PSORT_COPY_SIMPLE(d, s, TYPE)	(*(TYPE *) (d) = *(const TYPE *) (s))
+#define PSORT_COPY_ANY(d, s)		memcpy(d, s, hs)
+
+static void
+psort_merge(void *arg)
+{
+	struct psort_merge *m = (struct psort_merge *) arg;
+	const struct psort_t *ps = m->ps;
+	const char *h1 = m->h1, *h2 = m->h2;
+	size_t hs = (size_t) ps->hs, ts = (size_t) ps->ts;
+	size_t i1 = 0, i2 = 0;
+
+	if (m->lo == m->hi)
+		return;
+	if (m->t1 == NULL)
+		ts = 0;
+
+#define LT_bte(x, y)	PSORT_LT_SIMPLE(x, y, bte)
+#define GT_bte(x, y)	PSORT_GT_SIMPLE(x, y, bte)
+#define CP_bte(d, s)	PSORT_COPY_SIMPLE(d, s, bte)
+#define LT_sht(x, y)	PSORT_LT_SIMPLE(x, y, sht)
+#define GT_sht(x, y)	PSORT_GT_SIMPLE(x, y, sht)
+#define CP_sht(d, s)	PSORT_COPY_SIMPLE(d, s, sht)
+#define LT_int(x, y)	PSORT_LT_SIMPLE(x, y, int)
+#define GT_int(x, y)	PSORT_GT_SIMPLE(x, y, int)
+#define CP_int(d, s)	PSORT_COPY_SIMPLE(d, s, int)
+#define LT_lng(x, y)	PSORT_LT_SIMPLE(x, y, lng)
+#define GT_lng(x, y)	PSORT_GT_SIMPLE(x, y, lng)
+#define CP_lng(d, s)	PSORT_COPY_SIMPLE(d, s, lng)
+#define LT_flt(x, y)	PSORT_LT_SIMPLE(x, y, flt)
+#define GT_flt(x, y)	PSORT_GT_SIMPLE(x, y, flt)
+#define CP_flt(d, s)	PSORT_COPY_SIMPLE(d, s, flt)
+#define LT_dbl(x, y)	PSORT_LT_SIMPLE(x, y, dbl)
+#define GT_dbl(x, y)	PSORT_GT_SIMPLE(x, y, dbl)
+#define CP_dbl(d, s)	PSORT_COPY_SIMPLE(d, s, dbl)
+#define LT_any(x, y)	(PSORT_GENERIC_CMP(x, y) < 0)
+#define GT_any(x, y)	(PSORT_GENERIC_CMP(x, y) > 0)
+#define CP_any(d, s)	PSORT_COPY_ANY(d, s)
+
+	/* same type dispatch as GDKqsort so that the order of the
+	 * merge agrees with the order of the chunks */
+	switch (ps->base ? TYPE_str : ATOMstorage(ps->tpe)) {
+	case TYPE_bte:
+		if (ps->reverse)
+			PSORT_MERGE(GT_bte, CP_bte);
+		else
+			PSORT_MERGE(LT_bte, CP_bte);
+		break;
+	case TYPE_sht:
+		if (ps->reverse)
+			PSORT_MERGE(GT_sht, CP_sht);
+		else
+			PSORT_MERGE(LT_sht, CP_sht);
+		break;
+	case TYPE_int:
+		if (ps->reverse)
+			PSORT_MERGE(GT_int, CP_int);
+		else
+			PSORT_MERGE(LT_int, CP_int);
+		break;
+	case TYPE_lng:
+		if (ps->reverse)
+			PSORT_MERGE(GT_lng, CP_lng);
+		else
+			PSORT_MERGE(LT_lng, CP_lng);
+		break;
+	case TYPE_flt:
+		if (ps->reverse)
+			PSORT_MERGE(GT_flt, CP_flt);
+		else
+			PSORT_MERGE(LT_flt, CP_flt);
+		break;
+	case TYPE_dbl:
+		if (ps->reverse)
+			PSORT_MERGE(GT_dbl, CP_dbl);
+		else
+			PSORT_MERGE(LT_dbl, CP_dbl);
+		break;
+	default:
+		if (ps->reverse)
+			PSORT_MERGE(GT_any, CP_any);
+		else
+			PSORT_MERGE(LT_any, CP_any);
+		break;
+	}
+}
+
+/* Sort n entries of h (and t alongside) using nthreads workers.
+ * Returns GDK_FAIL if memory could not be allocated; in that case h
+ * and t still contain the same entries (possibly with some chunks
+ * already sorted) and the caller should fall back to a sequential
+ * sort. */
+gdk_return
+GDKpsort(void *h, void *t, const void *base, size_t n, int hs, int ts,
+	 int tpe, int reverse, int stable, int nthreads)
+{
+	struct psort_t ps;
+	struct psort_chunk *chunks = NULL;
+	struct psort_merge *merges = NULL;
+	void **tasks = NULL;
+	size_t *runs = NULL;	/* start of each run, runs[nruns] == n */
+	char *h1, *t1, *h2, *t2, *tmp;
+	char *hbuf = NULL, *tbuf = NULL;
+	int nruns, nr, ntasks, r, k, pieces;
+
+	assert(hs > 0);
+	assert(ts >= 0);
+	if (t == NULL)
+		ts = 0;
+	if (nthreads < 2 || n < (size_t) nthreads * 2)
+		return GDK_FAIL;
+
+	ps.base = base;
+	ps.hs = hs;
+	ps.ts = ts;
+	ps.tpe = tpe;
+	ps.cmp = BATatoms[tpe].atomCmp;
+	ps.reverse = reverse;
+	ps.stable = stable;
+
+	nruns = nthreads;
+	hbuf = GDKmalloc(n * hs);
+	tbuf = ts ? GDKmalloc(n * ts) : NULL;
+	chunks = GDKmalloc(nruns * sizeof(struct psort_chunk));
+	merges = GDKmalloc(nthreads * 2 * sizeof(struct psort_merge));
+	tasks = GDKmalloc(nthreads * 2 * sizeof(void *));
+	runs = GDKmalloc((nruns + 1) * sizeof(size_t));
+	if (hbuf == NULL || (ts && tbuf == NULL) || chunks == NULL ||
+	    merges == NULL || tasks == NULL || runs == NULL)
+		goto bailout;
+
+	/* phase 1: sort the chunks independently */
+	for (r = 0; r < nruns; r++) {
+		runs[r] = n / nruns * r;
+		chunks[r].ps = &ps;
+		chunks[r].h = (char *) h + runs[r] * hs;
+		chunks[r].t = ts ? (char *) t + runs[r] * ts : NULL;
+		chunks[r].n = (r == nruns - 1 ? n : n / nruns * (r + 1)) - runs[r];
+		tasks[r] = &chunks[r];
+	}
+	runs[nruns] = n;
+	MRschedule(nruns, tasks, psort_chunk);
+	for (r = 0; r < nruns; r++)
+		if (chunks[r].ret < 0)
+			goto bailout;
+
+	/* phase 2: merge adjacent runs pairwise, ping-ponging between
+	 * the input array and the scratch buffer */
+	h1 = h;
+	t1 = t;
+	h2 = hbuf;
+	t2 = tbuf;
+	while (nruns > 1) {
+		ntasks = 0;
+		pieces = nthreads / (nruns / 2);
+		if (pieces < 1)
+			pieces = 1;
+		for (r = 0, nr = 0; r < nruns; r += 2, nr++) {
+			size_t lo = runs[r], mid, hi, len;
+
+			if (r + 1 == nruns) {
+				/* odd run out: treat as merge with an
+				 * empty right run so it gets copied */
+				mid = hi = runs[nruns];
+			} else {
+				mid = runs[r + 1];
+				hi = runs[r + 2];
+			}
+			len = hi - lo;
+			for (k = 0; k < pieces; k++) {
+				struct psort_merge *m = &merges[ntasks];
+
+				m->ps = &ps;
+				m->h1 = h1 + lo * hs;
+				m->t1 = ts ? t1 + lo * ts : NULL;
+				m->n1 = mid - lo;
+				m->h2 = h1 + mid * hs;
+				m->t2 = ts ? t1 + mid * ts : NULL;
+				m->n2 = hi - mid;
+				m->h = h2 + lo * hs;
+				m->t = ts ? t2 + lo * ts : NULL;
+				m->lo = len / pieces * k;
+				m->hi = k == pieces - 1 ? len : len / pieces * (k + 1);
+				tasks[ntasks++] = m;
+			}
+			runs[nr] = lo;
+		}
+		runs[nr] = n;
+		nruns = nr;
+		MRschedule(ntasks, tasks, psort_merge);
+		tmp = h1;
+		h1 = h2;
+		h2 = tmp;
+		tmp = t1;
+		t1 = t2;
+		t2 = tmp;
+	}
+	if (h1 != (char *) h) {
+		memcpy(h, h1, n * hs);
+		if (ts)
+			memcpy(t, t1, n * ts);
+	}
+
+	GDKfree(hbuf);
+	if (tbuf)
+		GDKfree(tbuf);
+	GDKfree(chunks);
+	GDKfree(merges);
+	GDKfree(tasks);
+	GDKfree(runs);
+	return GDK_SUCCEED;
+
+  bailout:
+	if (hbuf)
+		GDKfree(hbuf);
+	if (tbuf)
+		GDKfree(tbuf);
+	if (chunks)
+		GDKfree(chunks);
+	if (merges)
+		GDKfree(merges);
+	if (tasks)
+		GDKfree(tasks);
+	if (runs)
+		GDKfree(runs);
+	return GDK_FAIL;
+}
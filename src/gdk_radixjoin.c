@@ -0,0 +1,598 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * Radix-cluster hash join.
+ * 基数分区的hash join
+ *
+ * BAThashjoin probes a single hash table on the head of r.  Once r no
+ * longer fits in the cache, every probe costs a cache and TLB miss
+ * for the bucket, for the chain and for the key.  The radix join
+ * instead clusters both l.tail and r.head on the high bits of a hash
+ * of the join key, so that each cluster of r, together with a small
+ * local hash table over it, fits in the L2 cache, and then joins the
+ * matching clusters of l and r.  Clustering all of r is only worth
+ * it for many probes: for a small l the hash table that BAThashjoin
+ * builds on r is cheaper, and is kept for later joins.
+ *
+ * Clustering is done in one or more passes of at most RADIX_PASSBITS
+ * bits each, to keep the number of concurrently written clusters (and
+ * hence TLB entries) low.  The first pass is parallel over chunks of
+ * the input, later passes and the cluster joins are parallel over
+ * clusters.  Every pass is stable, so within a cluster the tuples are
+ * in their original order.  The tuples of l carry their position
+ * through the clustering, those of r their tail value.
+ *
+ * The result is the same as that of BAThashjoin, in the same order:
+ * the tuples of l in order, and for each of them the matching tuples
+ * of r in descending position order (the order of the bucket chains).
+ * To achieve this, the cluster joins only record the first match of
+ * each tuple of l (in a position-ordered array); the result is then
+ * written by a parallel scan over l.
+ */
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_mapreduce.h"
+
+typedef unsigned long long ulng;
+
+#define RADIX_L2	((BUN) 256 << 10) /* target size of a cluster of r */
+#define RADIX_PASSBITS	8	/* clusters per pass at most 1 << RADIX_PASSBITS */
+#define RADIX_MAXBITS	20	/* at most 1 << RADIX_MAXBITS clusters */
+
+/* what a clustered tuple carries along with its key */
+#define RADIX_POS	0	/* its position, relative to BUNfirst */
+#define RADIX_SEQ	1	/* its dense (void) tail value */
+#define RADIX_VAL	2	/* its fixed-width tail value */
+
+/* murmur3 finalizer: all 32 bits depend on all key bits, we use the
+ * high bits for the cluster number and the low bits for the bucket */
+static inline unsigned int
+radix_fmix(unsigned int h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35U;
+	h ^= h >> 16;
+	return h;
+}
+
+#define radix_hash_unsigned(k)	radix_fmix(k)
+#define radix_hash_ulng(k)	radix_fmix((unsigned int) ((k) ^ ((k) >> 32)))
+
+typedef struct {
+	/* clustering */
+	const void *col;	/* the key column, indexed by BUN */
+	BUN first;		/* first BUN of col */
+	BUN grain;		/* BUNs per piece of a parallel scan */
+	ulng nil;		/* nil key, which is skipped */
+	int pay;		/* RADIX_POS, RADIX_SEQ or RADIX_VAL */
+	const char *payval;	/* RADIX_VAL: the tail, indexed by BUN */
+	int payw;		/* RADIX_VAL: tail width */
+	oid payseq;		/* RADIX_SEQ: tail seqbase */
+	int shift;		/* cluster digit is (hash >> shift) & ... */
+	int bits;		/* ... ((1 << bits) - 1) */
+	BUN *cnt;		/* per chunk per digit counters */
+	const void *ks;		/* source keys and payloads */
+	const lng *ps;
+	void *kd;		/* destination keys and payloads */
+	lng *pd;
+	const BUN *bnd;		/* source cluster bounds */
+	BUN *nbnd;		/* destination cluster bounds */
+
+	/* joining */
+	const void *lk, *rk;	/* clustered keys */
+	const lng *lp, *rp;	/* clustered positions (l), tails (r) */
+	const BUN *lb, *rb;	/* cluster bounds */
+	BUN *boff;		/* start of the buckets of each cluster */
+	BUN *bucket;		/* local hash tables of the clusters of r */
+	BUN *rlink;		/* bucket chains, parallel to rk */
+	BUN *rfirst;		/* first match in rk of each tuple of l */
+	BUN *rcnt;		/* result tuples (then offsets) per piece of l */
+	volatile int dups;	/* some tuple of l has more than one match */
+	BUN lfirst;		/* BUNfirst(l) */
+	BAT *l, *bn;
+} radix_t;
+
+/* copy a fixed-width value of w bytes; the constant sizes compile to
+ * plain moves */
+#define radix_put(d, s, w)						\
+	do {								\
+		switch (w) {						\
+		case 0:							\
+			break;						\
+		case 1:							\
+			memcpy((d), (s), 1);				\
+			break;						\
+		case 2:							\
+			memcpy((d), (s), 2);				\
+			break;						\
+		case 4:							\
+			memcpy((d), (s), 4);				\
+			break;						\
+		case 8:							\
+			memcpy((d), (s), 8);				\
+			break;						\
+		default:						\
+			memcpy((d), (s), (w));				\
+			break;						\
+		}							\
+	} while (0)
+
+static inline lng
+radix_payload(const radix_t *rx, BUN i)
+{
+	lng v = 0;
+	oid o;
+
+	switch (rx->pay) {
+	case RADIX_POS:
+		v = (lng) (i - rx->first);
+		break;
+	case RADIX_SEQ:
+		o = rx->payseq + (i - rx->first);
+		radix_put(&v, &o, sizeof(oid));
+		break;
+	default:
+		radix_put(&v, rx->payval + i * rx->payw, rx->payw);
+		break;
+	}
+	return v;
+}
+
+#define RADIX_IMPL(KEY)							\
+/* first pass: histogram of the digits of a chunk */			\
+static void								\
+radix_histo_##KEY(BUN lo, BUN hi, void *arg)				\
+{									\
+	radix_t *rx = arg;						\
+	const KEY *col = rx->col, nil = (KEY) rx->nil;			\
+	BUN *cnt = rx->cnt + (((lo - rx->first) / rx->grain) << rx->bits); \
+	unsigned int m = (1U << rx->bits) - 1;				\
+	int shift = rx->shift;						\
+	BUN i;								\
+									\
+	for (i = lo; i < hi; i++)					\
+		if (col[i] != nil)					\
+			cnt[(radix_hash_##KEY(col[i]) >> shift) & m]++;	\
+}									\
+									\
+/* first pass: scatter a chunk to the clusters */			\
+static void								\
+radix_scatter_##KEY(BUN lo, BUN hi, void *arg)				\
+{									\
+	radix_t *rx = arg;						\
+	const KEY *col = rx->col, nil = (KEY) rx->nil;			\
+	BUN *cnt = rx->cnt + (((lo - rx->first) / rx->grain) << rx->bits); \
+	KEY *kd = rx->kd;						\
+	lng *pd = rx->pd;						\
+	unsigned int m = (1U << rx->bits) - 1;				\
+	int shift = rx->shift;						\
+	BUN i, o;							\
+									\
+	for (i = lo; i < hi; i++) {					\
+		if (col[i] != nil) {					\
+			o = cnt[(radix_hash_##KEY(col[i]) >> shift) & m]++; \
+			kd[o] = col[i];					\
+			pd[o] = radix_payload(rx, i);			\
+		}							\
+	}								\
+}									\
+									\
+/* later passes: split each of the clusters [lo, hi) on the next	\
+ * digit */								\
+static void								\
+radix_refine_##KEY(BUN lo, BUN hi, void *arg)				\
+{									\
+	radix_t *rx = arg;						\
+	const KEY *ks = rx->ks;						\
+	const lng *ps = rx->ps;						\
+	KEY *kd = rx->kd;						\
+	lng *pd = rx->pd;						\
+	BUN cnt[1 << RADIX_PASSBITS], c, i, s, e, t;			\
+	BUN nd = (BUN) 1 << rx->bits, d;				\
+	unsigned int m = (1U << rx->bits) - 1;				\
+	int shift = rx->shift;						\
+									\
+	for (c = lo; c < hi; c++) {					\
+		s = rx->bnd[c];						\
+		e = rx->bnd[c + 1];					\
+		memset(cnt, 0, nd * sizeof(BUN));			\
+		for (i = s; i < e; i++)					\
+			cnt[(radix_hash_##KEY(ks[i]) >> shift) & m]++;	\
+		for (d = 0; d < nd; d++) {				\
+			t = cnt[d];					\
+			rx->nbnd[(c << rx->bits) + d] = cnt[d] = s;	\
+			s += t;						\
+		}							\
+		for (i = rx->bnd[c]; i < e; i++) {			\
+			t = cnt[(radix_hash_##KEY(ks[i]) >> shift) & m]++; \
+			kd[t] = ks[i];					\
+			pd[t] = ps[i];					\
+		}							\
+	}								\
+}									\
+									\
+/* build the local hash tables of the clusters [lo, hi) of r and find	\
+ * the first match of the tuples of l */				\
+static void								\
+radix_probe_##KEY(BUN lo, BUN hi, void *arg)				\
+{									\
+	radix_t *rx = arg;						\
+	const KEY *lk = rx->lk, *rk = rx->rk;				\
+	BUN c, j, x, y, *bucket;					\
+	unsigned int h, mask;						\
+									\
+	for (c = lo; c < hi; c++) {					\
+		bucket = rx->bucket + rx->boff[c];			\
+		mask = (unsigned int) (rx->boff[c + 1] - rx->boff[c] - 1); \
+		for (j = 0; j <= mask; j++)				\
+			bucket[j] = BUN_NONE;				\
+		/* increasing positions: chains are descending */	\
+		for (j = rx->rb[c]; j < rx->rb[c + 1]; j++) {		\
+			h = radix_hash_##KEY(rk[j]) & mask;		\
+			rx->rlink[j] = bucket[h];			\
+			bucket[h] = j;					\
+		}							\
+		for (j = rx->lb[c]; j < rx->lb[c + 1]; j++) {		\
+			h = radix_hash_##KEY(lk[j]) & mask;		\
+			for (x = bucket[h]; x != BUN_NONE; x = rx->rlink[x]) \
+				if (rk[x] == lk[j])			\
+					break;				\
+			rx->rfirst[rx->lp[j]] = x;			\
+			if (x == BUN_NONE || rx->dups)			\
+				continue;				\
+			for (y = rx->rlink[x]; y != BUN_NONE; y = rx->rlink[y]) \
+				if (rk[y] == lk[j]) {			\
+					rx->dups = 1;			\
+					break;				\
+				}					\
+		}							\
+	}								\
+}									\
+									\
+/* number of result tuples of the tuples [lo, hi) of l */		\
+static void								\
+radix_count_##KEY(BUN lo, BUN hi, void *arg)				\
+{									\
+	radix_t *rx = arg;						\
+	const KEY *rk = rx->rk;						\
+	BUN i, x, n = 0;						\
+	KEY k;								\
+									\
+	for (i = lo; i < hi; i++) {					\
+		if ((x = rx->rfirst[i]) == BUN_NONE)			\
+			continue;					\
+		n++;							\
+		if (rx->dups) {						\
+			k = rk[x];					\
+			while ((x = rx->rlink[x]) != BUN_NONE)		\
+				n += rk[x] == k;			\
+		}							\
+	}								\
+	rx->rcnt[lo / rx->grain] = n;					\
+}									\
+									\
+/* write the result tuples of the tuples [lo, hi) of l */		\
+static void								\
+radix_fill_##KEY(BUN lo, BUN hi, void *arg)				\
+{									\
+	radix_t *rx = arg;						\
+	const KEY *rk = rx->rk;						\
+	BATiter li = bat_iterator(rx->l);				\
+	BAT *bn = rx->bn;						\
+	int hw = Hsize(bn), tw = Tsize(bn);				\
+	BUN i, x, o = BUNfirst(bn) + rx->rcnt[lo / rx->grain];		\
+	const void *hv;							\
+	KEY k;								\
+									\
+	for (i = lo; i < hi; i++) {					\
+		if ((x = rx->rfirst[i]) == BUN_NONE)			\
+			continue;					\
+		hv = BUNhead(li, rx->lfirst + i);			\
+		radix_put(Hloc(bn, o), hv, hw);				\
+		radix_put(Tloc(bn, o), &rx->rp[x], tw);			\
+		o++;							\
+		if (rx->dups) {						\
+			k = rk[x];					\
+			while ((x = rx->rlink[x]) != BUN_NONE) {	\
+				if (rk[x] != k)				\
+					continue;			\
+				radix_put(Hloc(bn, o), hv, hw);		\
+				radix_put(Tloc(bn, o), &rx->rp[x], tw);	\
+				o++;					\
+			}						\
+		}							\
+	}								\
+}
+
+RADIX_IMPL(unsigned)
+RADIX_IMPL(ulng)
+
+/* can GDKradixjoin handle this join? */
+int
+GDKradixjoinable(BAT *l, BAT *r)
+{
+	int s = ATOMsize(l->ttype);
+
+	if (l->ttype == TYPE_void || r->htype == TYPE_void ||
+	    ATOMvarsized(l->ttype) || (s != 4 && s != 8) ||
+	    ATOMsize(r->htype) != s ||
+	    ATOMvarsized(BAThtype(l)) || ATOMvarsized(BATttype(r)) ||
+	    ATOMsize(BATttype(r)) > (int) sizeof(lng))
+		return 0;
+	switch (ATOMstorage(l->ttype)) {
+	case TYPE_int:
+	case TYPE_flt:
+	case TYPE_lng:
+	case TYPE_dbl:
+		break;
+	default:
+		return 0;
+	}
+	/* r small enough that its hash table stays in the cache, or
+	 * too few probes to pay for clustering all of r on every
+	 * call: the hash table BAThashjoin builds is kept on r and
+	 * reused by the next join */
+	if (BATcount(r) < RADIX_MINSIZE || BATcount(l) < RADIX_MINSIZE)
+		return 0;
+	return 1;
+}
+
+/* Cluster the non-nil keys of col[first..first+n) with their payloads
+ * on B bits of their hash in npass passes.  On success *kp, *pp hold
+ * the clustered keys and payloads and *bp the (1 << B) + 1 cluster
+ * bounds. */
+static gdk_return
+radix_cluster(radix_t *rx, int wide, int B, int npass, BUN n,
+	      void **kp, lng **pp, BUN **bp)
+{
+	size_t ks = wide ? sizeof(ulng) : sizeof(unsigned int);
+	void *k1, *k2, *kt;
+	lng *p1, *p2, *pt;
+	BUN *bnd = NULL, nchunks, nclus, i, c, s, t, grain;
+	int pass, done, nthreads = GDKnr_threads > 0 ? GDKnr_threads : 1;
+
+	k1 = GDKmalloc(n * ks);
+	k2 = npass > 1 ? GDKmalloc(n * ks) : NULL;
+	p1 = GDKmalloc(n * sizeof(lng));
+	p2 = npass > 1 ? GDKmalloc(n * sizeof(lng)) : NULL;
+	rx->grain = (n + nthreads - 1) / nthreads;
+	nchunks = (n + rx->grain - 1) / rx->grain;
+	rx->bits = B / npass + (B % npass > 0);
+	rx->cnt = GDKzalloc((nchunks << rx->bits) * sizeof(BUN));
+	bnd = GDKmalloc((((BUN) 1 << rx->bits) + 1) * sizeof(BUN));
+	if (k1 == NULL || p1 == NULL || rx->cnt == NULL || bnd == NULL ||
+	    (npass > 1 && (k2 == NULL || p2 == NULL)))
+		goto bailout;
+
+	/* first pass */
+	rx->shift = 32 - rx->bits;
+	rx->kd = k1;
+	rx->pd = p1;
+	MRparallel_for(rx->first, rx->first + n, rx->grain, wide ? radix_histo_ulng : radix_histo_unsigned, rx);
+	nclus = (BUN) 1 << rx->bits;
+	for (c = 0, s = 0; c < nclus; c++) {
+		bnd[c] = s;
+		for (i = 0; i < nchunks; i++) {
+			t = rx->cnt[(i << rx->bits) + c];
+			rx->cnt[(i << rx->bits) + c] = s;
+			s += t;
+		}
+	}
+	bnd[nclus] = s;		/* number of non-nil keys */
+	MRparallel_for(rx->first, rx->first + n, rx->grain, wide ? radix_scatter_ulng : radix_scatter_unsigned, rx);
+	GDKfree(rx->cnt);
+	rx->cnt = NULL;
+	done = rx->bits;
+
+	/* refinement passes */
+	for (pass = 1; pass < npass; pass++) {
+		int bits = (B - done) / (npass - pass) + ((B - done) % (npass - pass) > 0);
+
+		rx->nbnd = GDKmalloc(((nclus << bits) + 1) * sizeof(BUN));
+		if (rx->nbnd == NULL)
+			goto bailout;
+		rx->ks = k1;
+		rx->ps = p1;
+		rx->kd = k2;
+		rx->pd = p2;
+		rx->bnd = bnd;
+		rx->bits = bits;
+		rx->shift = 32 - done - bits;
+		grain = nclus / (nthreads * 4);
+		MRparallel_for(0, nclus, grain > 0 ? grain : 1, wide ? radix_refine_ulng : radix_refine_unsigned, rx);
+		rx->nbnd[nclus << bits] = bnd[nclus];
+		GDKfree(bnd);
+		bnd = rx->nbnd;
+		rx->nbnd = NULL;
+		nclus <<= bits;
+		done += bits;
+		kt = k1;
+		k1 = k2;
+		k2 = kt;
+		pt = p1;
+		p1 = p2;
+		p2 = pt;
+	}
+	assert(done == B);
+	if (k2)
+		GDKfree(k2);
+	if (p2)
+		GDKfree(p2);
+	*kp = k1;
+	*pp = p1;
+	*bp = bnd;
+	return GDK_SUCCEED;
+
+  bailout:
+	if (k1)
+		GDKfree(k1);
+	if (k2)
+		GDKfree(k2);
+	if (p1)
+		GDKfree(p1);
+	if (p2)
+		GDKfree(p2);
+	if (rx->cnt)
+		GDKfree(rx->cnt);
+	rx->cnt = NULL;
+	if (bnd)
+		GDKfree(bnd);
+	return GDK_FAIL;
+}
+
+/* Join l.tail with r.head; the result has the same content and order
+ * as BAThashjoin's.  Returns NULL on failure (out of memory). */
+BAT *
+GDKradixjoin(BAT *l, BAT *r)
+{
+	radix_t rx;
+	int wide = ATOMsize(l->ttype) == 8, B, npass;
+	int nthreads = GDKnr_threads > 0 ? GDKnr_threads : 1;
+	size_t ks = wide ? sizeof(ulng) : sizeof(unsigned int);
+	BUN nl = BATcount(l), nr = BATcount(r), nclus, npieces, c, m, s, t, grain;
+	void *lk = NULL, *rk = NULL;
+	lng *lp = NULL, *rp = NULL;
+	BUN *lb = NULL, *rb = NULL;
+	BAT *bn = NULL;
+
+	assert(GDKradixjoinable(l, r));
+	memset(&rx, 0, sizeof(rx));
+
+	/* number of cluster bits such that a cluster of r with its
+	 * tails, chains and buckets fits in the L2 cache */
+	for (B = 1; B < RADIX_MAXBITS &&
+		     (nr >> B) * (ks + sizeof(lng) + 2 * sizeof(BUN)) > RADIX_L2;
+	     B++)
+		;
+	npass = (B + RADIX_PASSBITS - 1) / RADIX_PASSBITS;
+	nclus = (BUN) 1 << B;
+	ALGODEBUG fprintf(stderr, "#GDKradixjoin: " BUNFMT "x" BUNFMT ", %d bits, %d passes\n", nl, nr, B, npass);
+
+	/* r carries its tail values */
+	rx.col = Hloc(r, 0);
+	rx.first = BUNfirst(r);
+	rx.nil = wide ? *(const ulng *) ATOMnilptr(r->htype) : *(const unsigned int *) ATOMnilptr(r->htype);
+	if (r->ttype == TYPE_void) {
+		rx.pay = RADIX_SEQ;
+		rx.payseq = r->tseqbase;
+	} else {
+		rx.pay = RADIX_VAL;
+		rx.payval = Tloc(r, 0);
+		rx.payw = Tsize(r);
+	}
+	if (radix_cluster(&rx, wide, B, npass, nr, &rk, &rp, &rb) == GDK_FAIL)
+		goto bailout;
+	/* l carries its positions */
+	rx.col = Tloc(l, 0);
+	rx.first = BUNfirst(l);
+	rx.nil = wide ? *(const ulng *) ATOMnilptr(l->ttype) : *(const unsigned int *) ATOMnilptr(l->ttype);
+	rx.pay = RADIX_POS;
+	if (radix_cluster(&rx, wide, B, npass, nl, &lk, &lp, &lb) == GDK_FAIL)
+		goto bailout;
+
+	rx.lk = lk;
+	rx.rk = rk;
+	rx.lp = lp;
+	rx.rp = rp;
+	rx.lb = lb;
+	rx.rb = rb;
+	rx.lfirst = BUNfirst(l);
+	rx.l = l;
+	rx.boff = GDKmalloc((nclus + 1) * sizeof(BUN));
+	rx.rlink = GDKmalloc((rb[nclus] > 0 ? rb[nclus] : 1) * sizeof(BUN));
+	rx.rfirst = GDKmalloc(nl * sizeof(BUN));
+	if (rx.boff == NULL || rx.rlink == NULL || rx.rfirst == NULL)
+		goto bailout;
+	/* one bucket per tuple in each cluster, rounded up */
+	for (c = 0, s = 0; c < nclus; c++) {
+		rx.boff[c] = s;
+		for (m = 1; m < rb[c + 1] - rb[c]; m <<= 1)
+			;
+		s += m;
+	}
+	rx.boff[nclus] = s;
+	rx.bucket = GDKmalloc(s * sizeof(BUN));
+	if (rx.bucket == NULL)
+		goto bailout;
+	/* nils in l have no match */
+	for (c = 0; c < nl; c++)
+		rx.rfirst[c] = BUN_NONE;
+
+	grain = nclus / (nthreads * 4);
+	MRparallel_for(0, nclus, grain > 0 ? grain : 1, wide ? radix_probe_ulng : radix_probe_unsigned, &rx);
+	GDKfree(rx.bucket);
+	rx.bucket = NULL;
+
+	/* write the result in the order of l */
+	rx.grain = (nl + nthreads * 4 - 1) / (nthreads * 4);
+	npieces = (nl + rx.grain - 1) / rx.grain;
+	rx.rcnt = GDKmalloc(npieces * sizeof(BUN));
+	if (rx.rcnt == NULL)
+		goto bailout;
+	MRparallel_for(0, nl, rx.grain, wide ? radix_count_ulng : radix_count_unsigned, &rx);
+	for (c = 0, s = 0; c < npieces; c++) {
+		t = rx.rcnt[c];
+		rx.rcnt[c] = s;
+		s += t;
+	}
+	bn = BATnew(BAThtype(l), BATttype(r), s);
+	if (bn == NULL)
+		goto bailout;
+	rx.bn = bn;
+	MRparallel_for(0, nl, rx.grain, wide ? radix_fill_ulng : radix_fill_unsigned, &rx);
+	BATsetcount(bn, s);
+	bn->hsorted = BAThordered(l);
+	bn->hrevsorted = BAThrevordered(l);
+	bn->tsorted = FALSE;
+	bn->trevsorted = FALSE;
+	bn->hdense = FALSE;
+	bn->tdense = FALSE;
+	bn->hkey = FALSE;
+	bn->tkey = FALSE;
+	ALGODEBUG fprintf(stderr, "#GDKradixjoin: " BUNFMT " tuples%s\n", s, rx.dups ? ", duplicate matches" : "");
+
+  bailout:
+	if (lk)
+		GDKfree(lk);
+	if (rk)
+		GDKfree(rk);
+	if (lp)
+		GDKfree(lp);
+	if (rp)
+		GDKfree(rp);
+	if (lb)
+		GDKfree(lb);
+	if (rb)
+		GDKfree(rb);
+	if (rx.boff)
+		GDKfree(rx.boff);
+	if (rx.rlink)
+		GDKfree(rx.rlink);
+	if (rx.rfirst)
+		GDKfree(rx.rfirst);
+	if (rx.bucket)
+		GDKfree(rx.bucket);
+	if (rx.rcnt)
+		GDKfree(rx.rcnt);
+	return bn;
+}
@@ -38,6 +38,7 @@
 #include "monetdb_config.h"
 #include "gdk.h"
 #include "gdk_private.h"
+#include "gdk_mapreduce.h"
 
 #define SAMPLE_TRESHOLD_LOG 17
 #define SAMPLE_SLICE_SIZE 1000
@@ -62,6 +63,9 @@ static BAT *BATnlthetajoin(BAT *l, BAT *r, int op, BUN estimate);
  * and executed with the generic join algorithm to obtain an better estimate.
  *
  * On small joins we just assume 1-N joins with a limited (=3) hit rate.
+ *
+ * If both join columns have statistics (see gdk_stats.c), the estimate
+ * is computed from those and no sample is taken.
  */
 
 
@@ -98,10 +102,14 @@ static BAT *BATnlthetajoin(BAT *l, BAT *r, int op, BUN estimate);
 
 
 #line 289 "gdk_relop.mx"
+static BAT *mergejoin(BAT *l, BAT *r, BAT *bn, ptr nil_on_miss, BUN estimate, BUN *limit);
+
 /* serves both normal equi-join (nil_on_miss==NULL) and outerjoin
- * (nil_on_miss=nil) */
+ * (nil_on_miss=nil); joins the BUNs [l_lo, l_hi) of l with the BUNs
+ * [r_lo, r_hi) of r */
 static BAT *
-mergejoin(BAT *l, BAT *r, BAT *bn, ptr nil_on_miss, BUN estimate, BUN *limit)
+mergejoin_range(BAT *l, BAT *r, BAT *bn, ptr nil_on_miss, BUN estimate, BUN *limit,
+		BUN l_lo, BUN l_hi, BUN r_lo, BUN r_hi)
 {
 	ptr nil = ATOMnilptr(r->htype);
 	int r_scan = -1;	/* no scanning in r */
@@ -138,6 +146,9 @@ mergejoin(BAT *l, BAT *r, BAT *bn, ptr nil_on_miss, BUN estimate, BUN *limit)
 
 		
 #line 64 "gdk_relop.mx"
+	if ( _estimate == BUN_NONE)
+		/* column statistics make sampling unnecessary */
+		 _estimate = STATSjoin(BATmirror(l), r);
 	if ( _estimate == BUN_NONE) {
 		BUN _lcount = BATcount(l);
 		BUN _rcount = BATcount(r);
@@ -260,10 +271,10 @@ mergejoin(BAT *l, BAT *r, BAT *bn, ptr nil_on_miss, BUN estimate, BUN *limit)
 	/* the algorithm */
 	loc = ATOMstorage(l->ttype);
 
-	l_last = BUNlast(l);
-	r_last = BUNlast(r);
-	l_start = l_end = BUNfirst(l);
-	r_start = r_end = BUNfirst(r);
+	l_last = l_hi;
+	r_last = r_hi;
+	l_start = l_end = l_lo;
+	r_start = r_end = r_lo;
 
 	switch (loc) {
 	case TYPE_bte:
@@ -1083,6 +1094,184 @@ mergejoin(BAT *l, BAT *r, BAT *bn, ptr nil_on_miss, BUN estimate, BUN *limit)
 	return NULL;
 }
 
+static BAT *
+mergejoin(BAT *l, BAT *r, BAT *bn, ptr nil_on_miss, BUN estimate, BUN *limit)
+{
+	return mergejoin_range(l, r, bn, nil_on_miss, estimate, limit,
+			       BUNfirst(l), BUNlast(l), BUNfirst(r), BUNlast(r));
+}
+
+/*
+ * Parallel merge join: l is cut into ranges that are merge joined with
+ * r on separate threads.  If l is sorted, the ranges are cut at value
+ * boundaries and each is joined only with the range of r that holds
+ * the same values (found with SORTfndfirst); otherwise each range of l
+ * is joined with all of r.  The partial results are concatenated in
+ * the order of l, so the result is identical to that of a single
+ * mergejoin.
+ */
+#define MERGEJOIN_PARALLEL_MINSIZE	((BUN) 1 << 20)	/* BUNs of l */
+#define MERGEJOIN_PIECE_MINSIZE		((BUN) 1 << 16)	/* BUNs of l per range */
+
+typedef struct {
+	BAT *l, *r;
+	BUN *lpos, *rpos;	/* range bounds in l and r */
+	BUN *cnt;		/* result sizes, then offsets */
+	BAT **res;		/* partial results */
+	BAT *bn;
+	BUN estimate;		/* estimate per range */
+	int lsorted;		/* ranges of r are in rpos, else all of r */
+	volatile int error;
+} mjpiece_t;
+
+static void
+mergejoin_piece(BUN lo, BUN hi, void *arg)
+{
+	mjpiece_t *m = (mjpiece_t *) arg;
+
+	for (; lo < hi; lo++) {
+		if (m->error)
+			return;
+		m->res[lo] = mergejoin_range(m->l, m->r, NULL, NULL, m->estimate, NULL,
+					     m->lpos[lo], m->lpos[lo + 1],
+					     m->lsorted ? m->rpos[lo] : BUNfirst(m->r),
+					     m->lsorted ? m->rpos[lo + 1] : BUNlast(m->r));
+		if (m->res[lo] == NULL)
+			m->error = 1;
+	}
+}
+
+static void
+mergejoin_concat(BUN lo, BUN hi, void *arg)
+{
+	mjpiece_t *m = (mjpiece_t *) arg;
+	BAT *bn = m->bn, *b;
+
+	for (; lo < hi; lo++) {
+		b = m->res[lo];
+		memcpy(Hloc(bn, BUNfirst(bn) + m->cnt[lo]), Hloc(b, BUNfirst(b)),
+		       BATcount(b) * Hsize(bn));
+		memcpy(Tloc(bn, BUNfirst(bn) + m->cnt[lo]), Tloc(b, BUNfirst(b)),
+		       BATcount(b) * Tsize(bn));
+	}
+}
+
+static int
+mergejoin_parallelizable(BAT *l, BAT *r, BUN *limit)
+{
+	return limit == NULL && GDKnr_threads > 1 &&
+		BATcount(l) >= MERGEJOIN_PARALLEL_MINSIZE &&
+		l->ttype != TYPE_void && r->htype != TYPE_void &&
+		BAThordered(r) &&
+		!ATOMvarsized(BAThtype(l)) && !ATOMvarsized(BATttype(r));
+}
+
+static BAT *
+mergejoin_parallel(BAT *l, BAT *r, BUN estimate)
+{
+	mjpiece_t m;
+	BUN n = BATcount(l), i, k, s, t, npieces;
+	BATiter li = bat_iterator(l);
+	BAT *bn = NULL;
+
+	npieces = (BUN) GDKnr_threads * 4;
+	if (npieces > n / MERGEJOIN_PIECE_MINSIZE)
+		npieces = n / MERGEJOIN_PIECE_MINSIZE;
+	memset(&m, 0, sizeof(m));
+	m.l = l;
+	m.r = r;
+	m.lpos = GDKmalloc((npieces + 1) * sizeof(BUN));
+	m.rpos = GDKmalloc((npieces + 1) * sizeof(BUN));
+	m.cnt = GDKmalloc(npieces * sizeof(BUN));
+	m.res = GDKzalloc(npieces * sizeof(BAT *));
+	if (m.lpos == NULL || m.rpos == NULL || m.cnt == NULL || m.res == NULL)
+		goto bailout;
+
+	m.lsorted = BATtordered(l) != 0;
+	m.lpos[0] = BUNfirst(l);
+	m.rpos[0] = BUNfirst(r);
+	for (i = 1; i < npieces; i++) {
+		if (m.lsorted) {
+			/* cut l before the first occurrence of the value
+			 * at the split point, and r likewise */
+			const void *v = BUNtail(li, BUNfirst(l) + i * (n / npieces));
+
+			k = SORTfndfirst(l, v);
+			if (k < m.lpos[i - 1])
+				k = m.lpos[i - 1];
+			m.lpos[i] = k;
+			k = SORTfndfirst(BATmirror(r), v);
+			if (k < m.rpos[i - 1])
+				k = m.rpos[i - 1];
+			m.rpos[i] = k;
+		} else {
+			/* every range of l is joined with all of r */
+			m.lpos[i] = BUNfirst(l) + i * (n / npieces);
+			m.rpos[i] = BUNfirst(r);
+		}
+	}
+	m.lpos[npieces] = BUNlast(l);
+	m.rpos[npieces] = BUNlast(r);
+	m.estimate = (estimate == BUN_NONE ? n : estimate) / npieces + 1024;
+	ALGODEBUG fprintf(stderr, "#mergejoin: parallel, " BUNFMT " ranges\n", npieces);
+
+	MRparallel_for(0, npieces, 1, mergejoin_piece, &m);
+	if (m.error)
+		goto bailout;
+	for (i = 0, s = 0; i < npieces; i++) {
+		t = BATcount(m.res[i]);
+		m.cnt[i] = s;
+		s += t;
+	}
+	bn = BATnew(BAThtype(l), BATttype(r), s);
+	if (bn == NULL)
+		goto bailout;
+	m.bn = bn;
+	MRparallel_for(0, npieces, 1, mergejoin_concat, &m);
+	BATsetcount(bn, s);
+
+	/* the properties of a sequential mergejoin without nils */
+	bn->hsorted = BAThordered(l);
+	bn->hrevsorted = BAThrevordered(l);
+	if (r->hkey) {
+		if (BATcount(bn) == BATcount(l)) {
+			ALIGNsetH(bn, l);
+		} else if (l->hkey) {
+			BATkey(bn, TRUE);
+		}
+	}
+	bn->H->nonil = l->H->nonil;
+	bn->tsorted = FALSE;
+	bn->trevsorted = FALSE;
+	if (BATtordered(l)) {
+		if (l->tkey && BATcount(bn) == BATcount(r)) {
+			ALIGNsetT(bn, r);
+		} else if (l->tkey || r->hkey) {
+			bn->tsorted = BATtordered(r);
+			bn->trevsorted = BATtrevordered(r);
+		}
+	}
+	if (l->tkey && r->tkey) {
+		BATkey(BATmirror(bn), TRUE);
+	}
+	bn->T->nonil = r->T->nonil;
+
+  bailout:
+	if (m.res) {
+		for (i = 0; i < npieces; i++)
+			if (m.res[i])
+				BBPreclaim(m.res[i]);
+		GDKfree(m.res);
+	}
+	if (m.lpos)
+		GDKfree(m.lpos);
+	if (m.rpos)
+		GDKfree(m.rpos);
+	if (m.cnt)
+		GDKfree(m.cnt);
+	return bn;
+}
+
 static BAT *batfetchjoin(BAT *l, BAT *r, BUN estimate, bit swap, bit hitalways);
 
 static BAT *
@@ -1109,10 +1298,17 @@ batmergejoin(BAT *l, BAT *r, BUN estimate, bit swap, BUN *limit)
 	if (swap && (!BAThordered(r) || (BATtordered(l) && BATcount(l) > BATcount(r)))) {
 		/* reverse join if required (r not sorted) or if l is
 		 * larger (quick jump through l with binary search) */
-		BAT *bn = mergejoin(BATmirror(r), BATmirror(l), NULL, NULL, estimate, limit);
+		BAT *bn;
+
+		if (mergejoin_parallelizable(BATmirror(r), BATmirror(l), limit))
+			bn = mergejoin_parallel(BATmirror(r), BATmirror(l), estimate);
+		else
+			bn = mergejoin(BATmirror(r), BATmirror(l), NULL, NULL, estimate, limit);
 
 		return bn ? BATmirror(bn) : NULL;
 	}
+	if (mergejoin_parallelizable(l, r, limit))
+		return mergejoin_parallel(l, r, estimate);
 	return mergejoin(l, r, NULL, NULL, estimate, limit);
 }
 
@@ -1150,6 +1346,11 @@ BAThashjoin(BAT *l, BAT *r, BUN estimate)
 
 #line 482 "gdk_relop.mx"
 
+	/* large l and r: cache-conscious radix-cluster join, which needs
+	 * neither a size estimate nor the hash table on r */
+	if (GDKradixjoinable(l, r) && (bn = GDKradixjoin(l, r)) != NULL)
+		goto joined;
+
 	
 #line 170 "gdk_relop.mx"
 	{
@@ -1157,6 +1358,9 @@ BAThashjoin(BAT *l, BAT *r, BUN estimate)
 
 		
 #line 64 "gdk_relop.mx"
+	if ( _estimate == BUN_NONE)
+		/* column statistics make sampling unnecessary */
+		 _estimate = STATSjoin(BATmirror(l), r);
 	if ( _estimate == BUN_NONE) {
 		BUN _lcount = BATcount(l);
 		BUN _rcount = BATcount(r);
@@ -1442,6 +1646,7 @@ BAThashjoin(BAT *l, BAT *r, BUN estimate)
 
 	}
 
+  joined:
 	/* propagate alignment info */
 	bn->hsorted = BAThordered(l);
 	bn->hrevsorted = BAThrevordered(l);
@@ -11604,9 +11809,83 @@ batfetchjoin(BAT *l, BAT *r, BUN estimate, bit swap, bit hitalways)
 	return ret;
 }
 
+#define CANDfetch(TYPE)							\
+	do {								\
+		const TYPE *src = (const TYPE *) Tloc(r, BUNfirst(r));	\
+		TYPE *dst = (TYPE *) Tloc(bn, BUNfirst(bn));		\
+		while (ci.next != oid_nil)				\
+			*dst++ = src[CANDiternext(&ci) - r->hseqbase];	\
+	} while (0)
+
+/* fetchjoin with compact candidates l (see CANDtoBAT): the values of
+ * r in the order of the candidates, which are iterated directly if
+ * the values have a fixed width */
+static BAT *
+cand_fetchjoin(BAT *l, BAT *r)
+{
+	CandIter ci;
+	BAT *bn;
+
+	BATcheck(r, "BATfetchjoin: right BAT required");
+	if (!BAThdense(r) || r->ttype == TYPE_void || ATOMvarsized(r->ttype)) {
+		ALGODEBUG fprintf(stderr, "#BATfetchjoin: materialize compact candidates\n");
+		if ((l = BATcandlist(l)) == NULL)
+			return NULL;
+		bn = batfetchjoin(l, r, BATcount(l), FALSE, TRUE);
+		BBPunfix(l->batCacheid);
+		return bn;
+	}
+	CANDiter(&ci, l, r->hseqbase, r->hseqbase + BATcount(r));
+	if (ci.count != BATcount(l)) {
+		GDKerror("BATfetchjoin(%s,%s) does not hit always (|bn|=" BUNFMT " != " BUNFMT "=|l|) => can't use fetchjoin.\n", BATgetId(l), BATgetId(r), ci.count, BATcount(l));
+		return NULL;
+	}
+	ALGODEBUG fprintf(stderr, "#BATfetchjoin: iterate compact candidates\n");
+	bn = BATnew(TYPE_void, r->ttype, ci.count);
+	if (bn == NULL)
+		return NULL;
+	switch (Tsize(r)) {
+	case sizeof(bte):
+		CANDfetch(bte);
+		break;
+	case sizeof(sht):
+		CANDfetch(sht);
+		break;
+	case sizeof(int):
+		CANDfetch(int);
+		break;
+	case sizeof(lng):
+		CANDfetch(lng);
+		break;
+	default: {
+		const char *src = (const char *) Tloc(r, BUNfirst(r));
+		char *dst = (char *) Tloc(bn, BUNfirst(bn));
+		int w = Tsize(r);
+
+		while (ci.next != oid_nil) {
+			memcpy(dst, src + (CANDiternext(&ci) - r->hseqbase) * w, w);
+			dst += w;
+		}
+		break;
+	}
+	}
+	BATsetcount(bn, BATcount(l));
+	BATseqbase(bn, 0);
+	/* a subsequence of the values of r */
+	bn->tsorted = BATtordered(r);
+	bn->trevsorted = BATtrevordered(r);
+	bn->tkey = BATtkey(r);
+	bn->tdense = 0;
+	bn->T->nil = 0;
+	bn->T->nonil = r->T->nonil;
+	return bn;
+}
+
 BAT *
 BATfetchjoin(BAT *l, BAT *r, BUN estimate)
 {
+	if (l && BATtcand(l))
+		return cand_fetchjoin(l, r);
 	/* fetchjoin now implies that you assure no fetch misses (hitalways) */
 	/* allows swapping of left and right input for faster processing */
 	return batfetchjoin(l, r, estimate, TRUE, TRUE);
@@ -11615,6 +11894,8 @@ BATfetchjoin(BAT *l, BAT *r, BUN estimate)
 BAT *
 BATleftfetchjoin(BAT *l, BAT *r, BUN estimate)
 {
+	if (l && BATtcand(l))
+		return cand_fetchjoin(l, r);
 	/* fetchjoin now implies that you assure no fetch misses (hitalways) */
 	/* do not swap left and right input, and hence maintain order
 	 * of left head in result */
@@ -12004,6 +12285,9 @@ BATouterjoin(BAT *l, BAT *r, BUN estimate)
 
 		
 #line 64 "gdk_relop.mx"
+	if ( _estimate == BUN_NONE)
+		/* column statistics make sampling unnecessary */
+		 _estimate = STATSjoin(BATmirror(l), r);
 	if ( _estimate == BUN_NONE) {
 		BUN _lcount = BATcount(l);
 		BUN _rcount = BATcount(r);
@@ -0,0 +1,320 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * LSD radix sort for fixed-width integer heads.
+ * 基数排序
+ *
+ * The head values are translated into unsigned keys by flipping the
+ * sign bit (the "signed bias"), so that the unsigned order of the keys
+ * is the signed order of the values.  Since nil is the smallest value
+ * of each integer domain, it sorts first, just as with intCmp and
+ * lngCmp.  OIDs are sorted through their storage type, as GDKqsort
+ * and the oid atomCmp do, so oid_nil sorts first as well.  For a
+ * descending sort all key bits are inverted.
+ *
+ * The keys are sorted in passes of RSORT_BITS bits, least significant
+ * digit first.  The histograms of all digits are computed in a single
+ * scan up front, and passes in which all keys share the same digit
+ * are skipped.  Every scatter goes through a small per-bucket buffer
+ * of one cache line (software write-combining), which keeps the number
+ * of open cache lines and TLB entries during a pass low.
+ *
+ * The tail is not moved during the passes: we carry the original
+ * position of each entry along with its key and permute the tail once
+ * at the end.  LSD radix sort is stable, so it can be used for both
+ * GDKqsort and GDKssort requests.
+ */
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+typedef unsigned long long ulng;
+
+#define RSORT_BITS	11
+#define RSORT_BUCKETS	(1 << RSORT_BITS)
+#define RSORT_MASK	(RSORT_BUCKETS - 1)
+/* number of entries in a write-combining buffer (one cache line of
+ * keys) */
+#define RSORT_WC(KEY)	(64 / sizeof(KEY))
+
+/* One LSD pass: scatter the n entries of (ks, ps) into (kd, pd) on
+ * digit number dig, using the prefix sums in cnt. */
+#define RSORT_PASS(KEY)							\
+static void								\
+rsort_pass_##KEY(const KEY *restrict ks, const oid *restrict ps,	\
+		 KEY *restrict kd, oid *restrict pd,			\
+		 size_t n, int shift, size_t *restrict cnt,		\
+		 KEY *restrict wck, oid *restrict wcp,			\
+		 unsigned char *restrict wcn)				\
+{									\
+	size_t i, b, o;							\
+	unsigned int c;							\
+									\
+	memset(wcn, 0, RSORT_BUCKETS);					\
+	for (i = 0; i < n; i++) {					\
+		b = (size_t) (ks[i] >> shift) & RSORT_MASK;		\
+		c = wcn[b];						\
+		wck[b * RSORT_WC(KEY) + c] = ks[i];			\
+		if (ps)							\
+			wcp[b * RSORT_WC(KEY) + c] = ps[i];		\
+		if (++c == RSORT_WC(KEY)) {				\
+			o = cnt[b];					\
+			memcpy(kd + o, wck + b * RSORT_WC(KEY),		\
+			       RSORT_WC(KEY) * sizeof(KEY));		\
+			if (ps)						\
+				memcpy(pd + o, wcp + b * RSORT_WC(KEY),	\
+				       RSORT_WC(KEY) * sizeof(oid));	\
+			cnt[b] = o + RSORT_WC(KEY);			\
+			c = 0;						\
+		}							\
+		wcn[b] = (unsigned char) c;				\
+	}								\
+	/* flush the partially filled buffers */			\
+	for (b = 0; b < RSORT_BUCKETS; b++) {				\
+		if ((c = wcn[b]) > 0) {					\
+			o = cnt[b];					\
+			memcpy(kd + o, wck + b * RSORT_WC(KEY), c * sizeof(KEY)); \
+			if (ps)						\
+				memcpy(pd + o, wcp + b * RSORT_WC(KEY),	\
+				       c * sizeof(oid));		\
+		}							\
+	}								\
+}
+
+RSORT_PASS(unsigned)
+RSORT_PASS(ulng)
+
+/* Sort the keys in k (with positions in p if p is not NULL) using the
+ * scratch arrays k2 and p2.  Returns the array that holds the result
+ * (k or k2). */
+#define RSORT_SORT(KEY)							\
+static KEY *								\
+rsort_##KEY(KEY *k, oid **pp, KEY *k2, oid *p2, size_t n, int bits,	\
+	    size_t *cnt, KEY *wck, oid *wcp, unsigned char *wcn)	\
+{									\
+	int npass = (bits + RSORT_BITS - 1) / RSORT_BITS, d;		\
+	size_t i, s, c;							\
+	oid *p = *pp, *pt;						\
+	KEY *kt;							\
+									\
+	memset(cnt, 0, npass * RSORT_BUCKETS * sizeof(size_t));		\
+	for (i = 0; i < n; i++)						\
+		for (d = 0; d < npass; d++)				\
+			cnt[d * RSORT_BUCKETS +				\
+			    ((size_t) (k[i] >> (d * RSORT_BITS)) & RSORT_MASK)]++; \
+	for (d = 0; d < npass; d++) {					\
+		size_t *h = cnt + d * RSORT_BUCKETS;			\
+									\
+		/* skip pass if all keys have the same digit */		\
+		for (i = 0; i < RSORT_BUCKETS; i++)			\
+			if (h[i] != 0)					\
+				break;					\
+		if (h[i] == n)						\
+			continue;					\
+		for (i = 0, s = 0; i < RSORT_BUCKETS; i++) {		\
+			c = h[i];					\
+			h[i] = s;					\
+			s += c;						\
+		}							\
+		rsort_pass_##KEY(k, p, k2, p2, n, d * RSORT_BITS, h,	\
+				 wck, wcp, wcn);			\
+		kt = k;							\
+		k = k2;							\
+		k2 = kt;						\
+		pt = p;							\
+		p = p2;							\
+		p2 = pt;						\
+	}								\
+	*pp = p;							\
+	return k;							\
+}
+
+RSORT_SORT(unsigned)
+RSORT_SORT(ulng)
+
+/* can GDKrsort handle this sort? */
+int
+GDKrsortable(const void *base, int tpe)
+{
+	if (base != NULL || ATOMvarsized(tpe))
+		return 0;
+	switch (ATOMstorage(tpe)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+#define rsort_in(TYPE, KEY, SIGN)					\
+	do {								\
+		const TYPE *v = (const TYPE *) h;			\
+		KEY inv = reverse ? ~(KEY) 0 : 0;			\
+		for (i = 0; i < n; i++)					\
+			kk[i] = ((KEY) (v[i] ^ (SIGN)) ^ inv) & mask;	\
+	} while (0)
+#define rsort_out(TYPE, KEY, SIGN)					\
+	do {								\
+		TYPE *v = (TYPE *) h;					\
+		KEY inv = reverse ? ~(KEY) 0 : 0;			\
+		for (i = 0; i < n; i++)					\
+			v[i] = (TYPE) ((TYPE) ((r[i] ^ inv) & mask) ^ (SIGN)); \
+	} while (0)
+
+/* Sort n entries of the fixed-width integer array h ascending (or
+ * descending if reverse is set), permuting the entries of the array t
+ * (width ts, may be NULL) alongside.  The sort is stable.  Returns
+ * GDK_FAIL if the scratch memory cannot be allocated, in which case h
+ * and t are untouched. */
+gdk_return
+GDKrsort(void *h, void *t, size_t n, int hs, int ts, int tpe, int reverse)
+{
+	size_t *cnt = NULL, i;
+	oid *p = NULL, *p2 = NULL, *pr, *wcp = NULL;
+	unsigned char *wcn = NULL;
+	char *tt = NULL;
+	int bits = hs * 8, wide = hs > (int) sizeof(unsigned int);
+	size_t ks = wide ? sizeof(ulng) : sizeof(unsigned int);
+	void *k = NULL, *k2 = NULL, *wck = NULL;
+
+	assert(GDKrsortable(NULL, tpe));
+	assert(hs == ATOMsize(tpe));
+	if (t == NULL)
+		ts = 0;
+
+	cnt = GDKmalloc(((bits + RSORT_BITS - 1) / RSORT_BITS) *
+			RSORT_BUCKETS * sizeof(size_t));
+	k = GDKmalloc(n * ks);
+	k2 = GDKmalloc(n * ks);
+	wck = GDKmalloc(RSORT_BUCKETS * 64);
+	wcn = GDKmalloc(RSORT_BUCKETS);
+	if (ts) {
+		p = GDKmalloc(n * sizeof(oid));
+		p2 = GDKmalloc(n * sizeof(oid));
+		wcp = GDKmalloc(RSORT_BUCKETS * (64 / ks) * sizeof(oid));
+		tt = GDKmalloc(n * ts);
+	}
+	if (cnt == NULL || k == NULL || k2 == NULL || wck == NULL ||
+	    wcn == NULL ||
+	    (ts && (p == NULL || p2 == NULL || wcp == NULL || tt == NULL))) {
+		if (cnt)
+			GDKfree(cnt);
+		if (k)
+			GDKfree(k);
+		if (k2)
+			GDKfree(k2);
+		if (wck)
+			GDKfree(wck);
+		if (wcn)
+			GDKfree(wcn);
+		if (p)
+			GDKfree(p);
+		if (p2)
+			GDKfree(p2);
+		if (wcp)
+			GDKfree(wcp);
+		if (tt)
+			GDKfree(tt);
+		return GDK_FAIL;
+	}
+	if (ts)
+		for (i = 0; i < n; i++)
+			p[i] = (oid) i;
+	pr = p;			/* positions after sorting */
+
+	if (wide) {
+		ulng *kk = k, *r, mask = ~(ulng) 0;
+
+		rsort_in(lng, ulng, GDK_lng_min);
+		r = rsort_ulng(kk, &pr, k2, p2, n, bits, cnt, wck, wcp, wcn);
+		rsort_out(lng, ulng, GDK_lng_min);
+	} else {
+		unsigned int *kk = k, *r;
+		unsigned int mask = bits == 32 ? ~0U : (1U << bits) - 1;
+
+		switch (hs) {
+		case 1:
+			rsort_in(bte, unsigned int, GDK_bte_min);
+			break;
+		case 2:
+			rsort_in(sht, unsigned int, GDK_sht_min);
+			break;
+		default:
+			rsort_in(int, unsigned int, GDK_int_min);
+			break;
+		}
+		r = rsort_unsigned(kk, &pr, k2, p2, n, bits, cnt, wck, wcp, wcn);
+		switch (hs) {
+		case 1:
+			rsort_out(bte, unsigned int, GDK_bte_min);
+			break;
+		case 2:
+			rsort_out(sht, unsigned int, GDK_sht_min);
+			break;
+		default:
+			rsort_out(int, unsigned int, GDK_int_min);
+			break;
+		}
+	}
+
+	if (ts) {
+		memcpy(tt, t, n * ts);
+		switch (ts) {
+		case 1:
+			for (i = 0; i < n; i++)
+				((bte *) t)[i] = ((bte *) tt)[pr[i]];
+			break;
+		case 2:
+			for (i = 0; i < n; i++)
+				((sht *) t)[i] = ((sht *) tt)[pr[i]];
+			break;
+		case 4:
+			for (i = 0; i < n; i++)
+				((int *) t)[i] = ((int *) tt)[pr[i]];
+			break;
+		case 8:
+			for (i = 0; i < n; i++)
+				((lng *) t)[i] = ((lng *) tt)[pr[i]];
+			break;
+		default:
+			for (i = 0; i < n; i++)
+				memcpy((char *) t + i * ts, tt + pr[i] * ts, ts);
+			break;
+		}
+	}
+
+	GDKfree(cnt);
+	/* the result is in either of each pair of arrays, we free
+	 * both */
+	GDKfree(k);
+	GDKfree(k2);
+	GDKfree(wck);
+	GDKfree(wcn);
+	if (ts) {
+		GDKfree(p);
+		GDKfree(p2);
+		GDKfree(wcp);
+		GDKfree(tt);
+	}
+	return GDK_SUCCEED;
+}
@@ -79,18 +79,25 @@
  * the hash (integer) number to quickly find the head of the bucket
  * chain.  Clearly, the hash mask size is a crucial parameter. If we
  * know that the column is unique (hkey), we use direct hashing (mask
- * size ~= BATcount). Otherwise we dynamically determine the mask size
- * by starting out with mask size = BATcount/64 (just 1.5% of memory
- * storage overhead). Then we start building the hash table on the
- * first 25% of the BAT. As we aim for max-collisions list length of
- * 4, the list on 25% should not exceed length 1. So, if a small
- * number of collisssions occurs (mask/2) then we abandon the attempt
- * and restart with a mask that is 4 times larger. This converges
- * after three cycles to direct hashing.
+ * size ~= BATcount). Otherwise we estimate the number of distinct
+ * values from a sample of the column and pick the mask size from that
+ * estimate up front, so that the table is built only once (we used to
+ * start with mask size = BATcount/64 and restart with a 4 times larger
+ * mask whenever the first 25% of the BAT filled the buckets too
+ * much).
+ *
+ * Large hash tables are built in parallel.  The positions of the BAT
+ * are radix-partitioned on the high bits of their bucket number, so
+ * that each partition covers a disjoint range of buckets.  The bucket
+ * chains of the partitions are then filled by separate threads.  Each
+ * partition holds its positions in increasing order, hence the
+ * resulting hash and link arrays are identical to those of a
+ * sequential build, and HASHloop and friends need not know.
  */
 #include "monetdb_config.h"
 #include "gdk.h"
 #include "gdk_private.h"
+#include "gdk_mapreduce.h"
 
 BUN
 HASHmask(BUN cnt)
@@ -134,18 +141,6 @@ HASHnew(Heap *hp, int tpe, BUN size, BUN mask)
 	return h;
 }
 
-#define starthash(TYPE)							\
-	do {								\
-		TYPE *v = (TYPE*)BUNhloc(bi, 0);			\
-		for (; r < p; r++) {					\
-			BUN c = hash_##TYPE(h, v+r);			\
-									\
-			if (h->hash[c] == BUN_NONE && nslots-- == 0)	\
-				break; /* mask too full */		\
-			h->link[r] = h->hash[c];			\
-			h->hash[c] = r;					\
-		}							\
-	} while (0)
 #define finishhash(TYPE)				\
 	do {						\
 		TYPE *v = (TYPE*)BUNhloc(bi, 0);	\
@@ -157,6 +152,239 @@ HASHnew(Heap *hp, int tpe, BUN size, BUN mask)
 		}					\
 	} while (0)
 
+#define HASH_SAMPLE		4096	/* values sampled for the distinct estimate */
+#define HASH_PARALLEL_MINSIZE	(1 << 20)	/* smallest BAT built in parallel */
+#define HASH_PARTS_PER_THREAD	8
+
+/* Estimate the number of distinct values in the head of b from an
+ * evenly spaced sample of HASH_SAMPLE values.  We use the
+ * bias-corrected Chao1 estimator d + f1(f1-1)/(2(f2+1)), where d is
+ * the number of distinct values in the sample and f1 and f2 are the
+ * numbers of values seen exactly once and twice. */
+static BUN
+HASHdistinct(BAT *b)
+{
+	BUN cnt = BATcount(b), n = MIN(cnt, HASH_SAMPLE);
+	BUN m = 8, i, k, r, d = 0, f1 = 0, f2 = 0, est;
+	BUN *slot, *freq;
+	int tpe = b->htype;
+	BATiter bi = bat_iterator(b);
+	const void *v;
+
+	while (m < 2 * n)
+		m += m;
+	slot = GDKmalloc(m * sizeof(BUN));
+	freq = GDKzalloc(m * sizeof(BUN));
+	if (slot == NULL || freq == NULL) {
+		if (slot)
+			GDKfree(slot);
+		if (freq)
+			GDKfree(freq);
+		return cnt;
+	}
+	for (k = 0; k < m; k++)
+		slot[k] = BUN_NONE;
+	for (i = 0; i < n; i++) {
+		r = BUNfirst(b) + (n == cnt ? i : (BUN) ((dbl) i * cnt / n));
+		v = BUNhead(bi, r);
+		k = (BUN) ATOMhash(tpe, v) & (m - 1);
+		while (slot[k] != BUN_NONE &&
+		       ATOMcmp(tpe, v, BUNhead(bi, slot[k])) != 0)
+			k = (k + 1) & (m - 1);
+		if (slot[k] == BUN_NONE) {
+			slot[k] = r;
+			d++;
+		}
+		freq[k]++;
+	}
+	for (k = 0; k < m; k++)
+		if (freq[k] == 1)
+			f1++;
+		else if (freq[k] == 2)
+			f2++;
+	GDKfree(slot);
+	GDKfree(freq);
+	if (n == cnt)
+		return d;
+	est = d + (BUN) ((dbl) f1 * (f1 - (f1 > 0)) / (2.0 * (f2 + 1)));
+	if (est > cnt)
+		est = cnt;
+	ALGODEBUG fprintf(stderr, "#BAThash: sample " BUNFMT ", distinct " BUNFMT ", once " BUNFMT ", twice " BUNFMT ", estimate " BUNFMT "\n", n, d, f1, f2, est);
+	return est;
+}
+
+typedef struct {
+	BAT *b;
+	Hash *h;
+	unsigned int tpe;
+	BUN first;		/* BUNfirst(b) */
+	BUN grain;		/* positions per chunk */
+	BUN nparts;		/* number of partitions (power of 2) */
+	int shift;		/* bucket >> shift is the partition */
+	BUN *cnt;		/* per chunk per partition counters */
+	BUN *part;		/* start of each partition in pos */
+	BUN *pos;		/* positions, partitioned */
+} hashbuild_t;
+
+/* Evaluate BODY for the positions of the piece with HASH the bucket
+ * number of position r, specialized on the storage type. */
+#define hashpart_switch(BODY)						\
+	do {								\
+		switch (hb->tpe) {					\
+		case TYPE_bte: {					\
+			const bte *v = (const bte *) BUNhloc(bi, 0);	\
+			BODY(hash_bte(h, v + r));			\
+			break;						\
+		}							\
+		case TYPE_sht: {					\
+			const sht *v = (const sht *) BUNhloc(bi, 0);	\
+			BODY(hash_sht(h, v + r));			\
+			break;						\
+		}							\
+		case TYPE_int:						\
+		case TYPE_flt: {					\
+			const int *v = (const int *) BUNhloc(bi, 0);	\
+			BODY(hash_int(h, v + r));			\
+			break;						\
+		}							\
+		case TYPE_dbl:						\
+		case TYPE_lng: {					\
+			const lng *v = (const lng *) BUNhloc(bi, 0);	\
+			BODY(hash_lng(h, v + r));			\
+			break;						\
+		}							\
+		default:						\
+			BODY(heap_hash_any(hb->b->H->vheap, h, BUNhead(bi, r))); \
+			break;						\
+		}							\
+	} while (0)
+
+/* phase 1: histogram of the partitions of a chunk of positions */
+#define hashpart_histo(HASH)						\
+	for (r = l; r < hi; r++)					\
+		cnt[(HASH) >> shift]++
+/* phase 2: scatter the positions of a chunk to their partitions */
+#define hashpart_scatter(HASH)						\
+	for (r = l; r < hi; r++)					\
+		pos[cnt[(HASH) >> shift]++] = r
+/* phase 3: chain the positions of a partition into the buckets */
+#define hashpart_chain(HASH)						\
+	for (j = l; j < e; j++) {					\
+		BUN c;							\
+									\
+		r = pos[j];						\
+		c = HASH;						\
+		h->link[r] = h->hash[c];				\
+		h->hash[c] = r;						\
+	}
+
+static void
+HASHhisto(BUN lo, BUN hi, void *arg)
+{
+	hashbuild_t *hb = arg;
+	Hash *h = hb->h;
+	BATiter bi = bat_iterator(hb->b);
+	BUN *cnt = hb->cnt + ((lo - hb->first) / hb->grain) * hb->nparts;
+	BUN l = lo, r;
+	int shift = hb->shift;
+
+	hashpart_switch(hashpart_histo);
+}
+
+static void
+HASHscatter(BUN lo, BUN hi, void *arg)
+{
+	hashbuild_t *hb = arg;
+	Hash *h = hb->h;
+	BATiter bi = bat_iterator(hb->b);
+	BUN *cnt = hb->cnt + ((lo - hb->first) / hb->grain) * hb->nparts;
+	BUN *pos = hb->pos;
+	BUN l = lo, r;
+	int shift = hb->shift;
+
+	hashpart_switch(hashpart_scatter);
+}
+
+static void
+HASHchain(BUN lo, BUN hi, void *arg)
+{
+	hashbuild_t *hb = arg;
+	Hash *h = hb->h;
+	BATiter bi = bat_iterator(hb->b);
+	const BUN *pos = hb->pos;
+	BUN p, l, e, r, j;
+
+	/* pieces are ranges of partitions */
+	for (p = lo; p < hi; p++) {
+		l = hb->part[p];
+		e = hb->part[p + 1];
+		hashpart_switch(hashpart_chain);
+	}
+}
+
+/* Fill the (empty) hash table h with the positions of b in parallel.
+ * Returns GDK_FAIL if the scratch memory cannot be allocated, in which
+ * case h has not been touched. */
+static gdk_return
+HASHbuild_parallel(BAT *b, Hash *h, unsigned int tpe)
+{
+	hashbuild_t hb;
+	BUN n = BATcount(b), nchunks, i, k, s, c;
+	int nthreads = GDKnr_threads, bits = 0, mbits = 0;
+
+	hb.b = b;
+	hb.h = h;
+	hb.tpe = tpe;
+	hb.first = BUNfirst(b);
+	while (((BUN) 1 << mbits) <= h->mask)
+		mbits++;
+	hb.nparts = 1;
+	while (hb.nparts < (BUN) nthreads * HASH_PARTS_PER_THREAD &&
+	       bits < mbits) {
+		hb.nparts <<= 1;
+		bits++;
+	}
+	hb.shift = mbits - bits;
+	nchunks = (BUN) nthreads;
+	hb.grain = (n + nchunks - 1) / nchunks;
+	nchunks = (n + hb.grain - 1) / hb.grain;
+	hb.cnt = GDKzalloc(nchunks * hb.nparts * sizeof(BUN));
+	hb.part = GDKmalloc((hb.nparts + 1) * sizeof(BUN));
+	hb.pos = GDKmalloc(n * sizeof(BUN));
+	if (hb.cnt == NULL || hb.part == NULL || hb.pos == NULL) {
+		if (hb.cnt)
+			GDKfree(hb.cnt);
+		if (hb.part)
+			GDKfree(hb.part);
+		if (hb.pos)
+			GDKfree(hb.pos);
+		return GDK_FAIL;
+	}
+
+	MRparallel_for(hb.first, hb.first + n, hb.grain, HASHhisto, &hb);
+	/* turn the counts into scatter offsets: partition major, chunk
+	 * minor, so that within a partition the positions stay in
+	 * increasing order */
+	for (k = 0, s = 0; k < hb.nparts; k++) {
+		hb.part[k] = s;
+		for (i = 0; i < nchunks; i++) {
+			c = hb.cnt[i * hb.nparts + k];
+			hb.cnt[i * hb.nparts + k] = s;
+			s += c;
+		}
+	}
+	hb.part[hb.nparts] = s;
+	assert(s == n);
+	MRparallel_for(hb.first, hb.first + n, hb.grain, HASHscatter, &hb);
+	MRparallel_for(0, hb.nparts, 1, HASHchain, &hb);
+
+	ALGODEBUG fprintf(stderr, "#BAThash: parallel build, " BUNFMT " chunks, " BUNFMT " partitions\n", nchunks, hb.nparts);
+	GDKfree(hb.cnt);
+	GDKfree(hb.part);
+	GDKfree(hb.pos);
+	return GDK_SUCCEED;
+}
+
 /* collect HASH statistics for analysis */
 static void HASHcollisions(BAT *b, Hash *h)
 {
@@ -204,7 +432,7 @@ BAThash(BAT *b, BUN masksize)
 		unsigned int tpe = ATOMstorage(b->htype);
 		BUN cnt = BATcount(b);
 		BUN mask;
-		BUN p = BUNfirst(b), q = BUNlast(b), r;
+		BUN p = BUNfirst(b), q = BUNlast(b);
 		Hash *h = NULL;
 		Heap *hp = NULL;
 		str nme = BBP_physical(b->batCacheid);
@@ -226,8 +454,7 @@ BAThash(BAT *b, BUN masksize)
 
 			tpe = TYPE_void;
 		}
-		/* determine hash mask size p = first; then no dynamic
-		 * scheme */
+		/* determine the hash mask size up front */
 		if (masksize > 0) {
 			mask = HASHmask(masksize);
 		} else if (ATOMsize(ATOMstorage(tpe)) == 1) {
@@ -236,78 +463,35 @@ BAThash(BAT *b, BUN masksize)
 			mask = (1 << 12);
 		} else if (b->hkey) {
 			mask = HASHmask(cnt);
-		} else {
-			/* dynamic hash: we start with
-			 * HASHmask(cnt/64); if there are too many
-			 * collisions we try HASHmask(cnt/16), then
-			 * HASHmask(cnt/4), and finally
-			 * HASHmask(cnt).  */
+		} else if (BATcount(b) == 0) {
 			mask = HASHmask(cnt >> 6);
-			p += (cnt >> 2);	/* try out on first 25% of b */
-			if (p > q)
-				p = q;
+		} else {
+			/* aim at one distinct value per bucket */
+			mask = HASHmask(HASHdistinct(b));
 		}
 
 		if (mask < 1024)
 			mask = 1024;
-		do {
-			BUN nslots = mask >> 3;	/* 1/8 full is too full */
-
-			r = BUNfirst(b);
-			if (hp) {
-				HEAPfree(hp);
+		/* create the hash structures */
+		hp = (Heap *) GDKzalloc(sizeof(Heap));
+		if (hp &&
+		    (hp->filename = GDKmalloc(strlen(nme) + 12)) != NULL)
+			sprintf(hp->filename, "%s.%chash", nme, b->batCacheid > 0 ? 'h' : 't');
+		if (hp == NULL ||
+		    hp->filename == NULL ||
+		    (h = HASHnew(hp, ATOMtype(b->htype), BATcapacity(b), mask)) == NULL) {
+			MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BAThash");
+			if (hp != NULL) {
+				GDKfree(hp->filename);
 				GDKfree(hp);
 			}
-			if (h)
-				GDKfree(h);
-			/* create the hash structures */
-			hp = (Heap *) GDKzalloc(sizeof(Heap));
-			if (hp &&
-			    (hp->filename = GDKmalloc(strlen(nme) + 12)) != NULL)
-				sprintf(hp->filename, "%s.%chash", nme, b->batCacheid > 0 ? 'h' : 't');
-			if (hp == NULL ||
-			    hp->filename == NULL ||
-			    (h = HASHnew(hp, ATOMtype(b->htype), BATcapacity(b), mask)) == NULL) {
-				MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BAThash");
-				if (hp != NULL) {
-					GDKfree(hp->filename);
-					GDKfree(hp);
-				}
-				return NULL;
-			}
-
-			switch (tpe) {
-			case TYPE_bte:
-				starthash(bte);
-				break;
-			case TYPE_sht:
-				starthash(sht);
-				break;
-			case TYPE_int:
-			case TYPE_flt:
-				starthash(int);
-				break;
-			case TYPE_dbl:
-			case TYPE_lng:
-				starthash(lng);
-				break;
-			default:
-				for (; r < p; r++) {
-					ptr v = BUNhead(bi, r);
-					BUN c = heap_hash_any(b->H->vheap, h, v);
-
-					if (h->hash[c] == BUN_NONE &&
-					    nslots-- == 0)
-						break;	/* mask too full */
-					h->link[r] = h->hash[c];
-					h->hash[c] = r;
-				}
-				break;
-			}
-		} while (r < p && mask < cnt && (mask <<= 2));
+			return NULL;
+		}
 
-		/* finish the hashtable with the current mask */
-		p = r;
+		if (GDKnr_threads > 1 && tpe != TYPE_void &&
+		    BATcount(b) >= HASH_PARALLEL_MINSIZE &&
+		    HASHbuild_parallel(b, h, tpe) == GDK_SUCCEED)
+			p = q;
 		switch (tpe) {
 		case TYPE_bte:
 			finishhash(bte);
@@ -445,6 +629,318 @@ HASHgonebad(BAT *b, const void *v)
 }
 
 
+/*
+ * @- Zone Maps
+ * A zone map keeps the minimum and maximum value of each zone of
+ * ZONE_BYTES bytes (eight cache lines) of a fixed-width numeric
+ * column.  A range select can skip zones whose range does not overlap
+ * the selected range and can take all values of zones whose range
+ * lies inside it, without looking at the values.  This pays off for
+ * columns that are (nearly) clustered on the selected attribute, such
+ * as time stamps.
+ *
+ * The zone map lives in memory, with the minima of all zones followed
+ * by their maxima.  Appends extend it: the zones that were complete
+ * stay, the last one and the new ones are computed from the values,
+ * either when BATappend finishes (ZONEappend) or else when the zone
+ * map is next used.  Any other update drops it (see the ALIGN*
+ * macros).  The number of values covered is recorded so that values
+ * appended since can be recognized.
+ *
+ * BATsave writes the zone map of a column to a file next to it (file
+ * extension hzonemap or tzonemap, a Zonehdr followed by the minima
+ * and maxima), or removes that file if there is no zone map; BATload
+ * reads it back if it still matches the column.
+ *
+ * Zones containing a NaN get the widest possible range, so that they
+ * are always scanned.
+ */
+#define ZONE_BYTES	512
+#define ZONE_VERSION	1
+
+typedef struct {
+	int version;		/* ZONE_VERSION */
+	int type;		/* storage type of the column */
+	BUN count;		/* number of values covered */
+	BUN zonesize;		/* number of values per zone */
+} Zonehdr;
+
+/* compute the zones z0 and up */
+#define zonemapbuild(TYPE)						\
+	do {								\
+		const TYPE *v = (const TYPE *) Hloc(b, BUNfirst(b));	\
+		TYPE *mn = (TYPE *) zm->min, *mx = (TYPE *) zm->max;	\
+		TYPE lo, hi;						\
+		BUN z, i, e;						\
+		int nan;						\
+									\
+		for (z = z0; z < zm->nzones; z++) {			\
+			i = z * zm->zonesize;				\
+			e = MIN(i + zm->zonesize, cnt);			\
+			lo = hi = v[i];					\
+			nan = 0;					\
+			for (; i < e; i++) {				\
+				if (v[i] < lo)				\
+					lo = v[i];			\
+				if (v[i] > hi)				\
+					hi = v[i];			\
+				nan |= v[i] != v[i];			\
+			}						\
+			if (nan) {					\
+				lo = TYPE##_nil;			\
+				hi = GDK_##TYPE##_max;			\
+			}						\
+			mn[z] = lo;					\
+			mx[z] = hi;					\
+		}							\
+	} while (0)
+
+/* is the head of b a column that can have a zone map? */
+static int
+zone_type(BAT *b)
+{
+	if (isVIEW(b))
+		return 0;
+	switch (ATOMstorage(b->htype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* an empty zone map for cnt values of the head of b */
+static Zonemap *
+zone_alloc(BAT *b, BUN cnt)
+{
+	int width = ATOMsize(b->htype);
+	Zonemap *zm;
+	Heap *hp;
+
+	zm = (Zonemap *) GDKzalloc(sizeof(Zonemap));
+	hp = (Heap *) GDKzalloc(sizeof(Heap));
+	if (zm == NULL || hp == NULL) {
+		if (hp)
+			GDKfree(hp);
+		if (zm)
+			GDKfree(zm);
+		return NULL;
+	}
+	zm->type = ATOMstorage(b->htype);
+	zm->count = cnt;
+	zm->zonesize = ZONE_BYTES / width;
+	zm->nzones = (cnt + zm->zonesize - 1) / zm->zonesize;
+	/* no file name: the heap is always in memory, the file with
+	 * the saved zone map is written by ZONEsave */
+	if (HEAPalloc(hp, 2 * zm->nzones, width) < 0) {
+		GDKfree(hp);
+		GDKfree(zm);
+		return NULL;
+	}
+	hp->free = 2 * zm->nzones * width;
+	zm->heap = hp;
+	zm->min = hp->base;
+	zm->max = hp->base + zm->nzones * width;
+	return zm;
+}
+
+/* Make the zone map of b cover all its values, keeping the complete
+ * zones of the one it has, if any.  Call with the hash lock held.
+ * On failure b has no zone map. */
+static void
+zone_update(BAT *b)
+{
+	Zonemap *old = b->H->zonemap, *zm;
+	BUN cnt = BATcount(b), z0 = 0;
+	int width = ATOMsize(b->htype);
+
+	if (old && old->count > cnt) {
+		/* stale */
+		ZONEremove(b);
+		old = NULL;
+	}
+	if (old && old->count == cnt)
+		return;
+	if ((zm = zone_alloc(b, cnt)) == NULL) {
+		ZONEremove(b);
+		return;
+	}
+	if (old) {
+		z0 = old->count / old->zonesize;
+		memcpy(zm->min, old->min, z0 * width);
+		memcpy(zm->max, old->max, z0 * width);
+		ZONEremove(b);
+	}
+	ALGODEBUG fprintf(stderr, "#BATzonemap: %s zonemap(" BUNFMT "), " BUNFMT " zones;\n", z0 ? "extend" : "create", cnt, zm->nzones);
+	switch (zm->type) {
+	case TYPE_bte:
+		zonemapbuild(bte);
+		break;
+	case TYPE_sht:
+		zonemapbuild(sht);
+		break;
+	case TYPE_int:
+		zonemapbuild(int);
+		break;
+	case TYPE_lng:
+		zonemapbuild(lng);
+		break;
+	case TYPE_flt:
+		zonemapbuild(flt);
+		break;
+	case TYPE_dbl:
+		zonemapbuild(dbl);
+		break;
+	}
+	b->H->zonemap = zm;
+}
+
+BAT *
+BATzonemap(BAT *b)
+{
+	BATcheck(b, "BATzonemap");
+	if (BATcount(b) == 0 || !zone_type(b))
+		return NULL;
+	MT_lock_set(&GDKhashLock(ABS(b->batCacheid)), "BATzonemap");
+	zone_update(b);
+	MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BATzonemap");
+	return b->H->zonemap ? b : NULL;
+}
+
+/* extend the zone maps of b, if any, with the appended values */
+void
+ZONEappend(BAT *b)
+{
+	BAT *bm = BATmirror(b);
+
+	if (b->H->zonemap) {
+		MT_lock_set(&GDKhashLock(ABS(b->batCacheid)), "ZONEappend");
+		zone_update(b);
+		MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "ZONEappend");
+	}
+	if (bm && bm->H->zonemap) {
+		MT_lock_set(&GDKhashLock(ABS(bm->batCacheid)), "ZONEappend");
+		zone_update(bm);
+		MT_lock_unset(&GDKhashLock(ABS(bm->batCacheid)), "ZONEappend");
+	}
+}
+
+static void
+zone_save(BAT *b)
+{
+	const char *ext = b->batCacheid > 0 ? "hzonemap" : "tzonemap";
+	str nme = BBP_physical(b->batCacheid);
+	Zonemap *zm;
+	Zonehdr hdr;
+	size_t size;
+	int fd;
+
+	if (b->H->zonemap && zone_type(b)) {
+		MT_lock_set(&GDKhashLock(ABS(b->batCacheid)), "ZONEsave");
+		zone_update(b);
+		MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "ZONEsave");
+	}
+	if ((zm = b->H->zonemap) == NULL) {
+		GDKunlink(BATDIR, nme, ext);
+		return;
+	}
+	hdr.version = ZONE_VERSION;
+	hdr.type = zm->type;
+	hdr.count = zm->count;
+	hdr.zonesize = zm->zonesize;
+	size = 2 * zm->nzones * ATOMsize(b->htype);
+	if ((fd = GDKfdlocate(nme, "wb", ext)) < 0)
+		return;
+	if (write(fd, &hdr, sizeof(hdr)) != (ssize_t) sizeof(hdr) ||
+	    write(fd, zm->heap->base, size) != (ssize_t) size) {
+		/* better none than a broken one */
+		close(fd);
+		GDKunlink(BATDIR, nme, ext);
+		return;
+	}
+	close(fd);
+}
+
+/* write the zone maps of both columns of b, or remove stale ones */
+void
+ZONEsave(BAT *b)
+{
+	zone_save(b);
+	if (BATmirror(b))
+		zone_save(BATmirror(b));
+}
+
+static void
+zone_load(BAT *b)
+{
+	const char *ext = b->batCacheid > 0 ? "hzonemap" : "tzonemap";
+	Zonemap *zm;
+	Zonehdr hdr;
+	size_t size;
+	int fd;
+
+	b->H->zonemap = NULL;
+	if (BATcount(b) == 0 || !zone_type(b) ||
+	    (fd = GDKfdlocate(BBP_physical(b->batCacheid), "rb", ext)) < 0)
+		return;
+	if (read(fd, &hdr, sizeof(hdr)) == (ssize_t) sizeof(hdr) &&
+	    hdr.version == ZONE_VERSION &&
+	    hdr.type == ATOMstorage(b->htype) &&
+	    hdr.count == BATcount(b) &&
+	    hdr.zonesize == ZONE_BYTES / ATOMsize(b->htype) &&
+	    (zm = zone_alloc(b, hdr.count)) != NULL) {
+		size = 2 * zm->nzones * ATOMsize(b->htype);
+		if (read(fd, zm->heap->base, size) == (ssize_t) size) {
+			b->H->zonemap = zm;
+		} else {
+			HEAPfree(zm->heap);
+			GDKfree(zm->heap);
+			GDKfree(zm);
+		}
+	}
+	if (b->H->zonemap == NULL)
+		IODEBUG THRprintf(GDKstdout, "#ZONEload(%s): ignoring stale %s file\n", BATgetId(b), ext);
+	close(fd);
+}
+
+/* read the zone maps of both columns of a just loaded b */
+void
+ZONEload(BAT *b)
+{
+	zone_load(b);
+	if (BATmirror(b))
+		zone_load(BATmirror(b));
+}
+
+void
+ZONEremove(BAT *b)
+{
+	if (b && b->H->zonemap) {
+		Zonemap *zm = b->H->zonemap;
+
+		b->H->zonemap = NULL;
+		HEAPfree(zm->heap);
+		GDKfree(zm->heap);
+		GDKfree(zm);
+	}
+}
+
+void
+ZONEdestroy(BAT *b)
+{
+	if (b) {
+		ZONEremove(b);
+		if (BATmirror(b))
+			ZONEremove(BATmirror(b));
+	}
+}
+
+
 /*
  * By Peter sept-99. This is a simple implementation that avoids all
  * multiply and divs on most bats by using integer BUNindex numbers
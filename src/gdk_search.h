@@ -31,6 +31,12 @@
  */
 gdk_export void HASHremove(BAT *b);
 gdk_export void HASHdestroy(BAT *b);
+gdk_export void ZONEremove(BAT *b);
+gdk_export void ZONEdestroy(BAT *b);
+gdk_export void STATSremove(BAT *b);
+gdk_export void STATSdestroy(BAT *b);
+gdk_export void CRACKremove(BAT *b);
+gdk_export void CRACKdestroy(BAT *b);
 gdk_export BUN HASHprobe(Hash *h, const void *v);
 gdk_export BUN HASHlist(Hash *h, BUN i);
 
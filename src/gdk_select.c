@@ -20,6 +20,7 @@
 #include "monetdb_config.h"
 #include "gdk.h"
 #include "gdk_private.h"
+#include "gdk_mapreduce.h"
 #include <math.h>
 /*
  *  这个文件是选择操作，选择操作很多
@@ -448,9 +449,323 @@ fullscan_any(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 
 /* scan select with candidates */
 scan_sel ( candscan , o = *candlist++ )
-/* scan select without candidates */
-scan_sel ( fullscan , o = p + off     )
+/* scan select without candidates: see simdscanfunc below */
+
+/* Scan select without candidates using the branch-free kernels of
+ * GDKsimdselect.  The kernels need room for one oid per scanned value,
+ * so instead of buninsfix per qualifying value we make sure there is
+ * room for a whole block before each call. */
+#define SIMDSEL_BLOCK	((BUN) 1 << 16)
+/* smallest column for which we build a zone map */
+#define ZONEMAP_MINSIZE	((BUN) 1 << 16)
+
+/* make room for n more results after cnt in bn, extrapolating the
+ * final result size from the done values scanned so far and the todo
+ * values still to go; returns the (new) start of the result, or NULL
+ * (after reclaiming bn) if the BAT could not be extended */
+static oid *
+scanselect_reserve(BAT *bn, BUN cnt, BUN n, BUN done, BUN todo,
+		   BUN maximum)
+{
+	BUN cap;
+
+	if (BATcapacity(bn) < cnt + n) {
+		cap = cnt + (BUN) ((dbl) cnt / (dbl) (done + 1)
+				   * (dbl) todo * 1.1) + 1024;
+		cap = MAX(MIN(cap, maximum), cnt + n);
+		BATsetcount(bn, cnt);
+		if (BATextend(bn, cap) == NULL) {
+			BBPreclaim(bn);
+			return NULL;
+		}
+	}
+	return (oid *) Tloc(bn, BUNfirst(bn));
+}
+
+#define simdscanfunc(TYPE)						\
+static BUN								\
+simdscan_##TYPE(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th, \
+		int li, int hi, int equi, int anti, int lval, int hval,	\
+		BUN r, BUN q, BUN cnt, wrd off, oid *dst,		\
+		const oid *candlist, BUN maximum)			\
+{									\
+	const TYPE *src = (const TYPE *) Tloc(b, 0);			\
+	TYPE nil = TYPE##_nil;						\
+	int kind = equi ? SIMDSEL_EQ : anti ? SIMDSEL_ANTI : SIMDSEL_RANGE; \
+	BUN p, n;							\
+	(void) candlist;						\
+	(void) li;							\
+	(void) hi;							\
+	(void) lval;							\
+	(void) hval;							\
+	ALGODEBUG fprintf(stderr,					\
+			"#BATsubselect(b=%s#"BUNFMT",s=%s,anti=%d): "	\
+			"scanselect %s (%s)\n", BATgetId(b), BATcount(b), \
+			s ? BATgetId(s) : "NULL", anti,			\
+			equi ? "equi" : anti ? "anti" : "range",	\
+			GDKsimdselect_isa());				\
+	for (p = r; p < q; p += n) {					\
+		n = MIN(q - p, SIMDSEL_BLOCK);				\
+		if ((dst = scanselect_reserve(bn, cnt, n, p - r, q - p,	\
+					      maximum)) == NULL)	\
+			return BUN_NONE;				\
+		cnt += GDKsimdselect(TYPE_##TYPE, kind, src + p, n,	\
+				     (oid) (p + off), tl, th, &nil,	\
+				     dst + cnt);			\
+	}								\
+	return cnt;							\
+}
+
+simdscanfunc(bte)
+simdscanfunc(sht)
+simdscanfunc(int)
+simdscanfunc(flt)
+simdscanfunc(dbl)
+simdscanfunc(lng)
+
+/* Scan select without candidates using the zone map of b: zones that
+ * cannot contain a qualifying value are skipped, zones that contain
+ * only qualifying values are copied without looking at the values,
+ * and only the other zones are scanned.  Consecutive zones of the same
+ * kind are handled together. */
+#define ZONE_NONE	0
+#define ZONE_SOME	1
+#define ZONE_ALL	2
+
+#define zonescanfunc(TYPE)						\
+static int								\
+zoneclass_##TYPE(TYPE mn, TYPE mx, TYPE vl, TYPE vh, TYPE nil, int kind) \
+{									\
+	switch (kind) {							\
+	case SIMDSEL_EQ:						\
+		if (vl < mn || vl > mx)					\
+			return ZONE_NONE;				\
+		return mn == vl && mx == vl ? ZONE_ALL : ZONE_SOME;	\
+	case SIMDSEL_ANTI:						\
+		if (mn > vl && mx < vh)					\
+			return ZONE_NONE;				\
+		return mn != nil && (mx <= vl || mn >= vh) ? ZONE_ALL : ZONE_SOME; \
+	default:							\
+		if (mx < vl || mn > vh)					\
+			return ZONE_NONE;				\
+		return mn >= vl && mx <= vh ? ZONE_ALL : ZONE_SOME;	\
+	}								\
+}									\
+static BUN								\
+zonescan_##TYPE(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th, \
+		int li, int hi, int equi, int anti, int lval, int hval,	\
+		BUN r, BUN q, BUN cnt, wrd off, oid *dst,		\
+		const oid *candlist, BUN maximum)			\
+{									\
+	const TYPE *src = (const TYPE *) Tloc(b, 0);			\
+	const Zonemap *zm = b->T->zonemap;				\
+	const TYPE *mn = (const TYPE *) zm->min;			\
+	const TYPE *mx = (const TYPE *) zm->max;			\
+	TYPE vl = *(const TYPE *) tl, vh = *(const TYPE *) th;		\
+	TYPE nil = TYPE##_nil;						\
+	int kind = equi ? SIMDSEL_EQ : anti ? SIMDSEL_ANTI : SIMDSEL_RANGE; \
+	BUN first = BUNfirst(b), zs = zm->zonesize;			\
+	BUN p = r, e, z, n, i, skipped = 0, taken = 0;			\
+	int c;								\
+	(void) candlist;						\
+	(void) li;							\
+	(void) hi;							\
+	(void) lval;							\
+	(void) hval;							\
+	while (p < q) {							\
+		z = (p - first) / zs;					\
+		c = zoneclass_##TYPE(mn[z], mx[z], vl, vh, nil, kind);	\
+		for (z++; z < zm->nzones && first + z * zs < q &&	\
+			     zoneclass_##TYPE(mn[z], mx[z], vl, vh, nil, kind) == c; \
+		     z++)						\
+			;						\
+		e = MIN(first + z * zs, q);				\
+		if (c == ZONE_NONE) {					\
+			skipped += e - p;				\
+			p = e;						\
+			continue;					\
+		}							\
+		for (; p < e; p += n) {					\
+			n = MIN(e - p, SIMDSEL_BLOCK);			\
+			if ((dst = scanselect_reserve(bn, cnt, n, p - r, \
+						      q - p, maximum)) == NULL) \
+				return BUN_NONE;			\
+			if (c == ZONE_ALL) {				\
+				for (i = 0; i < n; i++)			\
+					dst[cnt + i] = (oid) (p + off + i); \
+				cnt += n;				\
+				taken += n;				\
+			} else {					\
+				cnt += GDKsimdselect(TYPE_##TYPE, kind,	\
+						     src + p, n,	\
+						     (oid) (p + off),	\
+						     tl, th, &nil,	\
+						     dst + cnt);	\
+			}						\
+		}							\
+	}								\
+	ALGODEBUG fprintf(stderr,					\
+			"#BATsubselect(b=%s#"BUNFMT",s=%s,anti=%d): "	\
+			"zonemap scanselect %s: skipped "BUNFMT		\
+			", taken "BUNFMT" of "BUNFMT"\n",		\
+			BATgetId(b), BATcount(b),			\
+			s ? BATgetId(s) : "NULL", anti,			\
+			equi ? "equi" : anti ? "anti" : "range",	\
+			skipped, taken, q - r);				\
+	return cnt;							\
+}
+
+zonescanfunc(bte)
+zonescanfunc(sht)
+zonescanfunc(int)
+zonescanfunc(flt)
+zonescanfunc(dbl)
+zonescanfunc(lng)
+
+
+/* signature of the type-specific core scan select functions */
+typedef BUN (*scanselect_fcn)(BAT *b, BAT *s, BAT *bn, const void *tl,
+			      const void *th, int li, int hi, int equi,
+			      int anti, int lval, int hval, BUN r, BUN q,
+			      BUN cnt, wrd off, oid *dst,
+			      const oid *candlist, BUN maximum);
+
+/*
+ * Morsel-parallel scan select.
+ *
+ * Large scans are cut into morsels of SELECT_MORSEL rows (or
+ * candidates) that are scanned by the map-reduce workers, each into
+ * a private result BAT.  Since the morsels are consecutive ranges of
+ * the input, concatenating the per-morsel results in morsel order
+ * gives the same sorted and key result as a sequential scan.
+ */
+#define SELECT_MORSEL	((BUN) 1 << 20)
+
+typedef struct {
+	BAT *b, *s;
+	const void *tl, *th;
+	int li, hi, equi, anti, lval, hval;
+	wrd off;
+	BUN p;			/* start of the scanned range */
+	const oid *candlist;	/* candidates at p, or NULL */
+	BUN estimate;		/* initial capacity of a morsel result */
+	scanselect_fcn scan;
+	BAT **res;		/* result of each morsel */
+	BUN *cnt;		/* number of results of each morsel */
+	oid *dst;		/* final result */
+	volatile int error;
+} scanmorsel_t;
+
+static void
+scanselect_morsel(BUN l, BUN h, void *arg)
+{
+	scanmorsel_t *m = (scanmorsel_t *) arg;
+	BUN i = (l - m->p) / SELECT_MORSEL;
+	BAT *bn;
+
+	if (m->error)
+		return;
+	bn = BATnew(TYPE_void, TYPE_oid, MIN(m->estimate, h - l));
+	if (bn == NULL) {
+		m->error = 1;
+		return;
+	}
+	m->cnt[i] = (*m->scan)(m->b, m->s, bn, m->tl, m->th, m->li, m->hi,
+			       m->equi, m->anti, m->lval, m->hval, l, h, 0,
+			       m->off, (oid *) Tloc(bn, BUNfirst(bn)),
+			       m->candlist ? m->candlist + (l - m->p) : NULL,
+			       h - l);
+	if (m->cnt[i] == BUN_NONE) {
+		/* bn has been reclaimed by buninsfix */
+		m->error = 1;
+		return;
+	}
+	BATsetcount(bn, m->cnt[i]);
+	m->res[i] = bn;
+}
+
+/* copy the results of morsels [l, h) to their place in the final
+ * result; cnt holds the prefix sums by now */
+static void
+scanselect_concat(BUN l, BUN h, void *arg)
+{
+	scanmorsel_t *m = (scanmorsel_t *) arg;
+
+	for (; l < h; l++)
+		memcpy(m->dst + m->cnt[l],
+		       Tloc(m->res[l], BUNfirst(m->res[l])),
+		       BATcount(m->res[l]) * sizeof(oid));
+}
+
+static BUN
+scanselect_parallel(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
+		    int li, int hi, int equi, int anti, int lval, int hval,
+		    BUN p, BUN q, wrd off, const oid *candlist,
+		    scanselect_fcn scan)
+{
+	scanmorsel_t m;
+	BUN i, n = (q - p + SELECT_MORSEL - 1) / SELECT_MORSEL, cnt = 0;
+
+	ALGODEBUG fprintf(stderr, "#BATsubselect(b=%s#" BUNFMT ",s=%s,anti=%d): "
+			  "parallel scanselect, " BUNFMT " morsels\n",
+			  BATgetId(b), BATcount(b),
+			  s ? BATgetId(s) : "NULL", anti, n);
+	m.b = b;
+	m.s = s;
+	m.tl = tl;
+	m.th = th;
+	m.li = li;
+	m.hi = hi;
+	m.equi = equi;
+	m.anti = anti;
+	m.lval = lval;
+	m.hval = hval;
+	m.off = off;
+	m.p = p;
+	m.candlist = candlist;
+	/* spread the caller's estimate over the morsels */
+	m.estimate = BATcapacity(bn) / n + 1024;
+	m.scan = scan;
+	m.error = 0;
+	m.res = (BAT **) GDKzalloc(n * sizeof(BAT *));
+	m.cnt = (BUN *) GDKmalloc((n + 1) * sizeof(BUN));
+	if (m.res == NULL || m.cnt == NULL)
+		goto bailout;
+
+	MRparallel_for(p, q, SELECT_MORSEL, scanselect_morsel, &m);
+	if (m.error)
+		goto bailout;
+
+	/* turn the counts into offsets in the result */
+	for (i = 0; i < n; i++) {
+		BUN c = m.cnt[i];
+		m.cnt[i] = cnt;
+		cnt += c;
+	}
+	m.cnt[n] = cnt;
+	if (BATcapacity(bn) < cnt && BATextend(bn, cnt) == NULL)
+		goto bailout;
+	m.dst = (oid *) Tloc(bn, BUNfirst(bn));
+	MRparallel_for(0, n, 1, scanselect_concat, &m);
+
+	for (i = 0; i < n; i++)
+		BBPreclaim(m.res[i]);
+	GDKfree(m.res);
+	GDKfree(m.cnt);
+	return cnt;
 
+  bailout:
+	if (m.res) {
+		for (i = 0; i < n; i++)
+			if (m.res[i])
+				BBPreclaim(m.res[i]);
+		GDKfree(m.res);
+	}
+	if (m.cnt)
+		GDKfree(m.cnt);
+	BBPreclaim(bn);
+	return BUN_NONE;
+}
 
 static BAT *
 BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
@@ -468,6 +783,8 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 	 * 32/64-bit OIDs */
 	wrd off;
 	const oid *candlist;
+	scanselect_fcn scan;
+	int zonemap;
 
 	assert(b != NULL);
 	assert(bn != NULL);
@@ -503,31 +820,29 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 		/* should we return an error if p > BUNfirst(s) || q <
 		 * BUNlast(s) (i.e. s not fully used)? */
 		candlist = (const oid *) Tloc(s, p);
-		/* call type-specific core scan select function */
+		/* select type-specific core scan select function */
 		switch (ATOMstorage(b->ttype)) {
 		case TYPE_bte:
-			cnt = candscan_bte(scanargs);
+			scan = candscan_bte;
 			break;
 		case TYPE_sht:
-			cnt = candscan_sht(scanargs);
+			scan = candscan_sht;
 			break;
 		case TYPE_int:
-			cnt = candscan_int(scanargs);
+			scan = candscan_int;
 			break;
 		case TYPE_flt:
-			cnt = candscan_flt(scanargs);
+			scan = candscan_flt;
 			break;
 		case TYPE_dbl:
-			cnt = candscan_dbl(scanargs);
+			scan = candscan_dbl;
 			break;
 		case TYPE_lng:
-			cnt = candscan_lng(scanargs);
+			scan = candscan_lng;
 			break;
 		default:
-			cnt = candscan_any(scanargs);
+			scan = candscan_any;
 		}
-		if (cnt == BUN_NONE)
-			return NULL;
 	} else {
 		if (s) {
 			assert(BATtdense(s));
@@ -544,32 +859,42 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 			q = BUNlast(b);
 		}
 		candlist = NULL;
-		/* call type-specific core scan select function */
+		/* build the zone map of a persistent column on its
+		 * first scan */
+		zonemap = b->batPersistence == PERSISTENT &&
+			  BATcount(b) >= ZONEMAP_MINSIZE &&
+			  BATzonemap(BATmirror(b)) != NULL;
+		/* select type-specific core scan select function */
 		switch (ATOMstorage(b->ttype)) {
 		case TYPE_bte:
-			cnt = fullscan_bte(scanargs);
+			scan = zonemap ? zonescan_bte : simdscan_bte;
 			break;
 		case TYPE_sht:
-			cnt = fullscan_sht(scanargs);
+			scan = zonemap ? zonescan_sht : simdscan_sht;
 			break;
 		case TYPE_int:
-			cnt = fullscan_int(scanargs);
+			scan = zonemap ? zonescan_int : simdscan_int;
 			break;
 		case TYPE_flt:
-			cnt = fullscan_flt(scanargs);
+			scan = zonemap ? zonescan_flt : simdscan_flt;
 			break;
 		case TYPE_dbl:
-			cnt = fullscan_dbl(scanargs);
+			scan = zonemap ? zonescan_dbl : simdscan_dbl;
 			break;
 		case TYPE_lng:
-			cnt = fullscan_lng(scanargs);
+			scan = zonemap ? zonescan_lng : simdscan_lng;
 			break;
 		default:
-			cnt = fullscan_any(scanargs);
+			scan = fullscan_any;
 		}
-		if (cnt == BUN_NONE)
-			return NULL;
 	}
+	if (GDKnr_threads > 1 && q > p && q - p >= 2 * SELECT_MORSEL)
+		cnt = scanselect_parallel(b, s, bn, tl, th, li, hi, equi, anti,
+					  lval, hval, p, q, off, candlist, scan);
+	else
+		cnt = (*scan)(scanargs);
+	if (cnt == BUN_NONE)
+		return NULL;
 	BATsetcount(bn, cnt);
 	bn->tsorted = 1;
 	bn->trevsorted = bn->U->count <= 1;
@@ -799,6 +1124,12 @@ BATsubselect(BAT *b, BAT *s, const void *tl, const void *th,
 			 "b must have a dense head.\n");
 		return NULL;
 	}
+	if (s && BATtcand(s)) {
+		/* compact candidates give compact candidates */
+		Cand *c = BATsubselect_cand(b, s, tl, th, li, hi, anti);
+
+		return c ? CANDtoBAT(c) : NULL;
+	}
 	if (s && !BATtordered(s)) {
 		GDKerror("BATsubselect: invalid argument: "
 			 "s must be sorted.\n");
@@ -1071,6 +1402,15 @@ BATsubselect(BAT *b, BAT *s, const void *tl, const void *th,
 		return bn;
 	}
 
+	if (b->T->cracker && s == NULL && !anti && !(equi && lnil) &&
+	    (bn = CRACKselect(BATmirror(b), tl, th, li, hi, lval, hval)) != NULL) {
+		ALGODEBUG fprintf(stderr, "#BATsubselect(b=%s#" BUNFMT
+				  ",s=%s,anti=%d): cracker index\n",
+				  BATgetId(b), BATcount(b),
+				  s ? BATgetId(s) : "NULL", anti);
+		return bn;
+	}
+
 	/* upper limit for result size */
 	maximum = BATcount(b);
 	if (s) {
@@ -1124,6 +1464,9 @@ BATsubselect(BAT *b, BAT *s, const void *tl, const void *th,
 			/* "small" input: don't bother about more accurate
 			 * estimate */
 			estimate = maximum;
+		} else if ((estimate = STATSselect(BATmirror(b), tl, th, li, hi, equi, anti)) != BUN_NONE) {
+			/* column statistics, plus 10% margin */
+			estimate += estimate / 10;
 		} else {
 			/* layman's quick "pseudo-sample" of 1000 tuples,
 			 * i.e., 333 from begin, middle & end of BAT */
@@ -1156,6 +1499,14 @@ BATsubselect(BAT *b, BAT *s, const void *tl, const void *th,
 		}
 		hash = hash && estimate < BATcount(b) / 100;
 	}
+	if (estimate == BUN_NONE &&
+	    (estimate = STATSselect(BATmirror(b), tl, th, li, hi, equi, anti)) != BUN_NONE) {
+		/* size the result by the column statistics, plus
+		 * 10% margin; the candidates take their share */
+		if (s)
+			estimate = (BUN) ((dbl) estimate * maximum / BATcount(b));
+		estimate += estimate / 10;
+	}
 	if (estimate == BUN_NONE) {
 		/* no better estimate possible/required:
 		 * (pre-)allocate 1M tuples, i.e., avoid/delay extend
@@ -1183,6 +1534,728 @@ BATsubselect(BAT *b, BAT *s, const void *tl, const void *th,
 	return bn;
 }
 
+/* fused conjunctive select
+ *
+ * BATsubselect_conj returns the same as a chain of BATsubselect calls,
+ * one per predicate, each using the result of the previous one as
+ * candidate list (the first one using s), but without materializing
+ * the intermediate candidate lists.  The columns of the predicates
+ * must be aligned.
+ *
+ * If all columns are of a fixed-width numeric type, the predicates
+ * are normalized to closed ranges (as BATsubselect does) and evaluated
+ * in one pass over the columns in blocks of CONJ_BLOCK positions: the
+ * first predicate produces a selection vector of qualifying positions
+ * within the block, which the others then shrink in place.  The
+ * predicates are reordered after every block so that the one that has
+ * recently been the most selective is evaluated first.  Otherwise we
+ * fall back to the chain of BATsubselect calls. */
+
+#define CONJ_BLOCK	((BUN) 1 << 10) /* positions per block */
+
+#define CONJ_EQ		0	/* v == lo */
+#define CONJ_RANGE	1	/* lo <= v && v <= hi */
+#define CONJ_ANTI	2	/* (v <= lo || v >= hi) && v != nil */
+
+typedef union {
+	bte v_bte;
+	sht v_sht;
+	int v_int;
+	lng v_lng;
+	flt v_flt;
+	dbl v_dbl;
+} conjval_t;
+
+typedef struct {
+	const void *vals;	/* values of the column */
+	int tpe;		/* their storage type */
+	int kind;		/* CONJ_EQ, CONJ_RANGE or CONJ_ANTI */
+	conjval_t lo, hi;	/* closed bounds */
+	dbl seen, passed;	/* recent selectivity (decaying counts) */
+} conjpred_t;
+
+#define CONJSET(TYPE, KIND, LO, HI)					\
+	do {								\
+		cp->kind = (KIND);					\
+		cp->lo.v_##TYPE = (LO);					\
+		cp->hi.v_##TYPE = (HI);					\
+	} while (0)
+
+/* see the breakdown of the arguments above BATsubselect; returns -1
+ * if nothing can qualify */
+#define CONJNORMALIZE(TYPE)						\
+	do {								\
+		const TYPE nil = TYPE##_nil;				\
+		TYPE vl = *(const TYPE *) sp->tl, vh;			\
+		if (sp->th == NULL) {					\
+			if (vl == nil) {				\
+				/* anti: everything but nil, whatever li */ \
+				if (sp->anti)				\
+					CONJSET(TYPE, CONJ_RANGE, MINVALUE##TYPE, MAXVALUE##TYPE); \
+				else if (!sp->li)			\
+					return -1;			\
+				else					\
+					CONJSET(TYPE, CONJ_EQ, nil, nil); \
+				break;					\
+			}						\
+			if (!sp->li) {					\
+				if (!sp->anti)				\
+					return -1;			\
+				CONJSET(TYPE, CONJ_RANGE, MINVALUE##TYPE, MAXVALUE##TYPE); \
+				break;					\
+			}						\
+			if (!sp->anti) {				\
+				CONJSET(TYPE, CONJ_EQ, vl, vl);		\
+				break;					\
+			}						\
+			vh = vl;					\
+		} else {						\
+			vh = *(const TYPE *) sp->th;			\
+			if (vl == nil && vh == nil) {			\
+				if (sp->anti)				\
+					return -1;			\
+				CONJSET(TYPE, CONJ_RANGE, MINVALUE##TYPE, MAXVALUE##TYPE); \
+				break;					\
+			}						\
+			if (vl == nil || vh == nil) {			\
+				/* half range; for anti, the other half */ \
+				int lower = (vl == nil) != sp->anti;	\
+				TYPE v = vl == nil ? vh : vl;		\
+				int incl = vl == nil ? sp->hi : sp->li;	\
+				if (lower) {				\
+					/* x <[=] v */			\
+					if (incl == sp->anti) {		\
+						if (v == MINVALUE##TYPE) \
+							return -1;	\
+						v = PREVVALUE##TYPE(v);	\
+					}				\
+					CONJSET(TYPE, CONJ_RANGE, MINVALUE##TYPE, v); \
+				} else {				\
+					/* x >[=] v */			\
+					if (incl == sp->anti) {		\
+						if (v == MAXVALUE##TYPE) \
+							return -1;	\
+						v = NEXTVALUE##TYPE(v);	\
+					}				\
+					CONJSET(TYPE, CONJ_RANGE, v, MAXVALUE##TYPE); \
+				}					\
+				break;					\
+			}						\
+			if (vl > vh)					\
+				return -1;				\
+			if (!sp->anti) {				\
+				if (!sp->li) {				\
+					if (vl == MAXVALUE##TYPE)	\
+						return -1;		\
+					vl = NEXTVALUE##TYPE(vl);	\
+				}					\
+				if (!sp->hi) {				\
+					if (vh == MINVALUE##TYPE)	\
+						return -1;		\
+					vh = PREVVALUE##TYPE(vh);	\
+				}					\
+				if (vl > vh)				\
+					return -1;			\
+				CONJSET(TYPE, CONJ_RANGE, vl, vh);	\
+				break;					\
+			}						\
+			if (vl == vh && !(sp->li && sp->hi)) {		\
+				/* anti-nothing: everything but nil */	\
+				CONJSET(TYPE, CONJ_RANGE, MINVALUE##TYPE, MAXVALUE##TYPE); \
+				break;					\
+			}						\
+		}							\
+		/* anti: x <[=] vl || x >[=] vh, with vl != nil */	\
+		if (sp->th == NULL || sp->li)				\
+			vl = PREVVALUE##TYPE(vl); /* may become nil */	\
+		if (sp->th == NULL || sp->hi) {				\
+			if (vh == MAXVALUE##TYPE) {			\
+				/* no upper part */			\
+				if (vl == nil)				\
+					return -1;			\
+				CONJSET(TYPE, CONJ_RANGE, MINVALUE##TYPE, vl); \
+				break;					\
+			}						\
+			vh = NEXTVALUE##TYPE(vh);			\
+		}							\
+		CONJSET(TYPE, CONJ_ANTI, vl, vh);			\
+	} while (0)
+
+static int
+conj_normalize(const selpred_t *sp, conjpred_t *cp)
+{
+	switch (cp->tpe) {
+	case TYPE_bte:
+		CONJNORMALIZE(bte);
+		break;
+	case TYPE_sht:
+		CONJNORMALIZE(sht);
+		break;
+	case TYPE_int:
+		CONJNORMALIZE(int);
+		break;
+	case TYPE_lng:
+		CONJNORMALIZE(lng);
+		break;
+	case TYPE_flt:
+		CONJNORMALIZE(flt);
+		break;
+	case TYPE_dbl:
+		CONJNORMALIZE(dbl);
+		break;
+	default:
+		assert(0);
+	}
+	return 0;
+}
+
+/* branch-free: always store the position, only advance if it
+ * qualifies; out may be equal to sv */
+#define CONJloop(TEST)							\
+	do {								\
+		if (sv == NULL) {					\
+			for (i = 0; i < n; i++) {			\
+				o = first + i;				\
+				out[k] = o;				\
+				k += (TEST);				\
+			}						\
+		} else {						\
+			for (i = 0; i < n; i++) {			\
+				o = sv[i];				\
+				out[k] = o;				\
+				k += (TEST);				\
+			}						\
+		}							\
+	} while (0)
+
+#define CONJfilter(TYPE)						\
+	do {								\
+		const TYPE *v = (const TYPE *) cp->vals;		\
+		const TYPE lo = cp->lo.v_##TYPE, hi = cp->hi.v_##TYPE;	\
+		const TYPE nil = TYPE##_nil;				\
+		switch (cp->kind) {					\
+		case CONJ_EQ:						\
+			CONJloop(v[o] == lo);				\
+			break;						\
+		case CONJ_RANGE:					\
+			CONJloop((v[o] >= lo) & (v[o] <= hi));		\
+			break;						\
+		case CONJ_ANTI:						\
+			CONJloop(((v[o] <= lo) | (v[o] >= hi)) & (v[o] != nil)); \
+			break;						\
+		}							\
+	} while (0)
+
+/* filter the n positions in sv (or, if sv is NULL, the n positions
+ * starting at first) with predicate cp into out; returns the number
+ * of qualifying positions */
+static BUN
+conj_filter(const conjpred_t *cp, const BUN *sv, BUN first, BUN n, BUN *out)
+{
+	BUN i, k = 0, o;
+
+	switch (cp->tpe) {
+	case TYPE_bte:
+		CONJfilter(bte);
+		break;
+	case TYPE_sht:
+		CONJfilter(sht);
+		break;
+	case TYPE_int:
+		CONJfilter(int);
+		break;
+	case TYPE_lng:
+		CONJfilter(lng);
+		break;
+	case TYPE_flt:
+		CONJfilter(flt);
+		break;
+	case TYPE_dbl:
+		CONJfilter(dbl);
+		break;
+	default:
+		assert(0);
+	}
+	return k;
+}
+
+BAT *
+BATsubselect_conj(BAT *s, const selpred_t *preds, int npreds)
+{
+	BAT *b, *bn;
+	conjpred_t *cps = NULL;
+	int *order = NULL;
+	BUN *sv = NULL;
+	const oid *candlist = NULL;
+	BUN p, q, n, m, k, i, cnt = 0, total;
+	oid o, *dst;
+	int c, j, fused = 1;
+
+	if (preds == NULL || npreds <= 0) {
+		GDKerror("BATsubselect_conj: no predicates\n");
+		return NULL;
+	}
+	b = preds[0].b;
+	for (c = 0; c < npreds; c++) {
+		BATcheck(preds[c].b, "BATsubselect_conj");
+		BATcheck(preds[c].tl, "BATsubselect_conj: tl value required");
+		if (!BAThdense(preds[c].b)) {
+			GDKerror("BATsubselect_conj: invalid argument: "
+				 "b must have a dense head.\n");
+			return NULL;
+		}
+		if (BATcount(preds[c].b) != BATcount(b) ||
+		    preds[c].b->hseqbase != b->hseqbase) {
+			GDKerror("BATsubselect_conj: invalid argument: "
+				 "columns must be aligned.\n");
+			return NULL;
+		}
+		if ((preds[c].li != 0 && preds[c].li != 1) ||
+		    (preds[c].hi != 0 && preds[c].hi != 1) ||
+		    (preds[c].anti != 0 && preds[c].anti != 1)) {
+			GDKerror("BATsubselect_conj: invalid arguments: "
+				 "li, hi, anti must be 0 or 1\n");
+			return NULL;
+		}
+		switch (preds[c].b->ttype == TYPE_oid ||
+			preds[c].b->ttype == TYPE_void ?
+			TYPE_oid : ATOMstorage(preds[c].b->ttype)) {
+		case TYPE_bte:
+		case TYPE_sht:
+		case TYPE_int:
+		case TYPE_lng:
+		case TYPE_flt:
+		case TYPE_dbl:
+			break;
+		default:
+			fused = 0;
+			break;
+		}
+	}
+	if (s && !BATtordered(s)) {
+		GDKerror("BATsubselect_conj: invalid argument: "
+			 "s must be sorted.\n");
+		return NULL;
+	}
+
+	/* BATsubselect iterates compact candidates itself */
+	if (!fused || npreds == 1 || (s && BATtcand(s))) {
+		BAT *cand = s;
+
+		ALGODEBUG fprintf(stderr, "#BATsubselect_conj(b=%s#" BUNFMT
+				  ",s=%s,npreds=%d): chain of subselects\n",
+				  BATgetId(b), BATcount(b),
+				  s ? BATgetId(s) : "NULL", npreds);
+		for (c = 0; c < npreds; c++) {
+			bn = BATsubselect(preds[c].b, cand, preds[c].tl,
+					  preds[c].th, preds[c].li,
+					  preds[c].hi, preds[c].anti);
+			if (cand != s)
+				BBPunfix(cand->batCacheid);
+			if (bn == NULL)
+				return NULL;
+			cand = bn;
+		}
+		return cand;
+	}
+
+	if (BATcount(b) == 0 || (s && BATcount(s) == 0))
+		return newempty();
+	cps = GDKzalloc(npreds * sizeof(conjpred_t));
+	order = GDKmalloc(npreds * sizeof(int));
+	if (cps == NULL || order == NULL)
+		goto bailout;
+	for (c = 0; c < npreds; c++) {
+		cps[c].vals = Tloc(preds[c].b, BUNfirst(preds[c].b));
+		cps[c].tpe = ATOMstorage(preds[c].b->ttype);
+		if (conj_normalize(&preds[c], &cps[c]) < 0) {
+			ALGODEBUG fprintf(stderr, "#BATsubselect_conj(b=%s#"
+					  BUNFMT ",s=%s,npreds=%d): "
+					  "predicate %d empty\n",
+					  BATgetId(b), BATcount(b),
+					  s ? BATgetId(s) : "NULL", npreds, c);
+			GDKfree(cps);
+			GDKfree(order);
+			return newempty();
+		}
+		order[c] = c;
+	}
+
+	/* the positions (relative to the start of the columns) to
+	 * look at: [p, q) or the candidates in candlist[0 .. q-p) */
+	if (s && !BATtdense(s)) {
+		o = b->hseqbase + BATcount(b);
+		q = SORTfndfirst(s, &o);
+		p = SORTfndfirst(s, &b->hseqbase);
+		candlist = (const oid *) Tloc(s, p);
+		total = q - p;
+	} else {
+		p = 0;
+		q = BATcount(b);
+		if (s) {
+			if (s->tseqbase > b->hseqbase)
+				p = MIN((BUN) (s->tseqbase - b->hseqbase), q);
+			if (s->tseqbase + BATcount(s) < b->hseqbase + q)
+				q = s->tseqbase + BATcount(s) > b->hseqbase ?
+					(BUN) (s->tseqbase + BATcount(s) - b->hseqbase) : 0;
+			if (q < p)
+				q = p;
+		}
+		total = q - p;
+	}
+	ALGODEBUG fprintf(stderr, "#BATsubselect_conj(b=%s#" BUNFMT
+			  ",s=%s,npreds=%d): fused scan of " BUNFMT
+			  " positions%s\n",
+			  BATgetId(b), BATcount(b),
+			  s ? BATgetId(s) : "NULL", npreds, total,
+			  candlist ? " (candidates)" : "");
+
+	sv = GDKmalloc(CONJ_BLOCK * sizeof(BUN));
+	bn = BATnew(TYPE_void, TYPE_oid, MIN(total, CONJ_BLOCK));
+	if (sv == NULL || bn == NULL) {
+		if (bn)
+			BBPreclaim(bn);
+		goto bailout;
+	}
+	for (i = 0; i < total; i += n) {
+		n = MIN(total - i, CONJ_BLOCK);
+		if (candlist) {
+			for (k = 0; k < n; k++)
+				sv[k] = (BUN) (candlist[i + k] - b->hseqbase);
+			j = 0;
+		} else {
+			k = conj_filter(&cps[order[0]], NULL, p + i, n, sv);
+			cps[order[0]].seen += n;
+			cps[order[0]].passed += k;
+			j = 1;
+		}
+		for (; j < npreds && k > 0; j++) {
+			conjpred_t *cp = &cps[order[j]];
+
+			cp->seen += k;
+			k = conj_filter(cp, sv, 0, k, sv);
+			cp->passed += k;
+		}
+		if (k > 0) {
+			if ((dst = scanselect_reserve(bn, cnt, k, i, total - i,
+						      total)) == NULL)
+				goto bailout;
+			for (m = 0; m < k; m++)
+				dst[cnt + m] = (oid) sv[m] + b->hseqbase;
+			cnt += k;
+		}
+		/* most selective (lowest pass rate) first; predicates
+		 * that weren't evaluated recently keep their place */
+		for (c = 1; c < npreds; c++) {
+			int t = order[c];
+			dbl rt = (cps[t].passed + 1) / (cps[t].seen + 1);
+
+			for (j = c;
+			     j > 0 &&
+				     (cps[order[j - 1]].passed + 1) /
+				     (cps[order[j - 1]].seen + 1) > rt;
+			     j--)
+				order[j] = order[j - 1];
+			order[j] = t;
+		}
+		for (c = 0; c < npreds; c++) {
+			cps[c].seen /= 2;
+			cps[c].passed /= 2;
+		}
+	}
+	GDKfree(sv);
+	GDKfree(cps);
+	GDKfree(order);
+
+	BATsetcount(bn, cnt);
+	bn->tsorted = 1;
+	bn->trevsorted = bn->U->count <= 1;
+	bn->tkey = 1;
+	bn->tdense = bn->U->count <= 1;
+	if (bn->U->count == 1)
+		bn->tseqbase =  * (oid *) Tloc(bn, BUNfirst(bn));
+	bn->hsorted = 1;
+	bn->hdense = 1;
+	bn->hseqbase = 0;
+	bn->hkey = 1;
+	bn->hrevsorted = bn->U->count <= 1;
+	bn->T->nonil = 1;
+	bn->T->nil = 0;
+	return bn;
+
+  bailout:
+	if (sv)
+		GDKfree(sv);
+	if (cps)
+		GDKfree(cps);
+	if (order)
+		GDKfree(order);
+	GDKerror("BATsubselect_conj: cannot allocate memory\n");
+	return NULL;
+}
+
+/* Selection into a compressed candidate list.
+ *
+ * BATsubselect_cand returns the result of BATsubselect as a Cand.  For
+ * the fixed-width numeric types (and no, a dense or a compact
+ * candidate list) the predicate is normalized as in BATsubselect_conj
+ * and evaluated into a bitmap a word at a time, without branches;
+ * compact candidates are then intersected with that, and CANDcompact
+ * turns the result into a run list or an oid list if that is smaller.
+ * For other types, and for compact candidates so sparse that their
+ * span is more than CANDWORDBITS times their count, compact
+ * candidates are handed to BATsubselect a window at a time, so that
+ * only the candidates are looked at and they are never materialized
+ * as a whole.
+ * Otherwise the BAT produced by BATsubselect is converted. */
+
+/* number of compact candidates per call of BATsubselect */
+#define CAND_WINDOW	((BUN) 1 << 16)
+
+/* are the candidates of Cand c so sparse that an oid list is smaller
+ * than a bitmap over their span? */
+#define CANDSPARSE(c)	((c)->count < ((c)->last - (c)->first) / CANDWORDBITS)
+
+#define CONJbitloop(TEST)						\
+	do {								\
+		for (; i < n && (off + i) % CANDWORDBITS; i++) {	\
+			k = i;						\
+			bits[(off + i) / CANDWORDBITS] |=		\
+				(candword) (TEST) << ((off + i) % CANDWORDBITS); \
+		}							\
+		for (; i + CANDWORDBITS <= n; i += CANDWORDBITS) {	\
+			candword m = 0;					\
+			BUN j;						\
+			for (j = 0; j < CANDWORDBITS; j++) {		\
+				k = i + j;				\
+				m |= (candword) (TEST) << j;		\
+			}						\
+			bits[(off + i) / CANDWORDBITS] = m;		\
+		}							\
+		for (; i < n; i++) {					\
+			k = i;						\
+			bits[(off + i) / CANDWORDBITS] |=		\
+				(candword) (TEST) << ((off + i) % CANDWORDBITS); \
+		}							\
+	} while (0)
+
+#define CONJbits(TYPE)							\
+	do {								\
+		const TYPE *v = (const TYPE *) cp->vals + first;	\
+		const TYPE lo = cp->lo.v_##TYPE, hi = cp->hi.v_##TYPE;	\
+		const TYPE nil = TYPE##_nil;				\
+		switch (cp->kind) {					\
+		case CONJ_EQ:						\
+			CONJbitloop(v[k] == lo);			\
+			break;						\
+		case CONJ_RANGE:					\
+			CONJbitloop((v[k] >= lo) & (v[k] <= hi));	\
+			break;						\
+		case CONJ_ANTI:						\
+			CONJbitloop(((v[k] <= lo) | (v[k] >= hi)) & (v[k] != nil)); \
+			break;						\
+		}							\
+	} while (0)
+
+/* set bit off + i of bits if position first + i qualifies, i < n */
+static void
+conj_bits(const conjpred_t *cp, BUN first, BUN n, candword *bits, BUN off)
+{
+	BUN i = 0, k;
+
+	switch (cp->tpe) {
+	case TYPE_bte:
+		CONJbits(bte);
+		break;
+	case TYPE_sht:
+		CONJbits(sht);
+		break;
+	case TYPE_int:
+		CONJbits(int);
+		break;
+	case TYPE_lng:
+		CONJbits(lng);
+		break;
+	case TYPE_flt:
+		CONJbits(flt);
+		break;
+	case TYPE_dbl:
+		CONJbits(dbl);
+		break;
+	default:
+		assert(0);
+	}
+}
+
+/* BATsubselect_cand for compact candidates s that BATsubselect has to
+ * deal with, or that are too sparse to evaluate the predicate over
+ * their whole span: select per window of candidates, collecting the
+ * results in a bitmap, or in an oid list if the candidates are so
+ * sparse that a bitmap over their span would be larger */
+static Cand *
+cand_subselect_window(BAT *b, BAT *s, const void *tl, const void *th,
+		      int li, int hi, int anti)
+{
+	const Cand *sc = s->T->cand;
+	CandIter ci;
+	Cand *c = NULL;
+	BAT *w, *bn, *rl = NULL;
+	oid *dst, *rd = NULL, o;
+	const oid *r = NULL;
+	BUN i, n, m = 0;
+
+	ALGODEBUG fprintf(stderr, "#BATsubselect_cand(b=%s#" BUNFMT
+			  ",s=%s,anti=%d): windows of candidates\n",
+			  BATgetId(b), BATcount(b), BATgetId(s), anti);
+	if (CANDSPARSE(sc)) {
+		if ((rl = BATnew(TYPE_void, TYPE_oid, sc->count)) == NULL)
+			return NULL;
+		rd = (oid *) Tloc(rl, BUNfirst(rl));
+	} else if ((c = CANDnew(CAND_BITMAP, sc->first, sc->last)) == NULL) {
+		return NULL;
+	}
+	CANDiter(&ci, s, sc->first, sc->last);
+	while (ci.next != oid_nil) {
+		if ((w = BATnew(TYPE_void, TYPE_oid, CAND_WINDOW)) == NULL)
+			goto bailout;
+		dst = (oid *) Tloc(w, BUNfirst(w));
+		for (n = 0; n < CAND_WINDOW && ci.next != oid_nil; n++)
+			dst[n] = CANDiternext(&ci);
+		BATsetcount(w, n);
+		BATseqbase(w, 0);
+		w->tsorted = 1;
+		w->trevsorted = n <= 1;
+		w->tkey = 1;
+		w->tdense = 0;
+		w->T->nil = 0;
+		w->T->nonil = 1;
+		bn = BATsubselect(b, w, tl, th, li, hi, anti);
+		BBPunfix(w->batCacheid);
+		if (bn == NULL)
+			goto bailout;
+		n = BATcount(bn);
+		if (!BATtdense(bn))
+			r = (const oid *) Tloc(bn, BUNfirst(bn));
+		for (i = 0; i < n; i++) {
+			o = BATtdense(bn) ? bn->tseqbase + i : r[i];
+			if (rl)
+				rd[m] = o;
+			else
+				c->bits[(o - c->first) / CANDWORDBITS] |=
+					(candword) 1 << ((o - c->first) % CANDWORDBITS);
+			m++;
+		}
+		BBPunfix(bn->batCacheid);
+	}
+	if (rl == NULL) {
+		c->count = m;
+		return CANDcompact(c);
+	}
+	BATsetcount(rl, m);
+	BATseqbase(rl, 0);
+	rl->tsorted = 1;
+	rl->trevsorted = m <= 1;
+	rl->tkey = 1;
+	rl->tdense = 0;
+	rl->T->nil = 0;
+	rl->T->nonil = 1;
+	c = CANDfromBAT(rl);
+	BBPunfix(rl->batCacheid);
+	return c;
+
+  bailout:
+	if (rl)
+		BBPunfix(rl->batCacheid);
+	CANDdestroy(c);
+	return NULL;
+}
+
+Cand *
+BATsubselect_cand(BAT *b, BAT *s, const void *tl, const void *th,
+		  int li, int hi, int anti)
+{
+	selpred_t sp;
+	conjpred_t cp;
+	BAT *bn;
+	Cand *c, *r;
+	BUN p, q, nwords;
+	oid sfirst, slast;
+
+	BATcheck(b, "BATsubselect_cand");
+	BATcheck(tl, "BATsubselect_cand: tl value required");
+	memset(&cp, 0, sizeof(cp));
+	cp.tpe = b->ttype == TYPE_oid || b->ttype == TYPE_void ?
+		TYPE_oid : ATOMstorage(b->ttype);
+	if (!BAThdense(b) || (s && !BATtdense(s) && !BATtcand(s)) ||
+	    (s && BATtcand(s) && CANDSPARSE(s->T->cand)) ||
+	    (li != 0 && li != 1) || (hi != 0 && hi != 1) ||
+	    (anti != 0 && anti != 1) ||
+	    (cp.tpe != TYPE_bte && cp.tpe != TYPE_sht &&
+	     cp.tpe != TYPE_int && cp.tpe != TYPE_lng &&
+	     cp.tpe != TYPE_flt && cp.tpe != TYPE_dbl)) {
+		if (s && BATtcand(s))
+			return cand_subselect_window(b, s, tl, th, li, hi, anti);
+		/* BATsubselect does the argument checking */
+		if ((bn = BATsubselect(b, s, tl, th, li, hi, anti)) == NULL)
+			return NULL;
+		c = CANDfromBAT(bn);
+		BBPunfix(bn->batCacheid);
+		return c;
+	}
+
+	sp.b = b;
+	sp.tl = tl;
+	sp.th = th;
+	sp.li = li;
+	sp.hi = hi;
+	sp.anti = anti;
+	p = 0;
+	q = BATcount(b);
+	if (s) {
+		/* the range of oids spanned by the candidates */
+		if (BATtcand(s)) {
+			sfirst = s->T->cand->first;
+			slast = s->T->cand->last;
+		} else {
+			sfirst = s->tseqbase;
+			slast = s->tseqbase + BATcount(s);
+		}
+		if (sfirst > b->hseqbase)
+			p = MIN((BUN) (sfirst - b->hseqbase), q);
+		if (slast < b->hseqbase + q)
+			q = slast > b->hseqbase ?
+				(BUN) (slast - b->hseqbase) : 0;
+		if (q < p)
+			q = p;
+	}
+	if (p == q || conj_normalize(&sp, &cp) < 0) {
+		ALGODEBUG fprintf(stderr, "#BATsubselect_cand(b=%s#" BUNFMT
+				  ",s=%s,anti=%d): empty\n",
+				  BATgetId(b), BATcount(b),
+				  s ? BATgetId(s) : "NULL", anti);
+		return CANDnew(CAND_DENSE, 0, 0);
+	}
+	ALGODEBUG fprintf(stderr, "#BATsubselect_cand(b=%s#" BUNFMT
+			  ",s=%s,anti=%d): bitmap select\n",
+			  BATgetId(b), BATcount(b),
+			  s ? BATgetId(s) : "NULL", anti);
+	cp.vals = Tloc(b, BUNfirst(b));
+	c = CANDnew(CAND_BITMAP, b->hseqbase + p, b->hseqbase + q);
+	if (c == NULL)
+		return NULL;
+	conj_bits(&cp, p, q - p, c->bits, (BUN) (b->hseqbase + p - c->first));
+	nwords = (BUN) ((c->last - 1 - c->first) / CANDWORDBITS) + 1;
+	for (p = 0, c->count = 0; p < nwords; p++)
+		c->count += (BUN) candword_popcount(c->bits[p]);
+	if (s && BATtcand(s)) {
+		/* only the candidates qualify */
+		r = CANDintersect(c, s->T->cand);
+		CANDdestroy(c);
+		return r;
+	}
+	return CANDcompact(c);
+}
+
 /* theta select
  *
  * Returns a dense-headed BAT with the OID values of b in the tail for
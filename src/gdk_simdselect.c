@@ -0,0 +1,369 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * Branch-free selection kernels for fixed-width types.
+ * 向量化的选择操作
+ *
+ * GDKsimdselect evaluates one of three closed predicates over an array
+ * of values and writes the oids of the qualifying values:
+ *	SIMDSEL_EQ	v == vl
+ *	SIMDSEL_RANGE	vl <= v && v <= vh
+ *	SIMDSEL_ANTI	(v <= vl || v >= vh) && v != nil
+ * These are exactly the tests of the scanfunc instances in
+ * gdk_select.c after NORMALIZE has made all ranges closed; the special
+ * cases there for one-sided ranges give the same results as the
+ * general range test.
+ *
+ * On x86-64 with 64-bit oids an AVX2 or SSE4.2 version is chosen at
+ * run time from the cpuid feature flags.  These compare a whole vector of values at a time and
+ * turn the comparison result into a bit mask.  The mask is consumed
+ * eight bits at a time: a lookup table gives the positions of the set
+ * bits, which are widened to oids and stored with two (AVX2) or four
+ * (SSE) unconditional vector stores, after which the output pointer is
+ * advanced by the number of set bits.  Everywhere else, and for the
+ * last few values, a scalar loop is used that unconditionally stores
+ * the oid and adds the outcome of the test to the count.  None of the
+ * versions contain data dependent branches.
+ *
+ * All versions write at most n oids to dst.
+ */
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+/* the vector versions store 64-bit oids */
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__) && SIZEOF_OID == 8
+#define SIMDSEL_X86 1
+#include <immintrin.h>
+#define SIMDSEL_TARGET_avx2	__attribute__((target("avx2")))
+#define SIMDSEL_TARGET_sse4	__attribute__((target("sse4.2")))
+#endif
+
+static volatile int simdsel_level = -1; /* 0: scalar, 1: SSE4.2, 2: AVX2 */
+static unsigned char simdsel_idx[256][8]; /* positions of set bits */
+static unsigned char simdsel_cnt[256];	  /* number of set bits */
+
+static void
+simdsel_init(void)
+{
+	int m, j, c, level = 0;
+
+	MT_lock_set(&GDKthreadLock, "simdsel_init");
+	if (simdsel_level >= 0) {
+		MT_lock_unset(&GDKthreadLock, "simdsel_init");
+		return;
+	}
+	for (m = 0; m < 256; m++) {
+		for (j = 0, c = 0; j < 8; j++)
+			if (m & (1 << j))
+				simdsel_idx[m][c++] = (unsigned char) j;
+		simdsel_cnt[m] = (unsigned char) c;
+		while (c < 8)
+			simdsel_idx[m][c++] = 0;
+	}
+#ifdef SIMDSEL_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		level = 2;
+	else if (__builtin_cpu_supports("sse4.2"))
+		level = 1;
+#endif
+	simdsel_level = level;
+	MT_lock_unset(&GDKthreadLock, "simdsel_init");
+}
+
+#define SIMDSEL_SCALAR(TYPE)						\
+static BUN								\
+simdsel_scalar_##TYPE(const TYPE *src, BUN n, oid base, TYPE vl,	\
+		      TYPE vh, TYPE nil, int kind, oid *dst)		\
+{									\
+	BUN i, cnt = 0;							\
+	TYPE v;								\
+									\
+	switch (kind) {							\
+	case SIMDSEL_EQ:						\
+		for (i = 0; i < n; i++) {				\
+			v = src[i];					\
+			dst[cnt] = base + i;				\
+			cnt += v == vl;					\
+		}							\
+		break;							\
+	case SIMDSEL_ANTI:						\
+		for (i = 0; i < n; i++) {				\
+			v = src[i];					\
+			dst[cnt] = base + i;				\
+			cnt += ((v <= vl) | (v >= vh)) & (v != nil);	\
+		}							\
+		break;							\
+	default:							\
+		for (i = 0; i < n; i++) {				\
+			v = src[i];					\
+			dst[cnt] = base + i;				\
+			cnt += (v >= vl) & (v <= vh);			\
+		}							\
+		break;							\
+	}								\
+	return cnt;							\
+}
+
+SIMDSEL_SCALAR(bte)
+SIMDSEL_SCALAR(sht)
+SIMDSEL_SCALAR(int)
+SIMDSEL_SCALAR(lng)
+SIMDSEL_SCALAR(flt)
+SIMDSEL_SCALAR(dbl)
+
+#ifdef SIMDSEL_X86
+
+/* store the oids base+j for the set bits j of the 8-bit mask m at d */
+static inline SIMDSEL_TARGET_avx2 oid *
+simdsel_store_avx2(oid *d, unsigned int m, oid base)
+{
+	__m256i b = _mm256_set1_epi64x((long long) base);
+	int lo, hi;
+
+	memcpy(&lo, simdsel_idx[m], sizeof(int));
+	memcpy(&hi, simdsel_idx[m] + 4, sizeof(int));
+	_mm256_storeu_si256((__m256i *) d,
+			    _mm256_add_epi64(b, _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(lo))));
+	_mm256_storeu_si256((__m256i *) (d + 4),
+			    _mm256_add_epi64(b, _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(hi))));
+	return d + simdsel_cnt[m];
+}
+
+static inline SIMDSEL_TARGET_sse4 oid *
+simdsel_store_sse4(oid *d, unsigned int m, oid base)
+{
+	__m128i b = _mm_set1_epi64x((long long) base);
+	__m128i x;
+	int lo, hi;
+
+	memcpy(&lo, simdsel_idx[m], sizeof(int));
+	memcpy(&hi, simdsel_idx[m] + 4, sizeof(int));
+	x = _mm_cvtsi32_si128(lo);
+	_mm_storeu_si128((__m128i *) d,
+			 _mm_add_epi64(b, _mm_cvtepu8_epi64(x)));
+	_mm_storeu_si128((__m128i *) (d + 2),
+			 _mm_add_epi64(b, _mm_cvtepu8_epi64(_mm_srli_si128(x, 2))));
+	x = _mm_cvtsi32_si128(hi);
+	_mm_storeu_si128((__m128i *) (d + 4),
+			 _mm_add_epi64(b, _mm_cvtepu8_epi64(x)));
+	_mm_storeu_si128((__m128i *) (d + 6),
+			 _mm_add_epi64(b, _mm_cvtepu8_epi64(_mm_srli_si128(x, 2))));
+	return d + simdsel_cnt[m];
+}
+
+/* Each iteration compares NV vectors of VL values, so that the mask
+ * has a multiple of eight bits. */
+#define SIMDSEL_LOOP(ISA, VEC, LOAD, VL, NV, PRED)			\
+	for (; i + (VL) * (NV) <= n; i += (VL) * (NV)) {		\
+		unsigned int m = 0;					\
+		int k;							\
+		for (k = 0; k < (NV); k++) {				\
+			VEC v = LOAD(src + i + k * (VL));		\
+			m |= (unsigned int) (PRED(v)) << (k * (VL));	\
+		}							\
+		for (k = 0; k < (VL) * (NV); k += 8)			\
+			d = simdsel_store_##ISA(d, (m >> k) & 0xFF,	\
+						base + i + k);		\
+	}
+
+#define SIMDSEL_FUNC(ISA, TYPE, VEC, SET1, LOAD, VL, NV, PFX)		\
+static SIMDSEL_TARGET_##ISA BUN						\
+simdsel_##ISA##_##TYPE(const TYPE *src, BUN n, oid base, TYPE vl,	\
+		       TYPE vh, TYPE nil, int kind, oid *dst)		\
+{									\
+	const VEC l = SET1(vl), h = SET1(vh), nl = SET1(nil);		\
+	oid *d = dst;							\
+	BUN i = 0;							\
+									\
+	(void) nl;							\
+	switch (kind) {							\
+	case SIMDSEL_EQ:						\
+		SIMDSEL_LOOP(ISA, VEC, LOAD, VL, NV, PFX##_EQ);		\
+		break;							\
+	case SIMDSEL_ANTI:						\
+		SIMDSEL_LOOP(ISA, VEC, LOAD, VL, NV, PFX##_ANTI);	\
+		break;							\
+	default:							\
+		SIMDSEL_LOOP(ISA, VEC, LOAD, VL, NV, PFX##_RANGE);	\
+		break;							\
+	}								\
+	/* the last few values */					\
+	return (BUN) (d - dst) +					\
+		simdsel_scalar_##TYPE(src + i, n - i, base + i, vl, vh,	\
+				      nil, kind, d);			\
+}
+
+/* Integer predicates are built from signed "greater than" and
+ * "equal"; we compute the lanes that do not qualify and invert the
+ * mask.  FULL has one bit per lane. */
+#define SIMDSEL_INT_EQ(MM, CMPGT, CMPEQ, OR, AND, FULL, v)		\
+	(MM(CMPEQ(v, l)))
+#define SIMDSEL_INT_RANGE(MM, CMPGT, CMPEQ, OR, AND, FULL, v)		\
+	(~MM(OR(CMPGT(l, v), CMPGT(v, h))) & (FULL))
+#define SIMDSEL_INT_ANTI(MM, CMPGT, CMPEQ, OR, AND, FULL, v)		\
+	(~MM(OR(AND(CMPGT(v, l), CMPGT(h, v)), CMPEQ(v, nl))) & (FULL))
+
+/* AVX2 */
+#define avx2_ld(p)	_mm256_loadu_si256((const __m256i *) (p))
+#define avx2_mm8(x)	((unsigned int) _mm256_movemask_epi8(x))
+#define avx2_mm16(x)	((unsigned int) _mm_movemask_epi8(_mm_packs_epi16(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1))))
+#define avx2_mm32(x)	((unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(x)))
+#define avx2_mm64(x)	((unsigned int) _mm256_movemask_pd(_mm256_castsi256_pd(x)))
+
+#define avx2_bte_EQ(v)	  SIMDSEL_INT_EQ(avx2_mm8, _mm256_cmpgt_epi8, _mm256_cmpeq_epi8, _mm256_or_si256, _mm256_and_si256, 0xFFFFFFFFU, v)
+#define avx2_bte_RANGE(v) SIMDSEL_INT_RANGE(avx2_mm8, _mm256_cmpgt_epi8, _mm256_cmpeq_epi8, _mm256_or_si256, _mm256_and_si256, 0xFFFFFFFFU, v)
+#define avx2_bte_ANTI(v)  SIMDSEL_INT_ANTI(avx2_mm8, _mm256_cmpgt_epi8, _mm256_cmpeq_epi8, _mm256_or_si256, _mm256_and_si256, 0xFFFFFFFFU, v)
+#define avx2_sht_EQ(v)	  SIMDSEL_INT_EQ(avx2_mm16, _mm256_cmpgt_epi16, _mm256_cmpeq_epi16, _mm256_or_si256, _mm256_and_si256, 0xFFFFU, v)
+#define avx2_sht_RANGE(v) SIMDSEL_INT_RANGE(avx2_mm16, _mm256_cmpgt_epi16, _mm256_cmpeq_epi16, _mm256_or_si256, _mm256_and_si256, 0xFFFFU, v)
+#define avx2_sht_ANTI(v)  SIMDSEL_INT_ANTI(avx2_mm16, _mm256_cmpgt_epi16, _mm256_cmpeq_epi16, _mm256_or_si256, _mm256_and_si256, 0xFFFFU, v)
+#define avx2_int_EQ(v)	  SIMDSEL_INT_EQ(avx2_mm32, _mm256_cmpgt_epi32, _mm256_cmpeq_epi32, _mm256_or_si256, _mm256_and_si256, 0xFFU, v)
+#define avx2_int_RANGE(v) SIMDSEL_INT_RANGE(avx2_mm32, _mm256_cmpgt_epi32, _mm256_cmpeq_epi32, _mm256_or_si256, _mm256_and_si256, 0xFFU, v)
+#define avx2_int_ANTI(v)  SIMDSEL_INT_ANTI(avx2_mm32, _mm256_cmpgt_epi32, _mm256_cmpeq_epi32, _mm256_or_si256, _mm256_and_si256, 0xFFU, v)
+#define avx2_lng_EQ(v)	  SIMDSEL_INT_EQ(avx2_mm64, _mm256_cmpgt_epi64, _mm256_cmpeq_epi64, _mm256_or_si256, _mm256_and_si256, 0xFU, v)
+#define avx2_lng_RANGE(v) SIMDSEL_INT_RANGE(avx2_mm64, _mm256_cmpgt_epi64, _mm256_cmpeq_epi64, _mm256_or_si256, _mm256_and_si256, 0xFU, v)
+#define avx2_lng_ANTI(v)  SIMDSEL_INT_ANTI(avx2_mm64, _mm256_cmpgt_epi64, _mm256_cmpeq_epi64, _mm256_or_si256, _mm256_and_si256, 0xFU, v)
+
+/* Floating point predicates use ordered comparisons (false for NaN)
+ * except for the test against nil, just like the C operators. */
+#define avx2_flt_EQ(v)	  ((unsigned int) _mm256_movemask_ps(_mm256_cmp_ps(v, l, _CMP_EQ_OQ)))
+#define avx2_flt_RANGE(v) ((unsigned int) _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(v, l, _CMP_GE_OQ), _mm256_cmp_ps(v, h, _CMP_LE_OQ))))
+#define avx2_flt_ANTI(v)  ((unsigned int) _mm256_movemask_ps(_mm256_and_ps(_mm256_or_ps(_mm256_cmp_ps(v, l, _CMP_LE_OQ), _mm256_cmp_ps(v, h, _CMP_GE_OQ)), _mm256_cmp_ps(v, nl, _CMP_NEQ_UQ))))
+#define avx2_dbl_EQ(v)	  ((unsigned int) _mm256_movemask_pd(_mm256_cmp_pd(v, l, _CMP_EQ_OQ)))
+#define avx2_dbl_RANGE(v) ((unsigned int) _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(v, l, _CMP_GE_OQ), _mm256_cmp_pd(v, h, _CMP_LE_OQ))))
+#define avx2_dbl_ANTI(v)  ((unsigned int) _mm256_movemask_pd(_mm256_and_pd(_mm256_or_pd(_mm256_cmp_pd(v, l, _CMP_LE_OQ), _mm256_cmp_pd(v, h, _CMP_GE_OQ)), _mm256_cmp_pd(v, nl, _CMP_NEQ_UQ))))
+
+SIMDSEL_FUNC(avx2, bte, __m256i, _mm256_set1_epi8, avx2_ld, 32, 1, avx2_bte)
+SIMDSEL_FUNC(avx2, sht, __m256i, _mm256_set1_epi16, avx2_ld, 16, 1, avx2_sht)
+SIMDSEL_FUNC(avx2, int, __m256i, _mm256_set1_epi32, avx2_ld, 8, 1, avx2_int)
+SIMDSEL_FUNC(avx2, lng, __m256i, _mm256_set1_epi64x, avx2_ld, 4, 2, avx2_lng)
+SIMDSEL_FUNC(avx2, flt, __m256, _mm256_set1_ps, _mm256_loadu_ps, 8, 1, avx2_flt)
+SIMDSEL_FUNC(avx2, dbl, __m256d, _mm256_set1_pd, _mm256_loadu_pd, 4, 2, avx2_dbl)
+
+/* SSE4.2 (needed for the 64-bit integer comparison) */
+#define sse4_ld(p)	_mm_loadu_si128((const __m128i *) (p))
+#define sse4_mm8(x)	((unsigned int) _mm_movemask_epi8(x))
+#define sse4_mm16(x)	((unsigned int) _mm_movemask_epi8(_mm_packs_epi16(x, _mm_setzero_si128())))
+#define sse4_mm32(x)	((unsigned int) _mm_movemask_ps(_mm_castsi128_ps(x)))
+#define sse4_mm64(x)	((unsigned int) _mm_movemask_pd(_mm_castsi128_pd(x)))
+
+#define sse4_bte_EQ(v)	  SIMDSEL_INT_EQ(sse4_mm8, _mm_cmpgt_epi8, _mm_cmpeq_epi8, _mm_or_si128, _mm_and_si128, 0xFFFFU, v)
+#define sse4_bte_RANGE(v) SIMDSEL_INT_RANGE(sse4_mm8, _mm_cmpgt_epi8, _mm_cmpeq_epi8, _mm_or_si128, _mm_and_si128, 0xFFFFU, v)
+#define sse4_bte_ANTI(v)  SIMDSEL_INT_ANTI(sse4_mm8, _mm_cmpgt_epi8, _mm_cmpeq_epi8, _mm_or_si128, _mm_and_si128, 0xFFFFU, v)
+#define sse4_sht_EQ(v)	  SIMDSEL_INT_EQ(sse4_mm16, _mm_cmpgt_epi16, _mm_cmpeq_epi16, _mm_or_si128, _mm_and_si128, 0xFFU, v)
+#define sse4_sht_RANGE(v) SIMDSEL_INT_RANGE(sse4_mm16, _mm_cmpgt_epi16, _mm_cmpeq_epi16, _mm_or_si128, _mm_and_si128, 0xFFU, v)
+#define sse4_sht_ANTI(v)  SIMDSEL_INT_ANTI(sse4_mm16, _mm_cmpgt_epi16, _mm_cmpeq_epi16, _mm_or_si128, _mm_and_si128, 0xFFU, v)
+#define sse4_int_EQ(v)	  SIMDSEL_INT_EQ(sse4_mm32, _mm_cmpgt_epi32, _mm_cmpeq_epi32, _mm_or_si128, _mm_and_si128, 0xFU, v)
+#define sse4_int_RANGE(v) SIMDSEL_INT_RANGE(sse4_mm32, _mm_cmpgt_epi32, _mm_cmpeq_epi32, _mm_or_si128, _mm_and_si128, 0xFU, v)
+#define sse4_int_ANTI(v)  SIMDSEL_INT_ANTI(sse4_mm32, _mm_cmpgt_epi32, _mm_cmpeq_epi32, _mm_or_si128, _mm_and_si128, 0xFU, v)
+#define sse4_lng_EQ(v)	  SIMDSEL_INT_EQ(sse4_mm64, _mm_cmpgt_epi64, _mm_cmpeq_epi64, _mm_or_si128, _mm_and_si128, 0x3U, v)
+#define sse4_lng_RANGE(v) SIMDSEL_INT_RANGE(sse4_mm64, _mm_cmpgt_epi64, _mm_cmpeq_epi64, _mm_or_si128, _mm_and_si128, 0x3U, v)
+#define sse4_lng_ANTI(v)  SIMDSEL_INT_ANTI(sse4_mm64, _mm_cmpgt_epi64, _mm_cmpeq_epi64, _mm_or_si128, _mm_and_si128, 0x3U, v)
+
+#define sse4_flt_EQ(v)	  ((unsigned int) _mm_movemask_ps(_mm_cmpeq_ps(v, l)))
+#define sse4_flt_RANGE(v) ((unsigned int) _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(v, l), _mm_cmple_ps(v, h))))
+#define sse4_flt_ANTI(v)  ((unsigned int) _mm_movemask_ps(_mm_and_ps(_mm_or_ps(_mm_cmple_ps(v, l), _mm_cmpge_ps(v, h)), _mm_cmpneq_ps(v, nl))))
+#define sse4_dbl_EQ(v)	  ((unsigned int) _mm_movemask_pd(_mm_cmpeq_pd(v, l)))
+#define sse4_dbl_RANGE(v) ((unsigned int) _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(v, l), _mm_cmple_pd(v, h))))
+#define sse4_dbl_ANTI(v)  ((unsigned int) _mm_movemask_pd(_mm_and_pd(_mm_or_pd(_mm_cmple_pd(v, l), _mm_cmpge_pd(v, h)), _mm_cmpneq_pd(v, nl))))
+
+SIMDSEL_FUNC(sse4, bte, __m128i, _mm_set1_epi8, sse4_ld, 16, 1, sse4_bte)
+SIMDSEL_FUNC(sse4, sht, __m128i, _mm_set1_epi16, sse4_ld, 8, 1, sse4_sht)
+SIMDSEL_FUNC(sse4, int, __m128i, _mm_set1_epi32, sse4_ld, 4, 2, sse4_int)
+SIMDSEL_FUNC(sse4, lng, __m128i, _mm_set1_epi64x, sse4_ld, 2, 4, sse4_lng)
+SIMDSEL_FUNC(sse4, flt, __m128, _mm_set1_ps, _mm_loadu_ps, 4, 2, sse4_flt)
+SIMDSEL_FUNC(sse4, dbl, __m128d, _mm_set1_pd, _mm_loadu_pd, 2, 4, sse4_dbl)
+
+#define SIMDSEL_DISPATCH(TYPE)						\
+	do {								\
+		if (simdsel_level == 2)					\
+			return simdsel_avx2_##TYPE((const TYPE *) src, n, base,	\
+						   *(const TYPE *) vl,	\
+						   *(const TYPE *) vh,	\
+						   *(const TYPE *) nil,	\
+						   kind, dst);		\
+		if (simdsel_level == 1)					\
+			return simdsel_sse4_##TYPE((const TYPE *) src, n, base,	\
+						   *(const TYPE *) vl,	\
+						   *(const TYPE *) vh,	\
+						   *(const TYPE *) nil,	\
+						   kind, dst);		\
+		return simdsel_scalar_##TYPE((const TYPE *) src, n, base, \
+					     *(const TYPE *) vl,	\
+					     *(const TYPE *) vh,	\
+					     *(const TYPE *) nil,	\
+					     kind, dst);		\
+	} while (0)
+
+#else
+
+#define SIMDSEL_DISPATCH(TYPE)						\
+	return simdsel_scalar_##TYPE((const TYPE *) src, n, base,	\
+				     *(const TYPE *) vl,		\
+				     *(const TYPE *) vh,		\
+				     *(const TYPE *) nil, kind, dst)
+
+#endif /* SIMDSEL_X86 */
+
+/* which instruction set GDKsimdselect uses, for debugging output */
+const char *
+GDKsimdselect_isa(void)
+{
+	if (simdsel_level < 0)
+		simdsel_init();
+	switch (simdsel_level) {
+	case 2:
+		return "avx2";
+	case 1:
+		return "sse4.2";
+	default:
+		return "scalar";
+	}
+}
+
+/* Evaluate predicate kind on the n values of type tpe (one of the
+ * fixed-width storage types) at src and write base+i for each
+ * qualifying value src[i] to dst, which must have room for n oids.
+ * Returns the number of qualifying values. */
+BUN
+GDKsimdselect(int tpe, int kind, const void *src, BUN n, oid base,
+	      const void *vl, const void *vh, const void *nil, oid *dst)
+{
+	if (simdsel_level < 0)
+		simdsel_init();
+	switch (ATOMstorage(tpe)) {
+	case TYPE_bte:
+		SIMDSEL_DISPATCH(bte);
+	case TYPE_sht:
+		SIMDSEL_DISPATCH(sht);
+	case TYPE_int:
+		SIMDSEL_DISPATCH(int);
+	case TYPE_lng:
+		SIMDSEL_DISPATCH(lng);
+	case TYPE_flt:
+		SIMDSEL_DISPATCH(flt);
+	case TYPE_dbl:
+		SIMDSEL_DISPATCH(dbl);
+	default:
+		assert(0);
+		return 0;
+	}
+}
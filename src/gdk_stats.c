@@ -0,0 +1,610 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * Column statistics.
+ * 列的统计信息
+ *
+ * For a fixed-width numeric column we keep the minimum and maximum,
+ * the number of nils, an estimate of the number of distinct values,
+ * and an equi-depth histogram: STATS_BUCKETS + 1 bounds such that
+ * each bucket holds about the same number of values.  BATsubselect,
+ * the join size estimate and BATgroup use them instead of running
+ * queries on samples.
+ *
+ * The distinct count is a "k minimum values" sketch: the STATS_KMV
+ * smallest hash values of the column.  If the hash values are spread
+ * uniformly over [0, 2^63), the k-th smallest of D distinct ones is
+ * about k * 2^63 / D.  The histogram is made from a regular sample of
+ * STATS_SAMPLE values.
+ *
+ * The statistics describe the first count values of the column.
+ * Appended values are added to the minimum, maximum, nil count and
+ * sketch when BATappend finishes, or else when the statistics are
+ * next used; the histogram only gets its outer bounds moved and is
+ * made again once the column has doubled.  Any other update drops
+ * the statistics (see the ALIGN* macros).
+ *
+ * BATsave builds the statistics of a persistent column of at least
+ * STATS_MINSIZE values and writes them to a file next to the column
+ * (extension hstats or tstats); BATload reads them back if they still
+ * match the column.  They are only used for estimates, so a file that
+ * is out of date after a crash does no harm beyond a bad estimate.
+ */
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_calc_private.h"	/* for ulng */
+
+#define STATS_VERSION	1
+#define STATS_SAMPLE	4096		/* values sampled for the histogram */
+#define STATS_MINSIZE	((BUN) 10000)	/* smaller columns get none at commit */
+
+static int
+stats_type(int tpe)
+{
+	switch (ATOMstorage(tpe)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* 64-bit finalizer of MurmurHash3; the top bit is dropped so that the
+ * hash values are non-negative lng's */
+static inline lng
+stats_hash(ulng h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return (lng) (h >> 1);
+}
+
+#define stats_key_int(v)	((ulng) (lng) (v))
+
+/* flt and dbl add 0 so that -0 and +0, which compare equal, hash
+ * equal */
+static inline ulng
+stats_key_dbl(dbl v)
+{
+	union {
+		dbl d;
+		ulng u;
+	} x;
+
+	x.d = v + 0.0;
+	return x.u;
+}
+
+/* add a hash value to the sketch of the smallest ones */
+static void
+stats_kmv(Colstats *st, lng h)
+{
+	int lo = 0, hi = st->nkmv, m;
+
+	if (st->nkmv == STATS_KMV && h >= st->kmv[STATS_KMV - 1])
+		return;
+	while (lo < hi) {
+		m = (lo + hi) / 2;
+		if (st->kmv[m] < h)
+			lo = m + 1;
+		else
+			hi = m;
+	}
+	if (lo < st->nkmv && st->kmv[lo] == h)
+		return;		/* seen before */
+	if (st->nkmv < STATS_KMV)
+		st->nkmv++;
+	memmove(&st->kmv[lo + 1], &st->kmv[lo],
+		(st->nkmv - 1 - lo) * sizeof(lng));
+	st->kmv[lo] = h;
+}
+
+static void
+stats_distinct(Colstats *st)
+{
+	BUN nonnil = st->count - st->nils;
+	dbl d;
+
+	if (st->nkmv < STATS_KMV) {
+		/* all distinct values are in the sketch */
+		st->distinct = (BUN) st->nkmv;
+	} else if (st->kmv[STATS_KMV - 1] == 0) {
+		st->distinct = nonnil;
+	} else {
+		d = (dbl) (STATS_KMV - 1) * ((dbl) GDK_lng_max / (dbl) st->kmv[STATS_KMV - 1]);
+		st->distinct = d < (dbl) nonnil ? (BUN) d : nonnil;
+	}
+	if (st->distinct == 0 && nonnil > 0)
+		st->distinct = 1;
+}
+
+/* add the values [st->count, cnt) of the head of b; NaNs count as
+ * neither nil nor value */
+#define statsscan(TYPE, KEY)						\
+	do {								\
+		const TYPE *v = (const TYPE *) Hloc(b, BUNfirst(b));	\
+		TYPE mn = 0, mx = 0;					\
+		BUN i, n = 0;						\
+									\
+		for (i = st->count; i < cnt; i++) {			\
+			if (v[i] == TYPE##_nil) {			\
+				st->nils++;				\
+				continue;				\
+			}						\
+			if (v[i] != v[i])				\
+				continue;				\
+			if (n++ == 0) {					\
+				mn = mx = v[i];				\
+			} else if (v[i] < mn) {				\
+				mn = v[i];				\
+			} else if (v[i] > mx) {				\
+				mx = v[i];				\
+			}						\
+			stats_kmv(st, stats_hash(KEY(v[i])));		\
+		}							\
+		if (n > 0) {						\
+			if ((dbl) mn < st->min)				\
+				st->min = (dbl) mn;			\
+			if ((dbl) mx > st->max)				\
+				st->max = (dbl) mx;			\
+		}							\
+	} while (0)
+
+static void
+stats_scan(BAT *b, Colstats *st, BUN cnt)
+{
+	switch (st->type) {
+	case TYPE_bte:
+		statsscan(bte, stats_key_int);
+		break;
+	case TYPE_sht:
+		statsscan(sht, stats_key_int);
+		break;
+	case TYPE_int:
+		statsscan(int, stats_key_int);
+		break;
+	case TYPE_lng:
+		statsscan(lng, stats_key_int);
+		break;
+	case TYPE_flt:
+		statsscan(flt, stats_key_dbl);
+		break;
+	case TYPE_dbl:
+		statsscan(dbl, stats_key_dbl);
+		break;
+	}
+	st->count = cnt;
+	stats_distinct(st);
+	if (st->nbounds > 0) {
+		/* the outer buckets take the new extremes */
+		st->bounds[0] = st->min;
+		st->bounds[st->nbounds - 1] = st->max;
+	}
+}
+
+#define statssample(TYPE)						\
+	do {								\
+		const TYPE *v = (const TYPE *) Hloc(b, BUNfirst(b));	\
+									\
+		for (i = step / 2; i < cnt && n < STATS_SAMPLE; i += step) \
+			if (v[i] != TYPE##_nil && v[i] == v[i])		\
+				smp[n++] = (dbl) v[i];			\
+	} while (0)
+
+static int
+stats_histogram(BAT *b, Colstats *st)
+{
+	BUN cnt = st->count, step, i;
+	size_t n = 0;
+	dbl *smp;
+	int j;
+
+	st->nbounds = 0;
+	st->hcount = cnt;
+	if (st->min > st->max)
+		return 0;	/* no values, only nils */
+	if ((smp = GDKmalloc(STATS_SAMPLE * sizeof(dbl))) == NULL)
+		return -1;
+	step = cnt / STATS_SAMPLE;
+	if (step == 0)
+		step = 1;
+	switch (st->type) {
+	case TYPE_bte:
+		statssample(bte);
+		break;
+	case TYPE_sht:
+		statssample(sht);
+		break;
+	case TYPE_int:
+		statssample(int);
+		break;
+	case TYPE_lng:
+		statssample(lng);
+		break;
+	case TYPE_flt:
+		statssample(flt);
+		break;
+	case TYPE_dbl:
+		statssample(dbl);
+		break;
+	}
+	if (n > 0) {
+		GDKqsort(smp, NULL, NULL, n, sizeof(dbl), 0, TYPE_dbl);
+		for (j = 0; j <= STATS_BUCKETS; j++)
+			st->bounds[j] = smp[(n - 1) * j / STATS_BUCKETS];
+		st->bounds[0] = st->min;
+		st->bounds[STATS_BUCKETS] = st->max;
+		st->nbounds = STATS_BUCKETS + 1;
+	}
+	GDKfree(smp);
+	return 0;
+}
+
+/* bring the statistics of the head of b up to date with the values
+ * appended since; call with the hash lock held */
+static Colstats *
+stats_update(BAT *b)
+{
+	Colstats *st = b->H->stats;
+	BUN cnt = BATcount(b);
+
+	if (st == NULL)
+		return NULL;
+	if (cnt < st->count || st->type != ATOMstorage(b->htype)) {
+		/* not an append */
+		STATSremove(b);
+		return NULL;
+	}
+	if (cnt > st->count) {
+		stats_scan(b, st, cnt);
+		if (st->count >= 2 * st->hcount && stats_histogram(b, st) < 0) {
+			STATSremove(b);
+			return NULL;
+		}
+	}
+	return st;
+}
+
+/* copy the up-to-date statistics of the head of b to *st */
+static int
+stats_get(BAT *b, Colstats *st)
+{
+	Colstats *s;
+
+	if (b->H->stats == NULL)
+		return 0;
+	MT_lock_set(&GDKhashLock(ABS(b->batCacheid)), "stats_get");
+	if ((s = stats_update(b)) != NULL)
+		*st = *s;
+	MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "stats_get");
+	return s != NULL;
+}
+
+BAT *
+BATstats(BAT *b)
+{
+	Colstats *st;
+
+	BATcheck(b, "BATstats");
+	if (isVIEW(b) || !stats_type(b->htype))
+		return NULL;
+	MT_lock_set(&GDKhashLock(ABS(b->batCacheid)), "BATstats");
+	if (stats_update(b) == NULL) {
+		if ((st = (Colstats *) GDKzalloc(sizeof(Colstats))) == NULL) {
+			MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BATstats");
+			return NULL;
+		}
+		st->type = ATOMstorage(b->htype);
+		st->version = STATS_VERSION;
+		st->min = GDK_dbl_max;
+		st->max = GDK_dbl_min;
+		ALGODEBUG fprintf(stderr, "#BATstats: create statistics(" BUNFMT ")\n", BATcount(b));
+		stats_scan(b, st, BATcount(b));
+		if (stats_histogram(b, st) < 0) {
+			MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BATstats");
+			GDKfree(st);
+			return NULL;
+		}
+		b->H->stats = st;
+		/* have them saved at the next commit */
+		if (b->batPersistence == PERSISTENT)
+			b->batDirtydesc = TRUE;
+	}
+	MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BATstats");
+	return b;
+}
+
+void
+STATSremove(BAT *b)
+{
+	if (b && b->H->stats) {
+		GDKfree(b->H->stats);
+		b->H->stats = NULL;
+	}
+}
+
+void
+STATSdestroy(BAT *b)
+{
+	if (b) {
+		STATSremove(b);
+		if (BATmirror(b))
+			STATSremove(BATmirror(b));
+	}
+}
+
+void
+STATSappend(BAT *b)
+{
+	BAT *bm = BATmirror(b);
+
+	if (b->H->stats) {
+		MT_lock_set(&GDKhashLock(ABS(b->batCacheid)), "STATSappend");
+		stats_update(b);
+		MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "STATSappend");
+	}
+	if (bm && bm->H->stats) {
+		MT_lock_set(&GDKhashLock(ABS(bm->batCacheid)), "STATSappend");
+		stats_update(bm);
+		MT_lock_unset(&GDKhashLock(ABS(bm->batCacheid)), "STATSappend");
+	}
+}
+
+static void
+stats_save(BAT *b)
+{
+	const char *ext = b->batCacheid > 0 ? "hstats" : "tstats";
+	str nme = BBP_physical(b->batCacheid);
+	Colstats st;
+
+	if (b->H->stats == NULL &&
+	    !isVIEW(b) &&
+	    b->batPersistence == PERSISTENT &&
+	    BATcount(b) >= STATS_MINSIZE)
+		BATstats(b);
+	if (!stats_type(b->htype))
+		return;
+	if (stats_get(b, &st))
+		GDKsave(nme, ext, &st, sizeof(st), STORE_MEM);
+	else
+		GDKunlink(BATDIR, nme, ext);
+}
+
+/* write the statistics of both columns of b, or remove stale ones */
+void
+STATSsave(BAT *b)
+{
+	stats_save(b);
+	if (BATmirror(b))
+		stats_save(BATmirror(b));
+}
+
+static void
+stats_load(BAT *b)
+{
+	const char *ext = b->batCacheid > 0 ? "hstats" : "tstats";
+	Colstats *st;
+	int fd;
+
+	b->H->stats = NULL;
+	if (!stats_type(b->htype) ||
+	    (fd = GDKfdlocate(BBP_physical(b->batCacheid), "rb", ext)) < 0)
+		return;
+	if ((st = (Colstats *) GDKmalloc(sizeof(Colstats))) != NULL) {
+		if (read(fd, st, sizeof(Colstats)) == (ssize_t) sizeof(Colstats) &&
+		    st->version == STATS_VERSION &&
+		    st->type == ATOMstorage(b->htype) &&
+		    st->count == BATcount(b)) {
+			b->H->stats = st;
+		} else {
+			IODEBUG THRprintf(GDKstdout, "#STATSload(%s): ignoring stale %s file\n", BATgetId(b), ext);
+			GDKfree(st);
+		}
+	}
+	close(fd);
+}
+
+/* read the statistics of both columns of a just loaded b */
+void
+STATSload(BAT *b)
+{
+	stats_load(b);
+	if (BATmirror(b))
+		stats_load(BATmirror(b));
+}
+
+/*
+ * @- Estimates
+ * The histogram is read as if the values are spread evenly within
+ * each bucket.  For integer columns a range [lo, hi] holds the values
+ * v with lo <= v < hi + 1.
+ */
+
+/* fraction of the values that are less than v */
+static dbl
+stats_below(const Colstats *st, dbl v)
+{
+	int j;
+	dbl lo, hi;
+
+	if (st->min > st->max || v <= st->min)
+		return 0;
+	if (v > st->max)
+		return 1;
+	if (v == st->max)
+		return 1 - 1 / (dbl) MAX(st->distinct, 1);
+	if (st->nbounds < 2)
+		return (v - st->min) / (st->max - st->min);
+	for (j = 1; j < st->nbounds - 1 && v >= st->bounds[j]; j++)
+		;
+	/* bounds[j - 1] <= v < bounds[j] */
+	lo = st->bounds[j - 1];
+	hi = st->bounds[j];
+	return (j - 1 + (v - lo) / (hi - lo)) / (st->nbounds - 1);
+}
+
+/* fraction of the values in the range; a nil bound is no bound */
+static dbl
+stats_range(const Colstats *st, dbl vl, dbl vh, int li, int hi, int lnil, int hnil)
+{
+	int integral = st->type != TYPE_flt && st->type != TYPE_dbl;
+	dbl fl = 0, fh = 1;
+
+	if (!lnil)
+		fl = stats_below(st, integral && !li ? vl + 1 : vl);
+	if (!hnil)
+		fh = stats_below(st, integral && hi ? vh + 1 : vh);
+	return fh > fl ? fh - fl : 0;
+}
+
+/* number of values equal to v */
+static dbl
+stats_equal(const Colstats *st, dbl v)
+{
+	dbl nonnil = (dbl) (st->count - st->nils), est, frq;
+	int j, k = 0;
+
+	if (st->min > st->max || v < st->min || v > st->max)
+		return 0;
+	est = nonnil / (dbl) MAX(st->distinct, 1);
+	/* a value that is the bound of several buckets takes up
+	 * (at least) all but one of them */
+	for (j = 0; j < st->nbounds; j++)
+		k += st->bounds[j] == v;
+	if (k > 1) {
+		frq = nonnil * (k - 1) / (st->nbounds - 1);
+		if (frq > est)
+			est = frq;
+	}
+	return est;
+}
+
+/* convert a value to dbl; returns whether it is nil */
+static int
+stats_value(int tpe, const void *v, dbl *d)
+{
+	switch (tpe) {
+	case TYPE_bte:
+		*d = (dbl) *(const bte *) v;
+		return *(const bte *) v == bte_nil;
+	case TYPE_sht:
+		*d = (dbl) *(const sht *) v;
+		return *(const sht *) v == sht_nil;
+	case TYPE_int:
+		*d = (dbl) *(const int *) v;
+		return *(const int *) v == int_nil;
+	case TYPE_lng:
+		*d = (dbl) *(const lng *) v;
+		return *(const lng *) v == lng_nil;
+	case TYPE_flt:
+		*d = (dbl) *(const flt *) v;
+		return *(const flt *) v == flt_nil;
+	case TYPE_dbl:
+		*d = *(const dbl *) v;
+		return *(const dbl *) v == dbl_nil;
+	}
+	*d = 0;
+	return 1;
+}
+
+/*
+ * Estimated result size of BATsubselect(b, NULL, tl, th, li, hi,
+ * anti) on the head of b after BATsubselect has normalized its
+ * arguments (th is set, equi tells whether it is a point select), or
+ * BUN_NONE if b has no statistics.
+ */
+BUN
+STATSselect(BAT *b, const void *tl, const void *th, int li, int hi, int equi, int anti)
+{
+	Colstats st;
+	dbl vl, vh, nonnil, est;
+	int lnil, hnil;
+
+	if (!stats_type(b->htype) || !stats_get(b, &st))
+		return BUN_NONE;
+	nonnil = (dbl) (st.count - st.nils);
+	lnil = stats_value(st.type, tl, &vl);
+	hnil = stats_value(st.type, th, &vh);
+	if (equi && lnil)
+		est = anti ? nonnil : (dbl) st.nils;
+	else if (equi)
+		est = stats_equal(&st, vl);
+	else
+		est = nonnil * stats_range(&st, vl, vh, li, hi, lnil, hnil);
+	if (anti && !(equi && lnil))
+		est = nonnil > est ? nonnil - est : 0;
+	return (BUN) est;
+}
+
+/*
+ * Estimated result size of an equi-join of the heads of l and r, or
+ * BUN_NONE if either has no statistics.  Only the values in the
+ * overlap of the two ranges can match; of those, each value of the
+ * side with fewer distinct values is assumed to find its matches on
+ * the other side.  Like the sampled estimate it is 5% on the high
+ * side.
+ */
+BUN
+STATSjoin(BAT *l, BAT *r)
+{
+	Colstats sl, sr;
+	dbl lo, hi, fl, fr, nl, nr, dl, dr, est;
+
+	if (!stats_type(l->htype) || !stats_get(l, &sl) || !stats_get(r, &sr) ||
+	    sl.type != sr.type)
+		return BUN_NONE;
+	if (sl.min > sl.max || sr.min > sr.max)
+		return 0;
+	lo = MAX(sl.min, sr.min);
+	hi = MIN(sl.max, sr.max);
+	if (lo > hi)
+		return 0;
+	fl = stats_range(&sl, lo, hi, 1, 1, 0, 0);
+	fr = stats_range(&sr, lo, hi, 1, 1, 0, 0);
+	nl = (dbl) (sl.count - sl.nils) * fl;
+	nr = (dbl) (sr.count - sr.nils) * fr;
+	dl = MAX((dbl) sl.distinct * fl, 1);
+	dr = MAX((dbl) sr.distinct * fr, 1);
+	est = nl * nr / MAX(dl, dr) * 1.05;
+	if (est >= (dbl) BUN_MAX)
+		return BUN_MAX;
+	return (BUN) est;
+}
+
+/* estimated number of groups of the head of b (nil is a group), or
+ * BUN_NONE if b has no statistics */
+BUN
+STATSdistinct(BAT *b)
+{
+	Colstats st;
+
+	if (!stats_type(b->htype) || !stats_get(b, &st))
+		return BUN_NONE;
+	return st.distinct + (st.nils > 0);
+}
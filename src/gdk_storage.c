@@ -459,6 +459,10 @@ DESCload(int i)
 	b->htype = ht;
 	b->ttype = tt;
 	b->H->hash = b->T->hash = NULL;
+	b->H->zonemap = b->T->zonemap = NULL;
+	b->H->stats = b->T->stats = NULL;
+	b->H->cracker = b->T->cracker = NULL;
+	b->H->cand = b->T->cand = NULL;
 	/* mil shouldn't mess with just loaded bats */
 	if (b->batStamp > 0)
 		b->batStamp = -b->batStamp;
@@ -605,6 +609,9 @@ BATsave(BAT *bd)
 		GDKfree(b->T->vheap);
 
 	if (err == 0) {
+		/* write (or remove stale) zone maps and statistics */
+		ZONEsave(bd);
+		STATSsave(bd);
 		bd->batCopiedtodisk = 1;
 		DESCclean(bd);
 		return bd;
@@ -705,6 +712,8 @@ BATload_intern(bat i, int lock)
 
 	/* load succeeded; register it in BBP */
 	BBPcacheit(bs, lock);
+	ZONEload(b);
+	STATSload(b);
 
 	if (!DELTAdirty(b)) {
 		ALIGNcommit(b);
@@ -744,6 +753,9 @@ BATdelete(BAT *b)
 	if (loaded) {
 		b = loaded;
 		HASHdestroy(b);
+		ZONEdestroy(b);
+		STATSdestroy(b);
+		CRACKdestroy(b);
 	}
 	assert(!b->H->heap.base || !b->T->heap.base || b->H->heap.base != b->T->heap.base);
 	if (b->batCopiedtodisk || (b->H->heap.storage != STORE_MEM)) {
@@ -780,6 +792,12 @@ BATdelete(BAT *b)
 			HEAPfree(b->T->vheap);
 		}
 	}
+	if (b->batCopiedtodisk) {
+		GDKunlink(BATDIR, o, "hzonemap");
+		GDKunlink(BATDIR, o, "tzonemap");
+		GDKunlink(BATDIR, o, "hstats");
+		GDKunlink(BATDIR, o, "tstats");
+	}
 	b->batCopiedtodisk = FALSE;
 	return 0;
 }
@@ -535,7 +535,9 @@
 /* #undef HAVE__SYS_SIGLIST */
 
 /* Define to 1 if the system has the type `__int128'. */
-/* #undef HAVE___INT128 */
+#ifdef __SIZEOF_INT128__
+#define HAVE___INT128 1
+#endif
 
 /* Define to 1 if the system has the type `__int64'. */
 /* #undef HAVE___INT64 */
@@ -810,6 +812,12 @@ typedef __int64 lng;
 # endif
 #endif
 
+#ifdef HAVE___INT128
+typedef __int128 hge;
+# define HAVE_HGE 1
+# define SIZEOF_HGE 16
+#endif
+
 #ifndef HAVE_PTRDIFF_T
 # if SIZEOF_SIZE_T == SIZEOF_INT
 typedef int ptrdiff_t;
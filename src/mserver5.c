@@ -29,6 +29,7 @@
 #include "gdk_utils.h"
 #include "mutils.h"
 #include "monet_debug.h"
+#include "gdk_mapreduce.h"
 
 #ifdef HAVE_LIBGEN_H
 #include <libgen.h>
@@ -565,6 +566,9 @@ main(int argc, char **av)
 	// #define TYPE_void	0
     // #define TYPE_bit	1
 
+	// 9, 测试mapreduce调度: 中心队列 vs work stealing
+	MRbenchmark(1024, 100);
+
 	/*
 	 * 测试区
 	 * */
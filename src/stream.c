@@ -124,6 +124,12 @@
 		((((lng)normal_int_SWAP(l))<<32) |\
 		 (0xffffffff&normal_int_SWAP(l>>32)))
 
+#ifdef HAVE_HGE
+#define huge_int_SWAP(h) \
+		((((hge)long_long_SWAP(h))<<64) |\
+		 (0xffffffffffffffff&long_long_SWAP(h>>64)))
+#endif
+
 
 struct stream {
 	/*
@@ -3034,6 +3040,32 @@ mnstr_writeLngArray(stream *s, const lng *val, size_t cnt)
 	return s->write(s, val, sizeof(*val), cnt) == (ssize_t) cnt;
 }
 
+#ifdef HAVE_HGE
+int
+mnstr_readHgeArray(stream *s, hge *val, size_t cnt)
+{
+	if (s->read(s, (void *) val, sizeof(*val), cnt) < (ssize_t) cnt) {
+		s->errnr = MNSTR_READ_ERROR;
+		return 0;
+	}
+
+	if (s->byteorder != 1234) {
+		size_t i;
+		for (i = 0; i < cnt; i++, val++)
+			*val = huge_int_SWAP(*val);
+	}
+	return 1;
+}
+
+int
+mnstr_writeHgeArray(stream *s, const hge *val, size_t cnt)
+{
+	if (!s || s->errnr)
+		return (0);
+	return s->write(s, val, sizeof(*val), cnt) == (ssize_t) cnt;
+}
+#endif
+
 int
 mnstr_printf(stream *s, const char *format, ...)
 {
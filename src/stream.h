@@ -113,6 +113,10 @@ stream_export int mnstr_readIntArray(stream *s, int *val, size_t cnt);
 stream_export int mnstr_writeIntArray(stream *s, const int *val, size_t cnt);
 stream_export int mnstr_readLngArray(stream *s, lng *val, size_t cnt);
 stream_export int mnstr_writeLngArray(stream *s, const lng *val, size_t cnt);
+#ifdef HAVE_HGE
+stream_export int mnstr_readHgeArray(stream *s, hge *val, size_t cnt);
+stream_export int mnstr_writeHgeArray(stream *s, const hge *val, size_t cnt);
+#endif
 stream_export int mnstr_printf(stream *s, _In_z_ _Printf_format_string_ const char *format, ...)
 	__attribute__((__format__(__printf__, 2, 3)));
 stream_export ssize_t mnstr_read(stream *s, void *buf, size_t elmsize, size_t cnt);
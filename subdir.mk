@@ -12,19 +12,26 @@ src/gdk_bat.c \
 src/gdk_batop.c \
 src/gdk_bbp.c \
 src/gdk_calc.c \
+src/gdk_cand.c \
+src/gdk_crack.c \
 src/gdk_delta.c \
 src/gdk_group.c \
 src/gdk_heap.c \
 src/gdk_logger.c \
 src/gdk_mapreduce.c \
 src/gdk_posix.c \
+src/gdk_psort.c \
+src/gdk_radixjoin.c \
 src/gdk_qsort.c \
 src/gdk_rangejoin.c \
 src/gdk_relop.c \
+src/gdk_rsort.c \
 src/gdk_sample.c \
 src/gdk_select.c \
+src/gdk_stats.c \
 src/gdk_search.c \
 src/gdk_setop.c \
+src/gdk_simdselect.c \
 src/gdk_ssort.c \
 src/gdk_storage.c \
 src/gdk_system.c \
@@ -49,19 +56,26 @@ src/gdk_bat.o \
 src/gdk_batop.o \
 src/gdk_bbp.o \
 src/gdk_calc.o \
+src/gdk_cand.o \
+src/gdk_crack.o \
 src/gdk_delta.o \
 src/gdk_group.o \
 src/gdk_heap.o \
 src/gdk_logger.o \
 src/gdk_mapreduce.o \
 src/gdk_posix.o \
+src/gdk_psort.o \
+src/gdk_radixjoin.o \
 src/gdk_qsort.o \
 src/gdk_rangejoin.o \
 src/gdk_relop.o \
+src/gdk_rsort.o \
 src/gdk_sample.o \
 src/gdk_select.o \
+src/gdk_stats.o \
 src/gdk_search.o \
 src/gdk_setop.o \
+src/gdk_simdselect.o \
 src/gdk_ssort.o \
 src/gdk_storage.o \
 src/gdk_system.o \
@@ -84,19 +98,26 @@ src/gdk_bat.d \
 src/gdk_batop.d \
 src/gdk_bbp.d \
 src/gdk_calc.d \
+src/gdk_cand.d \
+src/gdk_crack.d \
 src/gdk_delta.d \
 src/gdk_group.d \
 src/gdk_heap.d \
 src/gdk_logger.d \
 src/gdk_mapreduce.d \
 src/gdk_posix.d \
+src/gdk_psort.d \
+src/gdk_radixjoin.d \
 src/gdk_qsort.d \
 src/gdk_rangejoin.d \
 src/gdk_relop.d \
+src/gdk_rsort.d \
 src/gdk_sample.d \
 src/gdk_select.d \
+src/gdk_stats.d \
 src/gdk_search.d \
 src/gdk_setop.d \
+src/gdk_simdselect.d \
 src/gdk_ssort.d \
 src/gdk_storage.d \
 src/gdk_system.d \